@@ -26,6 +26,38 @@ function getBigQuery() {
   return bigquery;
 }
 
+// Device rollup window used for dashboard analytics (15 minutes)
+const ROLLUP_ANALYTICS_WINDOW_MS = 900000;
+
+// Settings stored in the device's flash config (Firmware config_store.cpp
+// key table), by the Firestore field that holds them
+const DEVICE_CONFIG_KEYS = {
+  thresholds: ['tempMin', 'tempMax', 'humidityMin', 'humidityMax'],
+  intervals: ['sensorIntervalMs', 'syncIntervalMs', 'healthIntervalMs'],
+  security: ['offHours']          // 1 while the greenhouse is closed (motion alerts)
+};
+
+/**
+ * Device settings from a config object: { set } with every known key
+ * present, and { delta } with only the keys that differ from previous
+ */
+function deviceConfigDelta(config, previous) {
+  const set = {};
+  const delta = {};
+  for (const [field, keys] of Object.entries(DEVICE_CONFIG_KEYS)) {
+    const values = (config && config[field]) || {};
+    const before = (previous && previous[field]) || {};
+    for (const key of keys) {
+      if (typeof values[key] !== 'number') continue;
+      set[key] = values[key];
+      if (values[key] !== before[key]) {
+        delta[key] = values[key];
+      }
+    }
+  }
+  return { set, delta };
+}
+
 /**
  * Generate a custom authentication token for a device
  */
@@ -180,7 +212,36 @@ exports.getAnalytics = async (data, context) => {
       throw new functions.https.HttpsError('permission-denied', 'Access denied');
     }
     
-    // Get recent sensor readings
+    // Prefer 15-minute device rollups: ~96 documents per day instead of
+    // every raw reading
+    const since = new Date(Date.now() - periodToMillis(period));
+    const rollupSnapshot = await getDb()
+      .collection('greenhouses')
+      .doc(greenhouseId)
+      .collection('rollups')
+      .where('window', '==', ROLLUP_ANALYTICS_WINDOW_MS)
+      .where('start', '>=', since)
+      .orderBy('start', 'desc')
+      .get();
+    
+    if (!rollupSnapshot.empty) {
+      const rollups = [];
+      rollupSnapshot.forEach(doc => rollups.push(doc.data()));
+      
+      const analytics = {
+        temperature: mergeRollupStats(rollups, 'airTemp'),
+        humidity: mergeRollupStats(rollups, 'airHumidity'),
+        vwc: mergeRollupStats(rollups, 'vwc'),
+        co2: mergeRollupStats(rollups, 'co2'),
+        totalReadings: rollups.reduce((total, r) => total + ((r.airTemp && r.airTemp.count) || 0), 0),
+        lastUpdate: rollups[0].end,
+        source: 'rollups'
+      };
+      
+      return { success: true, analytics };
+    }
+    
+    // Fallback for devices that do not upload rollups yet
     const snapshot = await getDb()
       .collection('greenhouses')
       .doc(greenhouseId)
@@ -203,7 +264,8 @@ exports.getAnalytics = async (data, context) => {
       vwc: calculateStats(readings, 'vwc'),
       co2: calculateStats(readings, 'co2'),
       totalReadings: readings.length,
-      lastUpdate: readings[0].timestamp
+      lastUpdate: readings[0].timestamp,
+      source: 'raw'
     };
     
     return { success: true, analytics };
@@ -237,15 +299,46 @@ exports.updateConfig = async (data, context) => {
       throw new functions.https.HttpsError('permission-denied', 'Access denied');
     }
     
+    // Only changed device settings go to the device, under a new generation
+    const { set, delta } = deviceConfigDelta(config, greenhouse);
+    const changed = Object.keys(delta).length > 0;
+    const generation = (greenhouse.configGeneration || 0) + (changed ? 1 : 0);
+    
+    const update = {
+      thresholds: config.thresholds,
+      schedules: config.schedules,
+      updatedAt: admin.firestore.FieldValue.serverTimestamp(),
+      updatedBy: context.auth.uid
+    };
+    if (config.intervals) {
+      update.intervals = config.intervals;
+    }
+    if (config.security) {
+      update.security = config.security;
+    }
+    if (changed) {
+      update.configGeneration = generation;
+    }
+    
     await getDb()
       .collection('greenhouses')
       .doc(greenhouseId)
-      .update({
-        thresholds: config.thresholds,
-        schedules: config.schedules,
-        updatedAt: admin.firestore.FieldValue.serverTimestamp(),
-        updatedBy: context.auth.uid
-      });
+      .update(update);
+    
+    if (changed) {
+      // Full document for fetchConfig() after an outage, delta over the stream
+      await admin.database()
+        .ref(`config/${greenhouseId}`)
+        .set({ generation, set });
+      await admin.database()
+        .ref(`commands/${greenhouseId}`)
+        .push({
+          target: 'config',
+          generation,
+          set: delta,
+          createdAt: admin.database.ServerValue.TIMESTAMP
+        });
+    }
     
     // Log configuration change
     await getDb()
@@ -259,7 +352,7 @@ exports.updateConfig = async (data, context) => {
         timestamp: admin.firestore.FieldValue.serverTimestamp()
       });
     
-    return { success: true };
+    return { success: true, configGeneration: generation };
     
   } catch (error) {
     console.error('Error updating config:', error);
@@ -332,6 +425,324 @@ exports.getGreenhouseStatus = async (data, context) => {
   }
 };
 
+/**
+ * Ingest a batch of buffered readings uploaded by a device
+ *
+ * Payload (v1) is columnar: "t" holds ms offsets from "base" in device
+ * millis(), value columns hold fixed-point integers (divide by "scale")
+ * or null for invalid samples. "base" and the rollup starts are millis()
+ * of "logBoot", the boot that logged the records, which for data synced
+ * from the device log may be a boot before a reset; "now" is millis() of
+ * the sending boot at send time. Times convert per boot (see
+ * bootStarts); a batch without "logBoot" is from the sending boot. Optional
+ * "rollups" carry completed 1-min / 15-min device windows as
+ * {w, s, <column>: [min, max, mean, count, last] | null, act} where
+ * "act" maps each actuator that ran to [on seconds, energy in 0.1 Wh].
+ *
+ * "boot" + "seq" identify the batch. A device retries a batch whose
+ * confirmation it never saw with the same id, so a batch already stored
+ * under greenhouses/{id}/batches/{boot}-{seq} is acknowledged again
+ * without writing anything.
+ */
+exports.ingestSensorBatch = async (data, context) => {
+  if (!context.auth || !context.auth.token.isDevice) {
+    throw new functions.https.HttpsError('unauthenticated', 'Device must be authenticated');
+  }
+
+  const greenhouseId = context.auth.token.greenhouseId;
+  const { v, now, base, n, scale, t, rollups = [], boot, seq, logBoot } = data;
+
+  if (v !== 1 || !Array.isArray(t) || t.length !== n || !scale) {
+    throw new functions.https.HttpsError('invalid-argument', 'Unsupported or malformed batch');
+  }
+
+  // Payload column -> Firestore field
+  const columns = {
+    temp: 'airTemp',
+    rh: 'airHumidity',
+    co2: 'co2',
+    ph: 'ph',
+    ec: 'ec',
+    vwc: 'vwc'
+  };
+
+  const greenhouseRef = getDb().collection('greenhouses').doc(greenhouseId);
+  const batchRef = Number.isInteger(boot) && Number.isInteger(seq)
+    ? greenhouseRef.collection('batches').doc(`${boot}-${seq}`)
+    : null;
+  const duplicate = { success: true, count: n, rollups: rollups.length, duplicate: true };
+
+  try {
+    if (batchRef && (await batchRef.get()).exists) {
+      console.log(`Duplicate batch ${boot}-${seq} for ${greenhouseId} - already stored`);
+      return duplicate;
+    }
+
+    const receivedAt = Date.now();
+    const sensorsRef = greenhouseRef.collection('sensors');
+
+    // Latest device time in the batch places it if its boot has no anchor
+    const latest = Math.max(base + (n > 0 ? Math.max(...t) : 0),
+      ...rollups.map(rollup => rollup.s + rollup.w));
+    const starts = await bootStarts(greenhouseRef, boot, now, receivedAt, { [logBoot]: latest });
+    const logStart = starts.of(logBoot);
+
+    // Firestore batches are limited to 500 writes
+    let batch = getDb().batch();
+    let pending = 0;
+
+    for (let i = 0; i < n; i++) {
+      const reading = {
+        timestamp: new Date(logStart.at + base + t[i]),
+        exported: false
+      };
+      if (logStart.approximate) reading.timestampApproximate = true;
+
+      Object.keys(columns).forEach(key => {
+        const column = data[key];
+        if (Array.isArray(column) && column[i] !== null && column[i] !== undefined) {
+          reading[columns[key]] = column[i] / scale[key];
+        }
+      });
+
+      batch.set(sensorsRef.doc(), reading);
+      pending++;
+
+      if (pending === 500) {
+        await batch.commit();
+        batch = getDb().batch();
+        pending = 0;
+      }
+    }
+
+    // Pre-aggregated windows for analytics (see getAnalytics)
+    const rollupsRef = greenhouseRef.collection('rollups');
+
+    for (const rollup of rollups) {
+      const start = new Date(logStart.at + rollup.s);
+      const doc = {
+        window: rollup.w,
+        start: start,
+        end: new Date(start.getTime() + rollup.w),
+        exported: false
+      };
+      if (logStart.approximate) doc.startApproximate = true;
+
+      Object.keys(columns).forEach(key => {
+        const summary = rollup[key];
+        if (Array.isArray(summary) && summary.length === 5) {
+          const [min, max, mean, count, last] = summary;
+          doc[columns[key]] = {
+            min: min / scale[key],
+            max: max / scale[key],
+            mean: mean / scale[key],
+            count: count,
+            last: last / scale[key]
+          };
+        }
+      });
+
+      // Actuator on-time and estimated energy (rated wattage x on-time)
+      if (rollup.act && typeof rollup.act === 'object') {
+        doc.actuators = {};
+        Object.keys(rollup.act).forEach(name => {
+          const usage = rollup.act[name];
+          if (Array.isArray(usage) && usage.length === 2) {
+            doc.actuators[name] = {
+              onSeconds: usage[0],
+              kwh: usage[1] / 10000
+            };
+          }
+        });
+      }
+
+      batch.set(rollupsRef.doc(), doc);
+      pending++;
+
+      if (pending === 500) {
+        await batch.commit();
+        batch = getDb().batch();
+        pending = 0;
+      }
+    }
+
+    // The marker commits with the last writes (a device batch is one
+    // commit); create() fails if a concurrent retry got there first
+    if (batchRef) {
+      batch.create(batchRef, { receivedAt: new Date(receivedAt), count: n, rollups: rollups.length });
+      pending++;
+    }
+
+    if (pending > 0) {
+      await batch.commit();
+    }
+
+    console.log(`Ingested ${n} readings and ${rollups.length} rollups for ${greenhouseId}`);
+    return { success: true, count: n, rollups: rollups.length };
+
+  } catch (error) {
+    if (batchRef && error.code === 6) {  // ALREADY_EXISTS
+      return duplicate;
+    }
+    console.error('Error ingesting sensor batch:', error);
+    throw new functions.https.HttpsError('internal', error.message);
+  }
+};
+
+/**
+ * Ingest device alerts
+ *
+ * Either one alert, {boot, now, message, severity?, first, logBoot}
+ * (emergencies, and alerts synced from the device log - severity is
+ * missing only in records from earlier firmware), or a coalesced queue
+ * batch, {boot, now, alerts: [{type, severity, count, first, last,
+ * escalated, message}]}, most severe first. A batch becomes ONE alert
+ * document, so sendAlertNotification fans out once per batch rather than
+ * per alert.
+ *
+ * Batch times are millis() of the sending boot. A single alert's "first"
+ * is millis() of "logBoot", which for a logged alert may be a boot
+ * before a reset - it is converted against that boot (see bootStarts).
+ */
+exports.ingestAlert = async (data, context) => {
+  if (!context.auth || !context.auth.token.isDevice) {
+    throw new functions.https.HttpsError('unauthenticated', 'Device must be authenticated');
+  }
+
+  const greenhouseId = context.auth.token.greenhouseId;
+  const { boot, now, message, severity, alerts, first, logBoot } = data;
+  const greenhouseRef = getDb().collection('greenhouses').doc(greenhouseId);
+
+  try {
+    const receivedAt = Date.now();
+    const starts = await bootStarts(greenhouseRef, boot, now, receivedAt,
+      Number.isInteger(first) ? { [logBoot]: first } : {});
+
+    let doc;
+    if (Array.isArray(alerts) && alerts.length > 0) {
+      const entries = alerts.map(entry => ({
+        type: entry.type,
+        severity: entry.severity || 'medium',
+        count: entry.count || 1,
+        firstSeen: new Date(starts.current + entry.first),
+        lastSeen: new Date(starts.current + entry.last),
+        escalated: entry.escalated === true,
+        message: entry.message
+      }));
+
+      doc = {
+        type: entries.length > 1 ? `${entries[0].type} (+${entries.length - 1} more)` : entries[0].type,
+        severity: entries[0].severity,
+        message: entries.map(entry => entry.message).join('; '),
+        entries: entries
+      };
+    } else if (typeof message === 'string' && message.length > 0) {
+      doc = {
+        type: 'DEVICE',
+        severity: severity || 'medium',
+        message: message
+      };
+      if (Number.isInteger(first)) {
+        const start = starts.of(logBoot);
+        doc.firstSeen = new Date(start.at + first);
+        if (start.approximate) doc.firstSeenApproximate = true;
+      }
+    } else {
+      throw new functions.https.HttpsError('invalid-argument', 'No alert in request');
+    }
+
+    await greenhouseRef
+      .collection('alerts')
+      .add({
+        ...doc,
+        source: 'device',
+        timestamp: admin.firestore.FieldValue.serverTimestamp(),
+        acknowledged: false
+      });
+
+    return { success: true, count: doc.entries ? doc.entries.length : 1 };
+
+  } catch (error) {
+    if (error instanceof functions.https.HttpsError) throw error;
+    console.error('Error ingesting alert:', error);
+    throw new functions.https.HttpsError('internal', error.message);
+  }
+};
+
+/**
+ * Wall-clock start (epoch ms at millis() = 0) of the boots a device
+ * request refers to
+ *
+ * The sending boot is anchored at receipt as receivedAt - now and the
+ * anchor kept in greenhouses/{id}/boots/{boot} (earliest estimate wins -
+ * upload latency only makes it late), so records logged in that boot and
+ * synced after a reset still convert against it. `latest` maps each
+ * other boot id to its latest device time in the request. A boot with no
+ * anchor never reached the cloud: its records are placed to end at the
+ * sending boot's start and flagged approximate. Requests without a boot
+ * id (earlier firmware) convert against receipt, as before.
+ */
+async function bootStarts(greenhouseRef, boot, now, receivedAt, latest = {}) {
+  const current = receivedAt - now;
+  const known = {};
+
+  if (Number.isInteger(boot)) {
+    const ids = [...new Set([boot, ...Object.keys(latest).map(Number).filter(Number.isInteger)])];
+    const refs = ids.map(id => greenhouseRef.collection('boots').doc(String(id)));
+    const docs = await getDb().getAll(...refs);
+    docs.forEach((doc, i) => {
+      if (doc.exists) known[ids[i]] = doc.data().start;
+    });
+
+    if (known[boot] === undefined || known[boot] > current) {
+      await refs[0].set({ start: current, updatedAt: new Date(receivedAt) });
+      known[boot] = current;
+    }
+  }
+
+  return {
+    current: Number.isInteger(boot) ? known[boot] : current,
+    of(id) {
+      if (!Number.isInteger(boot) || id === undefined || id === boot) {
+        return { at: this.current, approximate: false };
+      }
+      if (known[id] !== undefined) {
+        return { at: known[id], approximate: false };
+      }
+      return { at: this.current - (latest[id] || 0), approximate: true };
+    }
+  };
+}
+
+/**
+ * Parse an analytics period such as "24h", "7d" or "30d"
+ */
+function periodToMillis(period) {
+  const match = /^(\d+)([hd])$/.exec(period);
+  if (!match) return 7 * 86400000;
+  return parseInt(match[1], 10) * (match[2] === 'h' ? 3600000 : 86400000);
+}
+
+/**
+ * Merge rollup summaries (newest first) into the calculateStats() shape
+ */
+function mergeRollupStats(rollups, field) {
+  const summaries = rollups
+    .map(r => r[field])
+    .filter(s => s && s.count > 0);
+  
+  if (summaries.length === 0) return null;
+  
+  const count = summaries.reduce((total, s) => total + s.count, 0);
+  
+  return {
+    current: summaries[0].last,
+    avg: summaries.reduce((total, s) => total + s.mean * s.count, 0) / count,
+    min: Math.min(...summaries.map(s => s.min)),
+    max: Math.max(...summaries.map(s => s.max))
+  };
+}
+
 /**
  * Helper function to calculate statistics
  */
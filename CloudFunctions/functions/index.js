@@ -78,6 +78,18 @@ exports.updateConfig = functions.region(REGION).https.onCall(api.updateConfig);
  */
 exports.getGreenhouseStatus = functions.region(REGION).https.onCall(api.getGreenhouseStatus);
 
+/**
+ * Ingest a batch of buffered sensor readings
+ * Called by the Arduino device, one request per batch
+ */
+exports.ingestSensorBatch = functions.region(REGION).https.onCall(api.ingestSensorBatch);
+
+/**
+ * Ingest device alerts (single emergency alerts or coalesced batches)
+ * Called by the Arduino device alert queue
+ */
+exports.ingestAlert = functions.region(REGION).https.onCall(api.ingestAlert);
+
 // ============================================================================
 // SCHEDULED FUNCTIONS
 // ============================================================================
@@ -109,3 +121,10 @@ exports.generateDailySummary = functions.region(REGION).pubsub
 exports.checkDeviceHealth = functions.region(REGION).pubsub
   .schedule("every 15 minutes")
   .onRun(scheduled.checkDeviceHealth);
+
+/**
+ * Prune device commands past retention every hour
+ */
+exports.pruneDeviceCommands = functions.region(REGION).pubsub
+  .schedule("every 1 hours")
+  .onRun(scheduled.pruneDeviceCommands);
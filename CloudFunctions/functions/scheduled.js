@@ -25,6 +25,13 @@ function getBigQuery() {
   return bigquery;
 }
 
+// Device rollup window exported as actuator energy rows (15 minutes)
+const ROLLUP_ENERGY_WINDOW_MS = 900000;
+
+// Device command nodes are kept this long (24 hours) for a device whose
+// stream was down when they were pushed
+const COMMAND_RETENTION_MS = 86400000;
+
 /**
  * Export sensor data to BigQuery every hour
  */
@@ -40,6 +47,9 @@ exports.exportToBigQuery = async (context) => {
     for (const greenhouseDoc of greenhousesSnapshot.docs) {
       const greenhouseId = greenhouseDoc.id;
       
+      // Device rollups first - one row per metric per window
+      totalExported += await exportRollups(greenhouseId);
+      
       // Get sensor data from the last hour that hasn't been exported
       const oneHourAgo = new Date(Date.now() - 3600000);
       
@@ -100,6 +110,88 @@ exports.exportToBigQuery = async (context) => {
   }
 };
 
+/**
+ * Export not-yet-exported device rollup windows for one greenhouse
+ * Returns the number of rows inserted
+ */
+async function exportRollups(greenhouseId) {
+  const rollupsSnapshot = await getDb()
+    .collection('greenhouses')
+    .doc(greenhouseId)
+    .collection('rollups')
+    .where('exported', '==', false)
+    .orderBy('start', 'asc')
+    .limit(500)
+    .get();
+  
+  if (rollupsSnapshot.empty) {
+    return 0;
+  }
+  
+  const metrics = ['airTemp', 'airHumidity', 'co2', 'ph', 'ec', 'vwc'];
+  const rows = [];
+  const energyRows = [];
+  rollupsSnapshot.forEach(doc => {
+    const data = doc.data();
+    
+    // 15-minute windows only, so 1-min and 15-min rows never double count
+    if (data.actuators && data.window === ROLLUP_ENERGY_WINDOW_MS) {
+      Object.keys(data.actuators).forEach(actuator => {
+        const usage = data.actuators[actuator];
+        energyRows.push({
+          greenhouse_id: greenhouseId,
+          window_start: data.start.toDate(),
+          window_ms: data.window,
+          actuator: actuator,
+          on_seconds: usage.onSeconds,
+          kwh: usage.kwh
+        });
+      });
+    }
+    
+    metrics.forEach(metric => {
+      const summary = data[metric];
+      if (summary && summary.count > 0) {
+        rows.push({
+          greenhouse_id: greenhouseId,
+          window_start: data.start.toDate(),
+          window_ms: data.window,
+          sensor_type: metric,
+          min_value: summary.min,
+          max_value: summary.max,
+          avg_value: summary.mean,
+          count: summary.count,
+          last_value: summary.last
+        });
+      }
+    });
+  });
+  
+  if (rows.length > 0) {
+    await getBigQuery()
+      .dataset('greenos')
+      .table('sensor_rollups')
+      .insert(rows);
+  }
+  
+  if (energyRows.length > 0) {
+    await getBigQuery()
+      .dataset('greenos')
+      .table('actuator_energy')
+      .insert(energyRows);
+  }
+  
+  // Mark as exported
+  const batch = getDb().batch();
+  rollupsSnapshot.forEach(doc => {
+    batch.update(doc.ref, { exported: true });
+  });
+  await batch.commit();
+  
+  console.log(`Exported ${rows.length} rollup rows and ${energyRows.length} energy rows for ${greenhouseId}`);
+  return rows.length;
+}
+
 /**
  * Fetch external weather data
  */
@@ -282,6 +374,51 @@ exports.checkDeviceHealth = async (context) => {
   }
 };
 
+/**
+ * Prune old device commands from the Realtime Database every hour
+ *
+ * commands/{greenhouseId} only grows otherwise. The device skips keys at
+ * or before the newest it has seen, so a node past retention is never
+ * needed again; config deltas among them are also in config/{id}, which
+ * the device fetches after an outage.
+ */
+exports.pruneDeviceCommands = async (context) => {
+  console.log('Pruning device commands...');
+  
+  try {
+    const cutoff = Date.now() - COMMAND_RETENTION_MS;
+    const greenhousesSnapshot = await getDb().collection('greenhouses').get();
+    
+    let totalPruned = 0;
+    
+    for (const greenhouseDoc of greenhousesSnapshot.docs) {
+      const commandsRef = admin.database().ref(`commands/${greenhouseDoc.id}`);
+      const expired = await commandsRef
+        .orderByChild('createdAt')
+        .endAt(cutoff)
+        .once('value');
+      
+      if (!expired.exists()) continue;
+      
+      // One multi-path update per greenhouse
+      const removals = {};
+      expired.forEach(child => {
+        removals[child.key] = null;
+      });
+      await commandsRef.update(removals);
+      
+      totalPruned += Object.keys(removals).length;
+    }
+    
+    console.log(`Pruned ${totalPruned} device commands`);
+    return { success: true, pruned: totalPruned };
+    
+  } catch (error) {
+    console.error('Error pruning device commands:', error);
+    throw error;
+  }
+};
+
 /**
  * Helper functions
  */
@@ -198,7 +198,7 @@ exports.sendAlertNotification = async (snap, context) => {
 };
 
 /**
- * Log user commands for audit trail
+ * Log user commands for audit trail and forward them to the device
  */
 exports.logUserCommand = async (snap, context) => {
   const command = snap.data();
@@ -222,6 +222,17 @@ exports.logUserCommand = async (snap, context) => {
         details: command
       });
     
+    // Mirror to the Realtime Database path the device streams from
+    // (Firestore has no server-sent-events listener for REST clients)
+    await admin.database()
+      .ref(`commands/${greenhouseId}`)
+      .push({
+        target: command.target,
+        action: command.action,
+        commandId: commandId,
+        createdAt: admin.database.ServerValue.TIMESTAMP
+      });
+    
     return { logged: true };
     
   } catch (error) {
@@ -0,0 +1,50 @@
+/**
+ * GreenOS - AlertQueue Benchmarks
+ */
+
+#include "bench_util.h"
+#include "alert_queue.h"
+
+// update() + takeBatch() per detection pass with two persisting conditions
+static void BM_AlertQueueUpdate(benchmark::State& state) {
+  AnomalyDetection detector;
+  AlertQueue queue;
+  uint32_t sequence = 0;
+  uint32_t batches = 0;
+
+  SensorData data = benchReading(0, 0);
+  data.airHumidity = HUMIDITY_MAX + 5.0f;
+  data.scd30ErrorRate = 75.0f;
+
+  AllocationReport allocs(state);
+  for (auto _ : state) {
+    sequence++;
+    data.timestamp = sequence * SENSOR_READ_INTERVAL;
+    data.sequence = sequence;
+    detector.detectAnomalies(data);
+    queue.update(detector, detector.getAnomalySet(), data.timestamp);
+    if (queue.takeBatch(data.timestamp) != nullptr) batches++;
+  }
+  benchmark::DoNotOptimize(batches);
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AlertQueueUpdate);
+
+static void BM_AlertQueueFormatBatch(benchmark::State& state) {
+  AlertBatch batch;
+  batch.count = ALERT_MAX_BATCH;
+  for (uint8_t i = 0; i < batch.count; i++) {
+    batch.entries[i].type = (AnomalyType)(i + 1);
+    batch.entries[i].severity = ALERT_MEDIUM;
+    batch.entries[i].occurrences = 7;
+    strcpy(batch.entries[i].text, "Humidity too high: 90.0% (limit 80.0)");
+  }
+  char line[ALERT_MAX_BATCH * ALERT_TEXT_SIZE];
+
+  AllocationReport allocs(state);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(AlertQueue::formatBatch(batch, line, sizeof(line)));
+  }
+  state.SetItemsProcessed(state.iterations() * batch.count);
+}
+BENCHMARK(BM_AlertQueueFormatBatch);
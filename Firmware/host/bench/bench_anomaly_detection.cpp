@@ -0,0 +1,40 @@
+/**
+ * GreenOS - AnomalyDetection Benchmarks
+ */
+
+#include "bench_util.h"
+#include "anomaly_detection.h"
+
+// One detection pass per new snapshot (the per-cycle cost on the board)
+static void BM_AnomalyDetectNominal(benchmark::State& state) {
+  AnomalyDetection detector;
+  uint32_t sequence = 0;
+
+  AllocationReport allocs(state);
+  for (auto _ : state) {
+    sequence++;
+    SensorData data = benchReading(sequence * SENSOR_READ_INTERVAL, sequence);
+    benchmark::DoNotOptimize(detector.detectAnomalies(data));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AnomalyDetectNominal);
+
+// Several conditions active at once, plus formatting one alert text
+static void BM_AnomalyDetectAndFormat(benchmark::State& state) {
+  AnomalyDetection detector;
+  uint32_t sequence = 0;
+  char text[ANOMALY_DETAILS_SIZE];
+
+  AllocationReport allocs(state);
+  for (auto _ : state) {
+    sequence++;
+    SensorData data = benchReading(sequence * SENSOR_READ_INTERVAL, sequence);
+    data.airHumidity = HUMIDITY_MAX + 5.0f;
+    data.scd30ErrorRate = 75.0f;
+    detector.detectAnomalies(data);
+    benchmark::DoNotOptimize(detector.formatDetails(text, sizeof(text)));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AnomalyDetectAndFormat);
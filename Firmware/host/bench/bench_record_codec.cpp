@@ -0,0 +1,54 @@
+/**
+ * GreenOS - RecordCodec Benchmarks
+ */
+
+#include "bench_util.h"
+#include "record_codec.h"
+
+static void BM_RecordCodecPack(benchmark::State& state) {
+  RecordCodec codec;
+  SensorData data = benchReading(0, 0);
+
+  AllocationReport allocs(state);
+  for (auto _ : state) {
+    data.timestamp += SENSOR_READ_INTERVAL;
+    PackedReading packed = codec.pack(data);
+    benchmark::DoNotOptimize(packed);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RecordCodecPack);
+
+static void BM_RecordCodecUnpack(benchmark::State& state) {
+  RecordCodec codec;
+  PackedReading packed = codec.pack(benchReading(1000, 3));
+  SensorReading out;
+
+  AllocationReport allocs(state);
+  for (auto _ : state) {
+    RecordCodec::unpack(packed, 1000, out);
+    benchmark::DoNotOptimize(out);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RecordCodecUnpack);
+
+// Frame a full log block and parse its header back
+static void BM_RecordCodecBlock(benchmark::State& state) {
+  size_t count = (size_t)state.range(0);
+  PackedReading records[120];
+  RecordCodec codec;
+  for (size_t i = 0; i < count; i++) {
+    records[i] = codec.pack(benchReading(i * SENSOR_READ_INTERVAL, i));
+  }
+  uint8_t block[sizeof(PackedBlockHeader) + sizeof(records)];
+
+  AllocationReport allocs(state);
+  for (auto _ : state) {
+    size_t written = RecordCodec::writeBlock(records, count, 0, block, sizeof(block));
+    PackedBlockHeader header;
+    benchmark::DoNotOptimize(RecordCodec::readBlockHeader(block, written, header));
+  }
+  state.SetBytesProcessed(state.iterations() * RecordCodec::blockSize(count));
+}
+BENCHMARK(BM_RecordCodecBlock)->Arg(16)->Arg(120);
@@ -0,0 +1,28 @@
+/**
+ * GreenOS - Trace Replay Benchmark
+ *
+ * Readings per second through the whole replay pipeline (SensorManager,
+ * detection, alert queue) for an hour-long trace.
+ */
+
+#include "bench_util.h"
+#include "config.h"
+#include "replay_pipeline.h"
+
+static void BM_ReplayPipelineHour(benchmark::State& state) {
+  TraceBuilder trace;
+  trace.addSteady(22.0f, 85.0f, 600.0f, 0, 3600000UL, SENSOR_READ_INTERVAL);
+  const std::vector<uint8_t>& bytes = trace.bytes();
+
+  static ReplayPipeline pipeline;
+  pipeline.begin();
+
+  uint64_t readings = 0;
+  AllocationReport allocs(state);
+  for (auto _ : state) {
+    pipeline.start(bytes.data(), bytes.size());
+    readings += pipeline.run();
+  }
+  state.SetItemsProcessed(readings);
+}
+BENCHMARK(BM_ReplayPipelineHour)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,45 @@
+/**
+ * GreenOS - RingBuffer Benchmarks
+ */
+
+#include "bench_util.h"
+#include "record_codec.h"
+#include "ring_buffer.h"
+
+// Offline buffer shape: PackedReadings, MAX_BUFFERED_READINGS deep
+static RingBuffer<PackedReading, MAX_BUFFERED_READINGS> ring;
+
+static void BM_RingBufferPushOverwrite(benchmark::State& state) {
+  PackedReading reading;
+  memset(&reading, 0x11, sizeof(reading));
+  ring.clear();
+
+  AllocationReport allocs(state);
+  for (auto _ : state) {
+    ring.push(reading);
+    benchmark::DoNotOptimize(ring);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_RingBufferPushOverwrite);
+
+// Fill, then drain through peekContiguous()/consume() like the log flush
+static void BM_RingBufferFillDrain(benchmark::State& state) {
+  PackedReading reading;
+  memset(&reading, 0x22, sizeof(reading));
+  size_t fill = (size_t)state.range(0);
+  uint32_t checksum = 0;
+
+  AllocationReport allocs(state);
+  for (auto _ : state) {
+    for (size_t i = 0; i < fill; i++) ring.push(reading);
+    while (!ring.isEmpty()) {
+      RingSpan<PackedReading> span = ring.peekContiguous(16);
+      checksum += span.data[0].airTemp;
+      ring.consume(span.length);
+    }
+  }
+  benchmark::DoNotOptimize(checksum);
+  state.SetItemsProcessed(state.iterations() * fill);
+}
+BENCHMARK(BM_RingBufferFillDrain)->Arg(16)->Arg(MAX_BUFFERED_READINGS);
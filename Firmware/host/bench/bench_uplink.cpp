@@ -0,0 +1,76 @@
+/**
+ * GreenOS - Uplink Serialization Benchmarks
+ *
+ * With the co-processor link, the MCU no longer builds JSON: a batch
+ * goes out as one RPC_UPLOAD_BATCH frame (COBS + CRC32) and the ESP32-S3
+ * does the JSON. This measures that framing for the batch sizes the
+ * sync path sends.
+ */
+
+#include "bench_util.h"
+#include "record_codec.h"
+#include "rpc_link.h"
+
+// UART that takes everything at once
+class DiscardStream : public Stream {
+public:
+  int available() override { return 0; }
+  int read() override { return -1; }
+  int peek() override { return -1; }
+  size_t write(uint8_t byte) override { return 1; }
+  size_t write(const uint8_t* buffer, size_t size) override { return size; }
+  int availableForWrite() override { return RPC_TX_BUFFER_SIZE; }
+};
+
+static void BM_UplinkBatchFrame(benchmark::State& state) {
+  static DiscardStream port;
+  static RpcLink link;
+  link.begin(port, nullptr, nullptr);
+
+  uint16_t count = (uint16_t)state.range(0);
+  RecordCodec codec;
+  PackedReading readings[120];
+  uint32_t offsets[120];
+  for (uint16_t i = 0; i < count; i++) {
+    readings[i] = codec.pack(benchReading(i * SENSOR_READ_INTERVAL, i));
+    offsets[i] = i * SENSOR_READ_INTERVAL;
+  }
+
+  RpcBatchHeader header;
+  memset(&header, 0, sizeof(header));
+  header.count = count;
+  size_t length = sizeof(header) + count * (sizeof(uint32_t) + sizeof(PackedReading));
+
+  AllocationReport allocs(state);
+  for (auto _ : state) {
+    if (link.beginFrame(RPC_UPLOAD_BATCH, length) == 0) {
+      state.SkipWithError("TX ring full");
+      break;
+    }
+    link.append(&header, sizeof(header));
+    link.append(offsets, count * sizeof(uint32_t));
+    link.append(readings, count * sizeof(PackedReading));
+    link.endFrame();
+    link.poll();
+  }
+  state.SetBytesProcessed(state.iterations() * length);
+}
+BENCHMARK(BM_UplinkBatchFrame)->Arg(16)->Arg(120);
+
+static void BM_UplinkCobsDecode(benchmark::State& state) {
+  // Two full COBS blocks: code 0xFF + 254 non-zero bytes each
+  uint8_t frame[2 * 255];
+  uint8_t work[sizeof(frame)];
+  size_t length = sizeof(frame);
+  for (size_t i = 0; i < length; i++) {
+    frame[i] = (i % 255 == 0) ? 0xFF : (uint8_t)((i % 37) + 1);
+  }
+
+  AllocationReport allocs(state);
+  for (auto _ : state) {
+    memcpy(work, frame, length);
+    benchmark::DoNotOptimize(RpcLink::decode(work, length));
+  }
+  state.SetBytesProcessed(state.iterations() * length);
+}
+BENCHMARK(BM_UplinkCobsDecode);
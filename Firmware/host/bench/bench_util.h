@@ -0,0 +1,52 @@
+/**
+ * GreenOS - Benchmark Helpers
+ */
+
+#ifndef GREENOS_BENCH_UTIL_H
+#define GREENOS_BENCH_UTIL_H
+
+#include <benchmark/benchmark.h>
+#include "alloc_counter.h"
+#include "config.h"
+#include "sensor_manager.h"
+
+// Reports heap allocations per iteration as the "allocs" counter. Create
+// it just before the timing loop.
+class AllocationReport {
+public:
+  explicit AllocationReport(benchmark::State& state) : state(state), start(allocationCount()) {}
+
+  ~AllocationReport() {
+    state.counters["allocs"] = benchmark::Counter((double)allocationsSince(start),
+                                                  benchmark::Counter::kAvgIterations);
+  }
+
+private:
+  benchmark::State& state;
+  AllocationCount start;
+};
+
+// Nominal air readings with the soil/analog fields left as "no data"
+inline SensorData benchReading(unsigned long timestamp, uint32_t sequence) {
+  SensorData data;
+  memset(&data, 0, sizeof(data));
+  data.airTemp = 22.0f + (sequence % 7) * 0.01f;
+  data.airHumidity = 55.0f + (sequence % 5) * 0.02f;
+  data.co2 = 600.0f + (sequence % 11);
+  data.airQualityPPM = NAN;
+  data.substrateTemp = NAN;
+  data.vwc = 31.0f;
+  data.ph = 6.5f;
+  data.ec = 1.2f;
+  data.nitrogen = NAN;
+  data.phosphorus = NAN;
+  data.potassium = NAN;
+  data.par = NAN;
+  data.noiseLevel = NAN;
+  data.voltage = 5.0f;
+  data.timestamp = timestamp;
+  data.sequence = sequence;
+  return data;
+}
+
+#endif // GREENOS_BENCH_UTIL_H
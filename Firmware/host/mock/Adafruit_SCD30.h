@@ -0,0 +1,53 @@
+/**
+ * GreenOS - Host Mock: Adafruit SCD-30 Driver
+ *
+ * Every instance reads the shared mockSCD30 state, so a test sets the
+ * sensor's presence, readiness and values without reaching into
+ * SensorManager.
+ */
+
+#ifndef GREENOS_MOCK_ADAFRUIT_SCD30_H
+#define GREENOS_MOCK_ADAFRUIT_SCD30_H
+
+#include <Arduino.h>
+
+struct MockSCD30State {
+  bool present;             // begin() succeeds
+  bool ready;               // dataReady()
+  bool readOk;              // read() succeeds
+  float co2;
+  float temperature;
+  float humidity;
+  uint32_t reads;           // read() calls
+};
+
+extern MockSCD30State mockSCD30;
+
+class Adafruit_SCD30 {
+public:
+  float CO2 = 0.0f;
+  float temperature = 0.0f;
+  float relative_humidity = 0.0f;
+
+  bool begin() { return mockSCD30.present; }
+  bool setMeasurementInterval(uint16_t interval) { this->interval = interval; return true; }
+  uint16_t getMeasurementInterval() { return interval; }
+  bool setAltitudeOffset(uint16_t altitude) { (void)altitude; return true; }
+  bool setTemperatureOffset(float offset) { (void)offset; return true; }
+  bool selfCalibrationEnabled(bool enabled) { (void)enabled; return true; }
+  bool dataReady() { return mockSCD30.present && mockSCD30.ready; }
+
+  bool read() {
+    mockSCD30.reads++;
+    if (!mockSCD30.present || !mockSCD30.readOk) return false;
+    CO2 = mockSCD30.co2;
+    temperature = mockSCD30.temperature;
+    relative_humidity = mockSCD30.humidity;
+    return true;
+  }
+
+private:
+  uint16_t interval = 2;
+};
+
+#endif // GREENOS_MOCK_ADAFRUIT_SCD30_H
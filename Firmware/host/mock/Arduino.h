@@ -0,0 +1,200 @@
+/**
+ * GreenOS - Host Mock: Arduino Core
+ *
+ * The subset of the Arduino API the firmware modules use, so they build
+ * and run on a PC. Nothing here touches real time or hardware: the clock,
+ * pins, ADC and serial ports are driven through mock_hal.h.
+ *
+ * - millis() / micros() read one simulated microsecond counter. Each
+ *   micros() call advances it by MOCK_MICROS_PER_CALL, so a busy-wait on
+ *   micros() terminates like it does on the board; millis() never moves
+ *   time on its own.
+ * - delay() / delayMicroseconds() advance the clock instead of sleeping.
+ * - Serial ports buffer what the firmware writes and replay what the test
+ *   injects; Serial can echo to stdout.
+ */
+
+#ifndef GREENOS_MOCK_ARDUINO_H
+#define GREENOS_MOCK_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef __cplusplus
+#include <deque>
+#include <vector>
+#endif
+
+// ============================================================================
+// CONSTANTS
+// ============================================================================
+
+#define HIGH 1
+#define LOW 0
+
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define CHANGE 4
+#define FALLING 2
+#define RISING 3
+
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+#define MOCK_PIN_COUNT 64
+#define MOCK_MICROS_PER_CALL 1       // Cost of one micros() read, in µs
+#define MOCK_SERIAL_CAPTURE 65536    // TX bytes kept per port (reserved up front - no steady-state heap)
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+// ============================================================================
+// TIME, PINS, INTERRUPTS
+// ============================================================================
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(int pin, int mode);
+int digitalRead(int pin);
+void digitalWrite(int pin, int value);
+int analogRead(int pin);
+void analogReadResolution(int bits);
+
+int digitalPinToInterrupt(int pin);
+void attachInterrupt(int interrupt, void (*handler)(), int mode);
+void detachInterrupt(int interrupt);
+void noInterrupts();
+void interrupts();
+
+void tone(int pin, unsigned int frequency, unsigned long duration = 0);
+void noTone(int pin);
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+void NVIC_SystemReset();
+
+char* ltoa(long value, char* buffer, int base);
+
+// ============================================================================
+// MATH HELPERS (templates, not macros, so <algorithm> still compiles)
+// ============================================================================
+
+template <typename T, typename L>
+auto min(const T& a, const L& b) -> decltype((b < a) ? b : a) {
+  return (b < a) ? b : a;
+}
+
+template <typename T, typename L>
+auto max(const T& a, const L& b) -> decltype((b < a) ? b : a) {
+  return (a < b) ? b : a;
+}
+
+template <typename T, typename L, typename H>
+T constrain(T x, L low, H high) {
+  return x < low ? low : (x > high ? high : x);
+}
+
+#define lowByte(w) ((uint8_t)((w) & 0xFF))
+#define highByte(w) ((uint8_t)((w) >> 8))
+
+inline uint16_t word(uint8_t high, uint8_t low) {
+  return (uint16_t)((high << 8) | low);
+}
+
+// ============================================================================
+// PRINT / STREAM
+// ============================================================================
+
+class Print {
+public:
+  virtual ~Print() {}
+
+  virtual size_t write(uint8_t byte) = 0;
+  virtual size_t write(const uint8_t* buffer, size_t size);
+  size_t write(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+  size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+  virtual int availableForWrite() { return 0; }
+  virtual void flush() {}
+
+  size_t print(const char* text) { return write(text); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char value, int base = DEC) { return print((unsigned long)value, base); }
+  size_t print(int value, int base = DEC) { return print((long)value, base); }
+  size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+  size_t print(long value, int base = DEC);
+  size_t print(unsigned long value, int base = DEC);
+  size_t print(long long value, int base = DEC) { return print((long)value, base); }
+  size_t print(unsigned long long value, int base = DEC) { return print((unsigned long)value, base); }
+  size_t print(double value, int digits = 2);
+
+  size_t println() { return write("\r\n"); }
+  template <typename T>
+  size_t println(T value) { return print(value) + println(); }
+  template <typename T>
+  size_t println(T value, int format) { return print(value, format) + println(); }
+};
+
+class Stream : public Print {
+public:
+  virtual int available() = 0;
+  virtual int read() = 0;
+  virtual int peek() = 0;
+
+  void setTimeout(unsigned long timeout) { (void)timeout; }
+  long parseInt();
+  float parseFloat();
+  size_t readBytes(uint8_t* buffer, size_t length);
+  size_t readBytes(char* buffer, size_t length) { return readBytes((uint8_t*)buffer, length); }
+};
+
+// RX from inject(), TX captured for takeOutput() (and echoed if enabled)
+class HardwareSerial : public Stream {
+public:
+  HardwareSerial();
+
+  void begin(unsigned long baud) { (void)baud; open = true; }
+  void begin(unsigned long baud, uint16_t config) { (void)config; begin(baud); }
+  void end() { open = false; }
+  explicit operator bool() { return connected; }
+
+  int available() override { return (int)rx.size(); }
+  int read() override;
+  int peek() override { return rx.empty() ? -1 : rx.front(); }
+  size_t write(uint8_t byte) override;
+  using Print::write;
+  int availableForWrite() override { return writeRoom; }
+
+  // Host-side controls
+  void inject(const uint8_t* data, size_t length);
+  std::vector<uint8_t> takeOutput();
+  void setEcho(bool echo) { this->echo = echo; }
+  void setConnected(bool connected) { this->connected = connected; }
+  void setWriteRoom(int room) { writeRoom = room; }
+  void reset();
+
+private:
+  std::deque<uint8_t> rx;
+  std::vector<uint8_t> tx;
+  bool open;
+  bool echo;
+  bool connected;
+  int writeRoom;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+extern HardwareSerial Serial2;
+
+#endif // GREENOS_MOCK_ARDUINO_H
@@ -0,0 +1,23 @@
+/**
+ * GreenOS - Host Mock: I2C (Wire)
+ *
+ * Only bus setup is mocked; the SCD-30 mock answers at the driver level.
+ */
+
+#ifndef GREENOS_MOCK_WIRE_H
+#define GREENOS_MOCK_WIRE_H
+
+#include <Arduino.h>
+
+class TwoWire {
+public:
+  void begin() { started = true; }
+  void setClock(unsigned long frequency) { clock = frequency; }
+
+  bool started = false;
+  unsigned long clock = 0;
+};
+
+extern TwoWire Wire;
+
+#endif // GREENOS_MOCK_WIRE_H
@@ -0,0 +1,121 @@
+/**
+ * GreenOS - Host Build Configuration
+ *
+ * Stand-in for the board config.h (not committed), with the values the
+ * host tests assume. Pins only need to be distinct; thresholds and
+ * intervals match the shipped defaults.
+ */
+
+#ifndef GREENOS_HOST_CONFIG_H
+#define GREENOS_HOST_CONFIG_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// IDENTITY
+// ============================================================================
+
+#define GREENHOUSE_ID "gh-001"
+
+// ============================================================================
+// PINS
+// ============================================================================
+
+#define HEATER_PRIMARY_PIN 2
+#define HEATER_SECONDARY_PIN 3
+#define FAN_EXHAUST_PIN 4
+#define FAN_CIRCULATION_PIN 5
+#define PUMP_IRRIGATION_PIN 6
+#define LIGHT_GROW_PIN 7
+#define STATUS_LED_PIN 13
+#define PIR_SENSOR_PIN 8
+#define UPS_STATUS_PIN 9
+#define MODBUS_DE_RE_PIN 10
+#define MQ135_SENSOR_PIN 14
+#define VWC_SENSOR_PIN 15
+#define MICROPHONE_PIN 16
+
+// ============================================================================
+// ADC
+// ============================================================================
+
+#define ADC_RESOLUTION 14
+#define ADC_MAX_VALUE 16383.0f
+#define ADC_SAMPLES 100
+#define ADC_SAMPLE_DELAY_MS 10
+#define ADC_VREF_NOMINAL 3.3f
+
+// ============================================================================
+// MODBUS
+// ============================================================================
+
+#define MODBUS_BAUD_RATE 9600
+#define MODBUS_SLAVE_ID 1
+#define MODBUS_REG_MOISTURE 0x0000
+
+// ============================================================================
+// SCD-30 / MQ135
+// ============================================================================
+
+#define SCD30_MEASUREMENT_INTERVAL 2
+#define SCD30_ALTITUDE_COMPENSATION true
+#define SCD30_TEMP_OFFSET 0.0
+#define SCD30_AUTO_CALIBRATION false
+#define GREENHOUSE_ALTITUDE_M 1609
+#define MQ135_PREHEAT_TIME_MS 172800000UL
+#define MQ135_VDIV_R1 10000.0f
+#define MQ135_VDIV_R2 20000.0f
+#define MQ135_LOAD_RESISTOR 10000.0f
+#define MQ135_CLEAN_AIR_RATIO 3.6f
+
+// ============================================================================
+// TIMING
+// ============================================================================
+
+#define MAX_SENSOR_ERRORS 5
+#define MAX_BUFFERED_READINGS 100
+#define SENSOR_READ_INTERVAL 2000
+#define ANOMALY_CHECK_INTERVAL 5000
+#define FIREBASE_SYNC_INTERVAL 30000
+#define SD_BUFFER_FLUSH_INTERVAL 60000
+#define MEMORY_CHECK_INTERVAL 60000
+#define SENSOR_HEALTH_CHECK_INTERVAL 60000
+#define SAFE_MODE_TIMEOUT 3600000UL
+#define WDT_ENABLED true
+#define WDT_TIMEOUT_SECONDS 8
+
+// ============================================================================
+// THRESHOLDS
+// ============================================================================
+
+#define TEMP_MIN 5.0f
+#define TEMP_MAX 35.0f
+#define TEMP_OPTIMAL_MIN 18.0f
+#define TEMP_OPTIMAL_MAX 27.0f
+#define HUMIDITY_MIN 40.0f
+#define HUMIDITY_MAX 80.0f
+
+// ============================================================================
+// TYPES
+// ============================================================================
+
+struct ADCCalibration {
+  float offset;
+  float scale;
+  float vRef;
+  float tempCoeff;
+  uint32_t crc32;
+};
+
+enum SystemState {
+  STATE_BOOT,
+  STATE_SENSOR_INIT,
+  STATE_NETWORK_CONNECT,
+  STATE_FIREBASE_AUTH,
+  STATE_NORMAL_OPERATION,
+  STATE_SAFE_MODE,
+  STATE_EMERGENCY,
+  STATE_CALIBRATION_MODE
+};
+
+#endif // GREENOS_HOST_CONFIG_H
@@ -0,0 +1,307 @@
+/**
+ * GreenOS - Host Mock HAL Implementation
+ */
+
+#include "mock_hal.h"
+
+// ============================================================================
+// STATE
+// ============================================================================
+
+HardwareSerial Serial;
+HardwareSerial Serial1;
+HardwareSerial Serial2;
+TwoWire Wire;
+MockSCD30State mockSCD30;
+
+static uint64_t clockMicros = 0;
+static int digitalLevels[MOCK_PIN_COUNT];
+static int analogValues[MOCK_PIN_COUNT];
+static void (*interruptHandlers[MOCK_PIN_COUNT])();
+static MockAnalogSource analogSource = nullptr;
+static void* analogContext = nullptr;
+static uint32_t analogReads = 0;
+static uint32_t resetRequests = 0;
+
+static bool validPin(int pin) {
+  return pin >= 0 && pin < MOCK_PIN_COUNT;
+}
+
+void mockReset() {
+  clockMicros = 0;
+  for (int pin = 0; pin < MOCK_PIN_COUNT; pin++) {
+    digitalLevels[pin] = LOW;
+    analogValues[pin] = 0;
+    interruptHandlers[pin] = nullptr;
+  }
+  analogSource = nullptr;
+  analogContext = nullptr;
+  analogReads = 0;
+  resetRequests = 0;
+
+  Serial.reset();
+  Serial1.reset();
+  Serial2.reset();
+  Wire = TwoWire();
+
+  mockSCD30.present = true;
+  mockSCD30.ready = true;
+  mockSCD30.readOk = true;
+  mockSCD30.co2 = 600.0f;
+  mockSCD30.temperature = 22.0f;
+  mockSCD30.humidity = 55.0f;
+  mockSCD30.reads = 0;
+}
+
+// ============================================================================
+// CLOCK
+// ============================================================================
+
+unsigned long millis() {
+  return (unsigned long)(clockMicros / 1000);
+}
+
+unsigned long micros() {
+  unsigned long now = (unsigned long)clockMicros;
+  clockMicros += MOCK_MICROS_PER_CALL;
+  return now;
+}
+
+void delay(unsigned long ms) {
+  clockMicros += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us) {
+  clockMicros += us;
+}
+
+void mockSetMillis(unsigned long ms) {
+  clockMicros = (uint64_t)ms * 1000;
+}
+
+void mockAdvanceMillis(unsigned long ms) {
+  clockMicros += (uint64_t)ms * 1000;
+}
+
+void mockAdvanceMicros(unsigned long us) {
+  clockMicros += us;
+}
+
+// ============================================================================
+// PINS AND INTERRUPTS
+// ============================================================================
+
+void pinMode(int pin, int mode) {
+  if (validPin(pin) && mode == INPUT_PULLUP) digitalLevels[pin] = HIGH;
+}
+
+int digitalRead(int pin) {
+  return validPin(pin) ? digitalLevels[pin] : LOW;
+}
+
+void digitalWrite(int pin, int value) {
+  if (validPin(pin)) digitalLevels[pin] = value ? HIGH : LOW;
+}
+
+int analogRead(int pin) {
+  analogReads++;
+  if (analogSource != nullptr) {
+    return analogSource(pin, (unsigned long)clockMicros, analogContext);
+  }
+  return validPin(pin) ? analogValues[pin] : 0;
+}
+
+void analogReadResolution(int bits) {
+  (void)bits;
+}
+
+int digitalPinToInterrupt(int pin) {
+  return pin;
+}
+
+void attachInterrupt(int interrupt, void (*handler)(), int mode) {
+  (void)mode;
+  if (validPin(interrupt)) interruptHandlers[interrupt] = handler;
+}
+
+void detachInterrupt(int interrupt) {
+  if (validPin(interrupt)) interruptHandlers[interrupt] = nullptr;
+}
+
+void noInterrupts() {}
+void interrupts() {}
+
+void tone(int pin, unsigned int frequency, unsigned long duration) {
+  (void)pin;
+  (void)frequency;
+  (void)duration;
+}
+
+void noTone(int pin) {
+  (void)pin;
+}
+
+void mockSetDigitalInput(int pin, int level) {
+  if (validPin(pin)) digitalLevels[pin] = level ? HIGH : LOW;
+}
+
+int mockGetDigitalOutput(int pin) {
+  return digitalRead(pin);
+}
+
+void mockSetAnalog(int pin, int value) {
+  if (validPin(pin)) analogValues[pin] = value;
+}
+
+void mockSetAnalogSource(MockAnalogSource source, void* context) {
+  analogSource = source;
+  analogContext = context;
+}
+
+void mockFireInterrupt(int pin) {
+  if (validPin(pin) && interruptHandlers[pin] != nullptr) interruptHandlers[pin]();
+}
+
+uint32_t mockGetAnalogReads() {
+  return analogReads;
+}
+
+uint32_t mockGetResetRequests() {
+  return resetRequests;
+}
+
+// ============================================================================
+// MISC
+// ============================================================================
+
+long random(long max) {
+  return max > 0 ? rand() % max : 0;
+}
+
+long random(long min, long max) {
+  return max > min ? min + rand() % (max - min) : min;
+}
+
+void randomSeed(unsigned long seed) {
+  srand((unsigned int)seed);
+}
+
+void NVIC_SystemReset() {
+  resetRequests++;
+}
+
+char* ltoa(long value, char* buffer, int base) {
+  if (base == 16) {
+    sprintf(buffer, "%lx", value);
+  } else {
+    sprintf(buffer, "%ld", value);
+  }
+  return buffer;
+}
+
+// ============================================================================
+// PRINT / STREAM
+// ============================================================================
+
+size_t Print::write(const uint8_t* buffer, size_t size) {
+  size_t written = 0;
+  while (written < size && write(buffer[written])) {
+    written++;
+  }
+  return written;
+}
+
+size_t Print::print(long value, int base) {
+  char text[24];
+  return write(ltoa(value, text, base));
+}
+
+size_t Print::print(unsigned long value, int base) {
+  char text[24];
+  sprintf(text, base == 16 ? "%lX" : "%lu", value);
+  return write(text);
+}
+
+size_t Print::print(double value, int digits) {
+  char text[48];
+  snprintf(text, sizeof(text), "%.*f", digits, value);
+  return write(text);
+}
+
+size_t Stream::readBytes(uint8_t* buffer, size_t length) {
+  size_t count = 0;
+  while (count < length && available() > 0) {
+    buffer[count++] = (uint8_t)read();
+  }
+  return count;
+}
+
+// Like the Arduino core: skip to the first digit or sign, stop at the
+// first byte that can't continue the number (no timeout - what's
+// buffered is all there is)
+static bool skipToNumber(Stream& stream) {
+  int c;
+  while ((c = stream.peek()) >= 0) {
+    if (c == '-' || c == '.' || (c >= '0' && c <= '9')) return true;
+    stream.read();
+  }
+  return false;
+}
+
+long Stream::parseInt() {
+  return (long)parseFloat();
+}
+
+float Stream::parseFloat() {
+  if (!skipToNumber(*this)) return 0.0f;
+
+  char text[32];
+  size_t length = 0;
+  int c;
+  while ((c = peek()) >= 0 && length + 1 < sizeof(text) &&
+         (c == '-' || c == '.' || (c >= '0' && c <= '9'))) {
+    text[length++] = (char)read();
+  }
+  text[length] = '\0';
+  return strtof(text, nullptr);
+}
+
+HardwareSerial::HardwareSerial() {
+  reset();
+}
+
+void HardwareSerial::reset() {
+  rx.clear();
+  tx.clear();
+  open = false;
+  echo = false;
+  connected = false;
+  writeRoom = 64;
+  tx.reserve(MOCK_SERIAL_CAPTURE);
+}
+
+int HardwareSerial::read() {
+  if (rx.empty()) return -1;
+  uint8_t byte = rx.front();
+  rx.pop_front();
+  return byte;
+}
+
+size_t HardwareSerial::write(uint8_t byte) {
+  if (echo) {
+    fputc(byte, stdout);
+  } else if (tx.size() < MOCK_SERIAL_CAPTURE) {
+    tx.push_back(byte);
+  }
+  return 1;
+}
+
+void HardwareSerial::inject(const uint8_t* data, size_t length) {
+  rx.insert(rx.end(), data, data + length);
+}
+
+std::vector<uint8_t> HardwareSerial::takeOutput() {
+  std::vector<uint8_t> output(tx);
+  tx.clear();
+  return output;
+}
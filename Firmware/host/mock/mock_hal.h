@@ -0,0 +1,37 @@
+/**
+ * GreenOS - Host Mock HAL Controls
+ *
+ * Test-side handles on the mocked hardware. mockReset() puts everything
+ * back to power-on state (clock at 0, pins low, ports empty, SCD-30
+ * present with a steady 22 °C / 55 %RH / 600 ppm).
+ */
+
+#ifndef GREENOS_MOCK_HAL_H
+#define GREENOS_MOCK_HAL_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <Adafruit_SCD30.h>
+
+// Analog input generator, e.g. a microphone waveform (nowMicros = sample time)
+typedef int (*MockAnalogSource)(int pin, unsigned long nowMicros, void* context);
+
+void mockReset();
+
+// Clock
+void mockSetMillis(unsigned long ms);
+void mockAdvanceMillis(unsigned long ms);
+void mockAdvanceMicros(unsigned long us);
+
+// Pins
+void mockSetDigitalInput(int pin, int level);
+int mockGetDigitalOutput(int pin);
+void mockSetAnalog(int pin, int value);
+void mockSetAnalogSource(MockAnalogSource source, void* context);
+void mockFireInterrupt(int pin);     // Runs the handler attached to the pin
+
+// Counters
+uint32_t mockGetAnalogReads();
+uint32_t mockGetResetRequests();
+
+#endif // GREENOS_MOCK_HAL_H
@@ -0,0 +1,54 @@
+/**
+ * GreenOS - Host Heap Counter Implementation
+ */
+
+#include "alloc_counter.h"
+
+#include <new>
+#include <stdlib.h>
+
+static AllocationCount counter = {0, 0};
+
+static void* countedAllocate(size_t size) {
+  counter.allocations++;
+  counter.bytes += size;
+  void* block = malloc(size > 0 ? size : 1);
+  if (block == nullptr) throw std::bad_alloc();
+  return block;
+}
+
+AllocationCount allocationCount() {
+  return counter;
+}
+
+uint64_t allocationsSince(const AllocationCount& since) {
+  return counter.allocations - since.allocations;
+}
+
+// ============================================================================
+// GLOBAL OPERATORS
+// ============================================================================
+
+void* operator new(size_t size) {
+  return countedAllocate(size);
+}
+
+void* operator new[](size_t size) {
+  return countedAllocate(size);
+}
+
+void operator delete(void* block) noexcept {
+  free(block);
+}
+
+void operator delete[](void* block) noexcept {
+  free(block);
+}
+
+void operator delete(void* block, size_t) noexcept {
+  free(block);
+}
+
+void operator delete[](void* block, size_t) noexcept {
+  free(block);
+}
@@ -0,0 +1,25 @@
+/**
+ * GreenOS - Host Heap Counter
+ *
+ * Replaces global operator new/delete in host binaries that link it, so
+ * tests and benchmarks can check the "no heap in steady state" rule:
+ * take a snapshot, run the code, compare.
+ */
+
+#ifndef GREENOS_ALLOC_COUNTER_H
+#define GREENOS_ALLOC_COUNTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct AllocationCount {
+  uint64_t allocations;      // operator new calls since process start
+  uint64_t bytes;
+};
+
+AllocationCount allocationCount();
+
+// Allocations since `since` was taken
+uint64_t allocationsSince(const AllocationCount& since);
+
+#endif // GREENOS_ALLOC_COUNTER_H
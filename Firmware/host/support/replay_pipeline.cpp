@@ -0,0 +1,175 @@
+/**
+ * GreenOS - Host Trace Replay Pipeline Implementation
+ */
+
+#include "replay_pipeline.h"
+#include "mock_hal.h"
+
+// ============================================================================
+// TRACE BUILDER
+// ============================================================================
+
+TraceBuilder::TraceBuilder() {
+  pendingCount = 0;
+  blockBase = 0;
+  recordCount = 0;
+}
+
+void TraceBuilder::add(const SensorData& data) {
+  // Same blocking as TraceRecorder::add()
+  PackedReading packed = codec.pack(data);
+  if (pendingCount == 0) {
+    blockBase = codec.getLastTimestamp();
+  }
+  pending[pendingCount++] = packed;
+  recordCount++;
+
+  if (pendingCount == TRACE_BLOCK_RECORDS) {
+    flush();
+  }
+}
+
+void TraceBuilder::addSteady(float airTemp, float airHumidity, float co2, unsigned long startMs,
+                             unsigned long durationMs, unsigned long intervalMs) {
+  SensorData data;
+  memset(&data, 0, sizeof(data));
+  data.airTemp = airTemp;
+  data.airHumidity = airHumidity;
+  data.co2 = co2;
+  data.ph = NAN;
+  data.ec = NAN;
+  data.vwc = NAN;
+
+  for (unsigned long t = 0; t < durationMs; t += intervalMs) {
+    data.timestamp = startMs + t;
+    add(data);
+  }
+}
+
+void TraceBuilder::flush() {
+  if (pendingCount == 0) return;
+
+  size_t offset = trace.size();
+  trace.resize(offset + RecordCodec::blockSize(pendingCount));
+  RecordCodec::writeBlock(pending, pendingCount, blockBase, trace.data() + offset,
+                          trace.size() - offset);
+  pendingCount = 0;
+}
+
+const std::vector<uint8_t>& TraceBuilder::bytes() {
+  flush();
+  return trace;
+}
+
+uint32_t TraceBuilder::getRecordCount() {
+  return recordCount;
+}
+
+// ============================================================================
+// REPLAY PIPELINE
+// ============================================================================
+
+ReplayPipeline::ReplayPipeline() {
+  batchCallback = nullptr;
+  batchContext = nullptr;
+  readings = 0;
+  batches = 0;
+  emergencies = 0;
+  memset(reports, 0, sizeof(reports));
+}
+
+void ReplayPipeline::begin() {
+  mockReset();
+  sensors.init();
+  sensors.setReplaySource(&replay);
+  detector.init();
+  queue.reset();
+}
+
+bool ReplayPipeline::start(const uint8_t* trace, size_t length) {
+  readings = 0;
+  batches = 0;
+  emergencies = 0;
+  memset(reports, 0, sizeof(reports));
+  return replay.startFromMemory(trace, length);
+}
+
+bool ReplayPipeline::step() {
+  sensors.readAll();
+  if (!sensors.isReplaying()) {
+    return false;  // Trace exhausted - this cycle published nothing
+  }
+
+  const SensorData& data = sensors.getData();
+  readings++;
+
+  // The clock follows the trace so queue timers see recorded time
+  if ((long)(data.timestamp - millis()) > 0) {
+    mockSetMillis(data.timestamp);
+  }
+
+  // Same order as checkAnomalies() in main.ino
+  bool detected = detector.detectAnomalies(data);
+  AnomalySet anomalies = detected ? detector.getAnomalySet() : 0;
+  if (anomalies & REPLAY_EMERGENCY_ANOMALIES) emergencies++;
+  queue.update(detector, anomalies & ~REPLAY_EMERGENCY_ANOMALIES, millis());
+
+  serviceQueue();
+  return true;
+}
+
+uint32_t ReplayPipeline::run() {
+  while (step()) {
+  }
+
+  // Let the last coalescing window close
+  mockAdvanceMillis(ALERT_COALESCE_MS);
+  serviceQueue();
+  return readings;
+}
+
+void ReplayPipeline::serviceQueue() {
+  const AlertBatch* batch = queue.takeBatch(millis());
+  if (batch == nullptr) return;
+
+  batches++;
+  for (uint8_t i = 0; i < batch->count; i++) {
+    reports[batch->entries[i].type]++;
+  }
+  if (batchCallback != nullptr) {
+    batchCallback(*batch, millis(), batchContext);
+  }
+}
+
+void ReplayPipeline::setBatchCallback(ReplayBatchCallback callback, void* context) {
+  batchCallback = callback;
+  batchContext = context;
+}
+
+SensorManager& ReplayPipeline::getSensors() {
+  return sensors;
+}
+
+AnomalyDetection& ReplayPipeline::getDetector() {
+  return detector;
+}
+
+AlertQueue& ReplayPipeline::getQueue() {
+  return queue;
+}
+
+uint32_t ReplayPipeline::getReadings() {
+  return readings;
+}
+
+uint32_t ReplayPipeline::getBatches() {
+  return batches;
+}
+
+uint32_t ReplayPipeline::getReports(AnomalyType type) {
+  return type < ANOMALY_TYPE_COUNT ? reports[type] : 0;
+}
+
+uint32_t ReplayPipeline::getEmergencies() {
+  return emergencies;
+}
@@ -0,0 +1,111 @@
+/**
+ * GreenOS - Host Trace Replay Pipeline
+ *
+ * Runs a recorded (or synthesized) sensor trace through the same path
+ * the sensor task uses on the board:
+ *
+ *   TraceReplay -> SensorManager::readAll() -> AnomalyDetection
+ *               -> AlertQueue::update() / takeBatch()
+ *
+ * Unlike the on-device replay, the mock clock follows the trace, so
+ * hold-down and escalation timers see the recorded time span rather than
+ * a compressed one. Actuators, rollups and the uplink are not involved.
+ *
+ * TraceBuilder produces the input: concatenated RecordCodec blocks, the
+ * same bytes TraceRecorder stores as LOG_TYPE_TRACE payloads.
+ */
+
+#ifndef GREENOS_REPLAY_PIPELINE_H
+#define GREENOS_REPLAY_PIPELINE_H
+
+#include <Arduino.h>
+#include "sensor_manager.h"
+#include "sensor_trace.h"
+#include "anomaly_detection.h"
+#include "alert_queue.h"
+
+// Mirrors EMERGENCY_ANOMALIES in main.ino - these bypass the queue
+#define REPLAY_EMERGENCY_ANOMALIES (ANOMALY_BIT(TEMP_TOO_LOW) | ANOMALY_BIT(TEMP_TOO_HIGH))
+
+// ============================================================================
+// TRACE BUILDER
+// ============================================================================
+
+class TraceBuilder {
+public:
+  TraceBuilder();
+
+  // One snapshot at data.timestamp (blocks of TRACE_BLOCK_RECORDS)
+  void add(const SensorData& data);
+
+  // Steady reading every intervalMs for durationMs, starting at startMs
+  void addSteady(float airTemp, float airHumidity, float co2, unsigned long startMs,
+                 unsigned long durationMs, unsigned long intervalMs);
+
+  // Flushes the partial block
+  const std::vector<uint8_t>& bytes();
+  uint32_t getRecordCount();
+
+private:
+  std::vector<uint8_t> trace;
+  RecordCodec codec;
+  PackedReading pending[TRACE_BLOCK_RECORDS];
+  uint16_t pendingCount;
+  unsigned long blockBase;
+  uint32_t recordCount;
+
+  void flush();
+};
+
+// ============================================================================
+// REPLAY PIPELINE
+// ============================================================================
+
+typedef void (*ReplayBatchCallback)(const AlertBatch& batch, unsigned long now, void* context);
+
+class ReplayPipeline {
+public:
+  ReplayPipeline();
+
+  // Resets the mock HAL and brings the sensor stack up on it
+  void begin();
+
+  // Trace bytes must stay valid until the replay ends
+  bool start(const uint8_t* trace, size_t length);
+
+  // One sensor cycle. False once the trace is exhausted.
+  bool step();
+
+  // Every remaining cycle, then one coalescing window so alerts still
+  // pending at the end of the trace are reported. Returns readings played.
+  uint32_t run();
+
+  void setBatchCallback(ReplayBatchCallback callback, void* context);
+
+  SensorManager& getSensors();
+  AnomalyDetection& getDetector();
+  AlertQueue& getQueue();
+
+  uint32_t getReadings();
+  uint32_t getBatches();
+  uint32_t getReports(AnomalyType type);       // Entries of this type across all batches
+  uint32_t getEmergencies();                   // Cycles with an emergency-level anomaly
+
+private:
+  SensorManager sensors;
+  TraceReplay replay;
+  AnomalyDetection detector;
+  AlertQueue queue;
+
+  ReplayBatchCallback batchCallback;
+  void* batchContext;
+
+  uint32_t readings;
+  uint32_t batches;
+  uint32_t reports[ANOMALY_TYPE_COUNT];
+  uint32_t emergencies;
+
+  void serviceQueue();
+};
+
+#endif // GREENOS_REPLAY_PIPELINE_H
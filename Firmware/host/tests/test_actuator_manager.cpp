@@ -0,0 +1,82 @@
+/**
+ * GreenOS - Actuator Manager Tests
+ *
+ * Dry run (trace replay): automatic control moves only the shadow mask,
+ * operator commands still reach the relays.
+ */
+
+#include <gtest/gtest.h>
+#include "config.h"
+#include "actuator_manager.h"
+#include "mock_hal.h"
+
+class ActuatorManagerTest : public ::testing::Test {
+protected:
+  ActuatorManager actuators;
+
+  void SetUp() override {
+    mockReset();
+    actuators = ActuatorManager();
+    actuators.init();
+  }
+};
+
+TEST_F(ActuatorManagerTest, CommandSwitchesRelay) {
+  actuators.setActuator(ACTUATOR_FAN_CIRCULATION, true);
+
+  EXPECT_TRUE(actuators.isOn(ACTUATOR_FAN_CIRCULATION));
+  EXPECT_EQ(mockGetDigitalOutput(FAN_CIRCULATION_PIN), HIGH);
+}
+
+TEST_F(ActuatorManagerTest, DryRunLeavesRelaysAlone) {
+  actuators.setDryRun(true);
+  actuators.handleWarning(ANOMALY_BIT(HUMIDITY_TOO_HIGH));
+
+  EXPECT_EQ(actuators.getState(), 0);
+  EXPECT_EQ(mockGetDigitalOutput(FAN_EXHAUST_PIN), LOW);
+  EXPECT_EQ(mockGetDigitalOutput(FAN_CIRCULATION_PIN), LOW);
+  EXPECT_EQ(actuators.getShadowState(),
+            ACTUATOR_BIT(ACTUATOR_FAN_EXHAUST) | ACTUATOR_BIT(ACTUATOR_FAN_CIRCULATION));
+  EXPECT_EQ(actuators.getShadowSwitches(), 2u);
+}
+
+TEST_F(ActuatorManagerTest, DryRunKeepsInterlocks) {
+  actuators.setDryRun(true);
+  actuators.command(ACTUATOR_BIT(ACTUATOR_FAN_EXHAUST), 0);
+  actuators.setActuator(ACTUATOR_HEATER_PRIMARY, true);
+
+  // Heaters refuse ON next to the exhaust fan (no settle sequence)
+  EXPECT_EQ(actuators.getShadowState(), ACTUATOR_BIT(ACTUATOR_FAN_EXHAUST));
+}
+
+TEST_F(ActuatorManagerTest, OperatorCommandBypassesDryRun) {
+  actuators.setDryRun(true);
+
+  ActuatorCommand command = {CMD_LIGHT, true, millis()};
+  ASSERT_TRUE(actuators.queueCommand(command));
+  actuators.tick();
+
+  EXPECT_TRUE(actuators.isOn(ACTUATOR_LIGHT));
+  EXPECT_EQ(mockGetDigitalOutput(LIGHT_GROW_PIN), HIGH);
+}
+
+TEST_F(ActuatorManagerTest, LeavingDryRunRestoresRealControl) {
+  actuators.setDryRun(true);
+  actuators.setActuator(ACTUATOR_PUMP, true);
+  actuators.setDryRun(false);
+
+  EXPECT_FALSE(actuators.isDryRun());
+  EXPECT_EQ(actuators.getShadowState(), 0);
+  actuators.setActuator(ACTUATOR_PUMP, true);
+  EXPECT_TRUE(actuators.isOn(ACTUATOR_PUMP));
+}
+
+TEST_F(ActuatorManagerTest, InstancesKeepSeparateState) {
+  ActuatorManager other;
+  other.setDryRun(true);
+  other.setActuator(ACTUATOR_PUMP, true);
+
+  EXPECT_FALSE(actuators.isDryRun());
+  EXPECT_EQ(actuators.getShadowState(), 0);
+  EXPECT_FALSE(actuators.isOn(ACTUATOR_PUMP));
+}
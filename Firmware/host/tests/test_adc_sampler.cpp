@@ -0,0 +1,155 @@
+/**
+ * GreenOS - ADC Sampler Tests
+ *
+ * Scan pacing and the running window on the mock clock and analog pins.
+ */
+
+#include <gtest/gtest.h>
+#include "adc_sampler.h"
+#include "mock_hal.h"
+
+#define ADC_TEST_PIN_A 2
+#define ADC_TEST_PIN_B 3
+
+class AdcSamplerTest : public ::testing::Test {
+protected:
+  AdcSampler sampler;
+
+  void SetUp() override {
+    mockReset();
+    mockSetMillis(1000);
+  }
+
+  // One scan per period
+  void scan(int scans) {
+    for (int i = 0; i < scans; i++) {
+      sampler.service();
+      mockAdvanceMillis(ADC_SAMPLER_PERIOD_MS);
+    }
+  }
+};
+
+// ============================================================================
+// CHANNELS
+// ============================================================================
+
+TEST_F(AdcSamplerTest, ChannelTableFullIsRefused) {
+  for (int i = 0; i < ADC_SAMPLER_MAX_CHANNELS; i++) {
+    ASSERT_EQ(sampler.addChannel(ADC_TEST_PIN_A + i), i);
+  }
+  EXPECT_EQ(sampler.addChannel(ADC_TEST_PIN_A), -1);
+  EXPECT_EQ(sampler.getChannelCount(), ADC_SAMPLER_MAX_CHANNELS);
+}
+
+TEST_F(AdcSamplerTest, ChannelsSampleTheirOwnPins) {
+  int8_t a = sampler.addChannel(ADC_TEST_PIN_A);
+  int8_t b = sampler.addChannel(ADC_TEST_PIN_B);
+  mockSetAnalog(ADC_TEST_PIN_A, 100);
+  mockSetAnalog(ADC_TEST_PIN_B, 3000);
+  scan(3);
+
+  EXPECT_FLOAT_EQ(sampler.getAverageRaw(a), 100.0f);
+  EXPECT_FLOAT_EQ(sampler.getAverageRaw(b), 3000.0f);
+  EXPECT_EQ(sampler.getSampleCount(a), 3);
+}
+
+// ============================================================================
+// PACING
+// ============================================================================
+
+TEST_F(AdcSamplerTest, OneScanPerPeriod) {
+  sampler.addChannel(ADC_TEST_PIN_A);
+  sampler.service();                 // First call scans at once
+  EXPECT_EQ(sampler.getScanCount(), 1u);
+  EXPECT_EQ(sampler.msUntilNextScan(), (unsigned long)ADC_SAMPLER_PERIOD_MS);
+
+  mockAdvanceMillis(ADC_SAMPLER_PERIOD_MS - 1);
+  uint32_t reads = mockGetAnalogReads();
+  sampler.service();
+  EXPECT_EQ(sampler.getScanCount(), 1u);
+  EXPECT_EQ(mockGetAnalogReads(), reads);  // No conversion between scans
+  EXPECT_EQ(sampler.msUntilNextScan(), 1u);
+
+  mockAdvanceMillis(1);
+  EXPECT_EQ(sampler.msUntilNextScan(), 0u);
+  sampler.service();
+  EXPECT_EQ(sampler.getScanCount(), 2u);
+}
+
+TEST_F(AdcSamplerTest, LateServiceTakesOneScan) {
+  sampler.addChannel(ADC_TEST_PIN_A);
+  sampler.service();
+
+  mockAdvanceMillis(10 * ADC_SAMPLER_PERIOD_MS);
+  sampler.service();
+  sampler.service();
+  EXPECT_EQ(sampler.getScanCount(), 2u);
+  EXPECT_EQ(sampler.getSampleCount(0), 2);
+  EXPECT_EQ(sampler.msUntilNextScan(), (unsigned long)ADC_SAMPLER_PERIOD_MS);
+}
+
+TEST_F(AdcSamplerTest, NoChannelsNeverDue) {
+  EXPECT_EQ(sampler.msUntilNextScan(), (unsigned long)ADC_SAMPLER_PERIOD_MS);
+}
+
+// ============================================================================
+// RUNNING AVERAGE
+// ============================================================================
+
+TEST_F(AdcSamplerTest, WindowKeepsTheLatestSamples) {
+  int8_t a = sampler.addChannel(ADC_TEST_PIN_A);
+  mockSetAnalog(ADC_TEST_PIN_A, 1000);
+  scan(ADC_SAMPLER_WINDOW - 1);
+  EXPECT_FALSE(sampler.isPrimed(a));
+  scan(1);
+  EXPECT_TRUE(sampler.isPrimed(a));
+
+  // Half a window at a new level: the old half is still in the sum
+  mockSetAnalog(ADC_TEST_PIN_A, 2000);
+  scan(ADC_SAMPLER_WINDOW / 2);
+  EXPECT_FLOAT_EQ(sampler.getAverageRaw(a), 1500.0f);
+  EXPECT_EQ(sampler.getLatestRaw(a), 2000);
+  EXPECT_EQ(sampler.getSampleCount(a), ADC_SAMPLER_WINDOW);
+
+  // A full window later the old level has dropped out
+  scan(ADC_SAMPLER_WINDOW / 2);
+  EXPECT_FLOAT_EQ(sampler.getAverageRaw(a), 2000.0f);
+}
+
+TEST_F(AdcSamplerTest, RunningSumMatchesWindowAfterManyScans) {
+  int8_t a = sampler.addChannel(ADC_TEST_PIN_A);
+  for (int i = 0; i < 10 * ADC_SAMPLER_WINDOW + 5; i++) {
+    mockSetAnalog(ADC_TEST_PIN_A, (i * 37) % 4096);
+    scan(1);
+  }
+
+  // Average of the last window, computed directly
+  float sum = 0.0f;
+  for (int i = 10 * ADC_SAMPLER_WINDOW + 5 - ADC_SAMPLER_WINDOW; i < 10 * ADC_SAMPLER_WINDOW + 5; i++) {
+    sum += (i * 37) % 4096;
+  }
+  EXPECT_FLOAT_EQ(sampler.getAverageRaw(a), sum / ADC_SAMPLER_WINDOW);
+}
+
+TEST_F(AdcSamplerTest, FirstReadBeforeAnyScanConverts) {
+  int8_t a = sampler.addChannel(ADC_TEST_PIN_A);
+  mockSetAnalog(ADC_TEST_PIN_A, 512);
+  EXPECT_EQ(sampler.getLatestRaw(a), 0);
+
+  EXPECT_FLOAT_EQ(sampler.getAverageRaw(a), 512.0f);
+  EXPECT_EQ(sampler.getSampleCount(a), 1);
+  EXPECT_EQ(sampler.getScanCount(), 0u);
+}
+
+TEST_F(AdcSamplerTest, RestartDropsHistory) {
+  int8_t a = sampler.addChannel(ADC_TEST_PIN_A);
+  mockSetAnalog(ADC_TEST_PIN_A, 4000);
+  scan(ADC_SAMPLER_WINDOW);
+  ASSERT_TRUE(sampler.isPrimed(a));
+
+  sampler.restart(a);
+  EXPECT_EQ(sampler.getSampleCount(a), 0);
+  mockSetAnalog(ADC_TEST_PIN_A, 10);
+  scan(2);
+  EXPECT_FLOAT_EQ(sampler.getAverageRaw(a), 10.0f);
+}
@@ -0,0 +1,159 @@
+/**
+ * GreenOS - AlertQueue Tests
+ */
+
+#include <gtest/gtest.h>
+#include "alert_queue.h"
+
+// Drives the queue with a detector whose records match the set
+class AlertQueueTest : public ::testing::Test {
+protected:
+  AnomalyDetection detector;
+  AlertQueue queue;
+  SensorData data;
+  unsigned long now = 0;
+
+  void SetUp() override {
+    memset(&data, 0, sizeof(data));
+    data.airTemp = 22.0f;
+    data.airHumidity = 55.0f;
+    data.co2 = 600.0f;
+  }
+
+  // One detection pass at `now`; returns the batch taken, if any
+  const AlertBatch* pass(float humidity, float scd30ErrorRate = 0.0f) {
+    data.airHumidity = humidity;
+    data.scd30ErrorRate = scd30ErrorRate;
+    data.timestamp = now;
+    data.sequence++;
+    bool detected = detector.detectAnomalies(data);
+    queue.update(detector, detected ? detector.getAnomalySet() : 0, now);
+    return queue.takeBatch(now);
+  }
+};
+
+TEST_F(AlertQueueTest, CoalescesNonCriticalAlerts) {
+  EXPECT_EQ(pass(90.0f), nullptr);       // Pending, waiting for company
+  now += ALERT_COALESCE_MS / 2;
+  EXPECT_EQ(pass(90.0f, 80.0f), nullptr);
+  now += ALERT_COALESCE_MS / 2;
+
+  const AlertBatch* batch = pass(90.0f, 80.0f);
+  ASSERT_NE(batch, nullptr);
+  ASSERT_EQ(batch->count, 2);
+  for (uint8_t i = 0; i < batch->count; i++) {
+    EXPECT_EQ(batch->entries[i].severity, ALERT_MEDIUM);
+  }
+  EXPECT_EQ(batch->entries[0].type, HUMIDITY_TOO_HIGH);   // AnomalyType order within a level
+  EXPECT_EQ(batch->entries[1].type, SENSOR_MALFUNCTION);
+  EXPECT_EQ(batch->entries[0].occurrences, 3);
+  EXPECT_FALSE(queue.hasPending());
+}
+
+TEST_F(AlertQueueTest, HoldDownSuppressesRepeats) {
+  pass(90.0f);
+  now += ALERT_COALESCE_MS;
+  ASSERT_NE(pass(90.0f), nullptr);
+
+  const AlertPolicy& policy = AlertQueue::getPolicy(HUMIDITY_TOO_HIGH);
+  for (unsigned long t = 60000; t < policy.holdDownMs; t += 60000) {
+    now += 60000;
+    EXPECT_EQ(pass(90.0f), nullptr);
+    EXPECT_FALSE(queue.hasPending());
+  }
+}
+
+TEST_F(AlertQueueTest, ClearedConditionStartsOver) {
+  pass(90.0f);
+  now += ALERT_COALESCE_MS;
+  ASSERT_NE(pass(90.0f), nullptr);
+
+  now += 1000;
+  EXPECT_EQ(pass(55.0f), nullptr);       // Cleared
+  now += 1000;
+  pass(90.0f);                           // New onset, still in hold-down
+  EXPECT_FALSE(queue.hasPending());
+}
+
+TEST_F(AlertQueueTest, EscalatesPersistingConditionOnce) {
+  const AlertPolicy& policy = AlertQueue::getPolicy(HUMIDITY_TOO_HIGH);
+  unsigned long onset = now;
+  int escalations = 0;
+
+  for (; now - onset <= policy.escalateAfterMs + policy.holdDownMs / 2; now += 60000) {
+    const AlertBatch* batch = pass(90.0f);
+    if (batch != nullptr && batch->entries[0].escalated) {
+      escalations++;
+      EXPECT_EQ(batch->entries[0].severity, ALERT_HIGH);
+      EXPECT_EQ(batch->entries[0].firstSeen, onset);
+    }
+  }
+  EXPECT_EQ(escalations, 1);
+}
+
+// The user-027 acceptance check: a humidity condition held for 3 h,
+// detected every minute, produces 6 reports instead of 180
+TEST_F(AlertQueueTest, HumidityHeldThreeHoursGivesSixReports) {
+  int reports = 0;
+  for (now = 0; now <= 3 * 3600000UL; now += 60000) {
+    const AlertBatch* batch = pass(90.0f);
+    if (batch != nullptr) reports += batch->count;
+  }
+  EXPECT_EQ(reports, 6);
+}
+
+TEST_F(AlertQueueTest, CriticalSkipsCoalescing) {
+  // RAPID_TEMP_DROP is high and escalates to critical; feed the set directly
+  queue.update(detector, ANOMALY_BIT(RAPID_TEMP_DROP), now);
+  EXPECT_EQ(queue.takeBatch(now), nullptr);   // High: waits to coalesce
+  now += ALERT_COALESCE_MS;
+  ASSERT_NE(queue.takeBatch(now), nullptr);
+
+  now = AlertQueue::getPolicy(RAPID_TEMP_DROP).escalateAfterMs;
+  queue.update(detector, ANOMALY_BIT(RAPID_TEMP_DROP), now);
+  const AlertBatch* batch = queue.takeBatch(now);   // No coalescing wait
+  ASSERT_NE(batch, nullptr);
+  EXPECT_EQ(batch->entries[0].severity, ALERT_CRITICAL);
+  EXPECT_TRUE(batch->entries[0].escalated);
+}
+
+TEST_F(AlertQueueTest, FormatBatchIsBoundedAndTerminated) {
+  AlertBatch batch;
+  batch.count = 1;
+  batch.entries[0].type = HUMIDITY_TOO_HIGH;
+  batch.entries[0].severity = ALERT_HIGH;
+  batch.entries[0].occurrences = 12;
+  strcpy(batch.entries[0].text, "Humidity too high: 90.0% (limit 80.0)");
+
+  char line[128];
+  size_t length = AlertQueue::formatBatch(batch, line, sizeof(line));
+  EXPECT_STREQ(line, "[high] Humidity too high: 90.0% (limit 80.0) x12");
+  EXPECT_EQ(length, strlen(line));
+
+  char tiny[8];
+  length = AlertQueue::formatBatch(batch, tiny, sizeof(tiny));
+  EXPECT_EQ(length, 7u);
+  EXPECT_EQ(tiny[7], '\0');
+}
+
+TEST_F(AlertQueueTest, DescribeBatchKeepsTopSeverityAndEarliestOnset) {
+  pass(90.0f);
+  now += 5000;
+  pass(90.0f, 80.0f);
+  now += ALERT_COALESCE_MS;
+
+  const AlertBatch* batch = pass(90.0f, 80.0f);
+  ASSERT_NE(batch, nullptr);
+  LoggedAlert alert = AlertQueue::describeBatch(*batch, 7);
+  EXPECT_EQ(alert.severity, ALERT_MEDIUM);
+  EXPECT_EQ(alert.firstSeen, 0u);       // Humidity, not the later sensor fault
+  EXPECT_EQ(alert.boot, 7u);
+}
+
+TEST_F(AlertQueueTest, ParseSeverityRoundTrips) {
+  for (uint8_t level = ALERT_LOW; level <= ALERT_CRITICAL; level++) {
+    EXPECT_EQ(AlertQueue::parseSeverity(AlertQueue::getSeverityName((AlertSeverity)level)), level);
+  }
+  EXPECT_EQ(AlertQueue::parseSeverity("unknown"), ALERT_SEVERITY_NONE);
+  EXPECT_EQ(AlertQueue::parseSeverity(nullptr), ALERT_SEVERITY_NONE);
+}
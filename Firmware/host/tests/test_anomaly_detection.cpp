@@ -0,0 +1,135 @@
+/**
+ * GreenOS - AnomalyDetection Tests
+ */
+
+#include <gtest/gtest.h>
+#include "config.h"
+#include "anomaly_detection.h"
+
+// Nominal cycle: only the air readings carry data
+class AnomalyDetectionTest : public ::testing::Test {
+protected:
+  AnomalyDetection detector;
+  SensorData data;
+
+  void SetUp() override {
+    memset(&data, 0, sizeof(data));
+    data.airTemp = 22.0f;
+    data.airHumidity = 55.0f;
+    data.co2 = 600.0f;
+    data.airQualityPPM = NAN;
+    data.substrateTemp = NAN;
+    data.vwc = NAN;
+    data.ph = NAN;
+    data.ec = NAN;
+    data.nitrogen = NAN;
+    data.phosphorus = NAN;
+    data.potassium = NAN;
+    data.par = NAN;
+    data.noiseLevel = NAN;
+    data.voltage = 5.0f;
+  }
+
+  // Next snapshot, SENSOR_READ_INTERVAL after the previous one
+  bool cycle() {
+    data.sequence++;
+    data.timestamp += SENSOR_READ_INTERVAL;
+    return detector.detectAnomalies(data);
+  }
+};
+
+TEST_F(AnomalyDetectionTest, QuietOnNominalReadings) {
+  for (int i = 0; i < 100; i++) {
+    EXPECT_FALSE(cycle());
+  }
+  EXPECT_EQ(detector.getAnomalyType(), NONE);
+}
+
+TEST_F(AnomalyDetectionTest, AbsoluteLimitsRaiseTheirType) {
+  data.airHumidity = HUMIDITY_MAX + 5.0f;
+  ASSERT_TRUE(cycle());
+  EXPECT_TRUE(detector.hasAnomaly(HUMIDITY_TOO_HIGH));
+  EXPECT_FLOAT_EQ(detector.getRecord(HUMIDITY_TOO_HIGH).threshold, HUMIDITY_MAX);
+
+  data.airHumidity = 55.0f;
+  data.airTemp = TEMP_MIN - 1.0f;
+  ASSERT_TRUE(cycle());
+  EXPECT_TRUE(detector.hasAnomaly(TEMP_TOO_LOW));
+  EXPECT_FALSE(detector.hasAnomaly(HUMIDITY_TOO_HIGH));
+}
+
+TEST_F(AnomalyDetectionTest, SimultaneousConditionsAreAllReported) {
+  data.airTemp = TEMP_MAX + 2.0f;
+  data.airHumidity = HUMIDITY_MIN - 10.0f;
+  data.scd30ErrorRate = 80.0f;
+  ASSERT_TRUE(cycle());
+
+  AnomalySet set = detector.getAnomalySet();
+  EXPECT_TRUE(set & ANOMALY_BIT(TEMP_TOO_HIGH));
+  EXPECT_TRUE(set & ANOMALY_BIT(HUMIDITY_TOO_LOW));
+  EXPECT_TRUE(set & ANOMALY_BIT(SENSOR_MALFUNCTION));
+  EXPECT_EQ(detector.getRecord(SENSOR_MALFUNCTION).sources, ANOMALY_SOURCE_SCD30);
+  EXPECT_EQ(detector.getAnomalyType(), TEMP_TOO_HIGH);   // Most severe first
+}
+
+TEST_F(AnomalyDetectionTest, SetLimitsOverridesDefaults) {
+  detector.setLimits(10.0f, 20.0f, HUMIDITY_MIN, HUMIDITY_MAX);
+  ASSERT_TRUE(cycle());                               // 22 °C is now too warm
+  EXPECT_TRUE(detector.hasAnomaly(TEMP_TOO_HIGH));
+}
+
+TEST_F(AnomalyDetectionTest, SpikeAfterWarmupIsStatisticalDeviation) {
+  // Small jitter so the residual variance is realistic
+  for (int i = 0; i < ANOMALY_WARMUP_SAMPLES * 2; i++) {
+    data.co2 = 600.0f + ((i % 2) ? 2.0f : -2.0f);
+    EXPECT_FALSE(cycle());
+  }
+
+  data.co2 = 1400.0f;
+  ASSERT_TRUE(cycle());
+  EXPECT_TRUE(detector.hasAnomaly(STATISTICAL_DEVIATION));
+  EXPECT_TRUE(detector.getRecord(STATISTICAL_DEVIATION).sources & (1 << METRIC_CO2));
+  EXPECT_GT(detector.getMetricStats(METRIC_CO2).zScore, 4.0f);
+}
+
+TEST_F(AnomalyDetectionTest, RapidTemperatureDrop) {
+  for (int i = 0; i < 60; i++) cycle();
+
+  // 4 °C/min, well past ANOMALY_RAPID_TEMP_DROP
+  bool dropped = false;
+  for (int i = 0; i < 30 && !dropped; i++) {
+    data.airTemp -= 4.0f * SENSOR_READ_INTERVAL / 60000.0f;
+    cycle();
+    dropped = detector.hasAnomaly(RAPID_TEMP_DROP);
+  }
+  EXPECT_TRUE(dropped);
+  EXPECT_LE(detector.getRecord(RAPID_TEMP_DROP).value, -ANOMALY_RAPID_TEMP_DROP);
+}
+
+TEST_F(AnomalyDetectionTest, SameSnapshotIsScoredOnce) {
+  for (int i = 0; i < 10; i++) cycle();
+  uint16_t count = detector.getMetricStats(METRIC_AIR_TEMP).count;
+
+  detector.detectAnomalies(data);                     // Same sequence again
+  EXPECT_EQ(detector.getMetricStats(METRIC_AIR_TEMP).count, count);
+}
+
+TEST_F(AnomalyDetectionTest, MotionOnlyMattersOffHours) {
+  data.motionEvents = ANOMALY_MOTION_MIN_EVENTS;
+  EXPECT_FALSE(cycle());
+
+  detector.setOffHours(true);
+  ASSERT_TRUE(cycle());
+  EXPECT_TRUE(detector.hasAnomaly(MOTION_OFF_HOURS));
+}
+
+TEST_F(AnomalyDetectionTest, FormatsDetailsOnDemand) {
+  data.airHumidity = 91.2f;
+  ASSERT_TRUE(cycle());
+
+  char text[ANOMALY_DETAILS_SIZE];
+  size_t length = detector.formatDetails(HUMIDITY_TOO_HIGH, text, sizeof(text));
+  EXPECT_GT(length, 0u);
+  EXPECT_NE(strstr(text, "Humidity too high"), nullptr);
+  EXPECT_NE(strstr(text, "91.2"), nullptr);
+}
@@ -0,0 +1,82 @@
+/**
+ * GreenOS - Boot State Tests
+ *
+ * The host has no hwinfo, so the reset cause is whatever the firmware
+ * noted. The retained block is a plain static here: it survives between
+ * BootState instances in one process, the way .noinit RAM survives a
+ * reset on the board.
+ */
+
+#include <gtest/gtest.h>
+#include "config.h"
+#include "boot_state.h"
+#include "actuator_manager.h"
+#include "mock_hal.h"
+
+class BootStateTest : public ::testing::Test {
+protected:
+  SensorData data;
+
+  void SetUp() override {
+    mockReset();
+    memset(&data, 0, sizeof(data));
+    data.sequence = 1;
+    data.airTemp = 21.0f;
+  }
+
+  // One boot that ran long enough to clear the warm-reset count, then
+  // reset - noting why unless noted is BOOT_UNKNOWN
+  void runPreviousBoot(ActuatorMask relays, BootCause noted) {
+    BootState boot;
+    boot.begin();
+    mockSetMillis(BOOT_STABLE_MS);
+    boot.save(relays, data, 0, 0);
+    if (noted != BOOT_UNKNOWN) boot.noteReset(noted);
+  }
+};
+
+TEST_F(BootStateTest, NotedSoftwareResetIsWarm) {
+  runPreviousBoot(ACTUATOR_BIT(ACTUATOR_PUMP), BOOT_SOFTWARE);
+
+  BootState boot;
+  EXPECT_EQ(boot.begin(), BOOT_SOFTWARE);
+  EXPECT_TRUE(boot.isWarm());
+  EXPECT_EQ(boot.getRelays(), ACTUATOR_BIT(ACTUATOR_PUMP));
+}
+
+TEST_F(BootStateTest, NotedWatchdogResetIsWarm) {
+  runPreviousBoot(0, BOOT_WATCHDOG);
+
+  BootState boot;
+  EXPECT_EQ(boot.begin(), BOOT_WATCHDOG);
+  EXPECT_TRUE(boot.isWarm());
+}
+
+TEST_F(BootStateTest, UnexplainedResetIsCold) {
+  runPreviousBoot(ACTUATOR_BIT(ACTUATOR_HEATER_PRIMARY), BOOT_UNKNOWN);
+
+  BootState boot;
+  EXPECT_EQ(boot.begin(), BOOT_UNKNOWN);
+  EXPECT_FALSE(boot.isWarm());
+  EXPECT_EQ(boot.getRelays(), 0);
+
+  SensorReading reading;
+  EXPECT_FALSE(boot.getReading(reading));
+}
+
+TEST_F(BootStateTest, RelaySwitchIsRetainedBeforeNextSave) {
+  bootState.begin();
+  mockSetMillis(BOOT_STABLE_MS);
+  bootState.save(0, data, 0, 0);
+
+  // Reset between the switch and the next cycle's save()
+  ActuatorManager actuators;
+  actuators.init();
+  actuators.setActuator(ACTUATOR_FAN_CIRCULATION, true);
+  bootState.noteReset(BOOT_WATCHDOG);
+
+  BootState boot;
+  boot.begin();
+  ASSERT_TRUE(boot.isWarm());
+  EXPECT_EQ(boot.getRelays(), ACTUATOR_BIT(ACTUATOR_FAN_CIRCULATION));
+}
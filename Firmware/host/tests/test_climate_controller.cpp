@@ -0,0 +1,224 @@
+/**
+ * GreenOS - Climate Controller Tests
+ *
+ * Control loops against a real ActuatorManager on the mock HAL. The
+ * controller is handed its clock; tests step it together with the mock
+ * millis() unless a test is about the two running apart (trace replay).
+ */
+
+#include <gtest/gtest.h>
+#include "config.h"
+#include "climate_controller.h"
+#include "mock_hal.h"
+
+class ClimateControllerTest : public ::testing::Test {
+protected:
+  ActuatorManager actuators;
+  ClimateController climate;
+  SensorData data;
+
+  void SetUp() override {
+    mockReset();
+    mockSetMillis(1000);
+    actuators = ActuatorManager();
+    actuators.init();
+    climate = ClimateController();
+    climate.init(&actuators);
+
+    memset(&data, 0, sizeof(data));
+    data.airTemp = 22.0f;          // Inside every temperature band
+    data.airHumidity = NAN;        // Humidity and irrigation loops idle
+    data.vwc = NAN;
+  }
+
+  // New sensor snapshot at the current time
+  void sample(float airTemp) {
+    data.airTemp = airTemp;
+    data.timestamp = millis();
+    data.sequence++;
+    climate.update(data, millis());
+  }
+
+  // Control passes without new data
+  void runFor(unsigned long durationMs) {
+    for (unsigned long t = 0; t < durationMs; t += CONTROL_PERIOD_MS) {
+      mockAdvanceMillis(CONTROL_PERIOD_MS);
+      climate.update(data, millis());
+      actuators.tick();
+    }
+  }
+
+  // One snapshot per control pass for durationMs
+  void holdFor(float airTemp, unsigned long durationMs) {
+    for (unsigned long t = 0; t < durationMs; t += CONTROL_PERIOD_MS) {
+      mockAdvanceMillis(CONTROL_PERIOD_MS);
+      sample(airTemp);
+      actuators.tick();
+    }
+  }
+
+  bool heaterCommanded() {
+    return climate.getStatus(CONTROL_LOOP_HEAT).relayOn;
+  }
+};
+
+static const ControlLoopConfig& heatLoop = ClimateController::getConfig(CONTROL_LOOP_HEAT);
+static const ControlLoopConfig& ventLoop = ClimateController::getConfig(CONTROL_LOOP_VENT);
+
+// ============================================================================
+// HYSTERESIS
+// ============================================================================
+
+TEST_F(ClimateControllerTest, VentLatchesAcrossTheBand) {
+  float setpoint = ventLoop.setpoint;
+
+  sample(setpoint + 0.5f * ventLoop.band);
+  EXPECT_FLOAT_EQ(climate.getStatus(CONTROL_LOOP_VENT).demand, 0.0f);
+
+  sample(setpoint + 1.5f * ventLoop.band);   // Above the band: ON
+  EXPECT_FLOAT_EQ(climate.getStatus(CONTROL_LOOP_VENT).demand, 1.0f);
+  EXPECT_TRUE(actuators.isOn(ACTUATOR_FAN_EXHAUST));
+
+  runFor(2 * MIN_CYCLE_TIME_MS);
+  sample(setpoint - 0.5f * ventLoop.band);   // Back inside: stays ON
+  EXPECT_FLOAT_EQ(climate.getStatus(CONTROL_LOOP_VENT).demand, 1.0f);
+  EXPECT_TRUE(actuators.isOn(ACTUATOR_FAN_EXHAUST));
+
+  sample(setpoint - 1.5f * ventLoop.band);   // Below the band: OFF mid-window
+  EXPECT_FLOAT_EQ(climate.getStatus(CONTROL_LOOP_VENT).demand, 0.0f);
+  EXPECT_FALSE(actuators.isOn(ACTUATOR_FAN_EXHAUST));
+}
+
+TEST_F(ClimateControllerTest, FullDemandHoldsRelayAcrossWindows) {
+  sample(ventLoop.setpoint + 2.0f * ventLoop.band);
+  runFor(3 * ventLoop.windowMs);
+
+  EXPECT_TRUE(actuators.isOn(ACTUATOR_FAN_EXHAUST));
+  EXPECT_EQ(climate.getStatus(CONTROL_LOOP_VENT).relaySwitches, 1u);
+}
+
+TEST_F(ClimateControllerTest, LostSensorFailsOff) {
+  sample(ventLoop.setpoint + 2.0f * ventLoop.band);
+  ASSERT_TRUE(actuators.isOn(ACTUATOR_FAN_EXHAUST));
+
+  runFor(MIN_CYCLE_TIME_MS);
+  sample(NAN);
+  EXPECT_FALSE(actuators.isOn(ACTUATOR_FAN_EXHAUST));
+}
+
+// ============================================================================
+// PID
+// ============================================================================
+
+TEST_F(ClimateControllerTest, SaturatedHeaterDoesNotWindUp) {
+  // Hours far below setpoint with the output pinned at its cap
+  holdFor(heatLoop.setpoint - 10.0f, 3 * 3600000UL);
+  EXPECT_FLOAT_EQ(climate.getStatus(CONTROL_LOOP_HEAT).demand, 1.0f);
+
+  // Just past setpoint the demand drops at once instead of unwinding
+  holdFor(heatLoop.setpoint + 0.5f, CONTROL_PERIOD_MS);
+  EXPECT_FLOAT_EQ(climate.getStatus(CONTROL_LOOP_HEAT).demand, 0.0f);
+}
+
+TEST_F(ClimateControllerTest, IntegralStopsAtDutyCap) {
+  float error = 0.5f;
+  holdFor(heatLoop.setpoint - error, 6 * 3600000UL);
+  EXPECT_NEAR(climate.getStatus(CONTROL_LOOP_HEAT).demand, heatLoop.maxDuty, 1e-3f);
+
+  // The integral term holds only what the cap left over, so an overshoot
+  // of the same size pulls the output down by twice the P term
+  holdFor(heatLoop.setpoint + error, CONTROL_PERIOD_MS);
+  EXPECT_NEAR(climate.getStatus(CONTROL_LOOP_HEAT).demand,
+              heatLoop.maxDuty - 2.0f * heatLoop.kp * error, 1e-3f);
+}
+
+TEST_F(ClimateControllerTest, IntegralRemovesSteadyOffset) {
+  float error = 0.2f;
+  holdFor(heatLoop.setpoint - error, CONTROL_PERIOD_MS);
+  float start = climate.getStatus(CONTROL_LOOP_HEAT).demand;
+  EXPECT_NEAR(start, heatLoop.kp * error, 1e-4f);
+
+  holdFor(heatLoop.setpoint - error, 600000UL);
+  EXPECT_NEAR(climate.getStatus(CONTROL_LOOP_HEAT).demand,
+              start + heatLoop.ki * error * 600.0f, 1e-3f);
+}
+
+// ============================================================================
+// TIME-PROPORTIONED WINDOWS
+// ============================================================================
+
+TEST_F(ClimateControllerTest, HalfDemandIsHalfWindow) {
+  float error = 0.5f / heatLoop.kp;         // Proportional term alone: 50%
+  sample(heatLoop.setpoint - error);        // First sample: no integral yet
+  EXPECT_EQ(climate.getStatus(CONTROL_LOOP_HEAT).onTimeMs, heatLoop.windowMs / 2);
+  EXPECT_TRUE(actuators.isOn(ACTUATOR_HEATER_PRIMARY));
+
+  runFor(heatLoop.windowMs / 2 - 2 * CONTROL_PERIOD_MS);
+  EXPECT_TRUE(actuators.isOn(ACTUATOR_HEATER_PRIMARY));
+  runFor(3 * CONTROL_PERIOD_MS);
+  EXPECT_FALSE(actuators.isOn(ACTUATOR_HEATER_PRIMARY));
+
+  runFor(heatLoop.windowMs / 2);            // Next window edge
+  EXPECT_TRUE(actuators.isOn(ACTUATOR_HEATER_PRIMARY));
+  EXPECT_EQ(climate.getStatus(CONTROL_LOOP_HEAT).relaySwitches, 3u);
+}
+
+TEST_F(ClimateControllerTest, PulseShorterThanMinCycleIsDropped) {
+  float duty = 0.5f * MIN_CYCLE_TIME_MS / heatLoop.windowMs;
+  sample(heatLoop.setpoint - duty / heatLoop.kp);
+
+  EXPECT_GT(climate.getStatus(CONTROL_LOOP_HEAT).demand, 0.0f);
+  EXPECT_EQ(climate.getStatus(CONTROL_LOOP_HEAT).onTimeMs, 0u);
+  runFor(heatLoop.windowMs);
+  EXPECT_EQ(climate.getStatus(CONTROL_LOOP_HEAT).relaySwitches, 0u);
+}
+
+// ============================================================================
+// CLOCK AND DRY RUN
+// ============================================================================
+
+TEST_F(ClimateControllerTest, WindowsFollowTheGivenClock) {
+  // Trace replay: data time runs far ahead of millis()
+  actuators.setDryRun(true);
+  unsigned long now = millis();
+  data.airTemp = heatLoop.setpoint - 0.5f / heatLoop.kp;
+  data.timestamp = now;
+  data.sequence++;
+  climate.update(data, now);
+  ASSERT_TRUE(heaterCommanded());
+
+  now += heatLoop.windowMs / 2 + CONTROL_PERIOD_MS;
+  mockAdvanceMillis(CONTROL_PERIOD_MS);
+  climate.update(data, now);
+  EXPECT_FALSE(heaterCommanded());
+
+  now += heatLoop.windowMs / 2;
+  mockAdvanceMillis(CONTROL_PERIOD_MS);
+  climate.update(data, now);
+  EXPECT_TRUE(heaterCommanded());
+}
+
+TEST_F(ClimateControllerTest, DryRunWindowEdgesCompareWithShadow) {
+  actuators.setDryRun(true);
+  sample(ventLoop.setpoint + 2.0f * ventLoop.band);
+  ASSERT_TRUE(actuators.getShadowState() & ACTUATOR_BIT(ACTUATOR_FAN_EXHAUST));
+  ASSERT_FALSE(actuators.isOn(ACTUATOR_FAN_EXHAUST));
+
+  // The real relay stays OFF; that is no reason to re-command every window
+  runFor(3 * ventLoop.windowMs);
+  EXPECT_EQ(climate.getStatus(CONTROL_LOOP_VENT).relaySwitches, 1u);
+  EXPECT_EQ(actuators.getShadowSwitches(), 1u);
+}
+
+TEST_F(ClimateControllerTest, WindowEdgeReassertsRefusedRelay) {
+  sample(ventLoop.setpoint + 2.0f * ventLoop.band);
+  ASSERT_TRUE(actuators.isOn(ACTUATOR_FAN_EXHAUST));
+
+  // Switched off behind the controller's back
+  runFor(MIN_CYCLE_TIME_MS);
+  actuators.setActuator(ACTUATOR_FAN_EXHAUST, false);
+  ASSERT_FALSE(actuators.isOn(ACTUATOR_FAN_EXHAUST));
+
+  runFor(ventLoop.windowMs);
+  EXPECT_TRUE(actuators.isOn(ACTUATOR_FAN_EXHAUST));
+}
@@ -0,0 +1,216 @@
+/**
+ * GreenOS - Config Store Tests
+ *
+ * A/B slots on the flash log's reserved sectors (RAM emulation). A
+ * second ConfigStore mounted on the same log loads what the first one
+ * committed, the way the next boot would. Slot images are damaged by
+ * rewriting the raw reserved sector.
+ */
+
+#include <gtest/gtest.h>
+#include "config.h"
+#include "config_store.h"
+#include "flash_log.h"
+#include "mock_hal.h"
+
+static int changeCalls = 0;
+
+static void countChange() {
+  changeCalls++;
+}
+
+class ConfigStoreTest : public ::testing::Test {
+protected:
+  FlashLog log;
+  ConfigStore store;
+
+  void SetUp() override {
+    mockReset();
+    ASSERT_TRUE(log.begin());
+    for (uint8_t slot = 0; slot < CONFIG_STORE_SLOTS; slot++) {
+      ASSERT_TRUE(log.writeReserved(slot, nullptr, 0));  // Erase only
+    }
+    changeCalls = 0;
+    store.setChangeCallback(countChange);
+  }
+
+  void TearDown() override {
+    flashLogEmulateStuckBits(0, 0);
+  }
+
+  void commitTempMax(float value) {
+    ASSERT_TRUE(store.set("tempMax", value));
+    ASSERT_TRUE(store.commit());
+  }
+
+  float tempMaxAfterRemount(bool& persisted) {
+    ConfigStore remounted;
+    persisted = remounted.begin(&log);
+    return remounted.get().tempMax;
+  }
+
+  // Rewrites one slot's sector with its bytes from offset on erased (0xFF)
+  // or with one bit flipped at offset
+  void damageSlot(uint8_t slot, uint32_t offset, bool tear) {
+    std::vector<uint8_t> sector(log.getReservedSize());
+    ASSERT_TRUE(log.readReserved(slot, 0, sector.data(), sector.size()));
+    if (tear) {
+      memset(sector.data() + offset, 0xFF, sector.size() - offset);
+    } else {
+      sector[offset] ^= 0x01;
+    }
+    ASSERT_TRUE(log.writeReserved(slot, sector.data(), sector.size()));
+  }
+};
+
+// Slot header: magic, version, length, sequence, crc32
+static const uint32_t SLOT_HEADER_SIZE = 16;
+
+// ============================================================================
+// LOAD
+// ============================================================================
+
+TEST_F(ConfigStoreTest, EmptyFlashLoadsDefaults) {
+  EXPECT_FALSE(store.begin(&log));
+  EXPECT_FALSE(store.isPersisted());
+  EXPECT_FLOAT_EQ(store.get().tempMax, TEMP_MAX);
+  EXPECT_EQ(store.get().sensorIntervalMs, (uint32_t)SENSOR_READ_INTERVAL);
+}
+
+TEST_F(ConfigStoreTest, CommitSurvivesRemount) {
+  store.begin(&log);
+  commitTempMax(33.0f);
+
+  bool persisted;
+  EXPECT_FLOAT_EQ(tempMaxAfterRemount(persisted), 33.0f);
+  EXPECT_TRUE(persisted);
+}
+
+TEST_F(ConfigStoreTest, NewerSlotWins) {
+  store.begin(&log);
+  commitTempMax(31.0f);  // Slot A
+  commitTempMax(32.0f);  // Slot B
+
+  bool persisted;
+  EXPECT_FLOAT_EQ(tempMaxAfterRemount(persisted), 32.0f);
+
+  commitTempMax(33.0f);  // Back to A, over the oldest copy
+  EXPECT_FLOAT_EQ(tempMaxAfterRemount(persisted), 33.0f);
+}
+
+TEST_F(ConfigStoreTest, TornSlotFallsBackToOtherCopy) {
+  store.begin(&log);
+  commitTempMax(31.0f);
+  commitTempMax(32.0f);
+
+  // Power lost halfway through programming B's payload
+  damageSlot(1, SLOT_HEADER_SIZE + sizeof(DeviceConfig) / 2, true);
+
+  bool persisted;
+  EXPECT_FLOAT_EQ(tempMaxAfterRemount(persisted), 31.0f);
+  EXPECT_TRUE(persisted);
+}
+
+TEST_F(ConfigStoreTest, BadCrcFallsBackToOtherCopy) {
+  store.begin(&log);
+  commitTempMax(31.0f);
+  commitTempMax(32.0f);
+
+  damageSlot(1, SLOT_HEADER_SIZE + 4, false);  // One bit of the payload
+
+  bool persisted;
+  EXPECT_FLOAT_EQ(tempMaxAfterRemount(persisted), 31.0f);
+}
+
+TEST_F(ConfigStoreTest, BothSlotsBadLoadsDefaults) {
+  store.begin(&log);
+  commitTempMax(31.0f);
+  commitTempMax(32.0f);
+  damageSlot(0, SLOT_HEADER_SIZE, false);
+  damageSlot(1, 0, false);  // Magic
+
+  bool persisted;
+  EXPECT_FLOAT_EQ(tempMaxAfterRemount(persisted), TEMP_MAX);
+  EXPECT_FALSE(persisted);
+}
+
+TEST_F(ConfigStoreTest, NextCommitGoesToTheDamagedSlot) {
+  store.begin(&log);
+  commitTempMax(31.0f);
+  commitTempMax(32.0f);
+  damageSlot(1, SLOT_HEADER_SIZE + 4, false);
+
+  ConfigStore remounted;
+  ASSERT_TRUE(remounted.begin(&log));
+  ASSERT_TRUE(remounted.set("tempMax", 34.0f));
+  ASSERT_TRUE(remounted.commit());  // Must not overwrite A, the only good copy
+
+  damageSlot(1, SLOT_HEADER_SIZE + 4, false);
+  bool persisted;
+  EXPECT_FLOAT_EQ(tempMaxAfterRemount(persisted), 31.0f);
+}
+
+// ============================================================================
+// COMMIT
+// ============================================================================
+
+TEST_F(ConfigStoreTest, ReadBackFailureKeepsTheActiveCopy) {
+  store.begin(&log);
+  commitTempMax(31.0f);
+  ASSERT_EQ(changeCalls, 1);
+
+  // Slot B's first magic byte can no longer be programmed as written
+  flashLogEmulateStuckBits(log.getReservedSize(), 0xFF);
+  ASSERT_TRUE(store.set("tempMax", 32.0f));
+  EXPECT_FALSE(store.commit());
+  EXPECT_TRUE(store.isDirty());
+  EXPECT_EQ(changeCalls, 1);  // Nothing new reached flash
+
+  bool persisted;
+  EXPECT_FLOAT_EQ(tempMaxAfterRemount(persisted), 31.0f);
+
+  // Once the cell works again the pending change goes out
+  flashLogEmulateStuckBits(0, 0);
+  EXPECT_TRUE(store.commit());
+  EXPECT_FALSE(store.isDirty());
+  EXPECT_EQ(changeCalls, 2);
+  EXPECT_FLOAT_EQ(tempMaxAfterRemount(persisted), 32.0f);
+}
+
+TEST_F(ConfigStoreTest, CleanCommitDoesNotNotify) {
+  store.begin(&log);
+  EXPECT_TRUE(store.commit());
+  ASSERT_TRUE(store.set("tempMax", store.get().tempMax));  // Same value
+  EXPECT_FALSE(store.isDirty());
+  EXPECT_TRUE(store.commit());
+  EXPECT_EQ(changeCalls, 0);
+}
+
+TEST_F(ConfigStoreTest, InvertedPairRevertsWithoutNotify) {
+  store.begin(&log);
+  commitTempMax(31.0f);
+
+  ASSERT_TRUE(store.set("tempMin", 35.0f));  // Above tempMax
+  EXPECT_FALSE(store.commit());
+  EXPECT_FALSE(store.isDirty());
+  EXPECT_FLOAT_EQ(store.get().tempMin, TEMP_MIN);
+  EXPECT_EQ(changeCalls, 1);
+}
+
+TEST_F(ConfigStoreTest, RangeMovesInEitherOrder) {
+  store.begin(&log);
+
+  // New range entirely above the old one: min moves past the old max first
+  ASSERT_TRUE(store.set("tempMin", 38.0f));
+  ASSERT_TRUE(store.set("tempMax", 45.0f));
+  EXPECT_TRUE(store.commit());
+  EXPECT_FLOAT_EQ(store.get().tempMin, 38.0f);
+}
+
+TEST_F(ConfigStoreTest, RejectsUnknownKeyAndOutOfRangeValue) {
+  store.begin(&log);
+  EXPECT_FALSE(store.set("noSuchKey", 1.0f));
+  EXPECT_FALSE(store.set("tempMax", 500.0f));
+  EXPECT_FALSE(store.set("sensorIntervalMs", 10.0f));
+  EXPECT_FALSE(store.isDirty());
+}
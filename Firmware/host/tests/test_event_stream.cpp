@@ -0,0 +1,236 @@
+/**
+ * GreenOS - Event Stream Parser Tests
+ *
+ * text/event-stream framing as the command channel sees it: Firebase
+ * events, proxy keep-alives, and socket reads that split lines anywhere.
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include "event_stream.h"
+
+struct StreamEvent {
+  std::string event;
+  std::string data;
+};
+
+static void collectEvent(const char* event, const char* data, size_t length, void* context) {
+  EXPECT_EQ(strlen(data), length);
+  static_cast<std::vector<StreamEvent>*>(context)->push_back({event, std::string(data, length)});
+}
+
+class EventStreamTest : public ::testing::Test {
+protected:
+  EventStreamParser parser;
+  std::vector<StreamEvent> events;
+
+  void SetUp() override {
+    parser.begin(collectEvent, &events);
+  }
+
+  uint8_t feed(const std::string& text) {
+    return parser.feed((const uint8_t*)text.data(), text.size());
+  }
+};
+
+// ============================================================================
+// EVENTS
+// ============================================================================
+
+TEST_F(EventStreamTest, FirebasePutEvent) {
+  EXPECT_EQ(feed("event: put\ndata: {\"path\":\"/\",\"data\":1}\n\n"), 1);
+
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].event, "put");
+  EXPECT_EQ(events[0].data, "{\"path\":\"/\",\"data\":1}");
+  EXPECT_EQ(parser.getEventCount(), 1u);
+}
+
+TEST_F(EventStreamTest, UnnamedEventIsMessage) {
+  feed("data: hello\n\n");
+
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].event, "message");
+  EXPECT_EQ(events[0].data, "hello");
+}
+
+TEST_F(EventStreamTest, MultiLineDataJoinedWithNewline) {
+  feed("event: put\ndata: first\ndata: second\ndata:third\n\n");
+
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].data, "first\nsecond\nthird");
+}
+
+TEST_F(EventStreamTest, OnlyOneLeadingSpaceIsSkipped) {
+  feed("data:  two spaces\n\n");
+
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].data, " two spaces");
+}
+
+TEST_F(EventStreamTest, IdAndUnknownFieldsAreIgnored) {
+  feed("id: 42\nretry: 1000\nfoo: bar\nevent: patch\ndata: x\n\n");
+
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].event, "patch");
+  EXPECT_EQ(events[0].data, "x");
+}
+
+TEST_F(EventStreamTest, EventNameDoesNotLeakIntoNextEvent) {
+  feed("event: put\ndata: a\n\ndata: b\n\n");
+
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[1].event, "message");
+  EXPECT_EQ(events[1].data, "b");
+}
+
+// ============================================================================
+// LINE ENDINGS
+// ============================================================================
+
+TEST_F(EventStreamTest, CrlfLineEndings) {
+  EXPECT_EQ(feed("event: put\r\ndata: a\r\ndata: b\r\n\r\n"), 1);
+
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].event, "put");
+  EXPECT_EQ(events[0].data, "a\nb");
+}
+
+TEST_F(EventStreamTest, BareCrLineEndings) {
+  feed("event: put\rdata: a\r\r");
+
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].event, "put");
+  EXPECT_EQ(events[0].data, "a");
+}
+
+TEST_F(EventStreamTest, CrlfSplitAcrossReads) {
+  feed("data: a\r");
+  feed("\n");           // Same line ending, not a blank line
+  EXPECT_TRUE(events.empty());
+
+  feed("\r");
+  feed("\n");
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].data, "a");
+}
+
+// ============================================================================
+// COMMENTS / KEEP-ALIVE
+// ============================================================================
+
+TEST_F(EventStreamTest, CommentLinesAreIgnored) {
+  EXPECT_EQ(feed(": keep-alive\n\n"), 0);
+  EXPECT_TRUE(events.empty());
+
+  feed("data: a\n: interleaved comment\ndata: b\n\n");
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].data, "a\nb");
+}
+
+TEST_F(EventStreamTest, FirebaseKeepAliveIsAnEvent) {
+  feed("event: keep-alive\ndata: null\n\n");
+
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].event, "keep-alive");
+  EXPECT_EQ(events[0].data, "null");
+}
+
+TEST_F(EventStreamTest, BlankLinesAloneDispatchNothing) {
+  EXPECT_EQ(feed("\n\n\r\n\r\r"), 0);
+  EXPECT_TRUE(events.empty());
+  EXPECT_EQ(parser.getDroppedCount(), 0u);
+}
+
+// ============================================================================
+// SPLIT READS
+// ============================================================================
+
+TEST_F(EventStreamTest, EveryByteInItsOwnRead) {
+  std::string stream = "event: put\r\ndata: {\"a\":1}\r\ndata: {\"b\":2}\r\n\r\n: ping\n\ndata: z\n\n";
+  uint32_t dispatched = 0;
+  for (char c : stream) {
+    dispatched += feed(std::string(1, c));
+  }
+
+  EXPECT_EQ(dispatched, 2u);
+  ASSERT_EQ(events.size(), 2u);
+  EXPECT_EQ(events[0].event, "put");
+  EXPECT_EQ(events[0].data, "{\"a\":1}\n{\"b\":2}");
+  EXPECT_EQ(events[1].data, "z");
+}
+
+TEST_F(EventStreamTest, SplitInsideFieldNameAndValue) {
+  feed("ev");
+  feed("ent: pu");
+  feed("t\nda");
+  feed("ta:");
+  feed(" payload\n");
+  feed("\n");
+
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].event, "put");
+  EXPECT_EQ(events[0].data, "payload");
+}
+
+TEST_F(EventStreamTest, SeveralEventsInOneRead) {
+  EXPECT_EQ(feed("data: 1\n\ndata: 2\n\ndata: 3\n\n"), 3);
+  ASSERT_EQ(events.size(), 3u);
+  EXPECT_EQ(events[2].data, "3");
+}
+
+// ============================================================================
+// OVERFLOW
+// ============================================================================
+
+TEST_F(EventStreamTest, OversizeDataIsDroppedAndParsingResyncs) {
+  std::string big(EVENT_STREAM_DATA_SIZE, 'x');
+  EXPECT_EQ(feed("event: put\ndata: " + big + "\n\ndata: after\n\n"), 1);
+
+  EXPECT_EQ(parser.getDroppedCount(), 1u);
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].event, "message");
+  EXPECT_EQ(events[0].data, "after");
+}
+
+TEST_F(EventStreamTest, DataThatJustFitsIsKept) {
+  std::string fits(EVENT_STREAM_DATA_SIZE - 1, 'x');
+  feed("data: " + fits + "\n\n");
+
+  EXPECT_EQ(parser.getDroppedCount(), 0u);
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].data, fits);
+}
+
+TEST_F(EventStreamTest, JoinedLinesCountTowardsTheLimit) {
+  std::string half(EVENT_STREAM_DATA_SIZE / 2, 'x');
+  feed("data: " + half + "\ndata: " + half + "\n\n");
+
+  EXPECT_EQ(parser.getDroppedCount(), 1u);
+  EXPECT_TRUE(events.empty());
+}
+
+TEST_F(EventStreamTest, LongFieldNameIsIgnored) {
+  feed("averyverylongfield: value\ndata: ok\n\n");
+
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].data, "ok");
+}
+
+TEST_F(EventStreamTest, LongEventNameIsTruncated) {
+  std::string name(2 * EVENT_STREAM_NAME_SIZE, 'n');
+  feed("event: " + name + "\ndata: x\n\n");
+
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].event, name.substr(0, EVENT_STREAM_NAME_SIZE - 1));
+}
+
+TEST_F(EventStreamTest, ResetDropsPartialEvent) {
+  feed("event: put\ndata: partial");
+  parser.reset();
+  feed("\n\ndata: fresh\n\n");
+
+  ASSERT_EQ(events.size(), 1u);
+  EXPECT_EQ(events[0].event, "message");
+  EXPECT_EQ(events[0].data, "fresh");
+}
@@ -0,0 +1,249 @@
+/**
+ * GreenOS - Modbus RTU Tests
+ *
+ * The master talks to the mock Serial1. Tests read the request it puts
+ * on the wire and inject the slave's reply, stepping the mock clock
+ * between poll() calls the way loop() would.
+ */
+
+#include <gtest/gtest.h>
+#include "config.h"
+#include "modbus_rtu.h"
+#include "mock_hal.h"
+
+struct ModbusCompletion {
+  int calls;
+  uint8_t slaveId;
+  uint8_t result;
+  std::vector<uint16_t> registers;
+};
+
+static void recordCompletion(uint8_t slaveId, uint8_t result, const uint16_t* registers,
+                             uint8_t count, void* context) {
+  ModbusCompletion* completion = static_cast<ModbusCompletion*>(context);
+  completion->calls++;
+  completion->slaveId = slaveId;
+  completion->result = result;
+  completion->registers.clear();
+  if (result == MODBUS_SUCCESS) {
+    completion->registers.assign(registers, registers + count);
+  }
+}
+
+class ModbusRTUTest : public ::testing::Test {
+protected:
+  ModbusRTU bus;
+  ModbusCompletion completion;
+
+  void SetUp() override {
+    mockReset();
+    bus.begin(Serial1, MODBUS_BAUD_RATE, MODBUS_DE_RE_PIN);
+    completion = ModbusCompletion();
+  }
+
+  // Polls until the request is on the wire and the bus is released
+  std::vector<uint8_t> runUntilSent() {
+    std::vector<uint8_t> sent;
+    for (int i = 0; i < 1000 && bus.getState() == MODBUS_TRANSMIT; i++) {
+      mockAdvanceMicros(100);
+      bus.poll();
+      std::vector<uint8_t> out = Serial1.takeOutput();
+      sent.insert(sent.end(), out.begin(), out.end());
+    }
+    return sent;
+  }
+
+  void runUntilComplete() {
+    for (int i = 0; i < 5000 && completion.calls == 0; i++) {
+      mockAdvanceMicros(100);
+      bus.poll();
+    }
+  }
+
+  void reply(std::vector<uint8_t> frame) {
+    uint16_t crc = ModbusRTU::calculateCRC16(frame.data(), frame.size());
+    frame.push_back(lowByte(crc));
+    frame.push_back(highByte(crc));
+    Serial1.inject(frame.data(), frame.size());
+  }
+
+  void requestTwoRegisters(uint8_t slaveId) {
+    ASSERT_TRUE(bus.requestHoldingRegisters(slaveId, 0x0010, 2, recordCompletion, &completion));
+    runUntilSent();
+    ASSERT_EQ(bus.getState(), MODBUS_AWAIT_FRAME);
+  }
+};
+
+// ============================================================================
+// REQUEST
+// ============================================================================
+
+TEST_F(ModbusRTUTest, RequestFrameOnTheWire) {
+  ASSERT_TRUE(bus.requestHoldingRegisters(7, 0x0102, 3, recordCompletion, &completion));
+  std::vector<uint8_t> sent = runUntilSent();
+
+  ASSERT_EQ(sent.size(), 8u);
+  EXPECT_EQ(sent[0], 7);
+  EXPECT_EQ(sent[1], MODBUS_FUNC_READ_HOLDING);
+  EXPECT_EQ(sent[2], 0x01);
+  EXPECT_EQ(sent[3], 0x02);
+  EXPECT_EQ(sent[4], 0x00);
+  EXPECT_EQ(sent[5], 3);
+  uint16_t crc = ModbusRTU::calculateCRC16(sent.data(), 6);
+  EXPECT_EQ(sent[6], lowByte(crc));
+  EXPECT_EQ(sent[7], highByte(crc));
+
+  EXPECT_EQ(mockGetDigitalOutput(MODBUS_DE_RE_PIN), LOW);  // Back to receive
+  EXPECT_EQ(bus.getState(), MODBUS_AWAIT_FRAME);
+}
+
+TEST_F(ModbusRTUTest, DriverEnabledOnlyWhileTransmitting) {
+  ASSERT_TRUE(bus.requestHoldingRegisters(1, 0, 1, recordCompletion, &completion));
+
+  bool sawTransmit = false;
+  for (int i = 0; i < 1000 && bus.getState() == MODBUS_TRANSMIT; i++) {
+    mockAdvanceMicros(100);
+    bus.poll();
+    if (!Serial1.takeOutput().empty()) {
+      sawTransmit = true;
+      EXPECT_EQ(mockGetDigitalOutput(MODBUS_DE_RE_PIN), HIGH);
+    }
+  }
+  EXPECT_TRUE(sawTransmit);
+  EXPECT_EQ(mockGetDigitalOutput(MODBUS_DE_RE_PIN), LOW);
+}
+
+TEST_F(ModbusRTUTest, WaitsForFrameGapBeforeSending) {
+  // Stray byte on an idle bus restarts the 3.5 character silence
+  uint8_t noise = 0x55;
+  Serial1.inject(&noise, 1);
+  bus.poll();
+
+  ASSERT_TRUE(bus.requestHoldingRegisters(1, 0, 1, recordCompletion, &completion));
+  mockAdvanceMicros(bus.getFrameGapMicros() / 2);
+  bus.poll();
+  EXPECT_TRUE(Serial1.takeOutput().empty());
+
+  mockAdvanceMicros(bus.getFrameGapMicros());
+  bus.poll();
+  EXPECT_EQ(Serial1.takeOutput().size(), 8u);
+}
+
+TEST_F(ModbusRTUTest, FrameGapFollowsBaudRate) {
+  EXPECT_EQ(bus.getFrameGapMicros(), (11UL * 1000000UL / 9600) * 7 / 2);
+
+  ModbusRTU fast;
+  fast.begin(Serial1, 38400, MODBUS_DE_RE_PIN);
+  EXPECT_EQ(fast.getFrameGapMicros(), 1750UL);  // Fixed above 19200 baud
+}
+
+TEST_F(ModbusRTUTest, RejectsInvalidOrOverlappingRequests) {
+  EXPECT_FALSE(bus.requestHoldingRegisters(1, 0, 0, recordCompletion, &completion));
+  EXPECT_FALSE(bus.requestHoldingRegisters(1, 0, MODBUS_MAX_REGISTERS + 1, recordCompletion, &completion));
+
+  EXPECT_TRUE(bus.requestHoldingRegisters(1, 0, 1, recordCompletion, &completion));
+  EXPECT_FALSE(bus.requestHoldingRegisters(2, 0, 1, recordCompletion, &completion));
+}
+
+// ============================================================================
+// RESPONSE
+// ============================================================================
+
+TEST_F(ModbusRTUTest, ValidResponseDecodesRegisters) {
+  requestTwoRegisters(4);
+  reply({4, MODBUS_FUNC_READ_HOLDING, 4, 0x12, 0x34, 0xAB, 0xCD});
+  runUntilComplete();
+
+  ASSERT_EQ(completion.calls, 1);
+  EXPECT_EQ(completion.slaveId, 4);
+  EXPECT_EQ(completion.result, MODBUS_SUCCESS);
+  EXPECT_EQ(completion.registers, std::vector<uint16_t>({0x1234, 0xABCD}));
+  EXPECT_TRUE(bus.isIdle());
+}
+
+TEST_F(ModbusRTUTest, ResponseFromAnotherSlaveIsRejected) {
+  requestTwoRegisters(4);
+  reply({5, MODBUS_FUNC_READ_HOLDING, 4, 0x12, 0x34, 0xAB, 0xCD});
+  runUntilComplete();
+
+  ASSERT_EQ(completion.calls, 1);
+  EXPECT_EQ(completion.result, MODBUS_INVALID_SLAVE_ID);
+  EXPECT_TRUE(completion.registers.empty());
+}
+
+TEST_F(ModbusRTUTest, CorruptResponseFailsCrc) {
+  requestTwoRegisters(4);
+  std::vector<uint8_t> frame = {4, MODBUS_FUNC_READ_HOLDING, 4, 0x12, 0x34, 0xAB, 0xCD};
+  uint16_t crc = ModbusRTU::calculateCRC16(frame.data(), frame.size());
+  frame.push_back(lowByte(crc) ^ 0x01);
+  frame.push_back(highByte(crc));
+  Serial1.inject(frame.data(), frame.size());
+  runUntilComplete();
+
+  ASSERT_EQ(completion.calls, 1);
+  EXPECT_EQ(completion.result, MODBUS_INVALID_CRC);
+}
+
+TEST_F(ModbusRTUTest, ShortByteCountIsRejected) {
+  requestTwoRegisters(4);
+  reply({4, MODBUS_FUNC_READ_HOLDING, 2, 0x12, 0x34});  // One register of two
+  runUntilComplete();
+
+  ASSERT_EQ(completion.calls, 1);
+  EXPECT_NE(completion.result, MODBUS_SUCCESS);
+}
+
+TEST_F(ModbusRTUTest, ExceptionResponseReportsSlaveCode) {
+  requestTwoRegisters(4);
+  reply({4, MODBUS_FUNC_READ_HOLDING | 0x80, 0x02});  // Illegal data address
+  runUntilComplete();
+
+  ASSERT_EQ(completion.calls, 1);
+  EXPECT_EQ(completion.result, 0x02);
+}
+
+TEST_F(ModbusRTUTest, SilentSlaveTimesOut) {
+  requestTwoRegisters(4);
+  unsigned long start = millis();
+  runUntilComplete();
+
+  ASSERT_EQ(completion.calls, 1);
+  EXPECT_EQ(completion.result, MODBUS_RESPONSE_TIMED_OUT);
+  EXPECT_GE(millis() - start, (unsigned long)MODBUS_RESPONSE_TIMEOUT_MS);
+  EXPECT_TRUE(bus.isIdle());
+}
+
+TEST_F(ModbusRTUTest, FrameCutOffByBusSilenceIsTruncated) {
+  requestTwoRegisters(4);
+  uint8_t partial[] = {4, MODBUS_FUNC_READ_HOLDING, 4};
+  Serial1.inject(partial, sizeof(partial));
+  runUntilComplete();
+
+  ASSERT_EQ(completion.calls, 1);
+  EXPECT_EQ(completion.result, MODBUS_RESPONSE_TIMED_OUT);
+  EXPECT_LT(bus.getLastTransactionMicros(), (unsigned long)MODBUS_RESPONSE_TIMEOUT_MS * 1000);
+}
+
+TEST_F(ModbusRTUTest, CallbackCanQueueTheNextRequest) {
+  struct Chain {
+    ModbusRTU* bus;
+    ModbusCompletion* completion;
+    bool queued;
+  };
+  Chain chain = {&bus, &completion, false};
+
+  ASSERT_TRUE(bus.requestHoldingRegisters(4, 0, 1,
+      [](uint8_t, uint8_t, const uint16_t*, uint8_t, void* context) {
+        Chain* chain = static_cast<Chain*>(context);
+        chain->queued = chain->bus->requestHoldingRegisters(5, 0, 1, recordCompletion, chain->completion);
+      }, &chain));
+  runUntilSent();
+  reply({4, MODBUS_FUNC_READ_HOLDING, 2, 0x00, 0x01});
+  for (int i = 0; i < 100 && !chain.queued; i++) {
+    mockAdvanceMicros(100);
+    bus.poll();
+  }
+
+  EXPECT_TRUE(chain.queued);
+  EXPECT_EQ(bus.getState(), MODBUS_TRANSMIT);
+}
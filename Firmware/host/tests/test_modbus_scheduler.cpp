@@ -0,0 +1,162 @@
+/**
+ * GreenOS - Modbus Scheduler Tests
+ *
+ * A fake bus of soil probes answers on the mock Serial1: each request the
+ * sweep puts on the wire is answered by the addressed probe, or left to
+ * time out when that probe is unplugged.
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include "config.h"
+#include "modbus_scheduler.h"
+#include "mock_hal.h"
+
+struct ProbeReply {
+  uint8_t index;
+  uint8_t result;
+};
+
+static bool recordReply(uint8_t index, uint8_t result, const uint16_t* registers,
+                        uint8_t count, void* context) {
+  static_cast<std::vector<ProbeReply>*>(context)->push_back({index, result});
+  return result == MODBUS_SUCCESS;
+}
+
+class ModbusSchedulerTest : public ::testing::Test {
+protected:
+  ModbusRTU bus;
+  ModbusScheduler scheduler;
+  std::vector<ProbeReply> replies;
+  std::vector<uint8_t> polledIds;  // Slave id of every request sent
+  bool online[256];
+  int answerAs[256];               // Id a probe puts in its reply (crosstalk)
+
+  void SetUp() override {
+    mockReset();
+    bus.begin(Serial1, MODBUS_BAUD_RATE, MODBUS_DE_RE_PIN);
+    scheduler.begin(&bus, MODBUS_REG_MOISTURE, 2, recordReply, &replies);
+    for (int id = 0; id < 256; id++) {
+      online[id] = true;
+      answerAs[id] = id;
+    }
+    for (uint8_t id = 1; id <= 3; id++) {
+      ASSERT_TRUE(scheduler.addSlave(id));
+    }
+  }
+
+  void answer(const std::vector<uint8_t>& request) {
+    ASSERT_EQ(request.size(), 8u);
+    uint8_t id = request[0];
+    polledIds.push_back(id);
+    if (!online[id]) return;
+
+    std::vector<uint8_t> frame = {(uint8_t)answerAs[id], MODBUS_FUNC_READ_HOLDING, 4, 0, id, 0, 1};
+    uint16_t crc = ModbusRTU::calculateCRC16(frame.data(), frame.size());
+    frame.push_back(lowByte(crc));
+    frame.push_back(highByte(crc));
+    Serial1.inject(frame.data(), frame.size());
+  }
+
+  void runSweep() {
+    replies.clear();
+    polledIds.clear();
+    ASSERT_TRUE(scheduler.startSweep());
+    for (int i = 0; i < 100000 && scheduler.isSweeping(); i++) {
+      mockAdvanceMicros(100);
+      bus.poll();
+      std::vector<uint8_t> out = Serial1.takeOutput();
+      if (!out.empty()) answer(out);
+    }
+    ASSERT_FALSE(scheduler.isSweeping());
+  }
+};
+
+TEST_F(ModbusSchedulerTest, SweepPollsEveryProbeInOrder) {
+  runSweep();
+
+  EXPECT_EQ(polledIds, std::vector<uint8_t>({1, 2, 3}));
+  ASSERT_EQ(replies.size(), 3u);
+  for (uint8_t i = 0; i < 3; i++) {
+    EXPECT_EQ(replies[i].index, i);
+    EXPECT_EQ(replies[i].result, MODBUS_SUCCESS);
+    EXPECT_TRUE(scheduler.getSlaveHealth(i).isValid);
+  }
+
+  ModbusSweepStats stats = scheduler.getStats();
+  EXPECT_EQ(stats.sweepCount, 1u);
+  EXPECT_EQ(stats.polled, 3);
+  EXPECT_EQ(stats.skipped, 0);
+  EXPECT_GT(stats.lastSweepMicros, 0u);
+}
+
+TEST_F(ModbusSchedulerTest, StartSweepRefusedWhileRunning) {
+  ASSERT_TRUE(scheduler.startSweep());
+  EXPECT_FALSE(scheduler.startSweep());
+}
+
+TEST_F(ModbusSchedulerTest, CrosstalkCountsAgainstThePolledProbe) {
+  answerAs[2] = 3;  // Probe 2 answers with probe 3's address
+  runSweep();
+
+  ASSERT_EQ(replies.size(), 3u);
+  EXPECT_EQ(replies[1].index, 1);
+  EXPECT_EQ(replies[1].result, MODBUS_INVALID_SLAVE_ID);
+  EXPECT_EQ(scheduler.getSlaveHealth(1).consecutiveErrors, 1);
+  EXPECT_EQ(scheduler.getSlaveHealth(2).consecutiveErrors, 0);
+}
+
+TEST_F(ModbusSchedulerTest, FailingProbeBacksOffExponentially) {
+  online[2] = false;
+  for (int i = 0; i <= MAX_SENSOR_ERRORS; i++) {
+    runSweep();
+  }
+  EXPECT_FALSE(scheduler.getSlaveHealth(1).isValid);
+  EXPECT_TRUE(scheduler.isBackedOff(1));
+
+  // Skipped for 1 sweep, then 2, then 4
+  for (int backoff : {1, 2, 4}) {
+    for (int i = 0; i < backoff; i++) {
+      runSweep();
+      EXPECT_EQ(polledIds, std::vector<uint8_t>({1, 3}));
+      EXPECT_EQ(scheduler.getStats().skipped, 1);
+    }
+    runSweep();
+    EXPECT_EQ(polledIds, std::vector<uint8_t>({1, 2, 3}));
+  }
+}
+
+TEST_F(ModbusSchedulerTest, BackoffIsCapped) {
+  online[2] = false;
+  for (int i = 0; i < 400; i++) {
+    runSweep();
+  }
+
+  // Polled at least once in every MODBUS_MAX_BACKOFF_SWEEPS + 1 sweeps
+  int sincePolled = 0;
+  for (int i = 0; i < 2 * (MODBUS_MAX_BACKOFF_SWEEPS + 1); i++) {
+    runSweep();
+    bool polled = std::find(polledIds.begin(), polledIds.end(), 2) != polledIds.end();
+    sincePolled = polled ? 0 : sincePolled + 1;
+    ASSERT_LE(sincePolled, MODBUS_MAX_BACKOFF_SWEEPS);
+  }
+}
+
+TEST_F(ModbusSchedulerTest, OneGoodReplyClearsBackoff) {
+  online[2] = false;
+  for (int i = 0; i <= MAX_SENSOR_ERRORS; i++) {
+    runSweep();
+  }
+  ASSERT_TRUE(scheduler.isBackedOff(1));
+
+  online[2] = true;
+  while (scheduler.isBackedOff(1)) {
+    runSweep();
+  }
+  runSweep();  // Probe 2 polled and answers
+
+  EXPECT_TRUE(scheduler.getSlaveHealth(1).isValid);
+  EXPECT_EQ(scheduler.getSlaveHealth(1).consecutiveErrors, 0);
+  runSweep();
+  EXPECT_EQ(polledIds, std::vector<uint8_t>({1, 2, 3}));
+}
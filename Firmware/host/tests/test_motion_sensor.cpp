@@ -0,0 +1,145 @@
+/**
+ * GreenOS - Motion Sensor Tests
+ *
+ * PIR edges are driven through the mock pin and its attached interrupt
+ * handler; windows are read on the mock clock.
+ */
+
+#include <gtest/gtest.h>
+#include "motion_sensor.h"
+#include "mock_hal.h"
+
+#define PIR_TEST_PIN 7
+
+static int triggerCalls = 0;
+
+static void countTrigger() {
+  triggerCalls++;
+}
+
+class MotionSensorTest : public ::testing::Test {
+protected:
+  MotionSensor motion;
+  MotionWindow window;
+
+  void SetUp() override {
+    mockReset();
+    mockSetMillis(1000);
+    triggerCalls = 0;
+    motion.begin(PIR_TEST_PIN);
+  }
+
+  // PIR output changes level; the CHANGE interrupt fires
+  void edge(int level) {
+    mockSetDigitalInput(PIR_TEST_PIN, level);
+    mockFireInterrupt(PIR_TEST_PIN);
+  }
+
+  void pulse(unsigned long lengthMs) {
+    edge(HIGH);
+    mockAdvanceMillis(lengthMs);
+    edge(LOW);
+  }
+};
+
+// ============================================================================
+// WINDOWS
+// ============================================================================
+
+TEST_F(MotionSensorTest, PulseCountsAndSetsDuty) {
+  mockAdvanceMillis(1000);
+  pulse(500);
+  mockAdvanceMillis(8500);
+  motion.takeWindow(window);
+
+  EXPECT_EQ(window.events, 1);
+  EXPECT_FLOAT_EQ(window.dutyPercent, 5.0f);
+  EXPECT_EQ(window.lastMotion, 2000u);
+  EXPECT_FALSE(window.active);
+}
+
+TEST_F(MotionSensorTest, PulseBetweenReadsIsNotMissed) {
+  // Both edges before anything looks at the sensor
+  mockAdvanceMillis(100);
+  pulse(20);
+  pulse(20);
+  mockAdvanceMillis(100);
+  motion.takeWindow(window);
+
+  EXPECT_EQ(window.events, 2);
+  EXPECT_EQ(motion.getTotalEvents(), 2u);
+  EXPECT_FALSE(window.active);
+}
+
+TEST_F(MotionSensorTest, SustainedPresenceSplitsAcrossWindows) {
+  mockAdvanceMillis(5000);
+  edge(HIGH);
+  mockAdvanceMillis(5000);
+  motion.takeWindow(window);
+  EXPECT_FLOAT_EQ(window.dutyPercent, 50.0f);
+  EXPECT_TRUE(window.active);
+
+  // Still high: only the part inside this window counts, no new event
+  mockAdvanceMillis(2000);
+  edge(LOW);
+  mockAdvanceMillis(8000);
+  motion.takeWindow(window);
+  EXPECT_EQ(window.events, 0);
+  EXPECT_FLOAT_EQ(window.dutyPercent, 20.0f);
+  EXPECT_EQ(window.lastMotion, 6000u);
+  EXPECT_FALSE(window.active);
+}
+
+TEST_F(MotionSensorTest, RepeatedLevelIsIgnored) {
+  edge(HIGH);
+  edge(HIGH);                          // Bounce
+  motion.takeWindow(window);
+  EXPECT_EQ(window.events, 1);
+}
+
+TEST_F(MotionSensorTest, EmptyWindowReportsNoMotion) {
+  mockAdvanceMillis(10000);
+  motion.takeWindow(window);
+
+  EXPECT_EQ(window.events, 0);
+  EXPECT_FLOAT_EQ(window.dutyPercent, 0.0f);
+  EXPECT_EQ(window.lastMotion, 0u);
+}
+
+// ============================================================================
+// CALLBACK
+// ============================================================================
+
+TEST_F(MotionSensorTest, CallbackRunsFromServiceNotTheInterrupt) {
+  motion.setCallback(countTrigger);
+  edge(HIGH);
+  EXPECT_EQ(triggerCalls, 0);
+
+  motion.service();
+  EXPECT_EQ(triggerCalls, 1);
+  motion.service();                    // Nothing new
+  EXPECT_EQ(triggerCalls, 1);
+
+  edge(LOW);
+  motion.service();                    // Falling edge is no trigger
+  EXPECT_EQ(triggerCalls, 1);
+}
+
+// ============================================================================
+// OVERFLOW
+// ============================================================================
+
+TEST_F(MotionSensorTest, FullRingDropsEdgesAndResyncs) {
+  // One edge more than the ring holds; the lost one is the last rising
+  for (int i = 0; i <= MOTION_EVENT_CAPACITY; i++) {
+    mockAdvanceMillis(10);
+    edge((i % 2 == 0) ? HIGH : LOW);
+  }
+  EXPECT_EQ(motion.getDroppedEvents(), 1u);
+
+  // The pin is high: the window picks the missing rise up from the level
+  mockAdvanceMillis(10);
+  motion.takeWindow(window);
+  EXPECT_TRUE(window.active);
+  EXPECT_EQ(window.events, MOTION_EVENT_CAPACITY / 2 + 1);
+}
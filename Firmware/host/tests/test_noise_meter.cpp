@@ -0,0 +1,54 @@
+/**
+ * GreenOS - Noise Meter Tests
+ *
+ * A block is captured a chunk per service() call, so no call holds the
+ * loop for the whole block.
+ */
+
+#include <gtest/gtest.h>
+#include "noise_meter.h"
+#include "mock_hal.h"
+
+#define MIC_TEST_PIN 5
+
+class NoiseMeterTest : public ::testing::Test {
+protected:
+  NoiseMeter meter;
+
+  void SetUp() override {
+    mockReset();
+    mockSetAnalog(MIC_TEST_PIN, 8192);
+    meter.begin(MIC_TEST_PIN);
+    mockAdvanceMillis(MIC_DSP_INTERVAL_MS);
+  }
+};
+
+TEST_F(NoiseMeterTest, ServiceCapturesOneChunkPerCall) {
+  uint32_t reads = mockGetAnalogReads();
+  unsigned long start = micros();
+  meter.service();
+  unsigned long elapsed = micros() - start;
+
+  EXPECT_LE(mockGetAnalogReads() - reads, (uint32_t)MIC_DSP_CHUNK_SAMPLES + 1);  // + DC seed
+  EXPECT_LE(elapsed, 1100ul);
+  EXPECT_EQ(meter.getBlockCount(), 0u);
+  EXPECT_EQ(meter.msUntilNextBlock(), 0ul);   // Rest of the block is due
+}
+
+TEST_F(NoiseMeterTest, ChunksCompleteOneBlockPerInterval) {
+  for (int i = 0; i < MIC_DSP_BLOCK_SAMPLES / MIC_DSP_CHUNK_SAMPLES; i++) {
+    meter.service();
+  }
+  EXPECT_EQ(meter.getBlockCount(), 1u);
+  EXPECT_GT(meter.msUntilNextBlock(), 0ul);
+
+  // Nothing more until the next interval
+  uint32_t reads = mockGetAnalogReads();
+  meter.service();
+  EXPECT_EQ(mockGetAnalogReads(), reads);
+
+  NoiseWindow window;
+  ASSERT_TRUE(meter.takeWindow(window));
+  EXPECT_EQ(window.blocks, 1);
+  EXPECT_EQ(window.dbfs, MIC_DSP_SILENCE_DBFS);   // Steady input at the bias point
+}
@@ -0,0 +1,109 @@
+/**
+ * GreenOS - Profiler Tests
+ *
+ * Section stats and the PROF line. The host has no DWT cycle counter, so
+ * spans come from the mock micros(), which moves 1 us per call on top of
+ * whatever a test advances.
+ */
+
+#include <gtest/gtest.h>
+#include <string>
+#include "profiler.h"
+#include "mock_hal.h"
+
+class ProfilerTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    mockReset();
+    mockSetMillis(5000);
+    profiler.reset();
+  }
+
+  std::string printLine(unsigned long watchdogTimeoutMs) {
+    Serial.takeOutput();
+    profiler.printLine(watchdogTimeoutMs);
+    std::vector<uint8_t> output = Serial.takeOutput();
+    return std::string(output.begin(), output.end());
+  }
+};
+
+// ============================================================================
+// RECORDING
+// ============================================================================
+
+TEST_F(ProfilerTest, SectionKeepsCountMinAvgMaxP99) {
+  profiler.record(PROFILE_SCD30, 100);
+  profiler.record(PROFILE_SCD30, 200);
+  profiler.record(PROFILE_SCD30, 300);
+
+  EXPECT_EQ(profiler.getMaxMicros(PROFILE_SCD30), 300u);
+  EXPECT_NE(printLine(8000).find(" scd30=3,100,200,300,300"), std::string::npos);
+}
+
+TEST_F(ProfilerTest, ScopeTimesItsBlock) {
+  {
+    ProfileScope scope(PROFILE_ANOMALY);
+    mockAdvanceMicros(250);
+  }
+
+  EXPECT_GE(profiler.getMaxMicros(PROFILE_ANOMALY), 250u);
+  EXPECT_LE(profiler.getMaxMicros(PROFILE_ANOMALY), 260u);
+  EXPECT_EQ(profiler.getMaxMicros(PROFILE_LOOP), 0u);
+}
+
+TEST_F(ProfilerTest, StartStopPairAcrossMicrosWrap) {
+  mockSetMillis(0xFFFFFFFFUL / 1000);   // Just before micros() wraps
+  uint32_t start = profiler.start();
+  mockAdvanceMicros(1000000);
+  profiler.stop(PROFILE_SYNC, start);
+
+  EXPECT_GE(profiler.getMaxMicros(PROFILE_SYNC), 1000000u);
+  EXPECT_LE(profiler.getMaxMicros(PROFILE_SYNC), 1000010u);
+}
+
+TEST_F(ProfilerTest, UnknownSectionIsIgnored) {
+  profiler.record(PROFILE_SECTION_COUNT, 100);
+  EXPECT_EQ(profiler.getMaxMicros(PROFILE_SECTION_COUNT), 0u);
+}
+
+TEST_F(ProfilerTest, WatchdogGapKeepsTheLongest) {
+  profiler.recordWatchdogGap(400);
+  profiler.recordWatchdogGap(1500);
+  profiler.recordWatchdogGap(900);
+  EXPECT_EQ(profiler.getMaxWatchdogGap(), 1500u);
+}
+
+// ============================================================================
+// PROF LINE
+// ============================================================================
+
+TEST_F(ProfilerTest, LineHasUptimeTickSourceAndWatchdog) {
+  profiler.recordWatchdogGap(1500);
+  std::string line = printLine(8000);
+
+  EXPECT_EQ(line.rfind("PROF up=5000 ticks=us wdt=1500/8000", 0), 0u);
+  EXPECT_EQ(line.back(), '\n');
+  EXPECT_FALSE(profiler.usesCycleCounter());
+}
+
+TEST_F(ProfilerTest, SectionsThatNeverRanAreOmitted) {
+  profiler.record(PROFILE_MODBUS, 4000);
+  std::string line = printLine(8000);
+
+  EXPECT_NE(line.find(" modbus=1,4000,4000,4000,4000"), std::string::npos);
+  EXPECT_EQ(line.find("loop="), std::string::npos);
+  EXPECT_EQ(line.find("scd30="), std::string::npos);
+}
+
+TEST_F(ProfilerTest, ResetClearsEverything) {
+  profiler.record(PROFILE_LOOP, 50);
+  profiler.recordWatchdogGap(700);
+  profiler.reset();
+
+  EXPECT_EQ(profiler.getMaxMicros(PROFILE_LOOP), 0u);
+  EXPECT_EQ(printLine(8000).find("loop="), std::string::npos);
+
+  // Min starts over too
+  profiler.record(PROFILE_LOOP, 80);
+  EXPECT_NE(printLine(8000).find(" loop=1,80,80,80,80"), std::string::npos);
+}
@@ -0,0 +1,97 @@
+/**
+ * GreenOS - RecordCodec / PackedReading Tests
+ */
+
+#include <gtest/gtest.h>
+#include "record_codec.h"
+
+static SensorData reading(unsigned long timestamp, float temp, float humidity, float co2) {
+  SensorData data;
+  memset(&data, 0, sizeof(data));
+  data.timestamp = timestamp;
+  data.airTemp = temp;
+  data.airHumidity = humidity;
+  data.co2 = co2;
+  data.ph = 6.42f;
+  data.ec = 1.234f;
+  data.vwc = 31.5f;
+  return data;
+}
+
+TEST(RecordCodec, RoundTripsAtSensorResolution) {
+  RecordCodec codec;
+  PackedReading packed = codec.pack(reading(1000, -3.27f, 55.55f, 612.0f));
+
+  SensorReading out;
+  RecordCodec::unpack(packed, 1000, out);
+  EXPECT_NEAR(out.airTemp, -3.27f, 0.005f);
+  EXPECT_NEAR(out.airHumidity, 55.55f, 0.005f);
+  EXPECT_FLOAT_EQ(out.co2, 612.0f);
+  EXPECT_NEAR(out.ph, 6.42f, 0.005f);
+  EXPECT_NEAR(out.ec, 1.234f, 0.0005f);
+  EXPECT_NEAR(out.vwc, 31.5f, 0.005f);
+}
+
+TEST(RecordCodec, NanBecomesSentinelAndBack) {
+  RecordCodec codec;
+  PackedReading packed = codec.pack(reading(0, NAN, NAN, NAN));
+  EXPECT_EQ(packed.airTemp, RECORD_INVALID_SIGNED);
+  EXPECT_EQ(packed.airHumidity, RECORD_INVALID_UNSIGNED);
+
+  SensorReading out;
+  RecordCodec::unpack(packed, 0, out);
+  EXPECT_TRUE(isnan(out.airTemp));
+  EXPECT_TRUE(isnan(out.co2));
+}
+
+TEST(RecordCodec, SaturatesInsteadOfWrapping) {
+  EXPECT_EQ(RecordCodec::toFixedSigned(500.0f, RECORD_SCALE_TEMP), 32767);
+  EXPECT_EQ(RecordCodec::toFixedSigned(-500.0f, RECORD_SCALE_TEMP), -32767);
+  EXPECT_EQ(RecordCodec::toFixedUnsigned(-1.0f, RECORD_SCALE_HUMIDITY), 0);
+  EXPECT_EQ(RecordCodec::toFixedUnsigned(1e6f, RECORD_SCALE_CO2), 65534);
+}
+
+TEST(RecordCodec, ShortDeltasAreExactMilliseconds) {
+  RecordCodec codec;
+  codec.pack(reading(10000, 20, 50, 600));
+  PackedReading packed = codec.pack(reading(12345, 20, 50, 600));
+  EXPECT_EQ(packed.timeDelta, 2345);
+  EXPECT_EQ(RecordCodec::deltaMillis(packed), 2345u);
+  EXPECT_EQ(codec.getLastTimestamp(), 12345u);
+}
+
+TEST(RecordCodec, LongGapRoundingDoesNotAccumulate) {
+  RecordCodec codec;
+  unsigned long t = 0;
+  codec.pack(reading(t, 20, 50, 600));
+
+  // 40.7 s gaps are stored as whole seconds; the chain tracks decoded time
+  unsigned long decoded = 0;
+  for (int i = 0; i < 100; i++) {
+    t += 40700;
+    PackedReading packed = codec.pack(reading(t, 20, 50, 600));
+    EXPECT_TRUE(packed.timeDelta & RECORD_DELTA_SECONDS_FLAG);
+    decoded += RecordCodec::deltaMillis(packed);
+  }
+  EXPECT_EQ(decoded, codec.getLastTimestamp());
+  EXPECT_LE(labs((long)(t - decoded)), 500L);
+}
+
+TEST(RecordCodec, BlockFramingRejectsBadInput) {
+  PackedReading records[3];
+  memset(records, 0, sizeof(records));
+  uint8_t block[64];
+
+  EXPECT_EQ(RecordCodec::writeBlock(records, 3, 777, block, 10), 0u);   // Too small
+  size_t written = RecordCodec::writeBlock(records, 3, 777, block, sizeof(block));
+  ASSERT_EQ(written, RecordCodec::blockSize(3));
+
+  PackedBlockHeader header;
+  EXPECT_EQ(RecordCodec::readBlockHeader(block, written, header), sizeof(PackedBlockHeader));
+  EXPECT_EQ(header.count, 3);
+  EXPECT_EQ(header.baseTimestamp, 777u);
+
+  EXPECT_EQ(RecordCodec::readBlockHeader(block, written - 1, header), 0u);  // Truncated
+  block[0] ^= 0xFF;
+  EXPECT_EQ(RecordCodec::readBlockHeader(block, written, header), 0u);      // Bad magic
+}
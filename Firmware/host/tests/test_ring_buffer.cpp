@@ -0,0 +1,68 @@
+/**
+ * GreenOS - RingBuffer Tests
+ */
+
+#include <gtest/gtest.h>
+#include "ring_buffer.h"
+
+TEST(RingBuffer, PushUntilFullThenOverwritesOldest) {
+  RingBuffer<int, 4> ring;
+  EXPECT_TRUE(ring.isEmpty());
+
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(ring.push(i));
+  }
+  EXPECT_TRUE(ring.isFull());
+  EXPECT_EQ(ring.getOverwritten(), 0u);
+
+  EXPECT_FALSE(ring.push(4));          // Drops 0
+  EXPECT_EQ(ring.size(), 4u);
+  EXPECT_EQ(ring.getOverwritten(), 1u);
+  EXPECT_EQ(ring.at(0), 1);
+  EXPECT_EQ(ring.at(3), 4);
+}
+
+TEST(RingBuffer, DrainTakesAtMostTwoSpans) {
+  RingBuffer<int, 8> ring;
+  for (int i = 0; i < 6; i++) ring.push(i);
+  ring.consume(5);
+  for (int i = 6; i < 12; i++) ring.push(i);  // Wraps: 5..11 stored
+
+  RingSpan<int> first = ring.peekContiguous();
+  ASSERT_EQ(first.length, 3u);         // Slots 5, 6, 7
+  EXPECT_EQ(first.data[0], 5);
+  ring.consume(first.length);
+
+  RingSpan<int> second = ring.peekContiguous();
+  ASSERT_EQ(second.length, 4u);
+  EXPECT_EQ(second.data[0], 8);
+  EXPECT_EQ(second.data[3], 11);
+  ring.consume(second.length);
+
+  EXPECT_TRUE(ring.isEmpty());
+  EXPECT_EQ(ring.peekContiguous().length, 0u);
+}
+
+TEST(RingBuffer, PeekRespectsMaxCountAndConsumeClamps) {
+  RingBuffer<int, 8> ring;
+  for (int i = 0; i < 5; i++) ring.push(i);
+
+  RingSpan<int> span = ring.peekContiguous(2);
+  EXPECT_EQ(span.length, 2u);
+  EXPECT_EQ(ring.size(), 5u);          // Peeking does not consume
+
+  ring.consume(100);
+  EXPECT_TRUE(ring.isEmpty());
+  EXPECT_TRUE(ring.push(42));
+  EXPECT_EQ(ring.at(0), 42);
+}
+
+TEST(RingBuffer, ClearKeepsOverwriteCount) {
+  RingBuffer<int, 2> ring;
+  ring.push(1);
+  ring.push(2);
+  ring.push(3);
+  ring.clear();
+  EXPECT_TRUE(ring.isEmpty());
+  EXPECT_EQ(ring.getOverwritten(), 1u);
+}
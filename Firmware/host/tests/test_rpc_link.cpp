@@ -0,0 +1,220 @@
+/**
+ * GreenOS - RPC Link Tests
+ *
+ * Frames go out of one RpcLink on the mock Serial1 and are injected into
+ * a second one on Serial2, so both the encoder and the receiver run on
+ * the real code.
+ */
+
+#include <gtest/gtest.h>
+#include "rpc_link.h"
+#include "sensor_manager.h"
+#include "mock_hal.h"
+
+struct ReceivedFrame {
+  uint8_t type;
+  uint8_t seq;
+  std::vector<uint8_t> payload;
+};
+
+static void collectFrame(uint8_t type, uint8_t seq, const uint8_t* payload, size_t length,
+                         void* context) {
+  ReceivedFrame frame = {type, seq, std::vector<uint8_t>(payload, payload + length)};
+  static_cast<std::vector<ReceivedFrame>*>(context)->push_back(frame);
+}
+
+class RpcLinkTest : public ::testing::Test {
+protected:
+  RpcLink sender;
+  RpcLink receiver;
+  std::vector<ReceivedFrame> received;
+
+  void SetUp() override {
+    mockReset();
+    sender.begin(Serial1, nullptr, nullptr);
+    receiver.begin(Serial2, collectFrame, &received);
+    sender.poll();
+    Serial1.takeOutput();  // begin()'s resync delimiter
+  }
+
+  // Encoded bytes of one frame, delimiter included
+  std::vector<uint8_t> encodeFrame(uint8_t type, const std::vector<uint8_t>& payload) {
+    EXPECT_NE(sender.send(type, payload.data(), payload.size()), 0);
+    sender.poll();
+    return Serial1.takeOutput();
+  }
+
+  void deliver(const std::vector<uint8_t>& bytes) {
+    Serial2.inject(bytes.data(), bytes.size());
+    while (Serial2.available() > 0) {
+      receiver.poll();
+    }
+  }
+};
+
+// ============================================================================
+// ROUND TRIP
+// ============================================================================
+
+TEST_F(RpcLinkTest, RoundTripKeepsZeroRuns) {
+  std::vector<uint8_t> payload = {0, 0, 0, 7, 0, 9, 9, 0, 0};
+  deliver(encodeFrame(RPC_RESULT, payload));
+
+  ASSERT_EQ(received.size(), 1u);
+  EXPECT_EQ(received[0].type, RPC_RESULT);
+  EXPECT_EQ(received[0].seq, 1);
+  EXPECT_EQ(received[0].payload, payload);
+  EXPECT_EQ(receiver.getStats().framesReceived, 1u);
+  EXPECT_TRUE(receiver.isAlive());
+}
+
+TEST_F(RpcLinkTest, EmptyPayloadRoundTrips) {
+  deliver(encodeFrame(RPC_POLL, std::vector<uint8_t>()));
+
+  ASSERT_EQ(received.size(), 1u);
+  EXPECT_EQ(received[0].type, RPC_POLL);
+  EXPECT_TRUE(received[0].payload.empty());
+}
+
+TEST_F(RpcLinkTest, EncodedFrameHasNoZeroBeforeDelimiter) {
+  std::vector<uint8_t> payload(300, 0);
+  std::vector<uint8_t> bytes = encodeFrame(RPC_STATUS, payload);
+
+  ASSERT_FALSE(bytes.empty());
+  EXPECT_EQ(bytes.back(), 0x00);
+  for (size_t i = 0; i + 1 < bytes.size(); i++) {
+    ASSERT_NE(bytes[i], 0x00) << "at " << i;
+  }
+}
+
+TEST_F(RpcLinkTest, SequenceSkipsZeroOnWrap) {
+  uint8_t last = 0;
+  for (int i = 0; i < 256; i++) {
+    last = sender.send(RPC_POLL, nullptr, 0);
+    ASSERT_NE(last, 0);
+    sender.poll();
+  }
+  EXPECT_EQ(last, 1);  // 1..255, then 1 again
+}
+
+// ============================================================================
+// COBS BLOCKS
+// ============================================================================
+
+// Decoded frame: type, seq, payload, crc32
+TEST_F(RpcLinkTest, FullBlocksDecodeAcrossBoundaries) {
+  for (size_t length : {252u, 253u, 254u, 255u, 507u, 508u, 509u, 1000u}) {
+    std::vector<uint8_t> payload(length);
+    for (size_t i = 0; i < length; i++) payload[i] = (uint8_t)(1 + i % 255);
+
+    std::vector<uint8_t> bytes = encodeFrame(RPC_CONFIG, payload);
+    size_t decoded = RpcLink::decode(bytes.data(), bytes.size() - 1);
+
+    ASSERT_EQ(decoded, length + RPC_FRAME_OVERHEAD) << "length " << length;
+    EXPECT_EQ(bytes[0], RPC_CONFIG);
+    EXPECT_EQ(memcmp(bytes.data() + 2, payload.data(), length), 0) << "length " << length;
+  }
+}
+
+TEST_F(RpcLinkTest, EncodedSizeMatchesEncoderWithoutZeros) {
+  uint8_t seq = 1;  // The sender's next seq
+  for (size_t length = 0; length <= 1100; length += 7) {
+    // Frame bytes (type, seq, payload, crc) all non-zero: COBS has no
+    // zero to save on, so encodedSize() is exact
+    uint8_t filler;
+    for (filler = 1; filler != 0; filler++) {
+      std::vector<uint8_t> frame(length + 2, filler);
+      frame[0] = RPC_CONFIG;
+      frame[1] = seq;
+      uint32_t crc = SensorManager::calculateCRC32(frame.data(), frame.size());
+      if ((crc & 0xFF) && (crc & 0xFF00) && (crc & 0xFF0000) && (crc & 0xFF000000)) break;
+    }
+    ASSERT_NE(filler, 0);
+
+    std::vector<uint8_t> bytes = encodeFrame(RPC_CONFIG, std::vector<uint8_t>(length, filler));
+    EXPECT_EQ(bytes.size(), RpcLink::encodedSize(length + RPC_FRAME_OVERHEAD)) << "length " << length;
+    seq = (seq == 255) ? 1 : seq + 1;
+  }
+}
+
+TEST_F(RpcLinkTest, EncodedSizeBoundsEncoderWithZeros) {
+  for (size_t length = 0; length <= 1100; length += 13) {
+    std::vector<uint8_t> payload(length);
+    for (size_t i = 0; i < length; i++) payload[i] = (i % 3 == 0) ? 0 : (uint8_t)i;
+
+    std::vector<uint8_t> bytes = encodeFrame(RPC_CONFIG, payload);
+    EXPECT_LE(bytes.size(), RpcLink::encodedSize(length + RPC_FRAME_OVERHEAD)) << "length " << length;
+  }
+}
+
+// ============================================================================
+// DAMAGED FRAMES
+// ============================================================================
+
+TEST_F(RpcLinkTest, DecodeRejectsCodePastEnd) {
+  uint8_t frame[] = {0x05, 0x11, 0x22};
+  EXPECT_EQ(RpcLink::decode(frame, sizeof(frame)), 0u);
+}
+
+TEST_F(RpcLinkTest, DecodeRejectsZeroCode) {
+  uint8_t frame[] = {0x02, 0x11, 0x00, 0x22};
+  EXPECT_EQ(RpcLink::decode(frame, sizeof(frame)), 0u);
+}
+
+TEST_F(RpcLinkTest, CorruptCodeByteIsDropped) {
+  std::vector<uint8_t> bytes = encodeFrame(RPC_RESULT, std::vector<uint8_t>(20, 0x42));
+  bytes[0] = 0xFE;  // Block runs past the frame
+
+  deliver(bytes);
+  EXPECT_TRUE(received.empty());
+  EXPECT_EQ(receiver.getStats().crcErrors, 1u);
+  EXPECT_FALSE(receiver.isAlive());
+}
+
+TEST_F(RpcLinkTest, TruncatedFrameIsDropped) {
+  std::vector<uint8_t> bytes = encodeFrame(RPC_RESULT, std::vector<uint8_t>(20, 0x42));
+  std::vector<uint8_t> truncated(bytes.begin(), bytes.begin() + bytes.size() / 2);
+  truncated.push_back(0x00);
+
+  deliver(truncated);
+  EXPECT_TRUE(received.empty());
+  EXPECT_EQ(receiver.getStats().crcErrors, 1u);
+}
+
+TEST_F(RpcLinkTest, RuntFrameIsDropped) {
+  deliver({0x03, 0x82, 0x01, 0x00});  // Decodes to 2 bytes - shorter than type, seq, crc
+  EXPECT_TRUE(received.empty());
+  EXPECT_EQ(receiver.getStats().crcErrors, 1u);
+}
+
+TEST_F(RpcLinkTest, CrcMismatchIsDropped) {
+  std::vector<uint8_t> bytes = encodeFrame(RPC_RESULT, std::vector<uint8_t>(20, 0x42));
+  bytes[5] ^= 0x01;  // Payload byte, still non-zero
+
+  deliver(bytes);
+  EXPECT_TRUE(received.empty());
+  EXPECT_EQ(receiver.getStats().crcErrors, 1u);
+  EXPECT_EQ(receiver.getStats().framesReceived, 0u);
+}
+
+TEST_F(RpcLinkTest, ResynchronizesAfterLineNoise) {
+  std::vector<uint8_t> bytes = {0x31, 0x99, 0x07, 0x00};  // Noise up to a delimiter
+  std::vector<uint8_t> frame = encodeFrame(RPC_RESULT, {1, 2, 3});
+  bytes.insert(bytes.end(), frame.begin(), frame.end());
+
+  deliver(bytes);
+  EXPECT_EQ(receiver.getStats().crcErrors, 1u);
+  ASSERT_EQ(received.size(), 1u);
+  EXPECT_EQ(received[0].payload, std::vector<uint8_t>({1, 2, 3}));
+}
+
+TEST_F(RpcLinkTest, OversizeFrameCountsOverflowAndResyncs) {
+  std::vector<uint8_t> bytes = encodeFrame(RPC_CONFIG, std::vector<uint8_t>(RPC_RX_BUFFER_SIZE, 0x42));
+  std::vector<uint8_t> small = encodeFrame(RPC_RESULT, {4, 5});
+  bytes.insert(bytes.end(), small.begin(), small.end());
+
+  deliver(bytes);
+  EXPECT_EQ(receiver.getStats().rxOverflows, 1u);
+  ASSERT_EQ(received.size(), 1u);
+  EXPECT_EQ(received[0].type, RPC_RESULT);
+}
@@ -0,0 +1,48 @@
+/**
+ * GreenOS - Sensor Health Tests
+ *
+ * SensorManager error rates on the mock HAL: the sliding window must
+ * keep reporting a sensor that has been flagged as failed.
+ */
+
+#include <gtest/gtest.h>
+#include "config.h"
+#include "sensor_manager.h"
+#include "health_window.h"
+#include "mock_hal.h"
+
+static const unsigned long SCD30_PERIOD_MS = SCD30_MEASUREMENT_INTERVAL * 1000UL;
+
+class SensorHealthTest : public ::testing::Test {
+protected:
+  SensorManager sensors;
+
+  void SetUp() override {
+    mockReset();
+    sensors.init();
+  }
+
+  void runFor(unsigned long durationMs) {
+    for (unsigned long t = 0; t < durationMs; t += SCD30_PERIOD_MS) {
+      mockAdvanceMillis(SCD30_PERIOD_MS);
+      sensors.readAll();
+    }
+  }
+};
+
+TEST_F(SensorHealthTest, HealthySCD30ReportsNoErrors) {
+  runFor(HEALTH_BUCKETS * HEALTH_BUCKET_MS);
+
+  EXPECT_TRUE(sensors.getHealthReport().scd30Valid);
+  EXPECT_FLOAT_EQ(sensors.getData().scd30ErrorRate, 0.0f);
+}
+
+TEST_F(SensorHealthTest, DeadSCD30KeepsFullErrorRate) {
+  mockSCD30.readOk = false;
+
+  // Well past the window: nothing but post-failure cycles remain in it
+  runFor(2 * HEALTH_BUCKETS * HEALTH_BUCKET_MS);
+
+  EXPECT_FALSE(sensors.getHealthReport().scd30Valid);
+  EXPECT_FLOAT_EQ(sensors.getData().scd30ErrorRate, 100.0f);
+}
@@ -0,0 +1,210 @@
+/**
+ * GreenOS - Sensor Rollup Tests
+ *
+ * Window statistics, alignment, the 1-minute to 15-minute cascade and
+ * per-window actuator usage. Samples carry their own timestamps, so no
+ * clock is involved.
+ */
+
+#include <gtest/gtest.h>
+#include "sensor_rollup.h"
+
+class SensorRollupTest : public ::testing::Test {
+protected:
+  SensorRollup rollup;
+  ActuatorUsage usage;
+
+  void SetUp() override {
+    memset(&usage, 0, sizeof(usage));
+  }
+
+  void addSample(unsigned long timestamp, float airTemp) {
+    SensorData data;
+    memset(&data, 0, sizeof(data));
+    data.airTemp = airTemp;
+    data.airHumidity = NAN;
+    data.co2 = 600.0f;
+    data.ph = NAN;
+    data.ec = NAN;
+    data.vwc = NAN;
+    data.timestamp = timestamp;
+    rollup.add(data, usage);
+  }
+
+  float decoded(const PackedRollup& record, RollupMetric metric, uint16_t PackedRollupMetric::*field) {
+    return SensorRollup::decodeValue(metric, record.metrics[metric].*field);
+  }
+
+  // Completed records of one level, oldest first
+  std::vector<PackedRollup> pendingAt(RollupLevel level) {
+    std::vector<PackedRollup> records;
+    for (size_t i = 0; i < rollup.getPendingCount(); i++) {
+      if (rollup.getPending(i).level == level) records.push_back(rollup.getPending(i));
+    }
+    return records;
+  }
+};
+
+// ============================================================================
+// 1-MINUTE WINDOWS
+// ============================================================================
+
+TEST_F(SensorRollupTest, MinuteWindowSummarizesSamples) {
+  addSample(60000, 20.0f);
+  addSample(70000, 24.0f);
+  addSample(80000, NAN);         // Not counted
+  addSample(90000, 22.5f);
+  EXPECT_EQ(rollup.getPendingCount(), 0u);
+
+  addSample(120000, 30.0f);      // Next minute closes the first
+  ASSERT_EQ(rollup.getPendingCount(), 1u);
+
+  const PackedRollup& record = rollup.getPending(0);
+  EXPECT_EQ(record.version, ROLLUP_VERSION);
+  EXPECT_EQ(record.level, ROLLUP_1MIN);
+  EXPECT_EQ(record.windowStart, 60000u);
+  EXPECT_EQ(record.metrics[ROLLUP_AIR_TEMP].count, 3);
+  EXPECT_FLOAT_EQ(decoded(record, ROLLUP_AIR_TEMP, &PackedRollupMetric::min), 20.0f);
+  EXPECT_FLOAT_EQ(decoded(record, ROLLUP_AIR_TEMP, &PackedRollupMetric::max), 24.0f);
+  EXPECT_FLOAT_EQ(decoded(record, ROLLUP_AIR_TEMP, &PackedRollupMetric::mean), 22.17f);
+  EXPECT_FLOAT_EQ(decoded(record, ROLLUP_AIR_TEMP, &PackedRollupMetric::last), 22.5f);
+  EXPECT_EQ(record.metrics[ROLLUP_CO2].count, 4);
+}
+
+TEST_F(SensorRollupTest, MetricWithoutSamplesPacksAsNoData) {
+  addSample(0, 20.0f);
+  addSample(60000, 20.0f);
+  ASSERT_EQ(rollup.getPendingCount(), 1u);
+
+  const PackedRollup& record = rollup.getPending(0);
+  EXPECT_EQ(record.metrics[ROLLUP_PH].count, 0);
+  EXPECT_TRUE(isnan(decoded(record, ROLLUP_PH, &PackedRollupMetric::min)));
+  EXPECT_TRUE(isnan(decoded(record, ROLLUP_PH, &PackedRollupMetric::mean)));
+}
+
+TEST_F(SensorRollupTest, WindowsAlignToTheirLength) {
+  addSample(61234, 20.0f);
+  addSample(185000, 20.0f);
+  ASSERT_EQ(rollup.getPendingCount(), 1u);
+  EXPECT_EQ(rollup.getPending(0).windowStart, 60000u);
+  EXPECT_EQ(rollup.getCurrent(ROLLUP_1MIN, ROLLUP_AIR_TEMP).count, 1);
+}
+
+TEST_F(SensorRollupTest, GapLeavesNoEmptyWindows) {
+  addSample(0, 20.0f);
+  addSample(5 * 60000UL, 21.0f);
+
+  // Minutes 1-4 had no samples and produce no records
+  EXPECT_EQ(pendingAt(ROLLUP_1MIN).size(), 1u);
+}
+
+TEST_F(SensorRollupTest, NegativeTemperatureRoundTrips) {
+  addSample(0, -5.25f);
+  addSample(60000, 0.0f);
+  ASSERT_EQ(rollup.getPendingCount(), 1u);
+  EXPECT_FLOAT_EQ(decoded(rollup.getPending(0), ROLLUP_AIR_TEMP, &PackedRollupMetric::min), -5.25f);
+}
+
+// ============================================================================
+// 15-MINUTE CASCADE
+// ============================================================================
+
+TEST_F(SensorRollupTest, QuarterHourMergesItsMinutes) {
+  // One sample every 10 s for 15 minutes, temperature ramps 10 -> 19.9
+  unsigned long t = 0;
+  float temp = 10.0f;
+  for (; t < ROLLUP_15MIN_MS; t += 10000, temp += 0.1f) {
+    addSample(t, temp);
+  }
+  addSample(t, 50.0f);           // Minute 15 closes minute 14
+  EXPECT_TRUE(pendingAt(ROLLUP_15MIN).empty());
+
+  addSample(t + 60000, 50.0f);   // Closing minute 15 starts a new quarter
+  std::vector<PackedRollup> quarters = pendingAt(ROLLUP_15MIN);
+  ASSERT_EQ(quarters.size(), 1u);
+  EXPECT_EQ(pendingAt(ROLLUP_1MIN).size(), 16u);
+
+  const PackedRollup& quarter = quarters[0];
+  EXPECT_EQ(quarter.windowStart, 0u);
+  EXPECT_EQ(quarter.metrics[ROLLUP_AIR_TEMP].count, 90);
+  EXPECT_NEAR(decoded(quarter, ROLLUP_AIR_TEMP, &PackedRollupMetric::min), 10.0f, 0.01f);
+  EXPECT_NEAR(decoded(quarter, ROLLUP_AIR_TEMP, &PackedRollupMetric::max), 18.9f, 0.01f);
+  EXPECT_NEAR(decoded(quarter, ROLLUP_AIR_TEMP, &PackedRollupMetric::mean), 14.45f, 0.01f);
+  EXPECT_NEAR(decoded(quarter, ROLLUP_AIR_TEMP, &PackedRollupMetric::last), 18.9f, 0.01f);
+}
+
+// ============================================================================
+// ACTUATOR USAGE
+// ============================================================================
+
+TEST_F(SensorRollupTest, UsageDifferencesBookToTheLaterSample) {
+  usage.onTimeMs[ACTUATOR_HEATER_PRIMARY] = 5000000;   // Before the first sample
+  addSample(0, 20.0f);
+  usage.onTimeMs[ACTUATOR_HEATER_PRIMARY] += 30000;
+  addSample(30000, 20.0f);
+  usage.onTimeMs[ACTUATOR_HEATER_PRIMARY] += 20000;    // Booked to minute 1
+  addSample(60000, 20.0f);
+  addSample(120000, 20.0f);
+
+  std::vector<PackedRollup> minutes = pendingAt(ROLLUP_1MIN);
+  ASSERT_EQ(minutes.size(), 2u);
+
+  const PackedActuatorUsage& first = minutes[0].actuators[ACTUATOR_HEATER_PRIMARY];
+  EXPECT_EQ(first.onSeconds, 30);
+  float deciWh = ActuatorManager::energyKwh(ACTUATOR_HEATER_PRIMARY, 30000) * 10000.0f;
+  EXPECT_EQ(first.energy, (uint16_t)(deciWh + 0.5f));
+
+  EXPECT_EQ(minutes[1].actuators[ACTUATOR_HEATER_PRIMARY].onSeconds, 20);
+  EXPECT_EQ(minutes[0].actuators[ACTUATOR_PUMP].onSeconds, 0);
+}
+
+TEST_F(SensorRollupTest, UsageCounterWrapIsHarmless) {
+  usage.onTimeMs[ACTUATOR_FAN_EXHAUST] = 0xFFFFFFFFUL - 4999;
+  addSample(0, 20.0f);
+  usage.onTimeMs[ACTUATOR_FAN_EXHAUST] = 5000;         // Wrapped: 10 s later
+  addSample(10000, 20.0f);
+  addSample(60000, 20.0f);
+
+  ASSERT_EQ(rollup.getPendingCount(), 1u);
+  EXPECT_EQ(rollup.getPending(0).actuators[ACTUATOR_FAN_EXHAUST].onSeconds, 10);
+}
+
+TEST_F(SensorRollupTest, QuarterHourSumsActuatorTime) {
+  addSample(0, 20.0f);
+  for (unsigned long t = 60000; t <= 16 * 60000UL; t += 60000) {
+    usage.onTimeMs[ACTUATOR_PUMP] += 6000;
+    addSample(t, 20.0f);
+  }
+
+  std::vector<PackedRollup> quarters = pendingAt(ROLLUP_15MIN);
+  ASSERT_EQ(quarters.size(), 1u);
+  // Each increment is booked to the minute of the sample that reports
+  // it, so this quarter gets minutes 1-14
+  EXPECT_EQ(quarters[0].actuators[ACTUATOR_PUMP].onSeconds, 14 * 6);
+}
+
+// ============================================================================
+// PENDING QUEUE
+// ============================================================================
+
+TEST_F(SensorRollupTest, FullQueueDropsOldest) {
+  for (unsigned long minute = 0; minute <= ROLLUP_PENDING_CAPACITY + 4; minute++) {
+    addSample(minute * 60000UL, 20.0f);
+  }
+
+  // 36 minutes closed plus two quarter-hour windows: 6 over capacity
+  EXPECT_EQ(rollup.getPendingCount(), (size_t)ROLLUP_PENDING_CAPACITY);
+  EXPECT_EQ(rollup.getDroppedCount(), 6u);
+  EXPECT_GT(rollup.getPending(0).windowStart, 0u);
+}
+
+TEST_F(SensorRollupTest, ConsumeRemovesOldestFirst) {
+  for (unsigned long minute = 0; minute <= 3; minute++) {
+    addSample(minute * 60000UL, 20.0f);
+  }
+  ASSERT_EQ(rollup.getPendingCount(), 3u);
+
+  rollup.consumePending(2);
+  ASSERT_EQ(rollup.getPendingCount(), 1u);
+  EXPECT_EQ(rollup.getPending(0).windowStart, 120000u);
+}
@@ -0,0 +1,58 @@
+/**
+ * GreenOS - SpscRing Tests
+ */
+
+#include <gtest/gtest.h>
+#include "spsc_ring.h"
+
+TEST(SpscRing, PopsInPushOrder) {
+  SpscRing<int, 4> ring;
+  int value;
+  EXPECT_TRUE(ring.isEmpty());
+  EXPECT_FALSE(ring.pop(value));
+
+  for (int i = 0; i < 3; i++) {
+    EXPECT_TRUE(ring.push(i));
+  }
+  EXPECT_EQ(ring.size(), 3u);
+
+  for (int i = 0; i < 3; i++) {
+    ASSERT_TRUE(ring.pop(value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_TRUE(ring.isEmpty());
+}
+
+TEST(SpscRing, FullRingRejectsNewest) {
+  SpscRing<int, 4> ring;
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(ring.push(i));
+  }
+  EXPECT_FALSE(ring.push(4));          // Unlike RingBuffer: 0 is kept
+  EXPECT_EQ(ring.size(), ring.capacity());
+
+  int value;
+  ASSERT_TRUE(ring.pop(value));
+  EXPECT_EQ(value, 0);
+  EXPECT_TRUE(ring.push(4));           // Room again
+}
+
+TEST(SpscRing, IndicesRunFreeAcrossManyWraps) {
+  SpscRing<int, 8> ring;
+  int value;
+  int next = 0;
+
+  // Keep a few entries in flight so head and tail wrap at different slots
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_TRUE(ring.push(i));
+    if (i % 3 != 0) continue;
+    while (ring.size() > 2) {
+      ASSERT_TRUE(ring.pop(value));
+      EXPECT_EQ(value, next++);
+    }
+  }
+  while (ring.pop(value)) {
+    EXPECT_EQ(value, next++);
+  }
+  EXPECT_EQ(next, 1000);
+}
@@ -0,0 +1,199 @@
+/**
+ * GreenOS - Task Scheduler Tests
+ *
+ * Dispatch order and overrun handling on the mock clock. Task callbacks
+ * take no context, so they log their runs to a file-scope list; a slow
+ * task advances the mock clock from inside its callback.
+ */
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <string>
+#include "task_scheduler.h"
+#include "mock_hal.h"
+
+static std::vector<std::string> runLog;
+static unsigned long slowTaskMs = 0;
+
+static void taskA() { runLog.push_back("A"); }
+static void taskB() { runLog.push_back("B"); }
+static void taskC() { runLog.push_back("C"); }
+
+static void taskSlow() {
+  runLog.push_back("slow");
+  mockAdvanceMillis(slowTaskMs);
+}
+
+class TaskSchedulerTest : public ::testing::Test {
+protected:
+  TaskScheduler scheduler;
+
+  void SetUp() override {
+    mockReset();
+    mockSetMillis(1000);
+    runLog.clear();
+    slowTaskMs = 0;
+  }
+
+  // Drain everything due now
+  void runDue() {
+    for (int i = 0; i < 100 && scheduler.runNext(); i++) {
+    }
+  }
+
+  // Step the clock 1 ms at a time, running whatever falls due
+  void runFor(unsigned long durationMs) {
+    for (unsigned long t = 0; t < durationMs; t++) {
+      mockAdvanceMillis(1);
+      runDue();
+    }
+  }
+};
+
+// ============================================================================
+// ORDERING
+// ============================================================================
+
+TEST_F(TaskSchedulerTest, EarlierDeadlineRunsFirst) {
+  scheduler.addTask("a", taskA, 100, TASK_PRIORITY_LOW, 20);
+  scheduler.addTask("b", taskB, 100, TASK_PRIORITY_CRITICAL, 30);
+  scheduler.addTask("c", taskC, 100, TASK_PRIORITY_NORMAL, 10);
+
+  runFor(30);
+  EXPECT_EQ(runLog, std::vector<std::string>({"C", "A", "B"}));
+}
+
+TEST_F(TaskSchedulerTest, PriorityBreaksDeadlineTies) {
+  scheduler.addTask("a", taskA, 100, TASK_PRIORITY_LOW);
+  scheduler.addTask("b", taskB, 100, TASK_PRIORITY_HIGH);
+  scheduler.addTask("c", taskC, 100, TASK_PRIORITY_CRITICAL);
+
+  runDue();
+  EXPECT_EQ(runLog, std::vector<std::string>({"C", "B", "A"}));
+
+  // Still tied a period later
+  runLog.clear();
+  runFor(100);
+  EXPECT_EQ(runLog, std::vector<std::string>({"C", "B", "A"}));
+}
+
+TEST_F(TaskSchedulerTest, RunNextRunsOneTaskAtATime) {
+  scheduler.addTask("a", taskA, 100, TASK_PRIORITY_NORMAL);
+  scheduler.addTask("b", taskB, 100, TASK_PRIORITY_NORMAL);
+
+  EXPECT_TRUE(scheduler.runNext());
+  EXPECT_EQ(runLog.size(), 1u);
+  EXPECT_TRUE(scheduler.runNext());
+  EXPECT_FALSE(scheduler.runNext());
+  EXPECT_EQ(scheduler.msUntilNextDeadline(), 100u);
+}
+
+TEST_F(TaskSchedulerTest, PeriodsKeepTheirPhase) {
+  int id = scheduler.addTask("a", taskA, 50, TASK_PRIORITY_NORMAL);
+  runDue();
+  runFor(500);
+
+  EXPECT_EQ(scheduler.getTask(id).runCount, 11u);
+  EXPECT_EQ(scheduler.getTask(id).maxLatenessMs, 0u);
+}
+
+TEST_F(TaskSchedulerTest, DisabledTaskNeverRuns) {
+  int a = scheduler.addTask("a", taskA, 10, TASK_PRIORITY_CRITICAL);
+  scheduler.addTask("b", taskB, 10, TASK_PRIORITY_LOW);
+  scheduler.setEnabled(a, false);
+
+  runFor(30);
+  EXPECT_EQ(std::count(runLog.begin(), runLog.end(), "A"), 0);
+  EXPECT_EQ(std::count(runLog.begin(), runLog.end(), "B"), 4);
+
+  // Re-enabled: first run one period from now
+  scheduler.setEnabled(a, true);
+  runFor(9);
+  EXPECT_EQ(std::count(runLog.begin(), runLog.end(), "A"), 0);
+  runFor(1);
+  EXPECT_EQ(std::count(runLog.begin(), runLog.end(), "A"), 1);
+}
+
+TEST_F(TaskSchedulerTest, NothingEnabledMeansNoDeadline) {
+  EXPECT_EQ(scheduler.msUntilNextDeadline(), 0xFFFFFFFFUL);
+
+  int a = scheduler.addTask("a", taskA, 10, TASK_PRIORITY_NORMAL);
+  scheduler.setEnabled(a, false);
+  EXPECT_EQ(scheduler.msUntilNextDeadline(), 0xFFFFFFFFUL);
+  EXPECT_FALSE(scheduler.runNext());
+}
+
+TEST_F(TaskSchedulerTest, RunSoonPullsTaskForward) {
+  int a = scheduler.addTask("a", taskA, 1000, TASK_PRIORITY_NORMAL, 1000);
+  runFor(100);
+  ASSERT_TRUE(runLog.empty());
+
+  scheduler.runSoon(a);
+  EXPECT_EQ(scheduler.msUntilNextDeadline(), 0u);
+  runDue();
+  EXPECT_EQ(runLog.size(), 1u);
+  EXPECT_EQ(scheduler.msUntilNextDeadline(), 1000u);  // Period restarts
+}
+
+TEST_F(TaskSchedulerTest, TableFullIsRefused) {
+  for (int i = 0; i < MAX_SCHEDULED_TASKS; i++) {
+    ASSERT_EQ(scheduler.addTask("a", taskA, 10, TASK_PRIORITY_NORMAL), i);
+  }
+  EXPECT_EQ(scheduler.addTask("b", taskB, 10, TASK_PRIORITY_NORMAL), -1);
+  EXPECT_EQ(scheduler.addTask("c", nullptr, 10, TASK_PRIORITY_NORMAL), -1);
+}
+
+// ============================================================================
+// OVERRUN
+// ============================================================================
+
+TEST_F(TaskSchedulerTest, OverrunningTaskIsRephasedWithoutBurst) {
+  int slow = scheduler.addTask("slow", taskSlow, 100, TASK_PRIORITY_NORMAL);
+  slowTaskMs = 350;             // Three and a half periods
+  ASSERT_TRUE(scheduler.runNext());
+  slowTaskMs = 0;
+
+  // 250 ms overdue: one catch-up run, not one per missed period, then a
+  // full period from now
+  runDue();
+  EXPECT_EQ(scheduler.getTask(slow).runCount, 2u);
+  EXPECT_EQ(scheduler.getTask(slow).maxLatenessMs, 250u);
+  EXPECT_EQ(scheduler.msUntilNextDeadline(), 100u);
+}
+
+TEST_F(TaskSchedulerTest, SlowTaskDoesNotStarveOthers) {
+  int slow = scheduler.addTask("slow", taskSlow, 10, TASK_PRIORITY_CRITICAL);
+  int other = scheduler.addTask("b", taskB, 10, TASK_PRIORITY_LOW);
+  slowTaskMs = 15;              // Longer than its own period
+
+  for (int i = 0; i < 60; i++) {
+    ASSERT_TRUE(scheduler.runNext());  // Always something overdue
+  }
+
+  // The low-priority task still gets a turn between every few slow runs
+  EXPECT_GE(scheduler.getTask(other).runCount, 20u);
+  EXPECT_LE(scheduler.getTask(other).maxLatenessMs, 2 * slowTaskMs);
+  EXPECT_GE(scheduler.getTask(slow).maxLatenessMs, 5u);
+}
+
+TEST_F(TaskSchedulerTest, SlightLatenessKeepsPhase) {
+  int a = scheduler.addTask("a", taskA, 100, TASK_PRIORITY_NORMAL, 100);
+  mockAdvanceMillis(130);       // 30 ms late
+  runDue();
+  ASSERT_EQ(runLog.size(), 1u);
+  EXPECT_EQ(scheduler.getTask(a).maxLatenessMs, 30u);
+
+  // Next deadline stays on the original grid
+  EXPECT_EQ(scheduler.msUntilNextDeadline(), 70u);
+}
+
+TEST_F(TaskSchedulerTest, RunTimeIsMeasured) {
+  int slow = scheduler.addTask("slow", taskSlow, 100, TASK_PRIORITY_NORMAL);
+  slowTaskMs = 2;
+  runDue();
+
+  ScheduledTask task = scheduler.getTask(slow);
+  EXPECT_GE(task.lastRunMicros, 2000u);
+  EXPECT_EQ(task.maxRunMicros, task.lastRunMicros);
+  EXPECT_EQ(task.totalRunMicros, task.lastRunMicros);
+}
@@ -0,0 +1,173 @@
+/**
+ * GreenOS - Trace Replay Pipeline Tests
+ *
+ * Full path on the mock HAL: TraceReplay -> SensorManager -> detection
+ * -> alert queue.
+ */
+
+#include <gtest/gtest.h>
+#include "config.h"
+#include "replay_pipeline.h"
+#include "alloc_counter.h"
+#include "mock_hal.h"
+
+static const unsigned long HOUR_MS = 3600000UL;
+
+class TraceReplayTest : public ::testing::Test {
+protected:
+  ReplayPipeline pipeline;
+  TraceBuilder trace;
+
+  void SetUp() override {
+    pipeline.begin();
+  }
+
+  bool start() {
+    const std::vector<uint8_t>& bytes = trace.bytes();
+    return pipeline.start(bytes.data(), bytes.size());
+  }
+};
+
+TEST_F(TraceReplayTest, NominalTraceRaisesNothing) {
+  trace.addSteady(22.0f, 55.0f, 600.0f, 0, HOUR_MS, SENSOR_READ_INTERVAL);
+  ASSERT_TRUE(start());
+
+  EXPECT_EQ(pipeline.run(), trace.getRecordCount());
+  EXPECT_EQ(pipeline.getBatches(), 0u);
+  EXPECT_EQ(pipeline.getEmergencies(), 0u);
+}
+
+TEST_F(TraceReplayTest, ReplayedValuesReachDetection) {
+  trace.addSteady(21.5f, 61.25f, 850.0f, 5000, 10 * SENSOR_READ_INTERVAL, SENSOR_READ_INTERVAL);
+  ASSERT_TRUE(start());
+
+  ASSERT_TRUE(pipeline.step());
+  const SensorData& data = pipeline.getSensors().getData();
+  EXPECT_FLOAT_EQ(data.airTemp, 21.5f);
+  EXPECT_FLOAT_EQ(data.airHumidity, 61.25f);
+  EXPECT_FLOAT_EQ(data.co2, 850.0f);
+  EXPECT_TRUE(isnan(data.ph));
+
+  unsigned long first = data.timestamp;
+  ASSERT_TRUE(pipeline.step());
+  EXPECT_EQ(pipeline.getSensors().getData().timestamp - first, (unsigned long)SENSOR_READ_INTERVAL);
+}
+
+TEST_F(TraceReplayTest, LiveValuesReturnAfterReplay) {
+  SensorManager& sensors = pipeline.getSensors();
+  const SensorData before = sensors.getData();
+
+  trace.addSteady(30.0f, 80.0f, 1500.0f, 0, 10 * SENSOR_READ_INTERVAL, SENSOR_READ_INTERVAL);
+  ASSERT_TRUE(start());
+  pipeline.run();
+  ASSERT_FALSE(sensors.isReplaying());
+
+  // Nothing the trace carried (or blanked) is left in the live copy
+  sensors.readAll();
+  const SensorData& after = sensors.getData();
+  EXPECT_FLOAT_EQ(after.ph, before.ph);
+  EXPECT_FLOAT_EQ(after.ec, before.ec);
+  EXPECT_FLOAT_EQ(after.substrateTemp, before.substrateTemp);
+  EXPECT_FLOAT_EQ(after.co2, mockSCD30.co2);
+}
+
+TEST_F(TraceReplayTest, SessionRestartKeepsTimeMovingForward) {
+  trace.addSteady(22.0f, 55.0f, 600.0f, HOUR_MS, 5 * SENSOR_READ_INTERVAL, SENSOR_READ_INTERVAL);
+  trace.addSteady(22.0f, 55.0f, 600.0f, 0, 5 * SENSOR_READ_INTERVAL, SENSOR_READ_INTERVAL);
+  ASSERT_TRUE(start());
+
+  unsigned long previous = 0;
+  uint32_t steps = 0;
+  while (pipeline.step()) {
+    unsigned long now = pipeline.getSensors().getData().timestamp;
+    if (steps > 0) EXPECT_GT(now, previous);
+    previous = now;
+    steps++;
+  }
+  EXPECT_EQ(steps, 10u);
+}
+
+// The user-027 acceptance check, end to end: 3 h above HUMIDITY_MAX at the
+// normal sensor rate gives six reports (hold-down every 30 min, one
+// escalation at 2 h), not one per detection
+TEST_F(TraceReplayTest, HumidityHeldThreeHoursGivesSixReports) {
+  trace.addSteady(22.0f, HUMIDITY_MAX + 10.0f, 600.0f, 0, 3 * HOUR_MS, SENSOR_READ_INTERVAL);
+  ASSERT_TRUE(start());
+
+  pipeline.run();
+  EXPECT_EQ(pipeline.getReports(HUMIDITY_TOO_HIGH), 6u);
+  EXPECT_EQ(pipeline.getReports(TEMP_TOO_HIGH), 0u);
+}
+
+TEST_F(TraceReplayTest, HeatWaveGoesToEmergencyNotQueue) {
+  trace.addSteady(TEMP_MAX + 3.0f, 55.0f, 600.0f, 0, 10 * 60000UL, SENSOR_READ_INTERVAL);
+  ASSERT_TRUE(start());
+
+  pipeline.run();
+  EXPECT_GT(pipeline.getEmergencies(), 0u);
+  EXPECT_EQ(pipeline.getReports(TEMP_TOO_HIGH), 0u);
+}
+
+TEST_F(TraceReplayTest, SteadyStateDoesNotAllocate) {
+  trace.addSteady(22.0f, HUMIDITY_MAX + 10.0f, 600.0f, 0, HOUR_MS, SENSOR_READ_INTERVAL);
+  ASSERT_TRUE(start());
+  ASSERT_TRUE(pipeline.step());
+
+  AllocationCount before = allocationCount();
+  while (pipeline.step()) {
+  }
+  EXPECT_EQ(allocationsSince(before), 0u);
+}
+
+// ============================================================================
+// RECORDER LOG SHARE
+// ============================================================================
+
+class TraceRecorderTest : public ::testing::Test {
+protected:
+  FlashLog log;
+  TraceRecorder recorder;
+  SensorData data;
+
+  void SetUp() override {
+    mockReset();
+    ASSERT_TRUE(log.begin());
+    memset(&data, 0, sizeof(data));
+    data.airTemp = 22.0f;
+    data.airHumidity = 55.0f;
+    data.co2 = 600.0f;
+  }
+
+  // Unsynced telemetry, one sector's worth at a time
+  void fillUnsynced(uint32_t sectors) {
+    uint8_t payload[200];
+    memset(payload, 0x5A, sizeof(payload));
+    uint32_t target = log.getStats().headSequence + sectors;
+    while (log.getStats().headSequence < target) {
+      ASSERT_TRUE(log.append(LOG_TYPE_READINGS, payload, sizeof(payload)));
+    }
+  }
+};
+
+TEST_F(TraceRecorderTest, StopsAtLogShare) {
+  ASSERT_TRUE(recorder.start(&log));
+
+  uint32_t budget = TRACE_MAX_SECTORS * log.getStats().sectorSize;
+  for (uint32_t i = 0; i < 10000 && recorder.isRecording(); i++) {
+    data.timestamp = i * SENSOR_READ_INTERVAL;
+    recorder.add(data);
+  }
+
+  EXPECT_FALSE(recorder.isRecording());
+  EXPECT_EQ(recorder.getDroppedCount(), 0u);
+  EXPECT_LE(recorder.getRecordCount() / TRACE_BLOCK_RECORDS * TRACE_BLOCK_BYTES, budget);
+  EXPECT_EQ(log.getStats().sectorsDropped, 0u);
+}
+
+TEST_F(TraceRecorderTest, RefusesWhenUnsyncedDataWouldWrap) {
+  FlashLogStats stats = log.getStats();
+  fillUnsynced(stats.sectorCount - TRACE_MAX_SECTORS);
+
+  EXPECT_FALSE(recorder.start(&log));
+  EXPECT_FALSE(recorder.isRecording());
+}
@@ -12,38 +12,31 @@
  * - Interlocks to prevent conflicting operations
  * - Emergency protocols for critical conditions
  * - Duty cycle limiting to prevent equipment damage
+ * - On-time and energy accounting per actuator
  */
 
 #include "actuator_manager.h"
 #include "config.h"
+#include "boot_state.h"
 
 // ============================================================================
-// ACTUATOR STATE TRACKING
+// ACTUATOR TABLE
 // ============================================================================
 
-struct ActuatorState {
-  bool heaterPrimary;
-  bool heaterSecondary;
-  bool fanExhaust;
-  bool fanCirculation;
-  bool pumpIrrigation;
-  bool lightGrow;
-  
-  // Duty cycle tracking (prevent excessive cycling)
-  unsigned long heaterOnTime;
-  unsigned long fanOnTime;
-  unsigned long pumpOnTime;
-  unsigned long lastHeaterChange;
-  unsigned long lastFanChange;
-  unsigned long lastPumpChange;
+// Rows in ActuatorId order. Relays are active-high (LOW = OFF); set
+// activeLow for modules that energise on LOW.
+static const ActuatorConfig actuatorTable[ACTUATOR_COUNT] = {
+  // name               pin                   activeLow  minCycleMs         maxRunMs              interlock                            settleMs             watts                   maxDuty
+  {"Heater Primary",    HEATER_PRIMARY_PIN,   false,     MIN_CYCLE_TIME_MS, 0,                    ACTUATOR_BIT(ACTUATOR_FAN_EXHAUST),  0,                   HEATER_PRIMARY_WATTS,   MAX_HEATER_DUTY_CYCLE},
+  {"Heater Secondary",  HEATER_SECONDARY_PIN, false,     MIN_CYCLE_TIME_MS, 0,                    ACTUATOR_BIT(ACTUATOR_FAN_EXHAUST),  0,                   HEATER_SECONDARY_WATTS, MAX_HEATER_DUTY_CYCLE},
+  {"Fan Exhaust",       FAN_EXHAUST_PIN,      false,     MIN_CYCLE_TIME_MS, 0,                    ACTUATOR_MASK_HEATERS,               HEATER_DISENGAGE_MS, FAN_EXHAUST_WATTS,      1.0f},
+  {"Fan Circulation",   FAN_CIRCULATION_PIN,  false,     MIN_CYCLE_TIME_MS, 0,                    0,                                   0,                   FAN_CIRCULATION_WATTS,  1.0f},
+  {"Irrigation Pump",   PUMP_IRRIGATION_PIN,  false,     MIN_CYCLE_TIME_MS, MAX_PUMP_RUN_TIME_MS, 0,                                   0,                   PUMP_IRRIGATION_WATTS,  1.0f},
+  {"Grow Lights",       LIGHT_GROW_PIN,       false,     0,                 0,                    0,                                   0,                   LIGHT_GROW_WATTS,       1.0f}
 };
 
-ActuatorState state;
-
-// Safety limits
-#define MIN_CYCLE_TIME_MS 60000      // Minimum 1 minute between state changes
-#define MAX_HEATER_DUTY_CYCLE 0.8    // Maximum 80% duty cycle
-#define MAX_PUMP_RUN_TIME_MS 600000  // Maximum 10 minutes continuous run
+static const unsigned long dutyHourLength = DUTY_HOUR_BUCKETS * DUTY_HOUR_BUCKET_MS;
+static const unsigned long dutyDayLength = DUTY_DAY_BUCKETS * DUTY_DAY_BUCKET_MS;
 
 // ============================================================================
 // CONSTRUCTOR
@@ -51,19 +44,33 @@ ActuatorState state;
 
 ActuatorManager::ActuatorManager() {
   // Initialize all actuators to OFF state
-  state.heaterPrimary = false;
-  state.heaterSecondary = false;
-  state.fanExhaust = false;
-  state.fanCirculation = false;
-  state.pumpIrrigation = false;
-  state.lightGrow = false;
-  
-  state.heaterOnTime = 0;
-  state.fanOnTime = 0;
-  state.pumpOnTime = 0;
-  state.lastHeaterChange = 0;
-  state.lastFanChange = 0;
-  state.lastPumpChange = 0;
+  relayState = 0;
+  switchedMask = 0;
+  runLimitedMask = 0;
+  dutyLimitedMask = 0;
+  dutyHourIndex = 0;
+  dutyDayIndex = 0;
+  dutyHourStart = 0;
+  dutyDayStart = 0;
+  dutyAccountedAt = 0;
+  deferredCount = 0;
+  dryRun = false;
+  shadowState = 0;
+  shadowSwitches = 0;
+  
+  for (uint8_t id = 0; id < ACTUATOR_COUNT; id++) {
+    lastChange[id] = 0;
+    onSince[id] = 0;
+    onTimeTotal[id] = 0;
+    memset(dutyHourBuckets[id], 0, sizeof(dutyHourBuckets[id]));
+    memset(dutyDayBuckets[id], 0, sizeof(dutyDayBuckets[id]));
+    if (actuatorTable[id].maxRunMs > 0) {
+      runLimitedMask |= ACTUATOR_BIT(id);
+    }
+    if (actuatorTable[id].maxDuty < 1.0f) {
+      dutyLimitedMask |= ACTUATOR_BIT(id);
+    }
+  }
 }
 
 // ============================================================================
@@ -73,140 +80,227 @@ ActuatorManager::ActuatorManager() {
 void ActuatorManager::init() {
   Serial.println("=== Initializing Actuators ===");
   
-  // Configure relay pins as outputs
-  pinMode(HEATER_PRIMARY_PIN, OUTPUT);
-  pinMode(HEATER_SECONDARY_PIN, OUTPUT);
-  pinMode(FAN_EXHAUST_PIN, OUTPUT);
-  pinMode(FAN_CIRCULATION_PIN, OUTPUT);
-  pinMode(PUMP_IRRIGATION_PIN, OUTPUT);
-  pinMode(LIGHT_GROW_PIN, OUTPUT);
-  
-  // Initialize all relays to OFF (LOW = OFF for active-high relays)
-  // Note: Adjust based on your relay module (some are active-low)
-  digitalWrite(HEATER_PRIMARY_PIN, LOW);
-  digitalWrite(HEATER_SECONDARY_PIN, LOW);
-  digitalWrite(FAN_EXHAUST_PIN, LOW);
-  digitalWrite(FAN_CIRCULATION_PIN, LOW);
-  digitalWrite(PUMP_IRRIGATION_PIN, LOW);
-  digitalWrite(LIGHT_GROW_PIN, LOW);
+  // Configure relay pins as outputs, driven to the OFF level
+  for (uint8_t id = 0; id < ACTUATOR_COUNT; id++) {
+    const ActuatorConfig& config = actuatorTable[id];
+    pinMode(config.pin, OUTPUT);
+    digitalWrite(config.pin, config.activeLow ? HIGH : LOW);
+  }
+  relayState = 0;
+  
+  // Accounting windows start now
+  unsigned long now = millis();
+  dutyAccountedAt = now;
+  dutyHourStart = now;
+  dutyDayStart = now;
   
   Serial.println("✓ All actuators initialized to OFF state");
   Serial.println("=== Actuator Initialization Complete ===\n");
 }
 
 // ============================================================================
-// INDIVIDUAL ACTUATOR CONTROL
+// TABLE-DRIVEN CONTROL
 // ============================================================================
 
-void ActuatorManager::setHeater(bool primary, bool turnOn) {
-  unsigned long now = millis();
-  
-  // Check minimum cycle time to prevent rapid switching
-  if (now - state.lastHeaterChange < MIN_CYCLE_TIME_MS) {
-    Serial.println("⚠️ Heater: Minimum cycle time not met, ignoring command");
+void ActuatorManager::command(ActuatorMask turnOn, ActuatorMask turnOff) {
+  if (dryRun) {
+    switchShadow(turnOn, turnOff);
     return;
   }
+  switchOutputs(turnOn, turnOff);
+}
+
+void ActuatorManager::switchOutputs(ActuatorMask turnOn, ActuatorMask turnOff) {
+  unsigned long now = millis();
+  accountOnTime(now);
   
-  // Safety interlock: Don't run heater and exhaust fan simultaneously
-  if (turnOn && state.fanExhaust) {
-    Serial.println("⚠️ Heater: Cannot enable while exhaust fan is running");
-    return;
-  }
+  turnOn &= ACTUATOR_MASK_ALL;
+  turnOff &= ACTUATOR_MASK_ALL & ~turnOn;
+  
+  // A direct command supersedes any pending deferred change for these
+  cancelActions(turnOn | turnOff);
   
-  int pin = primary ? HEATER_PRIMARY_PIN : HEATER_SECONDARY_PIN;
-  bool* stateVar = primary ? &state.heaterPrimary : &state.heaterSecondary;
+  // OFF is the safe state - always allowed, and applied before the ON
+  // checks so interlocks see it
+  ActuatorMask next = relayState & ~turnOff;
+  ActuatorMask pending = turnOn & ~next;
   
-  if (*stateVar != turnOn) {
-    digitalWrite(pin, turnOn ? HIGH : LOW);
-    *stateVar = turnOn;
-    state.lastHeaterChange = now;
+  for (uint8_t id = 0; pending != 0; id++) {
+    ActuatorMask bit = ACTUATOR_BIT(id);
+    if (!(pending & bit)) continue;
+    pending &= ~bit;
     
-    if (turnOn) {
-      state.heaterOnTime = now;
+    const ActuatorConfig& config = actuatorTable[id];
+    
+    // Minimum cycle time prevents rapid switching
+    if ((switchedMask & bit) && now - lastChange[id] < config.minCycleMs) {
+      Serial.print("⚠️ ");
+      Serial.print(config.name);
+      Serial.println(": Minimum cycle time not met, ignoring command");
+      continue;
     }
     
-    Serial.print("✓ Heater ");
-    Serial.print(primary ? "Primary" : "Secondary");
-    Serial.print(": ");
-    Serial.println(turnOn ? "ON" : "OFF");
+    // Duty cycle over the rolling hour
+    if (dutyExhausted((ActuatorId)id)) {
+      Serial.print("⚠️ ");
+      Serial.print(config.name);
+      Serial.println(": Duty cycle limit reached, ignoring command");
+      continue;
+    }
+    
+    // Safety interlock
+    ActuatorMask conflicts = next & config.interlock;
+    if (conflicts != 0) {
+      Serial.print("⚠️ ");
+      Serial.print(config.name);
+      if (config.settleMs == 0) {
+        Serial.println(": Blocked by interlock, ignoring command");
+        continue;
+      }
+      
+      // Disengage the conflicting actuators now, switch ON from tick()
+      Serial.println(": Disabling interlocked actuators first");
+      next &= ~conflicts;
+      scheduleAction(ACTION_SET_ACTUATOR, id, true, config.settleMs);
+      continue;
+    }
+    
+    next |= bit;
   }
+  
+  applyOutputs(next, now);
 }
 
-void ActuatorManager::setFan(bool exhaust, bool turnOn) {
-  unsigned long now = millis();
-  
-  // Check minimum cycle time
-  if (now - state.lastFanChange < MIN_CYCLE_TIME_MS) {
-    Serial.println("⚠️ Fan: Minimum cycle time not met, ignoring command");
-    return;
+void ActuatorManager::switchShadow(ActuatorMask turnOn, ActuatorMask turnOff) {
+  turnOn &= ACTUATOR_MASK_ALL;
+  turnOff &= ACTUATOR_MASK_ALL & ~turnOn;
+  
+  // Interlocks only - cycle and duty limits follow real relay history,
+  // which a dry run never makes. Settle sequences complete at once.
+  ActuatorMask next = shadowState & ~turnOff;
+  for (uint8_t id = 0; id < ACTUATOR_COUNT; id++) {
+    ActuatorMask bit = ACTUATOR_BIT(id);
+    if (!(turnOn & bit)) continue;
+    
+    const ActuatorConfig& config = actuatorTable[id];
+    ActuatorMask conflicts = next & config.interlock;
+    if (conflicts != 0) {
+      if (config.settleMs == 0) continue;
+      next &= ~conflicts;
+    }
+    next |= bit;
   }
   
-  // Safety interlock: Turn off heaters before enabling exhaust fan
-  if (exhaust && turnOn && (state.heaterPrimary || state.heaterSecondary)) {
-    Serial.println("⚠️ Exhaust Fan: Disabling heaters first");
-    setHeater(true, false);
-    setHeater(false, false);
-    delay(1000);  // Wait for heaters to fully disengage
+  ActuatorMask changed = next ^ shadowState;
+  shadowState = next;
+  
+  for (uint8_t id = 0; id < ACTUATOR_COUNT; id++) {
+    if (!(changed & ACTUATOR_BIT(id))) continue;
+    shadowSwitches++;
+    Serial.print("🔁 Dry run - ");
+    Serial.print(actuatorTable[id].name);
+    Serial.print(": ");
+    Serial.println((next & ACTUATOR_BIT(id)) ? "ON" : "OFF");
   }
+}
+
+void ActuatorManager::applyOutputs(ActuatorMask next, unsigned long now) {
+  ActuatorMask changed = next ^ relayState;
+  if (changed == 0) return;
   
-  int pin = exhaust ? FAN_EXHAUST_PIN : FAN_CIRCULATION_PIN;
-  bool* stateVar = exhaust ? &state.fanExhaust : &state.fanCirculation;
+  // Close the ON interval under the old state before switching
+  accountOnTime(now);
   
-  if (*stateVar != turnOn) {
-    digitalWrite(pin, turnOn ? HIGH : LOW);
-    *stateVar = turnOn;
-    state.lastFanChange = now;
-    
-    if (turnOn) {
-      state.fanOnTime = now;
-    }
+  // One pass, only the pins whose state changed
+  for (uint8_t id = 0; id < ACTUATOR_COUNT; id++) {
+    ActuatorMask bit = ACTUATOR_BIT(id);
+    if (!(changed & bit)) continue;
     
-    Serial.print("✓ Fan ");
-    Serial.print(exhaust ? "Exhaust" : "Circulation");
+    const ActuatorConfig& config = actuatorTable[id];
+    bool on = (next & bit) != 0;
+    digitalWrite(config.pin, (on != config.activeLow) ? HIGH : LOW);
+    lastChange[id] = now;
+    if (on) onSince[id] = now;
+  }
+  
+  relayState = next;
+  switchedMask |= changed;
+  bootState.saveRelays(next);
+  
+  for (uint8_t id = 0; id < ACTUATOR_COUNT; id++) {
+    if (!(changed & ACTUATOR_BIT(id))) continue;
+    Serial.print("✓ ");
+    Serial.print(actuatorTable[id].name);
     Serial.print(": ");
-    Serial.println(turnOn ? "ON" : "OFF");
+    Serial.println((next & ACTUATOR_BIT(id)) ? "ON" : "OFF");
   }
 }
 
-void ActuatorManager::setPump(bool turnOn) {
-  unsigned long now = millis();
-  
-  // Check minimum cycle time
-  if (now - state.lastPumpChange < MIN_CYCLE_TIME_MS) {
-    Serial.println("⚠️ Pump: Minimum cycle time not met, ignoring command");
-    return;
+void ActuatorManager::enforceRunLimits(unsigned long now) {
+  ActuatorMask running = relayState & runLimitedMask;
+  if (running == 0) return;
+  
+  ActuatorMask expired = 0;
+  for (uint8_t id = 0; id < ACTUATOR_COUNT; id++) {
+    if ((running & ACTUATOR_BIT(id)) && now - onSince[id] >= actuatorTable[id].maxRunMs) {
+      expired |= ACTUATOR_BIT(id);
+      Serial.print("⚠️ ");
+      Serial.print(actuatorTable[id].name);
+      Serial.println(": Maximum run time exceeded, forcing OFF");
+    }
   }
   
-  // Safety: Limit maximum continuous run time
-  if (turnOn && state.pumpIrrigation) {
-    unsigned long runTime = now - state.pumpOnTime;
-    if (runTime > MAX_PUMP_RUN_TIME_MS) {
-      Serial.println("⚠️ Pump: Maximum run time exceeded, forcing OFF");
-      turnOn = false;
+  if (expired != 0) {
+    cancelActions(expired);
+    applyOutputs(relayState & ~expired, now);
+  }
+}
+
+void ActuatorManager::enforceDutyLimits(unsigned long now) {
+  ActuatorMask running = relayState & dutyLimitedMask;
+  if (running == 0) return;
+  
+  ActuatorMask exhausted = 0;
+  for (uint8_t id = 0; id < ACTUATOR_COUNT; id++) {
+    if ((running & ACTUATOR_BIT(id)) && dutyExhausted((ActuatorId)id)) {
+      exhausted |= ACTUATOR_BIT(id);
+      Serial.print("⚠️ ");
+      Serial.print(actuatorTable[id].name);
+      Serial.println(": Duty cycle limit reached, forcing OFF");
     }
   }
   
-  if (state.pumpIrrigation != turnOn) {
-    digitalWrite(PUMP_IRRIGATION_PIN, turnOn ? HIGH : LOW);
-    state.pumpIrrigation = turnOn;
-    state.lastPumpChange = now;
-    
-    if (turnOn) {
-      state.pumpOnTime = now;
-    }
-    
-    Serial.print("✓ Irrigation Pump: ");
-    Serial.println(turnOn ? "ON" : "OFF");
+  if (exhausted != 0) {
+    cancelActions(exhausted);
+    applyOutputs(relayState & ~exhausted, now);
   }
 }
 
+void ActuatorManager::setActuator(ActuatorId id, bool turnOn) {
+  if (id >= ACTUATOR_COUNT) return;
+  
+  ActuatorMask bit = ACTUATOR_BIT(id);
+  command(turnOn ? bit : 0, turnOn ? 0 : bit);
+}
+
+// ============================================================================
+// INDIVIDUAL ACTUATOR CONTROL
+// ============================================================================
+
+void ActuatorManager::setHeater(bool primary, bool turnOn) {
+  setActuator(primary ? ACTUATOR_HEATER_PRIMARY : ACTUATOR_HEATER_SECONDARY, turnOn);
+}
+
+void ActuatorManager::setFan(bool exhaust, bool turnOn) {
+  setActuator(exhaust ? ACTUATOR_FAN_EXHAUST : ACTUATOR_FAN_CIRCULATION, turnOn);
+}
+
+void ActuatorManager::setPump(bool turnOn) {
+  setActuator(ACTUATOR_PUMP, turnOn);
+}
+
 void ActuatorManager::setLight(bool turnOn) {
-  if (state.lightGrow != turnOn) {
-    digitalWrite(LIGHT_GROW_PIN, turnOn ? HIGH : LOW);
-    state.lightGrow = turnOn;
-    Serial.print("✓ Grow Lights: ");
-    Serial.println(turnOn ? "ON" : "OFF");
-  }
+  setActuator(ACTUATOR_LIGHT, turnOn);
 }
 
 // ============================================================================
@@ -246,44 +340,32 @@ void ActuatorManager::handleEmergency(EmergencyType type) {
 void ActuatorManager::emergencyLowTemperature() {
   Serial.println("🔥 EMERGENCY: Low Temperature - Activating Heat");
   
-  // Turn off cooling systems
-  setFan(true, false);   // Exhaust fan OFF
-  
-  // Enable all heating
-  setHeater(true, true);   // Primary heater ON
-  setHeater(false, true);  // Secondary heater ON (backup)
-  
-  // Enable circulation to distribute heat
-  setFan(false, true);  // Circulation fan ON
+  // Exhaust fan OFF; both heaters (secondary as backup) and circulation
+  // ON to distribute heat - one pass, the OFF clears the heater interlock
+  switchOutputs(ACTUATOR_MASK_HEATERS | ACTUATOR_BIT(ACTUATOR_FAN_CIRCULATION),
+                ACTUATOR_BIT(ACTUATOR_FAN_EXHAUST));
 }
 
 void ActuatorManager::emergencyHighTemperature() {
   Serial.println("❄️ EMERGENCY: High Temperature - Activating Cooling");
   
-  // Turn off all heating immediately
-  setHeater(true, false);
-  setHeater(false, false);
-  
-  // Maximum ventilation
-  setFan(true, true);   // Exhaust fan ON
-  setFan(false, true);  // Circulation fan ON
-  
-  // Turn off grow lights (heat source)
-  setLight(false);
+  // All heating and the grow lights (heat source) OFF immediately, then
+  // maximum ventilation
+  switchOutputs(ACTUATOR_BIT(ACTUATOR_FAN_EXHAUST) | ACTUATOR_BIT(ACTUATOR_FAN_CIRCULATION),
+                ACTUATOR_MASK_HEATERS | ACTUATOR_BIT(ACTUATOR_LIGHT));
 }
 
 void ActuatorManager::emergencySecurityBreach() {
   Serial.println("🚨 EMERGENCY: Security Breach Detected");
   
   // Turn on all lights
-  setLight(true);
+  switchOutputs(ACTUATOR_BIT(ACTUATOR_LIGHT), 0);
   
-  // Activate alarm (if available)
+  // Activate alarm (if available) - 5 × 200 ms beeps, 300 ms apart
   #ifdef BUZZER_PIN
   pinMode(BUZZER_PIN, OUTPUT);
   for (int i = 0; i < 5; i++) {
-    tone(BUZZER_PIN, 2000, 200);
-    delay(300);
+    scheduleAction(ACTION_TONE, false, true, i * 300UL, 2000, 200);
   }
   #endif
   
@@ -294,7 +376,7 @@ void ActuatorManager::emergencyWaterLeak() {
   Serial.println("💧 EMERGENCY: Water Leak - Disabling Irrigation");
   
   // Immediately stop irrigation
-  setPump(false);
+  switchOutputs(0, ACTUATOR_BIT(ACTUATOR_PUMP));
   
   // Keep other systems running
 }
@@ -302,49 +384,52 @@ void ActuatorManager::emergencyWaterLeak() {
 void ActuatorManager::emergencyPowerFailure() {
   Serial.println("⚡ EMERGENCY: Power Failure - UPS Mode");
   
-  // Disable high-power consumers
-  setHeater(true, false);
-  setHeater(false, false);
-  setLight(false);
-  
-  // Keep only critical sensors and minimal ventilation
-  setFan(false, true);  // Circulation only
+  // Disable high-power consumers; keep only critical sensors and minimal
+  // ventilation (circulation only)
+  switchOutputs(ACTUATOR_BIT(ACTUATOR_FAN_CIRCULATION),
+                ACTUATOR_MASK_HEATERS | ACTUATOR_BIT(ACTUATOR_LIGHT));
 }
 
 // ============================================================================
 // WARNING LEVEL RESPONSES (Non-Emergency)
 // ============================================================================
 
-void ActuatorManager::handleWarning(AnomalyType type) {
-  Serial.print("⚠️ WARNING: Anomaly type ");
-  Serial.print(type);
+void ActuatorManager::handleWarning(AnomalySet anomalies) {
+  Serial.print("⚠️ WARNING: Anomaly set 0x");
+  Serial.print(anomalies, HEX);
   Serial.println(" - Adjusting controls");
   
-  switch (type) {
-    case TEMP_TOO_LOW:
-      setHeater(true, true);
-      break;
-      
-    case TEMP_TOO_HIGH:
-      setFan(true, true);
-      setLight(false);
-      break;
-      
-    case HUMIDITY_TOO_LOW:
-      // Reduce ventilation
-      setFan(true, false);
-      break;
-      
-    case HUMIDITY_TOO_HIGH:
-      // Increase ventilation
-      setFan(true, true);
-      setFan(false, true);
-      break;
-      
-    default:
-      // No automated response for other anomaly types
-      break;
+  bool tooCold = anomalies & ANOMALY_BIT(TEMP_TOO_LOW);
+  bool tooHot = anomalies & ANOMALY_BIT(TEMP_TOO_HIGH);
+  bool tooDry = anomalies & ANOMALY_BIT(HUMIDITY_TOO_LOW);
+  bool tooHumid = anomalies & ANOMALY_BIT(HUMIDITY_TOO_HIGH);
+  
+  ActuatorMask turnOn = 0;
+  ActuatorMask turnOff = 0;
+  
+  if (tooCold) {
+    turnOn |= ACTUATOR_BIT(ACTUATOR_HEATER_PRIMARY);
+  }
+  
+  // Temperature outranks humidity when they disagree on the exhaust fan
+  if (tooHot || tooHumid) {
+    turnOn |= ACTUATOR_BIT(ACTUATOR_FAN_EXHAUST);
+  } else if (tooDry) {
+    // Reduce ventilation
+    turnOff |= ACTUATOR_BIT(ACTUATOR_FAN_EXHAUST);
+  }
+  
+  if (tooHumid) {
+    // Increase ventilation
+    turnOn |= ACTUATOR_BIT(ACTUATOR_FAN_CIRCULATION);
+  }
+  
+  if (tooHot) {
+    turnOff |= ACTUATOR_BIT(ACTUATOR_LIGHT);
   }
+  
+  // No automated response for other anomaly types
+  command(turnOn, turnOff);
 }
 
 // ============================================================================
@@ -354,62 +439,303 @@ void ActuatorManager::handleWarning(AnomalyType type) {
 void ActuatorManager::stopAll() {
   Serial.println("⏹ Stopping all actuators...");
   
-  setHeater(true, false);
-  setHeater(false, false);
-  setFan(true, false);
-  setFan(false, false);
-  setPump(false);
-  setLight(false);
+  // Drop pending sequences so nothing re-enables after the stop
+  deferredCount = 0;
+  
+  // Every relay OFF in one output pass - no per-actuator checks
+  applyOutputs(0, millis());
   
   Serial.println("✓ All actuators stopped");
 }
 
+void ActuatorManager::setDryRun(bool enabled) {
+  if (enabled == dryRun) return;
+  
+  // The shadow starts from the real outputs
+  dryRun = enabled;
+  shadowState = relayState;
+  if (enabled) shadowSwitches = 0;
+}
+
+bool ActuatorManager::isDryRun() {
+  return dryRun;
+}
+
+ActuatorMask ActuatorManager::getShadowState() {
+  return shadowState;
+}
+
+uint32_t ActuatorManager::getShadowSwitches() {
+  return shadowSwitches;
+}
+
 void ActuatorManager::printStatus() {
   Serial.println("\n=== Actuator Status ===");
-  Serial.print("Heater Primary:    ");
-  Serial.println(state.heaterPrimary ? "ON" : "OFF");
-  Serial.print("Heater Secondary:  ");
-  Serial.println(state.heaterSecondary ? "ON" : "OFF");
-  Serial.print("Fan Exhaust:       ");
-  Serial.println(state.fanExhaust ? "ON" : "OFF");
-  Serial.print("Fan Circulation:   ");
-  Serial.println(state.fanCirculation ? "ON" : "OFF");
-  Serial.print("Irrigation Pump:   ");
-  Serial.println(state.pumpIrrigation ? "ON" : "OFF");
-  Serial.print("Grow Lights:       ");
-  Serial.println(state.lightGrow ? "ON" : "OFF");
-  
-  // Show duty cycles
+  
   unsigned long now = millis();
-  if (state.heaterPrimary) {
-    Serial.print("Heater run time:   ");
-    Serial.print((now - state.heaterOnTime) / 1000);
-    Serial.println(" seconds");
-  }
-  if (state.pumpIrrigation) {
-    Serial.print("Pump run time:     ");
-    Serial.print((now - state.pumpOnTime) / 1000);
-    Serial.println(" seconds");
+  for (uint8_t id = 0; id < ACTUATOR_COUNT; id++) {
+    const char* name = actuatorTable[id].name;
+    Serial.print(name);
+    Serial.print(":");
+    for (size_t pad = strlen(name) + 1; pad < 19; pad++) Serial.print(" ");
+    
+    if (relayState & ACTUATOR_BIT(id)) {
+      // Current run time
+      Serial.print("ON (");
+      Serial.print((now - onSince[id]) / 1000);
+      Serial.print(" s)");
+    } else {
+      Serial.print("OFF");
+    }
+    
+    // Rolling duty and energy
+    Serial.print("  1h ");
+    Serial.print((int)(getDutyCycle((ActuatorId)id, DUTY_WINDOW_HOUR) * 100.0f + 0.5f));
+    Serial.print("% ");
+    Serial.print(getEnergyKwh((ActuatorId)id, DUTY_WINDOW_HOUR), 2);
+    Serial.print(" kWh, 24h ");
+    Serial.print((int)(getDutyCycle((ActuatorId)id, DUTY_WINDOW_DAY) * 100.0f + 0.5f));
+    Serial.print("% ");
+    Serial.print(getEnergyKwh((ActuatorId)id, DUTY_WINDOW_DAY), 2);
+    Serial.print(" kWh");
+    if (dutyExhausted((ActuatorId)id)) Serial.print(" [duty limit]");
+    Serial.println();
   }
   Serial.println();
 }
 
+// ============================================================================
+// DEFERRED ACTION QUEUE
+// ============================================================================
+
+bool ActuatorManager::scheduleAction(DeferredActionType type, uint8_t actuator, bool turnOn,
+                                     unsigned long delayMs, uint16_t frequency, uint16_t durationMs) {
+  if (deferredCount >= MAX_DEFERRED_ACTIONS) {
+    Serial.println("⚠️ Actuator: Deferred action queue full, dropping action");
+    return false;
+  }
+  
+  DeferredAction& action = deferredQueue[deferredCount++];
+  action.type = type;
+  action.actuator = actuator;
+  action.state = turnOn;
+  action.frequency = frequency;
+  action.durationMs = durationMs;
+  action.dueAt = millis() + delayMs;
+  return true;
+}
+
+void ActuatorManager::cancelActions(ActuatorMask actuators) {
+  for (uint8_t i = 0; i < deferredCount; ) {
+    if (deferredQueue[i].type == ACTION_SET_ACTUATOR &&
+        (actuators & ACTUATOR_BIT(deferredQueue[i].actuator))) {
+      deferredQueue[i] = deferredQueue[--deferredCount];
+    } else {
+      i++;
+    }
+  }
+}
+
+void ActuatorManager::tick() {
+  unsigned long now = millis();
+  
+  // Operator commands first - a stop must beat any pending sequence step
+  while (!commandQueue.isEmpty()) {
+    ActuatorCommand command = commandQueue.at(0);
+    commandQueue.consume(1);
+    applyCommand(command);
+  }
+  
+  for (uint8_t i = 0; i < deferredCount; ) {
+    if ((long)(now - deferredQueue[i].dueAt) >= 0) {
+      // Remove before executing - the action may queue follow-ups
+      DeferredAction action = deferredQueue[i];
+      deferredQueue[i] = deferredQueue[--deferredCount];
+      executeAction(action);
+    } else {
+      i++;
+    }
+  }
+  
+  // Mask tests first - nothing to scan unless a limited relay is ON
+  accountOnTime(now);
+  enforceRunLimits(now);
+  enforceDutyLimits(now);
+}
+
+unsigned long ActuatorManager::msUntilNextAction() {
+  unsigned long now = millis();
+  unsigned long soonest = 0xFFFFFFFFUL;
+  
+  if (!commandQueue.isEmpty()) return 0;
+  
+  for (uint8_t i = 0; i < deferredCount; i++) {
+    long remaining = (long)(deferredQueue[i].dueAt - now);
+    if (remaining <= 0) return 0;
+    if ((unsigned long)remaining < soonest) soonest = remaining;
+  }
+  return soonest;
+}
+
+void ActuatorManager::executeAction(const DeferredAction& action) {
+  switch (action.type) {
+    case ACTION_SET_ACTUATOR:
+      // Second step of a real command - never shadowed
+      switchOutputs(action.state ? ACTUATOR_BIT(action.actuator) : 0,
+                    action.state ? 0 : ACTUATOR_BIT(action.actuator));
+      break;
+      
+    case ACTION_TONE:
+      #ifdef BUZZER_PIN
+      tone(BUZZER_PIN, action.frequency, action.durationMs);
+      #endif
+      break;
+  }
+}
+
+// ============================================================================
+// OPERATOR COMMAND QUEUE
+// ============================================================================
+
+bool ActuatorManager::queueCommand(const ActuatorCommand& command) {
+  // Reject rather than overwrite - dropping an older queued command
+  // (e.g. a stop) would be worse than refusing a new one
+  if (commandQueue.isFull()) {
+    Serial.println("⚠️ Actuator: Command queue full, dropping command");
+    return false;
+  }
+  
+  commandQueue.push(command);
+  return true;
+}
+
+void ActuatorManager::applyCommand(const ActuatorCommand& command) {
+  Serial.print("📥 Operator command (");
+  Serial.print(millis() - command.receivedAt);
+  Serial.println(" ms queued)");
+  
+  // Actuator targets share ActuatorId values
+  // An operator drives the real relays even during a dry run
+  if (command.target == CMD_STOP_ALL) {
+    stopAll();
+  } else if (command.target < CMD_STOP_ALL) {
+    ActuatorMask bit = ACTUATOR_BIT(command.target);
+    switchOutputs(command.state ? bit : 0, command.state ? 0 : bit);
+  }
+}
+
+// ============================================================================
+// DUTY-CYCLE AND ENERGY ACCOUNTING
+// ============================================================================
+
+// Rotate one bucket ring up to now, zeroing the buckets it moves into.
+// Buckets are [ACTUATOR_COUNT][count], flattened.
+static void advanceBuckets(uint32_t* buckets, uint8_t count, unsigned long length,
+                           uint8_t& index, unsigned long& start, unsigned long now) {
+  for (uint8_t step = 0; now - start >= length; step++) {
+    if (step >= count) {
+      start = now;       // Longer gap than the window - every bucket is clear
+      break;
+    }
+    index = (index + 1) % count;
+    start += length;
+    for (uint8_t id = 0; id < ACTUATOR_COUNT; id++) {
+      buckets[id * count + index] = 0;
+    }
+  }
+}
+
+void ActuatorManager::accountOnTime(unsigned long now) {
+  unsigned long elapsed = now - dutyAccountedAt;
+  dutyAccountedAt = now;
+  
+  advanceBuckets(&dutyHourBuckets[0][0], DUTY_HOUR_BUCKETS, DUTY_HOUR_BUCKET_MS,
+                 dutyHourIndex, dutyHourStart, now);
+  advanceBuckets(&dutyDayBuckets[0][0], DUTY_DAY_BUCKETS, DUTY_DAY_BUCKET_MS,
+                 dutyDayIndex, dutyDayStart, now);
+  
+  if (relayState == 0 || elapsed == 0) return;
+  
+  // Called every tick(), so an interval crossing a bucket edge is at most
+  // one loop long - it is booked to the newer bucket
+  for (uint8_t id = 0; id < ACTUATOR_COUNT; id++) {
+    if (!(relayState & ACTUATOR_BIT(id))) continue;
+    dutyHourBuckets[id][dutyHourIndex] += elapsed;
+    dutyDayBuckets[id][dutyDayIndex] += elapsed;
+    onTimeTotal[id] += elapsed;
+  }
+}
+
+bool ActuatorManager::dutyExhausted(ActuatorId id) {
+  if (!(dutyLimitedMask & ACTUATOR_BIT(id))) return false;
+  
+  float limitMs = actuatorTable[id].maxDuty * dutyHourLength;
+  return getOnTime(id, DUTY_WINDOW_HOUR) >= limitMs;
+}
+
+unsigned long ActuatorManager::getOnTime(ActuatorId id, DutyWindow window) {
+  if (id >= ACTUATOR_COUNT) return 0;
+  accountOnTime(millis());
+  
+  unsigned long total = 0;
+  if (window == DUTY_WINDOW_HOUR) {
+    for (uint8_t i = 0; i < DUTY_HOUR_BUCKETS; i++) total += dutyHourBuckets[id][i];
+  } else {
+    for (uint8_t i = 0; i < DUTY_DAY_BUCKETS; i++) total += dutyDayBuckets[id][i];
+  }
+  return total;
+}
+
+float ActuatorManager::getDutyCycle(ActuatorId id, DutyWindow window) {
+  return (float)getOnTime(id, window) / getWindowLength(window);
+}
+
+float ActuatorManager::getEnergyKwh(ActuatorId id, DutyWindow window) {
+  return energyKwh(id, getOnTime(id, window));
+}
+
+void ActuatorManager::getUsage(ActuatorUsage& usage) {
+  accountOnTime(millis());
+  memcpy(usage.onTimeMs, onTimeTotal, sizeof(usage.onTimeMs));
+}
+
+float ActuatorManager::energyKwh(ActuatorId id, unsigned long onTimeMs) {
+  if (id >= ACTUATOR_COUNT) return 0.0f;
+  return (float)actuatorTable[id].watts * onTimeMs / 3600000000.0f;
+}
+
+unsigned long ActuatorManager::getWindowLength(DutyWindow window) {
+  return window == DUTY_WINDOW_HOUR ? dutyHourLength : dutyDayLength;
+}
+
 // ============================================================================
 // GETTERS FOR STATE
 // ============================================================================
 
+ActuatorMask ActuatorManager::getState() {
+  return relayState;
+}
+
+bool ActuatorManager::isOn(ActuatorId id) {
+  return (relayState & ACTUATOR_BIT(id)) != 0;
+}
+
+const ActuatorConfig& ActuatorManager::getConfig(ActuatorId id) {
+  return actuatorTable[id];
+}
+
 bool ActuatorManager::isHeaterOn(bool primary) {
-  return primary ? state.heaterPrimary : state.heaterSecondary;
+  return isOn(primary ? ACTUATOR_HEATER_PRIMARY : ACTUATOR_HEATER_SECONDARY);
 }
 
 bool ActuatorManager::isFanOn(bool exhaust) {
-  return exhaust ? state.fanExhaust : state.fanCirculation;
+  return isOn(exhaust ? ACTUATOR_FAN_EXHAUST : ACTUATOR_FAN_CIRCULATION);
 }
 
 bool ActuatorManager::isPumpOn() {
-  return state.pumpIrrigation;
+  return isOn(ACTUATOR_PUMP);
 }
 
 bool ActuatorManager::isLightOn() {
-  return state.lightGrow;
+  return isOn(ACTUATOR_LIGHT);
 }
@@ -2,6 +2,24 @@
  * GreenOS - Actuator Manager
  * 
  * Handles control of all greenhouse actuators with safety features
+ *
+ * Actuators are rows of a static table (pin, polarity, minimum cycle,
+ * maximum run, interlock mask). Relay state is one ActuatorMask; a
+ * command is a pair of on/off masks checked in one pass and applied with
+ * a single write pass over the pins that actually changed. Adding a zone
+ * means one ActuatorId and one table row.
+ *
+ * Every ON interval is accounted into per-actuator on-time buckets: a
+ * rolling hour (5-minute buckets) and a rolling day (1-hour buckets),
+ * plus a wrapping since-boot total that rollups difference per window.
+ * Rows with a maxDuty below 1 are refused ON, and forced OFF, once their
+ * rolling-hour on-time reaches the cap. Energy is estimated from the
+ * row's rated wattage (relay ON = full rated draw).
+ *
+ * Dry run (trace replay): command() and the controllers built on it only
+ * move a shadow mask - no pin writes, timers or on-time accounting.
+ * Operator commands, deferred steps, emergency protocols and the run and
+ * duty limits always act on the real relays.
  */
 
 #ifndef ACTUATOR_MANAGER_H
@@ -9,6 +27,7 @@
 
 #include <Arduino.h>
 #include "anomaly_detection.h"
+#include "ring_buffer.h"
 
 enum EmergencyType {
   LOW_TEMP,
@@ -18,11 +37,146 @@ enum EmergencyType {
   POWER_FAILURE
 };
 
+// ============================================================================
+// SAFETY LIMITS (override in config.h)
+// ============================================================================
+
+#ifndef MIN_CYCLE_TIME_MS
+#define MIN_CYCLE_TIME_MS 60000      // Minimum 1 minute between state changes
+#endif
+#ifndef HEATER_DISENGAGE_MS
+#define HEATER_DISENGAGE_MS 1000     // Settle time between heaters OFF and exhaust fan ON
+#endif
+#ifndef MAX_HEATER_DUTY_CYCLE
+#define MAX_HEATER_DUTY_CYCLE 0.8    // Maximum 80% duty cycle
+#endif
+#ifndef MAX_PUMP_RUN_TIME_MS
+#define MAX_PUMP_RUN_TIME_MS 600000  // Maximum 10 minutes continuous run
+#endif
+
+// ============================================================================
+// RATED POWER (override in config.h)
+// ============================================================================
+
+#ifndef HEATER_PRIMARY_WATTS
+#define HEATER_PRIMARY_WATTS 1500
+#endif
+#ifndef HEATER_SECONDARY_WATTS
+#define HEATER_SECONDARY_WATTS 1500
+#endif
+#ifndef FAN_EXHAUST_WATTS
+#define FAN_EXHAUST_WATTS 120
+#endif
+#ifndef FAN_CIRCULATION_WATTS
+#define FAN_CIRCULATION_WATTS 40
+#endif
+#ifndef PUMP_IRRIGATION_WATTS
+#define PUMP_IRRIGATION_WATTS 250
+#endif
+#ifndef LIGHT_GROW_WATTS
+#define LIGHT_GROW_WATTS 600
+#endif
+
+// ============================================================================
+// DUTY-CYCLE ACCOUNTING
+// ============================================================================
+
+#define DUTY_HOUR_BUCKET_MS 300000UL     // Rolling hour: 12 × 5 min
+#define DUTY_HOUR_BUCKETS 12
+#define DUTY_DAY_BUCKET_MS 3600000UL     // Rolling day: 24 × 1 h
+#define DUTY_DAY_BUCKETS 24
+
+// The window includes the current, partly elapsed bucket, so it spans
+// between (buckets - 1) and buckets full periods
+enum DutyWindow {
+  DUTY_WINDOW_HOUR,
+  DUTY_WINDOW_DAY
+};
+
+// ============================================================================
+// ACTUATOR TABLE
+// ============================================================================
+
+enum ActuatorId {
+  ACTUATOR_HEATER_PRIMARY,
+  ACTUATOR_HEATER_SECONDARY,
+  ACTUATOR_FAN_EXHAUST,
+  ACTUATOR_FAN_CIRCULATION,
+  ACTUATOR_PUMP,
+  ACTUATOR_LIGHT,
+  ACTUATOR_COUNT
+};
+
+typedef uint8_t ActuatorMask;   // Bit per ActuatorId, 1 = ON
+#define ACTUATOR_BIT(id) ((ActuatorMask)(1U << (id)))
+#define ACTUATOR_MASK_ALL ((ActuatorMask)((1U << ACTUATOR_COUNT) - 1))
+#define ACTUATOR_MASK_HEATERS (ACTUATOR_BIT(ACTUATOR_HEATER_PRIMARY) | ACTUATOR_BIT(ACTUATOR_HEATER_SECONDARY))
+
+struct ActuatorConfig {
+  const char* name;
+  uint8_t pin;
+  bool activeLow;              // Relay energised by a LOW output
+  unsigned long minCycleMs;    // After a change, no switching ON again before this
+  unsigned long maxRunMs;      // Forced OFF after this long ON (0 = no limit)
+  ActuatorMask interlock;      // Must all be OFF for this actuator to turn ON
+  uint16_t settleMs;           // >0: switch interlocked ones OFF, turn ON after this; 0: refuse
+  uint16_t watts;              // Rated draw when ON (energy estimate)
+  float maxDuty;               // Share of the rolling hour it may be ON (1 = no limit)
+};
+
+// Since-boot on-time per actuator, wrapping at 2^32 ms. Take differences
+// between two snapshots; never read an absolute value.
+struct ActuatorUsage {
+  uint32_t onTimeMs[ACTUATOR_COUNT];
+};
+
+// Deferred actions let multi-step sequences (interlock settle time, alarm
+// patterns) run from tick() instead of blocking in delay()
+enum DeferredActionType {
+  ACTION_SET_ACTUATOR,
+  ACTION_TONE
+};
+
+struct DeferredAction {
+  DeferredActionType type;
+  uint8_t actuator;          // ActuatorId (ACTION_SET_ACTUATOR only)
+  bool state;
+  uint16_t frequency;        // ACTION_TONE only
+  uint16_t durationMs;       // ACTION_TONE only
+  unsigned long dueAt;       // millis()
+};
+
+#define MAX_DEFERRED_ACTIONS 8
+
+// Operator commands from the cloud command stream, applied by tick()
+enum CommandTarget {
+  CMD_HEATER_PRIMARY = ACTUATOR_HEATER_PRIMARY,
+  CMD_HEATER_SECONDARY = ACTUATOR_HEATER_SECONDARY,
+  CMD_FAN_EXHAUST = ACTUATOR_FAN_EXHAUST,
+  CMD_FAN_CIRCULATION = ACTUATOR_FAN_CIRCULATION,
+  CMD_PUMP = ACTUATOR_PUMP,
+  CMD_LIGHT = ACTUATOR_LIGHT,
+  CMD_STOP_ALL = ACTUATOR_COUNT
+};
+
+struct ActuatorCommand {
+  CommandTarget target;
+  bool state;
+  unsigned long receivedAt;  // millis() when parsed off the stream
+};
+
+#define MAX_QUEUED_COMMANDS 8
+
 class ActuatorManager {
 public:
   ActuatorManager();
   void init();
   
+  // Table-driven control: switch turnOff OFF and turnOn ON in one pass
+  // (cycle-time and interlock checks per bit, one output write pass)
+  void command(ActuatorMask turnOn, ActuatorMask turnOff);
+  void setActuator(ActuatorId id, bool state);
+  
   // Individual control
   void setHeater(bool primary, bool state);
   void setFan(bool exhaust, bool state);
@@ -31,19 +185,83 @@ public:
   
   // Emergency and warning responses
   void handleEmergency(EmergencyType type);
-  void handleWarning(AnomalyType type);
+  void handleWarning(AnomalySet anomalies);   // Whole set, one pass
   
   // System control
   void stopAll();
   void printStatus();
   
+  // Dry run: automatic control switches a shadow mask instead of relays
+  void setDryRun(bool enabled);
+  bool isDryRun();
+  ActuatorMask getShadowState();
+  uint32_t getShadowSwitches();      // Shadow relay changes since setDryRun(true)
+  
+  // Deferred action and command queues - call tick() every loop()
+  void tick();
+  bool queueCommand(const ActuatorCommand& command);
+  unsigned long msUntilNextAction();
+  
   // State queries
+  ActuatorMask getState();
+  bool isOn(ActuatorId id);
+  static const ActuatorConfig& getConfig(ActuatorId id);
   bool isHeaterOn(bool primary);
   bool isFanOn(bool exhaust);
   bool isPumpOn();
   bool isLightOn();
   
+  // Duty-cycle and energy accounting (updated by tick() and every switch)
+  unsigned long getOnTime(ActuatorId id, DutyWindow window);
+  float getDutyCycle(ActuatorId id, DutyWindow window);
+  float getEnergyKwh(ActuatorId id, DutyWindow window);
+  void getUsage(ActuatorUsage& usage);
+  static float energyKwh(ActuatorId id, unsigned long onTimeMs);
+  static unsigned long getWindowLength(DutyWindow window);
+  
 private:
+  ActuatorMask relayState;           // Outputs as last written
+  ActuatorMask switchedMask;         // Changed at least once since boot (cycle timer armed)
+  ActuatorMask runLimitedMask;       // Rows with a maxRunMs, checked every tick()
+  unsigned long lastChange[ACTUATOR_COUNT];
+  unsigned long onSince[ACTUATOR_COUNT];
+
+  // On-time accounting: ms ON per bucket, rings indexed by the current bucket
+  ActuatorMask dutyLimitedMask;      // Rows with a maxDuty below 1
+  uint32_t dutyHourBuckets[ACTUATOR_COUNT][DUTY_HOUR_BUCKETS];
+  uint32_t dutyDayBuckets[ACTUATOR_COUNT][DUTY_DAY_BUCKETS];
+  uint32_t onTimeTotal[ACTUATOR_COUNT];
+  uint8_t dutyHourIndex;
+  uint8_t dutyDayIndex;
+  unsigned long dutyHourStart;
+  unsigned long dutyDayStart;
+  unsigned long dutyAccountedAt;
+
+  // Pending timed actions (unordered - tick() scans all, N is tiny)
+  DeferredAction deferredQueue[MAX_DEFERRED_ACTIONS];
+  uint8_t deferredCount;
+
+  // Operator commands waiting for tick() (FIFO, new commands rejected when full)
+  RingBuffer<ActuatorCommand, MAX_QUEUED_COMMANDS> commandQueue;
+
+  // Dry run: what automatic control would have done to the relays
+  bool dryRun;
+  ActuatorMask shadowState;
+  uint32_t shadowSwitches;
+
+  bool scheduleAction(DeferredActionType type, uint8_t actuator, bool state,
+                      unsigned long delayMs, uint16_t frequency = 0, uint16_t durationMs = 0);
+  void cancelActions(ActuatorMask actuators);
+  void switchOutputs(ActuatorMask turnOn, ActuatorMask turnOff);
+  void switchShadow(ActuatorMask turnOn, ActuatorMask turnOff);
+  void applyOutputs(ActuatorMask next, unsigned long now);
+  void enforceRunLimits(unsigned long now);
+  void accountOnTime(unsigned long now);
+  bool dutyExhausted(ActuatorId id);
+  void enforceDutyLimits(unsigned long now);
+  void executeAction(const DeferredAction& action);
+  void applyCommand(const ActuatorCommand& command);
+  
   // Emergency protocols
   void emergencyLowTemperature();
   void emergencyHighTemperature();
@@ -0,0 +1,106 @@
+/**
+ * GreenOS - Background ADC Sampler Implementation
+ */
+
+#include "adc_sampler.h"
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+AdcSampler::AdcSampler() {
+  channelCount = 0;
+  lastScan = 0;
+  scanCount = 0;
+}
+
+int8_t AdcSampler::addChannel(uint8_t pin) {
+  if (channelCount >= ADC_SAMPLER_MAX_CHANNELS) {
+    return -1;
+  }
+
+  Channel& channel = channels[channelCount];
+  channel.pin = pin;
+  restart(channelCount);
+  return channelCount++;
+}
+
+void AdcSampler::restart(uint8_t channel) {
+  channels[channel].head = 0;
+  channels[channel].count = 0;
+  channels[channel].sum = 0;
+}
+
+// ============================================================================
+// ACQUISITION
+// ============================================================================
+
+void AdcSampler::service() {
+  unsigned long now = millis();
+  if (scanCount > 0 && now - lastScan < ADC_SAMPLER_PERIOD_MS) {
+    return;
+  }
+
+  // Late calls take one scan, not a catch-up burst
+  lastScan = now;
+  scanCount++;
+
+  for (uint8_t i = 0; i < channelCount; i++) {
+    acquire(channels[i]);
+  }
+}
+
+unsigned long AdcSampler::msUntilNextScan() {
+  if (channelCount == 0) return ADC_SAMPLER_PERIOD_MS;
+
+  unsigned long elapsed = millis() - lastScan;
+  return (elapsed >= ADC_SAMPLER_PERIOD_MS) ? 0 : ADC_SAMPLER_PERIOD_MS - elapsed;
+}
+
+void AdcSampler::acquire(Channel& channel) {
+  uint16_t raw = analogRead(channel.pin);
+
+  // Running sum: add the new sample, drop the one it replaces
+  if (channel.count == ADC_SAMPLER_WINDOW) {
+    channel.sum -= channel.samples[channel.head];
+  } else {
+    channel.count++;
+  }
+  channel.samples[channel.head] = raw;
+  channel.sum += raw;
+  channel.head = (channel.head + 1) % ADC_SAMPLER_WINDOW;
+}
+
+// ============================================================================
+// READINGS
+// ============================================================================
+
+float AdcSampler::getAverageRaw(uint8_t channel) {
+  Channel& c = channels[channel];
+  if (c.count == 0) {
+    acquire(c);  // Not scanned yet (e.g. first read right after boot)
+  }
+  return c.sum / (float)c.count;
+}
+
+uint16_t AdcSampler::getLatestRaw(uint8_t channel) {
+  const Channel& c = channels[channel];
+  if (c.count == 0) return 0;
+  return c.samples[(c.head + ADC_SAMPLER_WINDOW - 1) % ADC_SAMPLER_WINDOW];
+}
+
+uint16_t AdcSampler::getSampleCount(uint8_t channel) {
+  return channels[channel].count;
+}
+
+bool AdcSampler::isPrimed(uint8_t channel) {
+  return channels[channel].count == ADC_SAMPLER_WINDOW;
+}
+
+uint8_t AdcSampler::getChannelCount() {
+  return channelCount;
+}
+
+uint32_t AdcSampler::getScanCount() {
+  return scanCount;
+}
@@ -0,0 +1,74 @@
+/**
+ * GreenOS - Background ADC Sampler
+ *
+ * Continuous scan of the analog inputs with a running (boxcar) average
+ * per channel. service() converts every registered channel once per
+ * ADC_SAMPLER_PERIOD_MS and updates a fixed sample window and its
+ * running sum, so reading an average is an O(1) lookup instead of a
+ * busy loop of analogRead() + delay.
+ *
+ * The Arduino core on the UNO Q exposes no timer-triggered/DMA ADC
+ * mode, so the scan is paced from SensorManager::poll() and the main
+ * loop wakes for it via msUntilNextScan(). Each scan is a handful of
+ * conversions (tens of microseconds), not a blocking wait.
+ */
+
+#ifndef ADC_SAMPLER_H
+#define ADC_SAMPLER_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+#define ADC_SAMPLER_MAX_CHANNELS 4
+#define ADC_SAMPLER_WINDOW 32          // Samples per running average
+#define ADC_SAMPLER_PERIOD_MS 5        // Scan period (all channels, 200 Hz)
+
+// ============================================================================
+// ADC SAMPLER CLASS
+// ============================================================================
+
+class AdcSampler {
+public:
+  AdcSampler();
+
+  // Register an analog pin; returns its channel index, or -1 if full
+  int8_t addChannel(uint8_t pin);
+
+  // Scan all channels if the period has elapsed - call every loop()
+  void service();
+  unsigned long msUntilNextScan();
+
+  // Running average over the last ADC_SAMPLER_WINDOW samples (raw counts).
+  // Takes one conversion first if the channel has no samples yet.
+  float getAverageRaw(uint8_t channel);
+  uint16_t getLatestRaw(uint8_t channel);
+  uint16_t getSampleCount(uint8_t channel);
+  bool isPrimed(uint8_t channel);      // Window full
+
+  // Drop a channel's history (input reconnected, calibration step)
+  void restart(uint8_t channel);
+
+  uint8_t getChannelCount();
+  uint32_t getScanCount();
+
+private:
+  struct Channel {
+    uint8_t pin;
+    uint8_t head;                      // Next slot to overwrite
+    uint16_t count;                    // Valid samples (<= window)
+    uint32_t sum;                      // Running sum of the window
+    uint16_t samples[ADC_SAMPLER_WINDOW];
+  };
+
+  Channel channels[ADC_SAMPLER_MAX_CHANNELS];
+  uint8_t channelCount;
+  unsigned long lastScan;
+  uint32_t scanCount;
+
+  void acquire(Channel& channel);
+};
+
+#endif // ADC_SAMPLER_H
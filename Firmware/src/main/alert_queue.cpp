@@ -0,0 +1,256 @@
+/**
+ * GreenOS - Alert Queue Implementation
+ */
+
+#include "alert_queue.h"
+
+// ============================================================================
+// POLICY TABLE
+// ============================================================================
+
+// Rows in AnomalyType order. Temperature limits are listed for
+// completeness - they go out through the emergency path.
+static const AlertPolicy policyTable[ANOMALY_TYPE_COUNT] = {
+  // severity        holdDownMs  escalateAfterMs
+  {ALERT_LOW,        0,          0},           // NONE
+  {ALERT_CRITICAL,   300000UL,   0},           // TEMP_TOO_LOW
+  {ALERT_CRITICAL,   300000UL,   0},           // TEMP_TOO_HIGH
+  {ALERT_MEDIUM,     1800000UL,  7200000UL},   // HUMIDITY_TOO_LOW (30 min, escalate after 2 h)
+  {ALERT_MEDIUM,     1800000UL,  7200000UL},   // HUMIDITY_TOO_HIGH
+  {ALERT_HIGH,       300000UL,   900000UL},    // MOTION_OFF_HOURS (5 min, escalate after 15 min)
+  {ALERT_MEDIUM,     900000UL,   0},           // LOUD_NOISE
+  {ALERT_HIGH,       300000UL,   600000UL},    // RAPID_TEMP_DROP (escalate after 10 min)
+  {ALERT_MEDIUM,     3600000UL,  14400000UL},  // SENSOR_MALFUNCTION (1 h, escalate after 4 h)
+  {ALERT_LOW,        3600000UL,  0}            // STATISTICAL_DEVIATION
+};
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+AlertQueue::AlertQueue() {
+  reset();
+}
+
+void AlertQueue::reset() {
+  for (uint8_t type = 0; type < ANOMALY_TYPE_COUNT; type++) {
+    Slot& slot = slots[type];
+    slot.entry.type = (AnomalyType)type;
+    slot.entry.severity = policyTable[type].severity;
+    slot.entry.escalated = false;
+    slot.entry.occurrences = 0;
+    slot.entry.firstSeen = 0;
+    slot.entry.lastSeen = 0;
+    slot.entry.text[0] = '\0';
+    slot.active = false;
+    slot.pending = false;
+    slot.reported = false;
+    slot.pendingSince = 0;
+    slot.lastReport = 0;
+  }
+  batch.count = 0;
+
+  batchesSent = 0;
+  alertsReported = 0;
+  detectionsSuppressed = 0;
+  escalations = 0;
+}
+
+// ============================================================================
+// DETECTION INPUT
+// ============================================================================
+
+void AlertQueue::update(AnomalyDetection& detector, AnomalySet anomalies, unsigned long now) {
+  for (uint8_t type = NONE + 1; type < ANOMALY_TYPE_COUNT; type++) {
+    Slot& slot = slots[type];
+    const AlertPolicy& policy = policyTable[type];
+
+    if (!(anomalies & ANOMALY_BIT(type))) {
+      // Cleared - a pending report still goes out once
+      slot.active = false;
+      continue;
+    }
+
+    if (!slot.active) {
+      // New onset: severity and escalation start over
+      slot.active = true;
+      slot.entry.firstSeen = now;
+      slot.entry.severity = policy.severity;
+      slot.entry.escalated = false;
+    }
+    slot.entry.lastSeen = now;
+    if (slot.entry.occurrences < 0xFFFF) slot.entry.occurrences++;
+
+    if (policy.escalateAfterMs > 0 && !slot.entry.escalated &&
+        slot.entry.severity < ALERT_CRITICAL &&
+        now - slot.entry.firstSeen >= policy.escalateAfterMs) {
+      // Persisting condition - one level up, reported without waiting
+      slot.entry.severity = (AlertSeverity)(slot.entry.severity + 1);
+      slot.entry.escalated = true;
+      escalations++;
+      markPending(slot, now);
+    } else if (!slot.pending) {
+      if (!slot.reported || now - slot.lastReport >= policy.holdDownMs) {
+        markPending(slot, now);
+      } else {
+        detectionsSuppressed++;
+      }
+    }
+
+    // Pending text tracks the latest values until it is sent
+    if (slot.pending) {
+      detector.formatDetails((AnomalyType)type, slot.entry.text, sizeof(slot.entry.text));
+    }
+  }
+}
+
+void AlertQueue::markPending(Slot& slot, unsigned long now) {
+  if (!slot.pending) {
+    slot.pending = true;
+    slot.pendingSince = now;
+  }
+}
+
+// ============================================================================
+// BATCHING
+// ============================================================================
+
+const AlertBatch* AlertQueue::takeBatch(unsigned long now) {
+  bool any = false;
+  bool critical = false;
+  unsigned long oldestWait = 0;
+
+  for (uint8_t type = NONE + 1; type < ANOMALY_TYPE_COUNT; type++) {
+    const Slot& slot = slots[type];
+    if (!slot.pending) continue;
+    any = true;
+    if (slot.entry.severity == ALERT_CRITICAL) critical = true;
+    if (now - slot.pendingSince > oldestWait) oldestWait = now - slot.pendingSince;
+  }
+
+  // Nothing pending, or still gathering non-critical alerts
+  if (!any || (!critical && oldestWait < ALERT_COALESCE_MS)) return nullptr;
+
+  // Most severe first, AnomalyType order within a level
+  batch.count = 0;
+  for (int8_t level = ALERT_CRITICAL; level >= ALERT_LOW; level--) {
+    for (uint8_t type = NONE + 1; type < ANOMALY_TYPE_COUNT; type++) {
+      Slot& slot = slots[type];
+      if (!slot.pending || slot.entry.severity != level) continue;
+
+      batch.entries[batch.count++] = slot.entry;
+      slot.pending = false;
+      slot.reported = true;
+      slot.lastReport = now;
+      slot.entry.occurrences = 0;
+    }
+  }
+
+  batchesSent++;
+  alertsReported += batch.count;
+  return &batch;
+}
+
+bool AlertQueue::hasPending() {
+  for (uint8_t type = NONE + 1; type < ANOMALY_TYPE_COUNT; type++) {
+    if (slots[type].pending) return true;
+  }
+  return false;
+}
+
+size_t AlertQueue::formatBatch(const AlertBatch& batch, char* buffer, size_t size) {
+  size_t length = 0;
+  if (size == 0) return 0;
+  buffer[0] = '\0';
+
+  // "[high] Motion detected during off hours: 3 triggers x4; [low] ..."
+  for (uint8_t i = 0; i < batch.count; i++) {
+    const AlertEntry& entry = batch.entries[i];
+    if (i > 0) AnomalyDetection::appendText(buffer, size, length, "; ");
+    AnomalyDetection::appendText(buffer, size, length, "[");
+    AnomalyDetection::appendText(buffer, size, length, getSeverityName(entry.severity));
+    AnomalyDetection::appendText(buffer, size, length, "] ");
+    AnomalyDetection::appendText(buffer, size, length, entry.text);
+
+    // Repeat count since the previous report
+    if (entry.occurrences > 1) {
+      char count[8];
+      ltoa(entry.occurrences, count, 10);
+      AnomalyDetection::appendText(buffer, size, length, " x");
+      AnomalyDetection::appendText(buffer, size, length, count);
+    }
+  }
+  return length;
+}
+
+LoggedAlert AlertQueue::describeBatch(const AlertBatch& batch, uint32_t boot) {
+  LoggedAlert alert;
+  memset(&alert, 0, sizeof(alert));
+  alert.boot = boot;
+  alert.severity = ALERT_SEVERITY_NONE;
+  if (batch.count == 0) return alert;
+
+  // Entries are most severe first
+  alert.severity = batch.entries[0].severity;
+  alert.firstSeen = batch.entries[0].firstSeen;
+  for (uint8_t i = 1; i < batch.count; i++) {
+    if ((long)(batch.entries[i].firstSeen - alert.firstSeen) < 0) {
+      alert.firstSeen = batch.entries[i].firstSeen;
+    }
+  }
+  return alert;
+}
+
+const char* AlertQueue::getSeverityName(AlertSeverity severity) {
+  switch (severity) {
+    case ALERT_LOW:      return "low";
+    case ALERT_MEDIUM:   return "medium";
+    case ALERT_HIGH:     return "high";
+    case ALERT_CRITICAL: return "critical";
+  }
+  return "medium";
+}
+
+uint8_t AlertQueue::parseSeverity(const char* name) {
+  for (uint8_t level = ALERT_LOW; name != nullptr && level <= ALERT_CRITICAL; level++) {
+    if (strcmp(name, getSeverityName((AlertSeverity)level)) == 0) return level;
+  }
+  return ALERT_SEVERITY_NONE;
+}
+
+const AlertPolicy& AlertQueue::getPolicy(AnomalyType type) {
+  return policyTable[type < ANOMALY_TYPE_COUNT ? type : NONE];
+}
+
+// ============================================================================
+// STATUS
+// ============================================================================
+
+void AlertQueue::printStatus() {
+  Serial.println("\n=== Alert Queue ===");
+  Serial.print("Batches sent: ");
+  Serial.print(batchesSent);
+  Serial.print(", alerts: ");
+  Serial.print(alertsReported);
+  Serial.print(", suppressed detections: ");
+  Serial.print(detectionsSuppressed);
+  Serial.print(", escalations: ");
+  Serial.println(escalations);
+
+  unsigned long now = millis();
+  for (uint8_t type = NONE + 1; type < ANOMALY_TYPE_COUNT; type++) {
+    const Slot& slot = slots[type];
+    if (!slot.active && !slot.pending) continue;
+
+    Serial.print(AnomalyDetection::getTypeName((AnomalyType)type));
+    Serial.print(": ");
+    Serial.print(getSeverityName(slot.entry.severity));
+    Serial.print(slot.active ? ", active " : ", cleared, onset ");
+    Serial.print((now - slot.entry.firstSeen) / 1000);
+    Serial.print(" s, ");
+    Serial.print(slot.pending ? "pending" : "held");
+    Serial.print(", x");
+    Serial.println(slot.entry.occurrences);
+  }
+  Serial.println();
+}
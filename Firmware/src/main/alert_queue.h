@@ -0,0 +1,127 @@
+/**
+ * GreenOS - Alert Queue
+ *
+ * Rate-limits non-emergency anomaly alerts on the device. One slot per
+ * AnomalyType (dedup by type), each with a severity and timers from a
+ * static policy table:
+ * - Hold-down: after a type is reported, further detections only count
+ *   occurrences until the hold-down expires
+ * - Escalation: a condition that persists past escalateAfterMs is raised
+ *   one severity level and queued again, ignoring the hold-down
+ *
+ * Reportable slots are coalesced: takeBatch() hands out every pending
+ * alert, most severe first, once the oldest has waited ALERT_COALESCE_MS
+ * - or immediately if one is critical - so a burst of conditions costs
+ * one uplink request and one cloud alert instead of one per detection.
+ *
+ * Emergencies (TEMP_TOO_LOW / TEMP_TOO_HIGH) never enter the queue; the
+ * emergency state sends them directly.
+ */
+
+#ifndef ALERT_QUEUE_H
+#define ALERT_QUEUE_H
+
+#include <Arduino.h>
+#include "anomaly_detection.h"
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+#define ALERT_SERVICE_MS 1000UL        // takeBatch() polling period
+#define ALERT_COALESCE_MS 30000UL      // Max wait for non-critical alerts to batch up
+#define ALERT_TEXT_SIZE 96             // Per-type detail text (truncated)
+#define ALERT_MAX_BATCH (ANOMALY_TYPE_COUNT - 1)
+
+enum AlertSeverity {
+  ALERT_LOW,
+  ALERT_MEDIUM,
+  ALERT_HIGH,
+  ALERT_CRITICAL
+};
+
+// Per-type policy (static table in the .cpp, AnomalyType order)
+struct AlertPolicy {
+  AlertSeverity severity;
+  unsigned long holdDownMs;      // Minimum gap between reports of this type
+  unsigned long escalateAfterMs; // Persisting this long raises severity once (0 = never)
+};
+
+// One reported alert
+struct AlertEntry {
+  AnomalyType type;
+  AlertSeverity severity;
+  bool escalated;
+  uint16_t occurrences;          // Detections since the previous report
+  unsigned long firstSeen;       // millis() at onset of the condition
+  unsigned long lastSeen;        // millis() of the latest detection
+  char text[ALERT_TEXT_SIZE];    // Latest formatDetails() for the type
+};
+
+struct AlertBatch {
+  uint8_t count;
+  AlertEntry entries[ALERT_MAX_BATCH];
+};
+
+#define ALERT_SEVERITY_NONE 0xFF       // LoggedAlert.severity: not known
+
+// Header of an alert kept in the local log (LOG_TYPE_ALERT), followed by
+// its text. firstSeen is only meaningful against the boot it came from.
+struct LoggedAlert {
+  uint32_t firstSeen;            // millis() at onset, in that boot
+  uint32_t boot;                 // Boot id (FirebaseComm::setBootId)
+  uint8_t severity;              // AlertSeverity or ALERT_SEVERITY_NONE
+  uint8_t reserved[3];
+};
+
+// ============================================================================
+// ALERT QUEUE CLASS
+// ============================================================================
+
+class AlertQueue {
+public:
+  AlertQueue();
+  void reset();
+
+  // Feed the set from every detection pass (0 = nothing active). Only
+  // bits in the set are queued; the caller masks out emergency types.
+  void update(AnomalyDetection& detector, AnomalySet anomalies, unsigned long now);
+
+  // Pending alerts to send now, or nullptr while coalescing. Taking a
+  // batch marks its alerts reported whether or not the send succeeds.
+  const AlertBatch* takeBatch(unsigned long now);
+  bool hasPending();
+
+  // One "; "-joined line for the local log when the batch can't be sent
+  static size_t formatBatch(const AlertBatch& batch, char* buffer, size_t size);
+  // Its log header: the top severity and the earliest onset
+  static LoggedAlert describeBatch(const AlertBatch& batch, uint32_t boot);
+  static const char* getSeverityName(AlertSeverity severity);
+  static uint8_t parseSeverity(const char* name);   // ALERT_SEVERITY_NONE if unknown
+  static const AlertPolicy& getPolicy(AnomalyType type);
+
+  void printStatus();
+
+private:
+  struct Slot {
+    AlertEntry entry;
+    bool active;                 // In the latest detection pass
+    bool pending;                // Due in the next batch
+    bool reported;               // Reported at least once (hold-down armed)
+    unsigned long pendingSince;
+    unsigned long lastReport;
+  };
+
+  Slot slots[ANOMALY_TYPE_COUNT];
+  AlertBatch batch;
+
+  // Counters since boot
+  uint32_t batchesSent;
+  uint32_t alertsReported;
+  uint32_t detectionsSuppressed;
+  uint32_t escalations;
+
+  void markPending(Slot& slot, unsigned long now);
+};
+
+#endif // ALERT_QUEUE_H
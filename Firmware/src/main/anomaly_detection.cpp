@@ -0,0 +1,566 @@
+/**
+ * GreenOS - Anomaly Detection Implementation
+ *
+ * Statistics per metric, per sample:
+ * - residual r = x - EWMA (baseline before this sample)
+ * - z = (r - mean(r)) / sd(r), with sd from Welford and floored at the
+ *   sensor's resolution so flat signals do not produce huge z-scores
+ * - outliers are clipped at the spike threshold before entering Welford,
+ *   so a single spike cannot inflate its own baseline variance
+ * - CUSUM: S+ = max(0, S+ + z - k), S- = max(0, S- - z - k), trigger
+ *   and reset when either exceeds h
+ * - rate of change from the oldest of ANOMALY_RATE_SLOTS samples spaced
+ *   across ANOMALY_RATE_WINDOW_MS
+ */
+
+#include "anomaly_detection.h"
+#include "config.h"
+
+// ============================================================================
+// METRIC TUNING
+// ============================================================================
+
+// Indexed by AnomalyMetric
+static const MetricConfig metricConfig[METRIC_COUNT] = {
+  // name             alpha  z     minSd   rate/min
+  {"airTemp",         0.05f, 4.0f, 0.05f,  ANOMALY_RAPID_TEMP_DROP},
+  {"airHumidity",     0.05f, 4.0f, 0.1f,   5.0f},
+  {"co2",             0.05f, 4.0f, 5.0f,   200.0f},
+  {"airQuality",      0.05f, 4.0f, 5.0f,   0.0f},
+  {"substrateTemp",   0.02f, 4.0f, 0.05f,  1.0f},
+  {"vwc",             0.02f, 5.0f, 0.1f,   0.0f},   // Irrigation steps are expected
+  {"ph",              0.02f, 4.0f, 0.01f,  0.0f},
+  {"ec",              0.02f, 4.0f, 0.001f, 0.0f},
+  {"nitrogen",        0.02f, 5.0f, 1.0f,   0.0f},
+  {"phosphorus",      0.02f, 5.0f, 1.0f,   0.0f},
+  {"potassium",       0.02f, 5.0f, 1.0f,   0.0f},
+  {"par",             0.10f, 6.0f, 5.0f,   0.0f},   // Clouds and grow lights
+  {"noiseLevel",      0.10f, 5.0f, 0.005f, 0.0f},
+  {"voltage",         0.05f, 5.0f, 0.01f,  0.5f}
+};
+
+// Most severe first - getAnomalyType() returns the first member present
+static const AnomalyType severityOrder[] = {
+  TEMP_TOO_LOW,
+  TEMP_TOO_HIGH,
+  RAPID_TEMP_DROP,
+  HUMIDITY_TOO_LOW,
+  HUMIDITY_TOO_HIGH,
+  SENSOR_MALFUNCTION,
+  MOTION_OFF_HOURS,
+  LOUD_NOISE,
+  STATISTICAL_DEVIATION
+};
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+AnomalyDetection::AnomalyDetection() {
+  this->offHours = false;
+  setLimits(TEMP_MIN, TEMP_MAX, HUMIDITY_MIN, HUMIDITY_MAX);
+  init();
+}
+
+void AnomalyDetection::init() {
+  activeSet = 0;
+  memset(records, 0, sizeof(records));
+  lastTemp = NAN;
+  lastCheckTime = 0;
+  sampleTime = 0;
+  lastSequence = 0;
+  recentMotionEvents = 0;
+  recentMotionStart = 0;
+  lastMotionSequence = 0;
+
+  for (uint8_t m = 0; m < METRIC_COUNT; m++) {
+    resetMetric((AnomalyMetric)m);
+  }
+}
+
+void AnomalyDetection::resetMetric(AnomalyMetric metric) {
+  MetricStats& s = stats[metric];
+  s.count = 0;
+  s.residualMean = 0.0f;
+  s.residualM2 = 0.0f;
+  s.ewma = NAN;
+  s.last = NAN;
+  s.zScore = 0.0f;
+  s.cusumHigh = 0.0f;
+  s.cusumLow = 0.0f;
+  s.rateHead = 0;
+  s.rateCount = 0;
+  s.ratePerMinute = 0.0f;
+  s.flags = 0;
+}
+
+// ============================================================================
+// MAIN DETECTION
+// ============================================================================
+
+bool AnomalyDetection::detectAnomalies(const SensorData& data) {
+  activeSet = 0;
+  sampleTime = data.timestamp;
+
+  // Each snapshot enters the statistics once, however often we're called
+  if (data.sequence != lastSequence) {
+    lastSequence = data.sequence;
+    for (uint8_t m = 0; m < METRIC_COUNT; m++) {
+      updateMetric((AnomalyMetric)m, metricValue(data, (AnomalyMetric)m), data.timestamp);
+    }
+  }
+
+  // Every check runs - one condition never hides another
+  checkTemperature(data.airTemp);
+  checkRapidChange(data.airTemp);
+  checkHumidity(data.airHumidity);
+  checkSensorHealth(data);
+  checkMotion(data);
+
+  const MetricStats& noise = stats[METRIC_NOISE];
+  if ((noise.flags & METRIC_FLAG_SPIKE) && noise.zScore > 0) {
+    raise(LOUD_NOISE, noise.zScore, metricConfig[METRIC_NOISE].zThreshold, 1 << METRIC_NOISE);
+  }
+
+  // Remaining statistical triggers, collected into one record
+  for (uint8_t m = 0; m < METRIC_COUNT; m++) {
+    uint8_t flags = stats[m].flags;
+
+    // Already reported by a dedicated check
+    if (m == METRIC_NOISE) flags &= ~METRIC_FLAG_SPIKE;
+    if (m == METRIC_AIR_TEMP && stats[m].ratePerMinute < 0) flags &= ~METRIC_FLAG_RATE;
+    if (flags == 0) continue;
+
+    raise(STATISTICAL_DEVIATION, stats[m].zScore, metricConfig[m].zThreshold, 1 << m);
+  }
+
+  lastTemp = data.airTemp;
+  lastCheckTime = data.timestamp;
+
+  return activeSet != 0;
+}
+
+AnomalySet AnomalyDetection::getAnomalySet() {
+  return activeSet;
+}
+
+bool AnomalyDetection::hasAnomaly(AnomalyType type) {
+  return (activeSet & ANOMALY_BIT(type)) != 0;
+}
+
+const AnomalyRecord& AnomalyDetection::getRecord(AnomalyType type) {
+  return records[type];
+}
+
+AnomalyType AnomalyDetection::getAnomalyType() {
+  for (uint8_t i = 0; i < sizeof(severityOrder) / sizeof(severityOrder[0]); i++) {
+    if (hasAnomaly(severityOrder[i])) return severityOrder[i];
+  }
+  return NONE;
+}
+
+void AnomalyDetection::raise(AnomalyType type, float value, float threshold, uint16_t sources) {
+  AnomalyRecord& record = records[type];
+
+  if (!hasAnomaly(type)) {
+    activeSet |= ANOMALY_BIT(type);
+    record.value = value;
+    record.threshold = threshold;
+    record.timestamp = sampleTime;
+    record.sources = sources;
+    return;
+  }
+
+  // Same type from another source - keep the worst value
+  record.sources |= sources;
+  if (fabsf(value) > fabsf(record.value)) {
+    record.value = value;
+    record.threshold = threshold;
+  }
+}
+
+void AnomalyDetection::setLimits(float tempMin, float tempMax, float humidityMin, float humidityMax) {
+  this->tempMin = tempMin;
+  this->tempMax = tempMax;
+  this->humidityMin = humidityMin;
+  this->humidityMax = humidityMax;
+}
+
+void AnomalyDetection::setOffHours(bool offHours) {
+  this->offHours = offHours;
+}
+
+bool AnomalyDetection::isOffHours() {
+  return offHours;
+}
+
+// ============================================================================
+// ABSOLUTE CHECKS
+// ============================================================================
+
+bool AnomalyDetection::checkTemperature(float temp) {
+  if (isnan(temp)) return false;
+
+  if (temp < tempMin) {
+    raise(TEMP_TOO_LOW, temp, tempMin, 1 << METRIC_AIR_TEMP);
+    return true;
+  }
+  if (temp > tempMax) {
+    raise(TEMP_TOO_HIGH, temp, tempMax, 1 << METRIC_AIR_TEMP);
+    return true;
+  }
+  return false;
+}
+
+bool AnomalyDetection::checkHumidity(float humidity) {
+  if (isnan(humidity)) return false;
+
+  if (humidity < humidityMin) {
+    raise(HUMIDITY_TOO_LOW, humidity, humidityMin, 1 << METRIC_AIR_HUMIDITY);
+    return true;
+  }
+  if (humidity > humidityMax) {
+    raise(HUMIDITY_TOO_HIGH, humidity, humidityMax, 1 << METRIC_AIR_HUMIDITY);
+    return true;
+  }
+  return false;
+}
+
+bool AnomalyDetection::checkMotion(const SensorData& data) {
+  // Cycles can be pulled forward by a trigger, so count across them
+  if (data.sequence != lastMotionSequence) {
+    lastMotionSequence = data.sequence;
+    if (data.timestamp - recentMotionStart > ANOMALY_MOTION_WINDOW_MS) {
+      recentMotionEvents = 0;
+      recentMotionStart = data.timestamp;
+    }
+    recentMotionEvents += data.motionEvents;
+  }
+
+  if (!offHours) return false;
+
+  // A single short blip (insect, heat gust) is not presence
+  if (recentMotionEvents >= ANOMALY_MOTION_MIN_EVENTS || data.motionDuty >= ANOMALY_MOTION_MIN_DUTY) {
+    raise(MOTION_OFF_HOURS, recentMotionEvents, ANOMALY_MOTION_MIN_EVENTS, 0);
+    return true;
+  }
+  return false;
+}
+
+bool AnomalyDetection::checkRapidChange(float currentTemp) {
+  const MetricStats& s = stats[METRIC_AIR_TEMP];
+  if (isnan(currentTemp) || s.rateCount < 2) return false;
+
+  if (s.ratePerMinute <= -ANOMALY_RAPID_TEMP_DROP) {
+    raise(RAPID_TEMP_DROP, s.ratePerMinute, -ANOMALY_RAPID_TEMP_DROP, 1 << METRIC_AIR_TEMP);
+    return true;
+  }
+  return false;
+}
+
+bool AnomalyDetection::checkSensorHealth(const SensorData& data) {
+  bool failed = false;
+
+  if (data.scd30ErrorRate > ANOMALY_SENSOR_ERROR_RATE) {
+    raise(SENSOR_MALFUNCTION, data.scd30ErrorRate, ANOMALY_SENSOR_ERROR_RATE, ANOMALY_SOURCE_SCD30);
+    failed = true;
+  }
+  if (data.mq135ErrorRate > ANOMALY_SENSOR_ERROR_RATE) {
+    raise(SENSOR_MALFUNCTION, data.mq135ErrorRate, ANOMALY_SENSOR_ERROR_RATE, ANOMALY_SOURCE_MQ135);
+    failed = true;
+  }
+  if (data.modbusErrorRate > ANOMALY_SENSOR_ERROR_RATE) {
+    raise(SENSOR_MALFUNCTION, data.modbusErrorRate, ANOMALY_SENSOR_ERROR_RATE, ANOMALY_SOURCE_MODBUS);
+    failed = true;
+  }
+  return failed;
+}
+
+// ============================================================================
+// ALERT TEXT (formatted on demand - nothing is built per sample)
+// ============================================================================
+
+// Also used by AlertQueue::formatBatch()
+void AnomalyDetection::appendText(char* buffer, size_t size, size_t& length, const char* text) {
+  while (*text != '\0' && length + 1 < size) {
+    buffer[length++] = *text++;
+  }
+  buffer[length] = '\0';
+}
+
+// Fixed-point decimal without printf float support
+static void appendDecimal(char* buffer, size_t size, size_t& length, float value, uint8_t decimals) {
+  if (isnan(value)) {
+    AnomalyDetection::appendText(buffer, size, length, "nan");
+    return;
+  }
+
+  long scale = 1;
+  for (uint8_t i = 0; i < decimals; i++) scale *= 10;
+  long fixed = lroundf(fabsf(value) * scale);
+
+  char digits[12];
+  if (value < 0 && fixed != 0) AnomalyDetection::appendText(buffer, size, length, "-");
+  ltoa(fixed / scale, digits, 10);
+  AnomalyDetection::appendText(buffer, size, length, digits);
+
+  if (decimals > 0) {
+    char fraction[12];
+    ltoa(fixed % scale + scale, fraction, 10);   // Leading 1 keeps the zeros
+    AnomalyDetection::appendText(buffer, size, length, ".");
+    AnomalyDetection::appendText(buffer, size, length, fraction + 1);
+  }
+}
+
+const char* AnomalyDetection::getTypeName(AnomalyType type) {
+  switch (type) {
+    case TEMP_TOO_LOW:          return "Temperature too low";
+    case TEMP_TOO_HIGH:         return "Temperature too high";
+    case HUMIDITY_TOO_LOW:      return "Humidity too low";
+    case HUMIDITY_TOO_HIGH:     return "Humidity too high";
+    case MOTION_OFF_HOURS:      return "Motion detected during off hours";
+    case LOUD_NOISE:            return "Loud noise";
+    case RAPID_TEMP_DROP:       return "Rapid temperature drop";
+    case SENSOR_MALFUNCTION:    return "Sensor malfunction";
+    case STATISTICAL_DEVIATION: return "Statistical deviation";
+    default:                    return "None";
+  }
+}
+
+size_t AnomalyDetection::formatDetails(AnomalyType type, char* buffer, size_t size) {
+  size_t length = 0;
+  if (size == 0) return 0;
+  buffer[0] = '\0';
+  if (!hasAnomaly(type)) return 0;
+
+  const AnomalyRecord& record = records[type];
+  appendText(buffer, size, length, getTypeName(type));
+
+  switch (type) {
+    case TEMP_TOO_LOW:
+    case TEMP_TOO_HIGH:
+      appendText(buffer, size, length, ": ");
+      appendDecimal(buffer, size, length, record.value, 1);
+      appendText(buffer, size, length, "°C (limit ");
+      appendDecimal(buffer, size, length, record.threshold, 1);
+      appendText(buffer, size, length, ")");
+      break;
+
+    case HUMIDITY_TOO_LOW:
+    case HUMIDITY_TOO_HIGH:
+      appendText(buffer, size, length, ": ");
+      appendDecimal(buffer, size, length, record.value, 1);
+      appendText(buffer, size, length, "% (limit ");
+      appendDecimal(buffer, size, length, record.threshold, 1);
+      appendText(buffer, size, length, ")");
+      break;
+
+    case MOTION_OFF_HOURS:
+      appendText(buffer, size, length, ": ");
+      appendDecimal(buffer, size, length, record.value, 0);
+      appendText(buffer, size, length, " triggers");
+      break;
+
+    case RAPID_TEMP_DROP:
+      appendText(buffer, size, length, ": ");
+      appendDecimal(buffer, size, length, record.value, 2);
+      appendText(buffer, size, length, "°C/min");
+      break;
+
+    case SENSOR_MALFUNCTION:
+      appendText(buffer, size, length, ":");
+      if (record.sources & ANOMALY_SOURCE_SCD30) appendText(buffer, size, length, " SCD-30");
+      if (record.sources & ANOMALY_SOURCE_MQ135) appendText(buffer, size, length, " MQ135");
+      if (record.sources & ANOMALY_SOURCE_MODBUS) appendText(buffer, size, length, " Modbus");
+      appendText(buffer, size, length, " (worst ");
+      appendDecimal(buffer, size, length, record.value, 0);
+      appendText(buffer, size, length, "% errors)");
+      break;
+
+    case LOUD_NOISE:
+      appendText(buffer, size, length, ": ");
+      appendDecimal(buffer, size, length, stats[METRIC_NOISE].last, 3);
+      appendText(buffer, size, length, "V (z=");
+      appendDecimal(buffer, size, length, record.value, 1);
+      appendText(buffer, size, length, ")");
+      break;
+
+    case STATISTICAL_DEVIATION:
+      // Per-metric detail is still in the stats of the sample just scored
+      appendText(buffer, size, length, ":");
+      for (uint8_t m = 0; m < METRIC_COUNT; m++) {
+        if (!(record.sources & (1 << m))) continue;
+        const MetricStats& s = stats[m];
+        appendText(buffer, size, length, " ");
+        appendText(buffer, size, length, metricConfig[m].name);
+        if (s.flags & METRIC_FLAG_SPIKE) {
+          appendText(buffer, size, length, " spike z=");
+          appendDecimal(buffer, size, length, s.zScore, 1);
+        }
+        if (s.flags & METRIC_FLAG_DRIFT_UP) appendText(buffer, size, length, " drifting up");
+        if (s.flags & METRIC_FLAG_DRIFT_DOWN) appendText(buffer, size, length, " drifting down");
+        if (s.flags & METRIC_FLAG_RATE) {
+          appendText(buffer, size, length, " rate ");
+          appendDecimal(buffer, size, length, s.ratePerMinute, 2);
+          appendText(buffer, size, length, "/min");
+        }
+        appendText(buffer, size, length, ";");
+      }
+      if (length > 0 && buffer[length - 1] == ';') buffer[--length] = '\0';
+      break;
+
+    default:
+      break;
+  }
+
+  return length;
+}
+
+size_t AnomalyDetection::formatDetails(char* buffer, size_t size) {
+  size_t length = 0;
+  if (size == 0) return 0;
+  buffer[0] = '\0';
+
+  // Most severe first, "; " between members
+  for (uint8_t i = 0; i < sizeof(severityOrder) / sizeof(severityOrder[0]); i++) {
+    AnomalyType type = severityOrder[i];
+    if (!hasAnomaly(type)) continue;
+
+    if (length > 0) appendText(buffer, size, length, "; ");
+    length += formatDetails(type, buffer + length, size - length);
+  }
+  return length;
+}
+
+// ============================================================================
+// STREAMING STATISTICS
+// ============================================================================
+
+void AnomalyDetection::updateMetric(AnomalyMetric metric, float value, unsigned long now) {
+  MetricStats& s = stats[metric];
+  const MetricConfig& config = metricConfig[metric];
+  s.flags = 0;
+
+  if (isnan(value)) return;  // Sensor offline - keep the baseline
+
+  s.last = value;
+
+  if (isnan(s.ewma)) {
+    s.ewma = value;  // First sample seeds the baseline
+    updateRate(s, value, now);
+    return;
+  }
+
+  // Score against the baseline as it was before this sample
+  float residual = value - s.ewma;
+  float sd = getStdDev(metric);
+  s.zScore = (residual - s.residualMean) / sd;
+
+  bool warm = (s.count >= ANOMALY_WARMUP_SAMPLES);
+  if (warm) {
+    if (fabsf(s.zScore) > config.zThreshold) {
+      s.flags |= METRIC_FLAG_SPIKE;
+    }
+
+    s.cusumHigh = max(0.0f, s.cusumHigh + s.zScore - ANOMALY_CUSUM_SLACK);
+    s.cusumLow = max(0.0f, s.cusumLow - s.zScore - ANOMALY_CUSUM_SLACK);
+    if (s.cusumHigh > ANOMALY_CUSUM_LIMIT) {
+      s.flags |= METRIC_FLAG_DRIFT_UP;
+      s.cusumHigh = 0.0f;
+    }
+    if (s.cusumLow > ANOMALY_CUSUM_LIMIT) {
+      s.flags |= METRIC_FLAG_DRIFT_DOWN;
+      s.cusumLow = 0.0f;
+    }
+  }
+
+  // Welford on the clipped residual; once capped, older samples fade out
+  float limit = config.zThreshold * sd;
+  float clipped = constrain(residual, s.residualMean - limit, s.residualMean + limit);
+  if (s.count < ANOMALY_WELFORD_MAX_COUNT) {
+    s.count++;
+  } else {
+    s.residualM2 *= (float)(s.count - 1) / s.count;
+  }
+  float delta = clipped - s.residualMean;
+  s.residualMean += delta / s.count;
+  s.residualM2 += delta * (clipped - s.residualMean);
+
+  s.ewma += config.ewmaAlpha * residual;
+
+  updateRate(s, value, now);
+  if (warm && config.rateLimit > 0 && s.rateCount >= 2 &&
+      fabsf(s.ratePerMinute) >= config.rateLimit) {
+    s.flags |= METRIC_FLAG_RATE;
+  }
+}
+
+void AnomalyDetection::updateRate(MetricStats& s, float value, unsigned long now) {
+  const unsigned long slotSpacing = ANOMALY_RATE_WINDOW_MS / ANOMALY_RATE_SLOTS;
+
+  if (s.rateCount > 0) {
+    uint8_t newest = (s.rateHead + ANOMALY_RATE_SLOTS - 1) % ANOMALY_RATE_SLOTS;
+    uint8_t oldest = (s.rateHead + ANOMALY_RATE_SLOTS - s.rateCount) % ANOMALY_RATE_SLOTS;
+
+    // Long gap (sensor offline) - history no longer describes a trend
+    if (now - s.rateTimes[newest] > ANOMALY_RATE_WINDOW_MS) {
+      s.rateCount = 0;
+      s.ratePerMinute = 0.0f;
+    } else {
+      unsigned long span = now - s.rateTimes[oldest];
+      if (span >= slotSpacing) {
+        s.ratePerMinute = (value - s.rateValues[oldest]) * 60000.0f / span;
+      }
+      if (now - s.rateTimes[newest] < slotSpacing) {
+        return;  // Not due for a new slot yet
+      }
+    }
+  }
+
+  // Store a slot, overwriting the oldest once the window is full
+  s.rateValues[s.rateHead] = value;
+  s.rateTimes[s.rateHead] = now;
+  s.rateHead = (s.rateHead + 1) % ANOMALY_RATE_SLOTS;
+  if (s.rateCount < ANOMALY_RATE_SLOTS) s.rateCount++;
+}
+
+float AnomalyDetection::metricValue(const SensorData& data, AnomalyMetric metric) {
+  switch (metric) {
+    case METRIC_AIR_TEMP:       return data.airTemp;
+    case METRIC_AIR_HUMIDITY:   return data.airHumidity;
+    case METRIC_CO2:            return data.co2;
+    case METRIC_AIR_QUALITY:    return data.airQualityPPM;
+    case METRIC_SUBSTRATE_TEMP: return data.substrateTemp;
+    case METRIC_VWC:            return data.vwc;
+    case METRIC_PH:             return data.ph;
+    case METRIC_EC:             return data.ec;
+    case METRIC_NITROGEN:       return data.nitrogen;
+    case METRIC_PHOSPHORUS:     return data.phosphorus;
+    case METRIC_POTASSIUM:      return data.potassium;
+    case METRIC_PAR:            return data.par;
+    case METRIC_NOISE:          return data.noiseLevel;
+    case METRIC_VOLTAGE:        return data.voltage;
+    default:                    return NAN;
+  }
+}
+
+// ============================================================================
+// STATISTICS ACCESS
+// ============================================================================
+
+const MetricStats& AnomalyDetection::getMetricStats(AnomalyMetric metric) {
+  return stats[metric];
+}
+
+const char* AnomalyDetection::getMetricName(AnomalyMetric metric) {
+  return metricConfig[metric].name;
+}
+
+float AnomalyDetection::getStdDev(AnomalyMetric metric) {
+  const MetricStats& s = stats[metric];
+  float floor = metricConfig[metric].minStdDev;
+  if (s.count < 2) return floor;
+
+  float sd = sqrtf(s.residualM2 / (s.count - 1));
+  return (sd > floor) ? sd : floor;
+}
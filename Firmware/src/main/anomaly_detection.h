@@ -1,7 +1,23 @@
 /**
  * GreenOS - Anomaly Detection
- * 
+ *
  * On-device anomaly detection for rapid response to critical conditions
+ *
+ * Two layers, both O(1) per sample with state in a fixed array:
+ * - Absolute limits (TEMP_MIN/TEMP_MAX, HUMIDITY_MIN/HUMIDITY_MAX by
+ *   default, overridden by the stored config through setLimits(); rapid
+ *   temperature drop, sensor error rates) mapped to AnomalyType
+ * - Streaming statistics for every numeric SensorData field: EWMA
+ *   baseline, Welford variance of the residual around it, rate of change
+ *   over a fixed window, and a z-score spike / two-sided CUSUM drift
+ *   trigger on the standardized residual
+ *
+ * Cheap enough to run on every sample rather than on a slower interval.
+ *
+ * Every check runs on every sample and the result is a set: one bit per
+ * AnomalyType plus a fixed record (value, threshold, timestamp) per bit,
+ * so simultaneous conditions are all reported. Alert text is formatted
+ * on demand into a caller buffer.
  */
 
 #ifndef ANOMALY_DETECTION_H
@@ -10,6 +26,42 @@
 #include <Arduino.h>
 #include "sensor_manager.h"
 
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+// Absolute limits (override in config.h)
+#ifndef TEMP_MIN
+#define TEMP_MIN 5.0f
+#endif
+#ifndef TEMP_MAX
+#define TEMP_MAX 35.0f
+#endif
+#ifndef HUMIDITY_MIN
+#define HUMIDITY_MIN 40.0f
+#endif
+#ifndef HUMIDITY_MAX
+#define HUMIDITY_MAX 80.0f
+#endif
+
+#define ANOMALY_RAPID_TEMP_DROP 2.0f       // °C per minute (over the rate window)
+#define ANOMALY_SENSOR_ERROR_RATE 50.0f    // % errors before SENSOR_MALFUNCTION
+#define ANOMALY_MOTION_MIN_EVENTS 2        // PIR triggers within the motion window...
+#define ANOMALY_MOTION_MIN_DUTY 25.0f      // ...or % of a cycle present, for MOTION_OFF_HOURS
+#define ANOMALY_MOTION_WINDOW_MS 30000UL   // Triggers are counted across cycles this long
+
+// Streaming statistics
+#define ANOMALY_WARMUP_SAMPLES 30          // No statistical triggers before this
+#define ANOMALY_WELFORD_MAX_COUNT 1000     // Caps weight of history (slow forgetting)
+#define ANOMALY_CUSUM_SLACK 0.5f           // k, in standard deviations
+#define ANOMALY_CUSUM_LIMIT 8.0f           // h, in standard deviations
+#define ANOMALY_RATE_WINDOW_MS 120000UL    // Rate-of-change window (2 min)
+#define ANOMALY_RATE_SLOTS 8               // Samples kept across the window
+
+// ============================================================================
+// ANOMALY TYPES
+// ============================================================================
+
 enum AnomalyType {
   NONE,
   TEMP_TOO_LOW,
@@ -19,30 +71,157 @@ enum AnomalyType {
   MOTION_OFF_HOURS,
   LOUD_NOISE,
   RAPID_TEMP_DROP,
-  SENSOR_MALFUNCTION
+  SENSOR_MALFUNCTION,
+  STATISTICAL_DEVIATION,      // Spike or drift on a metric with no dedicated type
+  ANOMALY_TYPE_COUNT
+};
+
+// One bit per AnomalyType (bit 0 / NONE is never set)
+typedef uint16_t AnomalySet;
+#define ANOMALY_BIT(type) ((AnomalySet)1 << (type))
+#define ANOMALY_DETAILS_SIZE 192      // Buffer size for formatDetails()
+
+// Every numeric SensorData field tracked by the statistics engine
+enum AnomalyMetric {
+  METRIC_AIR_TEMP,
+  METRIC_AIR_HUMIDITY,
+  METRIC_CO2,
+  METRIC_AIR_QUALITY,
+  METRIC_SUBSTRATE_TEMP,
+  METRIC_VWC,
+  METRIC_PH,
+  METRIC_EC,
+  METRIC_NITROGEN,
+  METRIC_PHOSPHORUS,
+  METRIC_POTASSIUM,
+  METRIC_PAR,
+  METRIC_NOISE,
+  METRIC_VOLTAGE,
+  METRIC_COUNT
+};
+
+// Per-sample trigger flags (MetricStats::flags)
+#define METRIC_FLAG_SPIKE      0x01   // |z| above the metric's threshold
+#define METRIC_FLAG_DRIFT_UP   0x02   // Upper CUSUM crossed the limit
+#define METRIC_FLAG_DRIFT_DOWN 0x04   // Lower CUSUM crossed the limit
+#define METRIC_FLAG_RATE       0x08   // |rate| above the metric's limit
+
+// Fixed per-metric state (no heap)
+struct MetricStats {
+  // Welford over the residual (value - EWMA)
+  uint16_t count;
+  float residualMean;
+  float residualM2;
+
+  // Baseline and latest sample
+  float ewma;
+  float last;
+  float zScore;
+
+  // Two-sided CUSUM on the standardized residual
+  float cusumHigh;
+  float cusumLow;
+
+  // Rate of change: one slot per ANOMALY_RATE_WINDOW_MS / ANOMALY_RATE_SLOTS
+  float rateValues[ANOMALY_RATE_SLOTS];
+  unsigned long rateTimes[ANOMALY_RATE_SLOTS];
+  uint8_t rateHead;
+  uint8_t rateCount;
+  float ratePerMinute;
+
+  uint8_t flags;
+};
+
+// Per-metric tuning (static table in the .cpp)
+struct MetricConfig {
+  const char* name;
+  float ewmaAlpha;        // Baseline smoothing
+  float zThreshold;       // Spike trigger, in standard deviations
+  float minStdDev;        // Floor at sensor resolution (flat signals)
+  float rateLimit;        // Units per minute, 0 = off
+};
+
+// Sensor bits in AnomalyRecord::sources for SENSOR_MALFUNCTION
+#define ANOMALY_SOURCE_SCD30  0x01
+#define ANOMALY_SOURCE_MQ135  0x02
+#define ANOMALY_SOURCE_MODBUS 0x04
+
+// Fixed record per active anomaly, overwritten on each detection pass
+struct AnomalyRecord {
+  float value;                // Worst value this pass (metric units, % errors, or z)
+  float threshold;            // Limit that was crossed
+  unsigned long timestamp;    // Sample time (SensorData::timestamp)
+  uint16_t sources;           // AnomalyMetric bits, or ANOMALY_SOURCE_* for SENSOR_MALFUNCTION
 };
 
+// ============================================================================
+// ANOMALY DETECTION CLASS
+// ============================================================================
+
 class AnomalyDetection {
 private:
-  AnomalyType currentAnomaly;
-  String anomalyDetails;
+  AnomalySet activeSet;
+  AnomalyRecord records[ANOMALY_TYPE_COUNT];
   float lastTemp;
   unsigned long lastCheckTime;
-  
+  float tempMin;                  // Absolute limits (TEMP_MIN... or the config store)
+  float tempMax;
+  float humidityMin;
+  float humidityMax;
+  unsigned long sampleTime;
+  uint32_t lastSequence;          // SensorData::sequence already scored
+
+  MetricStats stats[METRIC_COUNT];
+  bool offHours;
+  uint16_t recentMotionEvents;    // PIR triggers since recentMotionStart
+  unsigned long recentMotionStart;
+  uint32_t lastMotionSequence;
+
 public:
   AnomalyDetection();
   void init();
-  
-  bool detectAnomalies(SensorData data);
+
+  bool detectAnomalies(const SensorData& data);
+  AnomalySet getAnomalySet();
+  bool hasAnomaly(AnomalyType type);
+  const AnomalyRecord& getRecord(AnomalyType type);
+
+  // Most severe member of the set (NONE if empty)
   AnomalyType getAnomalyType();
-  String getAnomalyDetails();
-  
+
+  // Alert text, built only when an alert is actually sent or logged
+  size_t formatDetails(char* buffer, size_t size);
+  size_t formatDetails(AnomalyType type, char* buffer, size_t size);
+  static const char* getTypeName(AnomalyType type);
+
+  // Bounded append for alert text; always leaves the buffer NUL-terminated
+  static void appendText(char* buffer, size_t size, size_t& length, const char* text);
+
+  // Streaming statistics access
+  const MetricStats& getMetricStats(AnomalyMetric metric);
+  const char* getMetricName(AnomalyMetric metric);
+  float getStdDev(AnomalyMetric metric);
+  void resetMetric(AnomalyMetric metric);
+
+  // Absolute limits; the macros are only the defaults
+  void setLimits(float tempMin, float tempMax, float humidityMin, float humidityMax);
+
+  // Security context - no RTC, so it comes from DeviceConfig.offHours
+  void setOffHours(bool offHours);
+  bool isOffHours();
+
 private:
   bool checkTemperature(float temp);
   bool checkHumidity(float humidity);
-  bool checkMotion(bool motion);
+  bool checkMotion(const SensorData& data);
   bool checkRapidChange(float currentTemp);
-  bool checkSensorHealth(SensorData data);
+  bool checkSensorHealth(const SensorData& data);
+
+  // Streaming statistics
+  void updateMetric(AnomalyMetric metric, float value, unsigned long now);
+  void updateRate(MetricStats& s, float value, unsigned long now);
+  static float metricValue(const SensorData& data, AnomalyMetric metric);
+  void raise(AnomalyType type, float value, float threshold, uint16_t sources);
 };
 
 #endif // ANOMALY_DETECTION_H
@@ -0,0 +1,228 @@
+/**
+ * GreenOS - Reset Cause and Warm Boot State Implementation
+ *
+ * Retained storage is Zephyr's __noinit section, which the startup code
+ * neither zeroes nor copies. Other builds have no such section: the
+ * block starts zeroed and every boot is cold.
+ */
+
+#include "boot_state.h"
+#include "sensor_manager.h"
+#include <stddef.h>
+
+#if defined(__ZEPHYR__) && defined(__has_include)
+// Kconfig symbols (CONFIG_HWINFO) before anything tests them
+#if __has_include(<zephyr/autoconf.h>)
+#include <zephyr/autoconf.h>
+#elif __has_include(<autoconf.h>)
+#include <autoconf.h>
+#endif
+#if __has_include(<zephyr/linker/section_tags.h>)
+#include <zephyr/linker/section_tags.h>
+#define BOOT_RETAINED __noinit
+#endif
+#if __has_include(<zephyr/drivers/hwinfo.h>) && defined(CONFIG_HWINFO)
+#include <zephyr/drivers/hwinfo.h>
+#define BOOT_HWINFO 1
+#endif
+#endif
+
+#ifndef BOOT_RETAINED
+#define BOOT_RETAINED            // Zeroed at startup - every boot is cold
+#endif
+
+#define BOOT_RETAINED_MAGIC 0x424E5247UL   // "GRNB"
+
+static RetainedState retained BOOT_RETAINED;
+
+BootState bootState;
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+BootState::BootState() {
+  cause = BOOT_POWER_ON;
+  warm = false;
+  memset(&previous, 0, sizeof(previous));
+}
+
+// ============================================================================
+// RESET CAUSE
+// ============================================================================
+
+BootCause BootState::begin() {
+  previous = retained;
+  bool valid = isSealed();
+
+  // The firmware's own note tells a software-watchdog reset from 'r'
+  BootCause noted = valid ? (BootCause)previous.resetRequest : BOOT_POWER_ON;
+
+  BootCause hardware;
+  if (hardwareCause(hardware)) {
+    cause = (hardware == BOOT_SOFTWARE && noted == BOOT_WATCHDOG) ? BOOT_WATCHDOG : hardware;
+  } else {
+    cause = valid ? noted : BOOT_POWER_ON;
+  }
+
+  // Crash or requested reset while powered - the retained state is
+  // current. Only a watchdog or software reset the hardware reported, or
+  // the firmware noted, qualifies: an unexplained reset may have been a
+  // power glitch, and without hwinfo an un-noted reset stays BOOT_UNKNOWN.
+  warm = valid && previous.warmResets < BOOT_MAX_WARM_RESETS &&
+         (cause == BOOT_WATCHDOG || cause == BOOT_SOFTWARE);
+
+  if (!valid) {
+    memset(&retained, 0, sizeof(retained));
+    retained.magic = BOOT_RETAINED_MAGIC;
+  }
+  if (!warm) {
+    // Nothing from before this boot may be restored later
+    retained.relays = 0;
+    retained.readingValid = false;
+    retained.preheatElapsedMs = 0;
+    previous.readingValid = false;
+  }
+  retained.bootCount++;
+  retained.warmResets = warm ? previous.warmResets + 1 : 0;
+  retained.resetRequest = BOOT_UNKNOWN;
+  seal();
+
+  return cause;
+}
+
+bool BootState::hardwareCause(BootCause& out) {
+  #ifdef BOOT_HWINFO
+  uint32_t flags = 0;
+  if (hwinfo_get_reset_cause(&flags) != 0) {
+    return false;
+  }
+  hwinfo_clear_reset_cause();  // Flags accumulate otherwise
+
+  // Several flags can be set at once (STM32 reports the pin on every reset)
+  if (flags & RESET_WATCHDOG) {
+    out = BOOT_WATCHDOG;
+  } else if (flags & RESET_SOFTWARE) {
+    out = BOOT_SOFTWARE;
+  } else if (flags & RESET_POR) {
+    out = BOOT_POWER_ON;
+  } else if (flags & RESET_BROWNOUT) {
+    out = BOOT_BROWNOUT;
+  } else if (flags & RESET_PIN) {
+    out = BOOT_RESET_PIN;
+  } else {
+    out = BOOT_UNKNOWN;        // Lockup, clock or other hardware reset
+  }
+  return true;
+  #else
+  (void)out;
+  return false;
+  #endif
+}
+
+BootCause BootState::getCause() {
+  return cause;
+}
+
+bool BootState::isWarm() {
+  return warm;
+}
+
+uint32_t BootState::getBootCount() {
+  return retained.bootCount;
+}
+
+// ============================================================================
+// RETAINED VALUES
+// ============================================================================
+
+ActuatorMask BootState::getRelays() {
+  return warm ? previous.relays : 0;
+}
+
+bool BootState::getReading(SensorReading& out) {
+  if (!warm || !previous.readingValid) {
+    return false;
+  }
+  out = previous.reading;
+  return true;
+}
+
+unsigned long BootState::getPreheatElapsed() {
+  return warm ? previous.preheatElapsedMs : 0;
+}
+
+void BootState::save(ActuatorMask relays, const SensorData& data, unsigned long preheatElapsedMs,
+                     uint8_t systemState) {
+  retained.relays = relays;
+  retained.systemState = systemState;
+  retained.preheatElapsedMs = preheatElapsedMs;
+
+  // Sequence 0 is the constructor defaults, not a measurement
+  retained.readingValid = data.sequence > 0;
+  retained.reading.timestamp = millis();
+  retained.reading.airTemp = data.airTemp;
+  retained.reading.airHumidity = data.airHumidity;
+  retained.reading.co2 = data.co2;
+  retained.reading.ph = data.ph;
+  retained.reading.ec = data.ec;
+  retained.reading.vwc = data.vwc;
+
+  if (millis() >= BOOT_STABLE_MS) {
+    retained.warmResets = 0;
+  }
+  seal();
+}
+
+void BootState::saveRelays(ActuatorMask relays) {
+  retained.relays = relays;
+  seal();
+}
+
+void BootState::noteReset(BootCause reason) {
+  retained.resetRequest = reason;
+  seal();
+}
+
+void BootState::seal() {
+  retained.crc32 = SensorManager::calculateCRC32((const uint8_t*)&retained,
+                                                 offsetof(RetainedState, crc32));
+}
+
+bool BootState::isSealed() {
+  return retained.magic == BOOT_RETAINED_MAGIC &&
+         retained.crc32 == SensorManager::calculateCRC32((const uint8_t*)&retained,
+                                                         offsetof(RetainedState, crc32));
+}
+
+// ============================================================================
+// STATUS
+// ============================================================================
+
+const char* BootState::getCauseName(BootCause cause) {
+  switch (cause) {
+    case BOOT_POWER_ON:  return "power-on";
+    case BOOT_WATCHDOG:  return "watchdog";
+    case BOOT_SOFTWARE:  return "software reset";
+    case BOOT_BROWNOUT:  return "brownout";
+    case BOOT_RESET_PIN: return "reset pin";
+    case BOOT_UNKNOWN:   return "unknown";
+  }
+  return "unknown";
+}
+
+void BootState::printStatus() {
+  Serial.print(warm ? "✓ Warm boot" : "ℹ️  Cold boot");
+  Serial.print(" (");
+  Serial.print(getCauseName(cause));
+  Serial.print(", boot #");
+  Serial.print(retained.bootCount);
+  if (warm) {
+    Serial.print(", relays 0x");
+    Serial.print(previous.relays, HEX);
+    Serial.print(previous.readingValid ? ", reading retained" : ", no reading");
+  } else if (previous.magic == BOOT_RETAINED_MAGIC && previous.warmResets >= BOOT_MAX_WARM_RESETS) {
+    Serial.print(", too many warm resets");
+  }
+  Serial.println(")");
+}
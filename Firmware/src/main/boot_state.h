@@ -0,0 +1,108 @@
+/**
+ * GreenOS - Reset Cause and Warm Boot State
+ *
+ * A small block of retained (.noinit) RAM survives a reset that keeps the
+ * board powered. It is refreshed every sensor and control cycle with the
+ * relay mask, the latest air/soil reading and the MQ135 preheat progress,
+ * and is CRC-checked, so a cold power-up (random RAM) never validates.
+ *
+ * begin() combines the hardware reset cause (Zephyr hwinfo where
+ * available) with that block:
+ * - Warm boot: watchdog or software reset - reported by the hardware or
+ *   noted by the firmware before resetting - with a valid block. setup()
+ *   skips the fixed settle delays, relays are restored straight away and
+ *   the retained reading is published until the sensors report again.
+ * - Cold boot: power-on, brownout, reset pin, any unexplained reset, or
+ *   no valid block - the full startup with every relay OFF.
+ *
+ * Relay state is never taken from flash: after a power loss of unknown
+ * length OFF is the only safe start. BOOT_MAX_WARM_RESETS consecutive
+ * warm boots without a stable run fall back to a cold boot, so a state
+ * that crashes the firmware is not restored forever.
+ */
+
+#ifndef BOOT_STATE_H
+#define BOOT_STATE_H
+
+#include <Arduino.h>
+#include "sensor_manager.h"
+#include "record_codec.h"
+#include "actuator_manager.h"
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+#define BOOT_MAX_WARM_RESETS 3         // Consecutive warm boots before forcing cold
+#define BOOT_STABLE_MS 300000UL        // Uptime that clears the warm boot count
+
+enum BootCause {
+  BOOT_POWER_ON,
+  BOOT_WATCHDOG,
+  BOOT_SOFTWARE,                       // NVIC_SystemReset(), 'r' command, fatal error
+  BOOT_BROWNOUT,
+  BOOT_RESET_PIN,
+  BOOT_UNKNOWN
+};
+
+// Retained across resets (not across power loss)
+struct RetainedState {
+  uint32_t magic;
+  uint32_t bootCount;                  // Boots since power-on
+  uint8_t warmResets;                  // Consecutive warm boots without a stable run
+  uint8_t resetRequest;                // BootCause noted just before a firmware reset
+  uint8_t systemState;                 // SystemState at the last save
+  ActuatorMask relays;
+  bool readingValid;
+  SensorReading reading;               // timestamp = uptime at the save
+  uint32_t preheatElapsedMs;           // MQ135 heater time before the reset
+  uint32_t crc32;                      // Over everything above
+};
+
+// ============================================================================
+// BOOT STATE CLASS
+// ============================================================================
+
+class BootState {
+public:
+  BootState();
+
+  // Call first in setup(): reads and clears the reset cause, validates
+  // the retained block and decides warm/cold
+  BootCause begin();
+  BootCause getCause();
+  bool isWarm();
+  uint32_t getBootCount();
+
+  // Retained values from before the reset (warm boot only)
+  ActuatorMask getRelays();
+  bool getReading(SensorReading& out);
+  unsigned long getPreheatElapsed();
+
+  // Refresh the block - a few microseconds, call every cycle
+  void save(ActuatorMask relays, const SensorData& data, unsigned long preheatElapsedMs,
+            uint8_t systemState);
+
+  // Relay mask only - on every output change, so a reset right after a
+  // switch never restores the mask from the previous cycle
+  void saveRelays(ActuatorMask relays);
+
+  // Record why the firmware is about to reset (call right before it)
+  void noteReset(BootCause reason);
+
+  static const char* getCauseName(BootCause cause);
+  void printStatus();
+
+private:
+  BootCause cause;
+  bool warm;
+  RetainedState previous;              // Copy taken at begin()
+
+  static bool hardwareCause(BootCause& out);
+  void seal();
+  bool isSealed();
+};
+
+extern BootState bootState;
+
+#endif // BOOT_STATE_H
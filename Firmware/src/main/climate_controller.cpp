@@ -0,0 +1,268 @@
+/**
+ * GreenOS - Closed-Loop Climate Controller Implementation
+ */
+
+#include "climate_controller.h"
+
+// ============================================================================
+// LOOP TABLE
+// ============================================================================
+
+// Rows in ControlLoopId order. Heating is PID (the heater is the only
+// proportional-enough actuator); ventilation and irrigation respond to
+// slow processes where a band avoids chatter.
+static const ControlLoopConfig loopTable[CONTROL_LOOP_COUNT] = {
+  // name        input                    mode                actuator                   reverse setpoint                   band  kp     ki       kd    windowMs  maxDuty
+  {"heat",       CONTROL_INPUT_AIR_TEMP,  CONTROL_PID,        ACTUATOR_HEATER_PRIMARY,   false,  CONTROL_HEAT_SETPOINT,     0.0f, 0.25f, 0.0002f, 0.0f, 600000UL, MAX_HEATER_DUTY_CYCLE},
+  {"vent",       CONTROL_INPUT_AIR_TEMP,  CONTROL_HYSTERESIS, ACTUATOR_FAN_EXHAUST,      true,   CONTROL_VENT_SETPOINT,     1.0f, 0.0f,  0.0f,    0.0f, 600000UL, 1.0f},
+  {"humidity",   CONTROL_INPUT_HUMIDITY,  CONTROL_HYSTERESIS, ACTUATOR_FAN_CIRCULATION,  true,   CONTROL_HUMIDITY_SETPOINT, 5.0f, 0.0f,  0.0f,    0.0f, 600000UL, 1.0f},
+  // Irrigation pulses (1/3 of 15 min) let water reach the probe between runs
+  {"irrigation", CONTROL_INPUT_VWC,       CONTROL_HYSTERESIS, ACTUATOR_PUMP,             false,  CONTROL_VWC_SETPOINT,      5.0f, 0.0f,  0.0f,    0.0f, 900000UL, 0.33f}
+};
+
+// ============================================================================
+// CONSTRUCTOR / SETUP
+// ============================================================================
+
+ClimateController::ClimateController() {
+  actuators = nullptr;
+  lastSequence = 0;
+  suspended = true;
+
+  for (uint8_t i = 0; i < CONTROL_LOOP_COUNT; i++) {
+    resetLoop(loops[i]);
+    loops[i].relaySwitches = 0;
+  }
+}
+
+void ClimateController::init(ActuatorManager* actuators) {
+  this->actuators = actuators;
+  suspended = false;
+
+  Serial.print("✓ Climate control: ");
+  Serial.print(CONTROL_LOOP_COUNT);
+  Serial.println(" loops");
+}
+
+void ClimateController::resetLoop(LoopState& state) {
+  state.measurement = NAN;
+  state.lastMeasurement = NAN;
+  state.integral = 0.0f;
+  state.demandLatched = false;
+  state.demand = 0.0f;
+  state.lastSample = 0;
+  state.windowStart = 0;
+  state.onTimeMs = 0;
+  state.windowOpen = false;
+  state.relayOn = false;
+}
+
+// ============================================================================
+// CONTROL PASS
+// ============================================================================
+
+void ClimateController::update(const SensorData& data, unsigned long now) {
+  if (actuators == nullptr) return;
+
+  bool fresh = data.sequence != lastSequence;
+  lastSequence = data.sequence;
+
+  if (suspended) {
+    // Relay states are unknown after an emergency - re-assert from scratch
+    suspended = false;
+    for (uint8_t i = 0; i < CONTROL_LOOP_COUNT; i++) {
+      loops[i].windowOpen = false;
+    }
+  }
+
+  for (uint8_t i = 0; i < CONTROL_LOOP_COUNT; i++) {
+    const ControlLoopConfig& config = loopTable[i];
+    LoopState& state = loops[i];
+
+    // Demand changes only with new data; windows advance on time
+    if (fresh) {
+      float previous = state.demand;
+      updateDemand(config, state, data);
+
+      // New demand starts a window now instead of at the next edge
+      if (previous == 0.0f && state.demand > 0.0f && !state.relayOn) {
+        state.windowOpen = false;
+      }
+    }
+
+    bool windowEdge = !state.windowOpen || now - state.windowStart >= config.windowMs;
+    if (windowEdge) {
+      state.windowStart = now;
+      state.windowOpen = true;
+      state.onTimeMs = windowOnTime(config, state.demand);
+    } else if (fresh && state.demand == 0.0f) {
+      // Demand gone mid-window (band crossed, sensor lost) - end the pulse now
+      state.onTimeMs = 0;
+    }
+
+    bool on = (now - state.windowStart) < state.onTimeMs;
+
+    // Command only on a change, or to re-assert at a window edge (the
+    // relay may have been refused or switched by an operator)
+    if (on != state.relayOn || (windowEdge && on != isOutputOn(config.actuator))) {
+      actuators->setActuator(config.actuator, on);
+      state.relayOn = on;
+      state.relaySwitches++;
+    }
+  }
+}
+
+void ClimateController::updateDemand(const ControlLoopConfig& config, LoopState& state,
+                                     const SensorData& data) {
+  float value = readInput(config.input, data);
+  state.measurement = value;
+
+  if (isnan(value)) {
+    // No data - fail to OFF and restart the integrator cleanly later
+    state.demand = 0.0f;
+    state.integral = 0.0f;
+    state.demandLatched = false;
+    state.lastMeasurement = NAN;
+    return;
+  }
+
+  // Positive error = the actuator should work harder
+  float error = config.reverse ? value - config.setpoint : config.setpoint - value;
+
+  if (config.mode == CONTROL_HYSTERESIS) {
+    if (error > config.band) {
+      state.demandLatched = true;
+    } else if (error < -config.band) {
+      state.demandLatched = false;
+    }
+    state.demand = state.demandLatched ? 1.0f : 0.0f;
+  } else {
+    float dt = 0.0f;
+    if (!isnan(state.lastMeasurement)) {
+      dt = (data.timestamp - state.lastSample) / 1000.0f;
+      if (dt > CONTROL_PID_MAX_DT_S) dt = CONTROL_PID_MAX_DT_S;
+    }
+
+    float derivative = 0.0f;
+    if (dt > 0.0f) {
+      // On measurement, so setpoint changes don't kick the output
+      float rate = (value - state.lastMeasurement) / dt;
+      derivative = config.reverse ? -rate : rate;
+    }
+
+    // Conditional integration: hold the integrator while saturated
+    float output = config.kp * error + config.ki * state.integral - config.kd * derivative;
+    bool saturated = (output >= config.maxDuty && error > 0.0f) || (output <= 0.0f && error < 0.0f);
+    if (!saturated) {
+      state.integral += error * dt;
+    }
+
+    // Anti-windup: the integral term alone never exceeds the duty range
+    if (config.ki > 0.0f) {
+      float limit = config.maxDuty / config.ki;
+      if (state.integral > limit) state.integral = limit;
+      if (state.integral < 0.0f) state.integral = 0.0f;
+    }
+
+    output = config.kp * error + config.ki * state.integral - config.kd * derivative;
+    state.demand = constrain(output, 0.0f, 1.0f);
+  }
+
+  state.lastMeasurement = value;
+  state.lastSample = data.timestamp;
+}
+
+unsigned long ClimateController::windowOnTime(const ControlLoopConfig& config, float demand) {
+  const ActuatorConfig& actuator = ActuatorManager::getConfig(config.actuator);
+
+  float duty = (demand < config.maxDuty) ? demand : config.maxDuty;
+  unsigned long onTime = (unsigned long)(duty * config.windowMs);
+  unsigned long minPulse = actuator.minCycleMs;
+
+  if (onTime < minPulse) {
+    onTime = 0;                       // Too short for the relay's cycle limit
+  } else if (onTime + minPulse > config.windowMs) {
+    // The OFF gap would be shorter than a cycle: stay on, or leave a full gap
+    onTime = (duty >= 1.0f) ? config.windowMs : config.windowMs - minPulse;
+  }
+
+  if (actuator.maxRunMs > 0 && onTime > actuator.maxRunMs) {
+    onTime = actuator.maxRunMs;
+  }
+  return onTime;
+}
+
+// The output setActuator() drives: the shadow mask in dry run
+bool ClimateController::isOutputOn(ActuatorId id) {
+  ActuatorMask outputs = actuators->isDryRun() ? actuators->getShadowState() : actuators->getState();
+  return (outputs & ACTUATOR_BIT(id)) != 0;
+}
+
+float ClimateController::readInput(ControlInput input, const SensorData& data) {
+  switch (input) {
+    case CONTROL_INPUT_AIR_TEMP: return data.airTemp;
+    case CONTROL_INPUT_HUMIDITY: return data.airHumidity;
+    case CONTROL_INPUT_VWC:      return data.vwc;
+  }
+  return NAN;
+}
+
+// ============================================================================
+// SUSPEND / STATUS
+// ============================================================================
+
+void ClimateController::suspend() {
+  suspended = true;
+  for (uint8_t i = 0; i < CONTROL_LOOP_COUNT; i++) {
+    loops[i].relayOn = actuators != nullptr && isOutputOn(loopTable[i].actuator);
+  }
+}
+
+bool ClimateController::isSuspended() {
+  return suspended;
+}
+
+ControlLoopStatus ClimateController::getStatus(ControlLoopId loop) {
+  ControlLoopStatus status;
+  const LoopState& state = loops[loop];
+  status.measurement = state.measurement;
+  status.demand = state.demand;
+  status.onTimeMs = state.onTimeMs;
+  status.relayOn = state.relayOn;
+  status.relaySwitches = state.relaySwitches;
+  return status;
+}
+
+const ControlLoopConfig& ClimateController::getConfig(ControlLoopId loop) {
+  return loopTable[loop];
+}
+
+void ClimateController::printStatus() {
+  Serial.println("\n=== Climate Control ===");
+  if (suspended) {
+    Serial.println("(suspended - emergency or safe mode owns the relays)");
+  }
+
+  for (uint8_t i = 0; i < CONTROL_LOOP_COUNT; i++) {
+    const ControlLoopConfig& config = loopTable[i];
+    const LoopState& state = loops[i];
+
+    Serial.print(config.name);
+    Serial.print(": ");
+    Serial.print(state.measurement, 1);
+    Serial.print(" / ");
+    Serial.print(config.setpoint, 1);
+    Serial.print(config.mode == CONTROL_PID ? " PID" : " band");
+    Serial.print(", demand ");
+    Serial.print((int)(state.demand * 100.0f + 0.5f));
+    Serial.print("%, on ");
+    Serial.print(state.onTimeMs / 1000);
+    Serial.print("/");
+    Serial.print(config.windowMs / 1000);
+    Serial.print(" s, relay ");
+    Serial.print(state.relayOn ? "ON" : "OFF");
+    Serial.print(", switches ");
+    Serial.println(state.relaySwitches);
+  }
+  Serial.println();
+}
@@ -0,0 +1,148 @@
+/**
+ * GreenOS - Closed-Loop Climate Controller
+ *
+ * Fixed-rate control loops for air temperature, humidity and substrate
+ * moisture, defined in a static table like the actuator table. Each loop
+ * is either PID (heating) or a hysteresis band (venting, humidity,
+ * irrigation) and produces a demand of 0..1. The demand is capped at the
+ * loop's maximum duty and turned into a time-proportioned relay window:
+ * ON for demand × window at the start of every window, OFF for the rest.
+ *
+ * Relay wear: pulses shorter than the actuator's minimum cycle are
+ * dropped, OFF gaps shorter than it are closed, and a pulse never
+ * exceeds the actuator's maximum run time. A relay is only commanded at
+ * window edges and band crossings, so a steady demand costs one cycle
+ * per window instead of one per anomaly alert.
+ *
+ * The controller owns the relays only in normal operation; emergency and
+ * safe-mode protocols call suspend() and drive them directly.
+ */
+
+#ifndef CLIMATE_CONTROLLER_H
+#define CLIMATE_CONTROLLER_H
+
+#include <Arduino.h>
+#include "sensor_manager.h"
+#include "actuator_manager.h"
+
+// ============================================================================
+// CONFIGURATION (override in config.h)
+// ============================================================================
+
+#ifndef CLIMATE_CONTROL_ENABLED
+#define CLIMATE_CONTROL_ENABLED 1        // 0 = anomaly warnings drive the relays
+#endif
+
+#define CONTROL_PERIOD_MS 1000UL         // Loop evaluation rate
+
+#ifndef CONTROL_HEAT_SETPOINT
+#define CONTROL_HEAT_SETPOINT 20.0f      // °C, PID target for the primary heater
+#endif
+#ifndef CONTROL_VENT_SETPOINT
+#define CONTROL_VENT_SETPOINT 26.0f      // °C, exhaust fan band centre
+#endif
+#ifndef CONTROL_HUMIDITY_SETPOINT
+#define CONTROL_HUMIDITY_SETPOINT 70.0f  // %RH, circulation fan band centre
+#endif
+#ifndef CONTROL_VWC_SETPOINT
+#define CONTROL_VWC_SETPOINT 30.0f       // % VWC, irrigation band centre
+#endif
+
+#define CONTROL_PID_MAX_DT_S 60.0f       // Longer sample gaps are treated as this
+
+// ============================================================================
+// LOOP DEFINITIONS
+// ============================================================================
+
+enum ControlInput {
+  CONTROL_INPUT_AIR_TEMP,
+  CONTROL_INPUT_HUMIDITY,
+  CONTROL_INPUT_VWC
+};
+
+enum ControlMode {
+  CONTROL_PID,
+  CONTROL_HYSTERESIS
+};
+
+enum ControlLoopId {
+  CONTROL_LOOP_HEAT,
+  CONTROL_LOOP_VENT,
+  CONTROL_LOOP_HUMIDITY,
+  CONTROL_LOOP_IRRIGATION,
+  CONTROL_LOOP_COUNT
+};
+
+struct ControlLoopConfig {
+  const char* name;
+  ControlInput input;
+  ControlMode mode;
+  ActuatorId actuator;
+  bool reverse;                // Output acts when the value is ABOVE setpoint
+  float setpoint;
+  float band;                  // Hysteresis: ON beyond setpoint ± band, OFF past the other side
+  float kp;                    // PID: duty per unit of error
+  float ki;                    // PID: duty per unit·second
+  float kd;                    // PID: duty per unit/second (on measurement)
+  unsigned long windowMs;      // Time-proportioning window
+  float maxDuty;               // 0..1 cap per window
+};
+
+struct ControlLoopStatus {
+  float measurement;           // NaN = no data (output forced to 0)
+  float demand;                // 0..1 before caps
+  unsigned long onTimeMs;      // Relay ON time in the current window
+  bool relayOn;                // Last state requested
+  uint32_t relaySwitches;      // Commands issued to ActuatorManager
+};
+
+// ============================================================================
+// CLIMATE CONTROLLER CLASS
+// ============================================================================
+
+class ClimateController {
+public:
+  ClimateController();
+  void init(ActuatorManager* actuators);
+
+  // Call every CONTROL_PERIOD_MS with the latest snapshot. now is on the
+  // same clock as data.timestamp (the replay clock during a trace replay).
+  void update(const SensorData& data, unsigned long now);
+
+  // Stop commanding relays (emergency / safe mode). Outputs are left as
+  // they are; the next update() starts fresh windows.
+  void suspend();
+  bool isSuspended();
+
+  ControlLoopStatus getStatus(ControlLoopId loop);
+  static const ControlLoopConfig& getConfig(ControlLoopId loop);
+  void printStatus();
+
+private:
+  struct LoopState {
+    float measurement;
+    float lastMeasurement;
+    float integral;
+    bool demandLatched;        // Hysteresis state
+    float demand;
+    unsigned long lastSample;  // data.timestamp of the last update
+    unsigned long windowStart;
+    unsigned long onTimeMs;
+    bool windowOpen;           // false = start a window on the next update
+    bool relayOn;
+    uint32_t relaySwitches;
+  };
+
+  ActuatorManager* actuators;
+  LoopState loops[CONTROL_LOOP_COUNT];
+  uint32_t lastSequence;
+  bool suspended;
+
+  void resetLoop(LoopState& state);
+  void updateDemand(const ControlLoopConfig& config, LoopState& state, const SensorData& data);
+  unsigned long windowOnTime(const ControlLoopConfig& config, float demand);
+  bool isOutputOn(ActuatorId id);
+  static float readInput(ControlInput input, const SensorData& data);
+};
+
+#endif // CLIMATE_CONTROLLER_H
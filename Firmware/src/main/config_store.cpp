@@ -0,0 +1,352 @@
+/**
+ * GreenOS - Persistent Device Configuration Implementation
+ */
+
+#include "config_store.h"
+#include "config.h"
+#include "anomaly_detection.h"
+#include "sensor_manager.h"
+#include <stddef.h>
+
+ConfigStore configStore;
+
+// ============================================================================
+// ON-FLASH STRUCTURES
+// ============================================================================
+
+#define CONFIG_SLOT_MAGIC 0x434E5247UL   // "GRNC"
+
+struct ConfigSlotHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t length;       // Payload bytes (sizeof(DeviceConfig) when written)
+  uint32_t sequence;     // Newer copy wins
+  uint32_t crc32;        // Over the first 12 header bytes, then the payload
+};
+
+struct ConfigSlotImage {
+  ConfigSlotHeader header;
+  DeviceConfig config;
+};
+
+// ============================================================================
+// KEY TABLE
+// ============================================================================
+
+// Rows in DeviceConfig order. Names match the cloud config document.
+static const ConfigKey keyTable[] = {
+  // name                 offset                                        type         min       max
+  {"tempMin",             offsetof(DeviceConfig, tempMin),              CONFIG_FLOAT, -20.0f,  40.0f},
+  {"tempMax",             offsetof(DeviceConfig, tempMax),              CONFIG_FLOAT, 0.0f,    60.0f},
+  {"humidityMin",         offsetof(DeviceConfig, humidityMin),          CONFIG_FLOAT, 0.0f,    100.0f},
+  {"humidityMax",         offsetof(DeviceConfig, humidityMax),          CONFIG_FLOAT, 0.0f,    100.0f},
+  {"adcOffset",           offsetof(DeviceConfig, adcOffset),            CONFIG_FLOAT, -0.5f,   0.5f},
+  {"adcScale",            offsetof(DeviceConfig, adcScale),             CONFIG_FLOAT, 0.5f,    1.5f},
+  {"adcVRef",             offsetof(DeviceConfig, adcVRef),              CONFIG_FLOAT, 2.5f,    3.6f},
+  {"adcTempCoeff",        offsetof(DeviceConfig, adcTempCoeff),         CONFIG_FLOAT, -0.01f,  0.01f},
+  {"mq135R0",             offsetof(DeviceConfig, mq135R0),              CONFIG_FLOAT, 100.0f,  1000000.0f},
+  // Intervals: the floors keep a typo from flooding the scheduler or the uplink
+  {"sensorIntervalMs",    offsetof(DeviceConfig, sensorIntervalMs),     CONFIG_U32,   1000.0f, 600000.0f},
+  {"syncIntervalMs",      offsetof(DeviceConfig, syncIntervalMs),       CONFIG_U32,   5000.0f, 3600000.0f},
+  {"healthIntervalMs",    offsetof(DeviceConfig, healthIntervalMs),     CONFIG_U32,   10000.0f,3600000.0f},
+  {"offHours",            offsetof(DeviceConfig, offHours),             CONFIG_U32,   0.0f,    1.0f}
+};
+
+#define CONFIG_KEY_COUNT (sizeof(keyTable) / sizeof(keyTable[0]))
+
+// ============================================================================
+// CONSTRUCTOR / LOAD
+// ============================================================================
+
+ConfigStore::ConfigStore() {
+  log = nullptr;
+  getDefaults(config);
+  saved = config;
+  dirty = false;
+  activeSlot = -1;
+  sequence = 0;
+  loadMicros = 0;
+  commits = 0;
+  commitFailures = 0;
+  changeCallback = nullptr;
+}
+
+void ConfigStore::getDefaults(DeviceConfig& defaults) {
+  defaults.tempMin = TEMP_MIN;
+  defaults.tempMax = TEMP_MAX;
+  defaults.humidityMin = HUMIDITY_MIN;
+  defaults.humidityMax = HUMIDITY_MAX;
+
+  defaults.adcOffset = 0.0f;
+  defaults.adcScale = 1.0f;
+  defaults.adcVRef = ADC_VREF_NOMINAL;
+  defaults.adcTempCoeff = 0.0002f;       // 0.02%/°C typical
+  defaults.mq135R0 = 10000.0f;           // Uncalibrated baseline
+
+  defaults.sensorIntervalMs = SENSOR_READ_INTERVAL;
+  defaults.syncIntervalMs = FIREBASE_SYNC_INTERVAL;
+  defaults.healthIntervalMs = SENSOR_HEALTH_CHECK_INTERVAL;
+
+  defaults.cloudGeneration = 0;
+
+  defaults.offHours = 0;
+}
+
+bool ConfigStore::begin(FlashLog* log) {
+  this->log = log;
+  uint32_t start = micros();
+
+  getDefaults(config);
+  saved = config;
+  dirty = false;
+  activeSlot = -1;
+  sequence = 0;
+
+  if (log == nullptr || log->getReservedSize() < sizeof(ConfigSlotImage)) {
+    loadMicros = micros() - start;
+    return false;
+  }
+
+  // Newest valid copy wins; a torn write only ever hits the other slot
+  for (uint8_t slot = 0; slot < CONFIG_STORE_SLOTS; slot++) {
+    DeviceConfig candidate;
+    uint32_t candidateSequence;
+    if (!readSlot(slot, candidate, candidateSequence)) continue;
+
+    if (activeSlot < 0 || (int32_t)(candidateSequence - sequence) > 0) {
+      config = candidate;
+      sequence = candidateSequence;
+      activeSlot = slot;
+    }
+  }
+
+  saved = config;
+  loadMicros = micros() - start;
+  return activeSlot >= 0;
+}
+
+bool ConfigStore::readSlot(uint8_t slot, DeviceConfig& out, uint32_t& outSequence) {
+  ConfigSlotImage image;
+  if (!log->readReserved(slot, 0, &image, sizeof(image))) {
+    return false;
+  }
+
+  const ConfigSlotHeader& header = image.header;
+  if (header.magic != CONFIG_SLOT_MAGIC || header.version == 0 ||
+      header.version > CONFIG_STORE_VERSION || header.length > sizeof(DeviceConfig)) {
+    return false;  // Erased, foreign, or written by newer firmware
+  }
+
+  uint32_t crc = SensorManager::calculateCRC32((const uint8_t*)&header, 12);
+  crc = SensorManager::calculateCRC32((const uint8_t*)&image.config, header.length, crc);
+  if (crc != header.crc32) {
+    return false;  // Torn write or bit rot
+  }
+
+  // Older blobs are a prefix: fields they lack keep their defaults
+  getDefaults(out);
+  memcpy(&out, &image.config, header.length);
+  if (!isOrdered(out)) {
+    return false;
+  }
+
+  outSequence = header.sequence;
+  return true;
+}
+
+// ============================================================================
+// ACCESS / DELTA UPDATES
+// ============================================================================
+
+const DeviceConfig& ConfigStore::get() {
+  return config;
+}
+
+bool ConfigStore::isPersisted() {
+  return activeSlot >= 0;
+}
+
+bool ConfigStore::set(const char* key, float value) {
+  for (uint8_t i = 0; i < CONFIG_KEY_COUNT; i++) {
+    const ConfigKey& entry = keyTable[i];
+    if (strcmp(key, entry.name) != 0) continue;
+
+    if (isnan(value) || value < entry.minValue || value > entry.maxValue) {
+      return false;
+    }
+
+    DeviceConfig updated = config;
+    uint8_t* field = (uint8_t*)&updated + entry.offset;
+    if (entry.type == CONFIG_FLOAT) {
+      memcpy(field, &value, sizeof(float));
+    } else {
+      uint32_t integer = (uint32_t)(value + 0.5f);
+      memcpy(field, &integer, sizeof(uint32_t));
+    }
+
+    if (memcmp(&updated, &config, sizeof(config)) != 0) {
+      config = updated;
+      dirty = true;
+    }
+    return true;
+  }
+  return false;
+}
+
+bool ConfigStore::setCalibration(float offset, float scale, float vRef, float tempCoeff) {
+  // All or nothing - a partly applied calibration is worse than none
+  DeviceConfig previous = config;
+  bool previousDirty = dirty;
+  if (set("adcOffset", offset) && set("adcScale", scale) &&
+      set("adcVRef", vRef) && set("adcTempCoeff", tempCoeff)) {
+    return true;
+  }
+  config = previous;
+  dirty = previousDirty;
+  return false;
+}
+
+bool ConfigStore::setMQ135R0(float r0) {
+  return set("mq135R0", r0);
+}
+
+void ConfigStore::setCloudGeneration(uint32_t generation) {
+  if (generation != config.cloudGeneration) {
+    config.cloudGeneration = generation;
+    dirty = true;
+  }
+}
+
+uint32_t ConfigStore::getCloudGeneration() {
+  return config.cloudGeneration;
+}
+
+bool ConfigStore::isOrdered(const DeviceConfig& candidate) {
+  return candidate.tempMin < candidate.tempMax &&
+         candidate.humidityMin < candidate.humidityMax;
+}
+
+// ============================================================================
+// COMMIT (A/B)
+// ============================================================================
+
+bool ConfigStore::commit() {
+  if (!dirty) return true;
+
+  if (!isOrdered(config)) {
+    revert();
+    commitFailures++;
+    return false;
+  }
+
+  // Never overwrite the active copy
+  uint8_t target = (activeSlot == 0) ? 1 : 0;
+  uint32_t nextSequence = sequence + 1;
+  bool written = log != nullptr && log->getReservedSize() >= sizeof(ConfigSlotImage) &&
+                 writeSlot(target, nextSequence);
+
+  if (!written) {
+    // Stays dirty so the next commit retries
+    commitFailures++;
+    return false;
+  }
+
+  activeSlot = target;
+  sequence = nextSequence;
+  saved = config;
+  dirty = false;
+  commits++;
+
+  if (changeCallback != nullptr) {
+    changeCallback();
+  }
+  return true;
+}
+
+bool ConfigStore::writeSlot(uint8_t slot, uint32_t slotSequence) {
+  ConfigSlotImage image;
+  image.header.magic = CONFIG_SLOT_MAGIC;
+  image.header.version = CONFIG_STORE_VERSION;
+  image.header.length = sizeof(DeviceConfig);
+  image.header.sequence = slotSequence;
+  image.config = config;
+
+  uint32_t crc = SensorManager::calculateCRC32((const uint8_t*)&image.header, 12);
+  image.header.crc32 = SensorManager::calculateCRC32((const uint8_t*)&image.config, sizeof(DeviceConfig), crc);
+
+  if (!log->writeReserved(slot, &image, sizeof(image))) {
+    return false;
+  }
+
+  // Read back: only a verified copy may become active
+  DeviceConfig check;
+  uint32_t checkSequence;
+  return readSlot(slot, check, checkSequence) && checkSequence == slotSequence &&
+         memcmp(&check, &config, sizeof(config)) == 0;
+}
+
+void ConfigStore::revert() {
+  config = saved;
+  dirty = false;
+}
+
+bool ConfigStore::isDirty() {
+  return dirty;
+}
+
+void ConfigStore::setChangeCallback(void (*callback)()) {
+  changeCallback = callback;
+}
+
+uint8_t ConfigStore::getKeyCount() {
+  return CONFIG_KEY_COUNT;
+}
+
+const ConfigKey& ConfigStore::getKey(uint8_t index) {
+  return keyTable[index < CONFIG_KEY_COUNT ? index : 0];
+}
+
+// ============================================================================
+// STATUS
+// ============================================================================
+
+void ConfigStore::printStatus() {
+  Serial.println("\n=== Device Config ===");
+  if (activeSlot < 0) {
+    Serial.print("Source: defaults");
+  } else {
+    Serial.print("Source: slot ");
+    Serial.print(activeSlot == 0 ? "A" : "B");
+    Serial.print(" (seq ");
+    Serial.print(sequence);
+    Serial.print(")");
+  }
+  Serial.print(", loaded in ");
+  Serial.print(loadMicros);
+  Serial.print(" us, cloud gen ");
+  Serial.print(config.cloudGeneration);
+  Serial.print(", commits ");
+  Serial.print(commits);
+  Serial.print(", failed ");
+  Serial.print(commitFailures);
+  Serial.println(dirty ? ", UNSAVED changes" : "");
+
+  for (uint8_t i = 0; i < CONFIG_KEY_COUNT; i++) {
+    const ConfigKey& entry = keyTable[i];
+    const uint8_t* field = (const uint8_t*)&config + entry.offset;
+
+    Serial.print("  ");
+    Serial.print(entry.name);
+    Serial.print(" = ");
+    if (entry.type == CONFIG_FLOAT) {
+      float value;
+      memcpy(&value, field, sizeof(float));
+      Serial.println(value, 4);
+    } else {
+      uint32_t value;
+      memcpy(&value, field, sizeof(uint32_t));
+      Serial.println(value);
+    }
+  }
+  Serial.println();
+}
@@ -0,0 +1,141 @@
+/**
+ * GreenOS - Persistent Device Configuration
+ *
+ * One versioned, CRC-checked DeviceConfig blob (thresholds, calibration,
+ * task intervals) in two A/B slots - the flash log's reserved sectors.
+ *
+ * - Load: both slot images are read and checked (magic, version, length,
+ *   CRC32); the valid one with the higher sequence wins. That is two
+ *   small flash reads and a CRC over ~70 bytes, so the config is in RAM
+ *   microseconds into setup(). With no valid slot the compiled defaults
+ *   (config.h / module headers) are used.
+ * - Save: the new image always goes to the slot that is NOT active, with
+ *   sequence + 1, and is read back before it becomes active. Power loss
+ *   mid-write leaves a CRC failure in that slot and the previous copy in
+ *   the other, so there is never a moment without a valid config.
+ * - Versioning: fields are only ever appended. An older, shorter blob
+ *   is loaded over the defaults, so new fields start at their default.
+ *
+ * Changes come in as individual key = value deltas (set()), checked
+ * against the key table's range, and are written together by commit(),
+ * which also checks that min/max pairs are still ordered (so a delta may
+ * move both ends of a range in any order) and otherwise reverts. The
+ * cloud's delta updates carry a generation number; setCloudGeneration()
+ * stores it with the values so a replayed or older update is ignored.
+ */
+
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+#include "flash_log.h"
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+#define CONFIG_STORE_VERSION 1
+#define CONFIG_STORE_SLOTS 2           // A/B (<= FLASH_LOG_RESERVED_SECTORS)
+
+// ============================================================================
+// DEVICE CONFIG (on-flash payload - append new fields at the end only)
+// ============================================================================
+
+struct DeviceConfig {
+  // Thresholds (AnomalyDetection absolute limits)
+  float tempMin;
+  float tempMax;
+  float humidityMin;
+  float humidityMax;
+
+  // Calibration
+  float adcOffset;
+  float adcScale;
+  float adcVRef;
+  float adcTempCoeff;
+  float mq135R0;                 // MQ135 clean-air resistance (ohms)
+
+  // Task intervals
+  uint32_t sensorIntervalMs;
+  uint32_t syncIntervalMs;
+  uint32_t healthIntervalMs;
+
+  uint32_t cloudGeneration;      // Last cloud update applied (0 = none)
+
+  // Security (no RTC - the cloud sets it from the greenhouse schedule)
+  uint32_t offHours;             // 1 = premises closed: motion raises MOTION_OFF_HOURS
+};
+
+// Key table entry (static table in the .cpp, DeviceConfig order)
+enum ConfigValueType {
+  CONFIG_FLOAT,
+  CONFIG_U32
+};
+
+struct ConfigKey {
+  const char* name;              // Cloud / serial name
+  uint16_t offset;               // offsetof(DeviceConfig, field)
+  ConfigValueType type;
+  float minValue;
+  float maxValue;
+};
+
+// ============================================================================
+// CONFIG STORE CLASS
+// ============================================================================
+
+class ConfigStore {
+public:
+  ConfigStore();
+
+  // Load the newest valid slot, or the defaults. Call after flashLog.begin().
+  bool begin(FlashLog* log);
+
+  const DeviceConfig& get();
+  static void getDefaults(DeviceConfig& config);
+  bool isPersisted();            // false = compiled defaults (nothing valid on flash)
+
+  // Delta update in RAM: false for an unknown key or an out-of-range
+  // value (the config is unchanged)
+  bool set(const char* key, float value);
+  bool setCalibration(float offset, float scale, float vRef, float tempCoeff);
+  bool setMQ135R0(float r0);
+  void setCloudGeneration(uint32_t generation);
+  uint32_t getCloudGeneration();
+
+  // Write pending changes to the inactive slot. Nothing to do = true.
+  // An unordered min/max pair reverts to the last committed config; a
+  // flash failure keeps the new values in RAM (still dirty) and fails.
+  bool commit();
+  void revert();
+  bool isDirty();
+
+  // Called after every commit that reached flash, so the running
+  // modules pick up the new values
+  void setChangeCallback(void (*callback)());
+
+  static uint8_t getKeyCount();
+  static const ConfigKey& getKey(uint8_t index);
+
+  void printStatus();
+
+private:
+  FlashLog* log;
+  DeviceConfig config;
+  DeviceConfig saved;            // As loaded / last committed
+  bool dirty;
+  int8_t activeSlot;             // -1 = defaults, nothing on flash yet
+  uint32_t sequence;             // Of the active slot
+  uint32_t loadMicros;
+  uint32_t commits;
+  uint32_t commitFailures;
+  void (*changeCallback)();
+
+  bool readSlot(uint8_t slot, DeviceConfig& out, uint32_t& outSequence);
+  bool writeSlot(uint8_t slot, uint32_t slotSequence);
+  static bool isOrdered(const DeviceConfig& config);
+};
+
+extern ConfigStore configStore;
+
+#endif // CONFIG_STORE_H
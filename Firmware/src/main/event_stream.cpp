@@ -0,0 +1,179 @@
+/**
+ * GreenOS - Server-Sent Events Parser Implementation
+ *
+ * Follows the WHATWG event-stream grammar for the subset Firebase uses:
+ * CR, LF or CRLF line endings, "field: value" lines, ':' comments and
+ * blank-line dispatch. The "id" and "retry" fields are ignored.
+ */
+
+#include "event_stream.h"
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+EventStreamParser::EventStreamParser() {
+  callback = nullptr;
+  context = nullptr;
+  eventCount = 0;
+  droppedCount = 0;
+  reset();
+}
+
+void EventStreamParser::begin(EventStreamCallback callback, void* context) {
+  this->callback = callback;
+  this->context = context;
+  reset();
+}
+
+void EventStreamParser::reset() {
+  lineState = LINE_FIELD;
+  fieldType = FIELD_UNKNOWN;
+  lastWasCR = false;
+  fieldLength = 0;
+  clearEvent();
+}
+
+void EventStreamParser::clearEvent() {
+  eventNameLength = 0;
+  eventName[0] = '\0';
+  dataLength = 0;
+  data[0] = '\0';
+  hasData = false;
+  overflow = false;
+}
+
+// ============================================================================
+// PARSING
+// ============================================================================
+
+uint8_t EventStreamParser::feed(const uint8_t* bytes, size_t length) {
+  uint8_t dispatched = 0;
+
+  for (size_t i = 0; i < length; i++) {
+    char c = (char)bytes[i];
+
+    if (c == '\r') {
+      lastWasCR = true;
+      if (endLine()) dispatched++;
+      continue;
+    }
+    if (c == '\n') {
+      if (lastWasCR) {
+        lastWasCR = false;  // Second half of CRLF
+        continue;
+      }
+      if (endLine()) dispatched++;
+      continue;
+    }
+
+    lastWasCR = false;
+    processChar(c);
+  }
+
+  return dispatched;
+}
+
+void EventStreamParser::processChar(char c) {
+  switch (lineState) {
+    case LINE_FIELD:
+      if (c == ':') {
+        // Empty field name = comment line (Firebase never sends these,
+        // proxies do for keep-alive)
+        if (fieldLength == 0) {
+          lineState = LINE_IGNORE;
+        } else {
+          beginValue();
+        }
+      } else if (fieldLength < EVENT_STREAM_FIELD_SIZE - 1) {
+        field[fieldLength++] = c;
+      } else {
+        lineState = LINE_IGNORE;  // No field we handle is this long
+      }
+      break;
+
+    case LINE_VALUE_START:
+      lineState = LINE_VALUE;
+      if (c != ' ') appendValue(c);
+      break;
+
+    case LINE_VALUE:
+      appendValue(c);
+      break;
+
+    case LINE_IGNORE:
+      break;
+  }
+}
+
+void EventStreamParser::beginValue() {
+  field[fieldLength] = '\0';
+
+  if (strcmp(field, "data") == 0) {
+    fieldType = FIELD_DATA;
+    // Successive data lines are joined with a newline
+    if (hasData) appendValue('\n');
+    hasData = true;
+  } else if (strcmp(field, "event") == 0) {
+    fieldType = FIELD_EVENT;
+    eventNameLength = 0;
+  } else {
+    fieldType = FIELD_UNKNOWN;
+  }
+
+  lineState = LINE_VALUE_START;
+}
+
+void EventStreamParser::appendValue(char c) {
+  if (fieldType == FIELD_DATA) {
+    if (dataLength < EVENT_STREAM_DATA_SIZE - 1) {
+      data[dataLength++] = c;
+    } else {
+      overflow = true;
+    }
+  } else if (fieldType == FIELD_EVENT) {
+    if (eventNameLength < EVENT_STREAM_NAME_SIZE - 1) {
+      eventName[eventNameLength++] = c;
+    }
+  }
+}
+
+bool EventStreamParser::endLine() {
+  bool dispatched = false;
+
+  if (lineState == LINE_FIELD && fieldLength == 0) {
+    // Blank line - dispatch the pending event
+    if (hasData || eventNameLength > 0) {
+      if (overflow) {
+        droppedCount++;
+      } else if (callback != nullptr) {
+        data[dataLength] = '\0';
+        eventName[eventNameLength] = '\0';
+        callback(eventNameLength > 0 ? eventName : "message", data, dataLength, context);
+        eventCount++;
+        dispatched = true;
+      }
+    }
+    clearEvent();
+  } else if (lineState == LINE_FIELD) {
+    // Field name without ':' - field with an empty value
+    beginValue();
+  }
+
+  lineState = LINE_FIELD;
+  fieldType = FIELD_UNKNOWN;
+  fieldLength = 0;
+  return dispatched;
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+uint32_t EventStreamParser::getEventCount() {
+  return eventCount;
+}
+
+uint32_t EventStreamParser::getDroppedCount() {
+  return droppedCount;
+}
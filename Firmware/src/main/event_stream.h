@@ -0,0 +1,79 @@
+/**
+ * GreenOS - Server-Sent Events Parser
+ *
+ * Incremental text/event-stream parser for the command channel. Bytes
+ * are fed as they arrive from the socket, in chunks of any size; each
+ * complete event (terminated by a blank line) is dispatched to a
+ * callback with its "event" name and "data" payload.
+ *
+ * Fixed buffers only: an event whose data exceeds EVENT_STREAM_DATA_SIZE
+ * is dropped and counted, and parsing resynchronizes at the next event.
+ */
+
+#ifndef EVENT_STREAM_H
+#define EVENT_STREAM_H
+
+#include <Arduino.h>
+
+#define EVENT_STREAM_DATA_SIZE 384
+#define EVENT_STREAM_NAME_SIZE 16
+#define EVENT_STREAM_FIELD_SIZE 8
+
+// data is null-terminated; multi-line data fields are joined with '\n'
+typedef void (*EventStreamCallback)(const char* event, const char* data, size_t length, void* context);
+
+class EventStreamParser {
+public:
+  EventStreamParser();
+  void begin(EventStreamCallback callback, void* context);
+  void reset();
+
+  // Returns number of events dispatched from this chunk
+  uint8_t feed(const uint8_t* bytes, size_t length);
+
+  uint32_t getEventCount();
+  uint32_t getDroppedCount();
+
+private:
+  enum LineState {
+    LINE_FIELD,        // Reading field name
+    LINE_VALUE_START,  // After ':' - one leading space is skipped
+    LINE_VALUE,        // Reading value
+    LINE_IGNORE        // Comment or unknown field
+  };
+
+  enum FieldType {
+    FIELD_UNKNOWN,
+    FIELD_DATA,
+    FIELD_EVENT
+  };
+
+  EventStreamCallback callback;
+  void* context;
+
+  LineState lineState;
+  FieldType fieldType;
+  bool lastWasCR;
+
+  char field[EVENT_STREAM_FIELD_SIZE];
+  uint8_t fieldLength;
+
+  char eventName[EVENT_STREAM_NAME_SIZE];
+  uint8_t eventNameLength;
+
+  char data[EVENT_STREAM_DATA_SIZE];
+  uint16_t dataLength;
+  bool hasData;
+  bool overflow;
+
+  uint32_t eventCount;
+  uint32_t droppedCount;
+
+  void processChar(char c);
+  void beginValue();
+  void appendValue(char c);
+  bool endLine();   // true if an event was dispatched
+  void clearEvent();
+};
+
+#endif // EVENT_STREAM_H
@@ -5,19 +5,73 @@
  * a secure, token-based authentication method.
  * 
  * NOTE: Firebase ESP Client library is not compatible with Arduino UNO R4.
- * This is a simplified stub implementation for initial testing.
- * For production, implement Firebase REST API calls using WiFiClient.
+ * With FIREBASE_RPC_LINK the network runs on the ESP32-S3 co-processor
+ * (see the CO-PROCESSOR LINK section); the direct transport below is
+ * still a stub for a core with working WiFi.
  */
 
  #include "firebase_comm.h"
  #include "config.h"
- #include <ArduinoJson.h>
+ #include "config_store.h"
  // Note: WiFi disabled due to BSP incompatibility on Arduino UNO Q
  
+ // Column identifiers for appendColumn()
+ enum UplinkField {
+   FIELD_TIME,
+   FIELD_AIR_TEMP,
+   FIELD_AIR_HUMIDITY,
+   FIELD_CO2,
+   FIELD_PH,
+   FIELD_EC,
+   FIELD_VWC
+ };
+ 
  FirebaseComm::FirebaseComm() {
    this->connected = false;
    this->lastConnectionAttempt = 0;
    this->deviceId = GREENHOUSE_ID;
+   this->batchCount = 0;
+   this->batchBase = 0;
+   this->rollupCount = 0;
+   this->payloadLength = 0;
+   this->payloadOverflow = false;
+   this->consecutiveFailures = 0;
+   this->reconnectDelayMs = 0;
+   this->lastActivity = 0;
+   this->sessionCached = false;
+   this->linkIdle = false;
+   memset(&this->linkStats, 0, sizeof(this->linkStats));
+   this->streamOpen = false;
+   this->streamFailures = 0;
+   this->lastStreamAttempt = 0;
+   this->streamRetryMs = 0;
+   this->lastStreamActivity = 0;
+   this->commandHistorySeen = false;
+   this->lastCommandKey[0] = '\0';
+   this->commandSink = nullptr;
+   this->commandStream.begin(onStreamEvent, this);
+   memset(&this->coprocessor, 0, sizeof(this->coprocessor));
+   this->linkWasAlive = false;
+   this->awaitingReply = false;
+   this->replySentAt = 0;
+   this->uplinkState = UPLINK_IDLE;
+   this->uplinkSeq = 0;
+   this->uplinkSentAt = 0;
+   this->uplinkCrc = 0;
+   this->uplinkReadings = 0;
+   this->uplinkRollups = 0;
+   this->uploadCallback = nullptr;
+   this->bootId = 0;
+   this->batchSeq = 0;
+   this->batchBoot = 0;
+   this->alertState = UPLINK_IDLE;
+   this->alertSeq = 0;
+   this->alertSentAt = 0;
+   this->alertCrc = 0;
+   this->alertCustody = false;
+   this->alertTextLength = 0;
+   memset(&this->alertRecord, 0, sizeof(this->alertRecord));
+   this->alertFallback = nullptr;
  }
  
  /**
@@ -25,82 +79,1582 @@
   * STUB: Firebase ESP Client not compatible with UNO R4 - using placeholder
   */
  void FirebaseComm::init() {
+ #if FIREBASE_RPC_LINK
+   Serial.println("Initializing Firebase (ESP32-S3 co-processor link)...");
+   RPC_LINK_SERIAL.begin(RPC_LINK_BAUD);
+   link.begin(RPC_LINK_SERIAL, onLinkFrame, this);
+   sendHello();
+   sendLinkRequest(RPC_POLL);
+   Serial.println("ℹ️  Data stays in the local log until the co-processor has a cloud session");
+ #else
    Serial.println("Initializing Firebase (Stub Mode)...");
    Serial.println("⚠️  Firebase integration disabled for initial testing");
    Serial.println("ℹ️  System will operate in offline mode with local data logging");
    
    // Mark as "connected" for testing purposes (no actual connection)
    this->connected = false;
+ #endif
+   
+   // Jitter source for reconnect backoff - differs per boot and device
+   randomSeed(micros());
+ }
+ 
+ void FirebaseComm::setBootId(uint32_t id) {
+   this->bootId = id;
  }
  
  /**
   * Connects to Firebase
-  * STUB: Returns false to indicate no connection
+  * STUB: Returns false to indicate no connection. A real client opens
+  * the TLS socket here, offering the cached session for resumption.
   */
  bool FirebaseComm::connect() {
-   Serial.println("Firebase connection skipped (stub mode)");
    this->lastConnectionAttempt = millis();
-   return false;  // Not actually connected
+   
+   bool resumed = this->sessionCached;
+   bool ok = false;  // Stub: no transport yet
+   
+   if (!ok) {
+     Serial.println("Firebase connection skipped (stub mode)");
+     this->linkStats.failedAttempts++;
+     this->sessionCached = false;  // Resumption failed - next attempt is a full handshake
+     scheduleReconnect();
+     return false;
+   }
+   
+   if (resumed) {
+     this->linkStats.resumedHandshakes++;
+   } else {
+     this->linkStats.fullHandshakes++;
+   }
+   this->connected = true;
+   this->linkIdle = false;
+   this->sessionCached = true;
+   this->consecutiveFailures = 0;
+   this->reconnectDelayMs = 0;
+   this->linkStats.requestsOnConnection = 0;
+   markActivity();
+   return true;
+ }
+ 
+ /**
+  * Closes the socket. keepSession retains the TLS session so the next
+  * connect() is an abbreviated handshake.
+  */
+ void FirebaseComm::disconnect(bool keepSession) {
+   this->connected = false;
+   if (!keepSession) {
+     this->sessionCached = false;
+   }
+ }
+ 
+ /**
+  * Exponential backoff with "equal jitter": the delay is drawn from
+  * [d/2, d) with d = base * 2^failures, capped, so a fleet that lost the
+  * same uplink does not reconnect in lockstep.
+  */
+ void FirebaseComm::scheduleReconnect() {
+   this->reconnectDelayMs = backoffDelay(this->consecutiveFailures);
+   this->linkStats.reconnectDelayMs = this->reconnectDelayMs;
+   
+   if (this->consecutiveFailures < 255) {
+     this->consecutiveFailures++;
+   }
+ }
+ 
+ unsigned long FirebaseComm::backoffDelay(uint8_t failures) {
+   unsigned long delayMs = FIREBASE_BACKOFF_BASE_MS;
+   for (uint8_t i = 0; i < failures && delayMs < FIREBASE_BACKOFF_MAX_MS; i++) {
+     delayMs *= 2;
+   }
+   if (delayMs > FIREBASE_BACKOFF_MAX_MS) {
+     delayMs = FIREBASE_BACKOFF_MAX_MS;
+   }
+   return delayMs / 2 + random(delayMs / 2);
+ }
+ 
+ void FirebaseComm::markActivity() {
+   this->lastActivity = millis();
+ }
+ 
+ /**
+  * Keeps the long-lived connections healthy:
+  * - Reconnects once the backoff window after lastConnectionAttempt expires
+  * - Closes an idle socket before the server's keep-alive timeout, keeping
+  *   the TLS session so reopening on demand is cheap
+  * - (Re)opens the command stream, and drops it if keep-alives stop
+  */
+ void FirebaseComm::maintainConnection() {
+   unsigned long now = millis();
+   
+ #if FIREBASE_RPC_LINK
+   // The co-processor reconnects and backs off itself; this only tracks
+   // whether it is still answering
+   bool alive = link.isAlive();
+   if (alive != this->linkWasAlive) {
+     Serial.println(alive ? "✓ Co-processor link up" : "⚠️  Co-processor link silent - buffering locally");
+     this->linkWasAlive = alive;
+   }
+   if (!alive) {
+     this->connected = false;
+     this->streamOpen = false;
+   }
+   
+   if (this->uplinkState == UPLINK_IN_FLIGHT &&
+       (!alive || now - this->uplinkSentAt >= RPC_UPLOAD_TIMEOUT_MS)) {
+     Serial.println("⚠️  Batch upload timed out - will retry");
+     finishUpload(false);
+   }
+   if (this->alertState == UPLINK_IN_FLIGHT &&
+       (!alive || now - this->alertSentAt >= RPC_UPLOAD_TIMEOUT_MS)) {
+     Serial.println("⚠️  Alert delivery timed out");
+     finishAlert(false);
+   }
+ #else
+   if (this->streamOpen) {
+     if (now - this->lastStreamActivity >= COMMAND_STREAM_TIMEOUT_MS) {
+       Serial.println("⚠️  Command stream silent - reconnecting");
+       closeCommandStream();
+     }
+   } else if (now - this->lastStreamAttempt >= this->streamRetryMs) {
+     openCommandStream();
+   }
+   
+   if (this->connected) {
+     if (now - this->lastActivity >= FIREBASE_KEEPALIVE_IDLE_MS) {
+       disconnect(true);
+       this->linkIdle = true;
+     }
+     return;
+   }
+   
+   if (!this->linkIdle && now - this->lastConnectionAttempt >= this->reconnectDelayMs) {
+     connect();
+   }
+ #endif
+ }
+ 
+ FirebaseLinkStats FirebaseComm::getLinkStats() {
+   return this->linkStats;
  }
 
  /**
-  * Sends sensor data to the Firebase Realtime Database.
-  * STUB: Not implemented - would require Firebase REST API
+  * Sends a single sensor snapshot as a one-reading batch.
+  * Buffered data should go through beginBatch()/addToBatch()/sendBatch().
+  */
+ bool FirebaseComm::syncSensorData(const SensorData& data) {
+   RecordCodec codec;
+   PackedReading packed = codec.pack(data);
+   PackedBlockHeader header = RecordCodec::blockHeader(1, data.timestamp);
+   
+   beginBatch();
+   addToBatch(header, &packed);
+   return sendBatch();
+ }
+ 
+ // ============================================================================
+ // BATCH UPLINK
+ // ============================================================================
+ 
+ /**
+  * Discards any pending batch. The next one holds this boot's records
+  * until setBatchBoot() says otherwise.
   */
- bool FirebaseComm::syncSensorData(SensorData data) {
-   // Stub: Log locally instead of syncing
-   Serial.println("📊 Sensor data logged locally (Firebase stub)");
-   return false;  // Indicate no cloud sync occurred
+ void FirebaseComm::beginBatch() {
+   this->batchCount = 0;
+   this->batchBase = 0;
+   this->rollupCount = 0;
+   this->batchBoot = bootId;
  }
  
  /**
-  * Sends an alert message to the Firebase Realtime Database.
-  * STUB: Not implemented - would require Firebase REST API
+  * Boot the batch's records were logged in - their millis() only map to
+  * wall-clock time against that boot. 0 = unknown (no boot marker yet).
   */
- bool FirebaseComm::sendAlert(String alertDetails) {
-   Serial.print("🚨 ALERT (local only): ");
-   Serial.println(alertDetails);
-   return false;  // Indicate no cloud sync occurred
+ void FirebaseComm::setBatchBoot(uint32_t boot) {
+   batchBoot = boot;
  }
  
+ /**
+  * Adds one packed block (header + header.count records) to the batch.
+  * Blocks are all-or-nothing: returns false without adding anything if
+  * the block does not fit, so the caller's cursor stays on a block edge.
+  */
+ bool FirebaseComm::addToBatch(const PackedBlockHeader& header, const PackedReading* records) {
+   if (header.count == 0) return true;
+   if (batchCount + header.count > getBatchCapacity()) return false;
+   
+   if (batchCount == 0) {
+     batchBase = header.baseTimestamp;
+   }
+   
+   // First record's delta is ignored - its time is the block base
+   unsigned long timestamp = header.baseTimestamp;
+   for (uint16_t i = 0; i < header.count; i++) {
+     if (i > 0) {
+       timestamp += RecordCodec::deltaMillis(records[i]);
+     }
+     batchRecords[batchCount] = records[i];
+     batchOffsets[batchCount] = timestamp - batchBase;
+     batchCount++;
+   }
+   return true;
+ }
+ 
+ /**
+  * Adds one completed rollup window. Returns false if the batch is full.
+  */
+ bool FirebaseComm::addRollupToBatch(const PackedRollup& rollup) {
+   uint8_t capacity = (uplinkState == UPLINK_IDLE) ? UPLINK_MAX_ROLLUPS : uplinkRollups;
+   if (rollupCount >= capacity) return false;
+   batchRollups[rollupCount++] = rollup;
+   return true;
+ }
+ 
+ uint16_t FirebaseComm::getBatchCount() {
+   return batchCount;
+ }
+ 
+ uint8_t FirebaseComm::getBatchRollupCount() {
+   return rollupCount;
+ }
+ 
+ size_t FirebaseComm::getLastPayloadSize() {
+   return payloadLength;
+ }
+ 
+ uint16_t FirebaseComm::getBatchCapacity() {
+   return (uplinkState == UPLINK_IDLE) ? UPLINK_MAX_BATCH : uplinkReadings;
+ }
+ 
+ bool FirebaseComm::isUploadPending() {
+   return uplinkState == UPLINK_IN_FLIGHT;
+ }
+ 
+ void FirebaseComm::setUploadCallback(void (*callback)(bool ok)) {
+   uploadCallback = callback;
+ }
+ 
+ /**
+  * Serializes the pending batch and uploads it in one request.
+  * The batch is kept on failure so it can be retried unchanged.
+  */
+ bool FirebaseComm::sendBatch() {
+   if (batchCount == 0 && rollupCount == 0) return true;
+   
+ #if FIREBASE_RPC_LINK
+   return sendBatchOverLink();
+ #else
+   assignBatchSeq(batchCrc());
+   if (serializeBatch() == 0) {
+     Serial.println("✗ Batch payload overflow - reduce UPLINK_MAX_BATCH");
+     return false;
+   }
+   
+   if (!sendPayload(UPLINK_BATCH_PATH, payload, payloadLength)) {
+     return false;
+   }
+   
+   Serial.print("📊 Uploaded ");
+   Serial.print(batchCount);
+   Serial.print(" readings, ");
+   Serial.print(rollupCount);
+   Serial.print(" rollups in ");
+   Serial.print(payloadLength);
+   Serial.println(" bytes");
+   
+   beginBatch();
+   return true;
+ #endif
+ }
+ 
+ /**
+  * Columnar layout (v1), fixed-point values as stored by RecordCodec,
+  * wrapped in the callable-function envelope {"data":{...}}:
+  *   {"device":"gh-001","v":1,"boot":<boot id>,"seq":<batch seq>,
+  *    "now":<millis>,"logBoot":<boot id>,"base":<millis>,"n":N,
+  *    "scale":{"temp":100,...},"t":[<ms from base>,...],
+  *    "temp":[...],"rh":[...],"co2":[...],"ph":[...],"ec":[...],"vwc":[...],
+  *    "rollups":[{"w":<window ms>,"s":<start millis>,
+  *                "temp":[min,max,mean,count,last],...,
+  *                "act":{"heater1":[on s,0.1 Wh],...}},...]}
+  * Invalid samples (and metrics with no samples in a window) are null.
+  * "base" and "s" are millis() of "logBoot", the boot that logged the
+  * records; "now" is millis() of "boot", the sending one, and anchors it
+  * to wall-clock time at receipt. "boot" + "seq" identify the batch so a
+  * retry is stored once.
+  * Returns the payload length, or 0 if it did not fit.
+  */
+ size_t FirebaseComm::serializeBatch() {
+   payloadLength = 0;
+   payloadOverflow = false;
+   
+   appendText("{\"data\":{\"device\":\"");
+   appendText(deviceId);
+   appendText("\",\"v\":");
+   appendNumber(UPLINK_FORMAT_VERSION);
+   appendText(",\"boot\":");
+   appendUnsigned(bootId);
+   appendText(",\"seq\":");
+   appendUnsigned(batchSeq);
+   appendText(",\"now\":");
+   appendUnsigned(millis());
+   appendText(",\"logBoot\":");
+   appendUnsigned(batchBoot);
+   appendText(",\"base\":");
+   appendUnsigned(batchBase);
+   appendText(",\"n\":");
+   appendNumber(batchCount);
+   appendText(",\"scale\":{\"temp\":");
+   appendNumber(RECORD_SCALE_TEMP);
+   appendText(",\"rh\":");
+   appendNumber(RECORD_SCALE_HUMIDITY);
+   appendText(",\"co2\":");
+   appendNumber(RECORD_SCALE_CO2);
+   appendText(",\"ph\":");
+   appendNumber(RECORD_SCALE_PH);
+   appendText(",\"ec\":");
+   appendNumber(RECORD_SCALE_EC);
+   appendText(",\"vwc\":");
+   appendNumber(RECORD_SCALE_VWC);
+   appendText("}");
+   
+   appendColumn("t", FIELD_TIME);
+   appendColumn("temp", FIELD_AIR_TEMP);
+   appendColumn("rh", FIELD_AIR_HUMIDITY);
+   appendColumn("co2", FIELD_CO2);
+   appendColumn("ph", FIELD_PH);
+   appendColumn("ec", FIELD_EC);
+   appendColumn("vwc", FIELD_VWC);
+   appendRollups();
+   appendText("}}");
+   
+   if (payloadOverflow) {
+     payloadLength = 0;
+   }
+   return payloadLength;
+ }
+ 
+ void FirebaseComm::appendText(const char* text) {
+   while (*text != '\0') {
+     if (payloadLength >= UPLINK_PAYLOAD_SIZE - 1) {
+       payloadOverflow = true;
+       return;
+     }
+     payload[payloadLength++] = *text++;
+   }
+   payload[payloadLength] = '\0';
+ }
+ 
+ void FirebaseComm::appendNumber(long value) {
+   char digits[12];
+   ltoa(value, digits, 10);
+   appendText(digits);
+ }
+ 
+ void FirebaseComm::appendUnsigned(uint32_t value) {
+   char digits[11];
+   char* cursor = &digits[sizeof(digits) - 1];
+   *cursor = '\0';
+   do {
+     *--cursor = (char)('0' + value % 10);
+     value /= 10;
+   } while (value > 0);
+   appendText(cursor);
+ }
+ 
+ /**
+  * Appends a JSON string body (no quotes): escapes quote, backslash and
+  * control characters; other bytes (UTF-8) pass through.
+  */
+ void FirebaseComm::appendEscaped(const char* text, size_t length) {
+   static const char hex[] = "0123456789abcdef";
+   char escape[7];
+   
+   for (size_t i = 0; i < length && !payloadOverflow; i++) {
+     char c = text[i];
+     if (c == '"' || c == '\\') {
+       escape[0] = '\\';
+       escape[1] = c;
+       escape[2] = '\0';
+     } else if ((uint8_t)c < 0x20) {
+       escape[0] = '\\';
+       escape[1] = 'u';
+       escape[2] = '0';
+       escape[3] = '0';
+       escape[4] = hex[(uint8_t)c >> 4];
+       escape[5] = hex[c & 0x0F];
+       escape[6] = '\0';
+     } else {
+       escape[0] = c;
+       escape[1] = '\0';
+     }
+     appendText(escape);
+   }
+ }
+ 
+ void FirebaseComm::appendColumn(const char* name, uint8_t field) {
+   appendText(",\"");
+   appendText(name);
+   appendText("\":[");
+   
+   for (uint16_t i = 0; i < batchCount; i++) {
+     if (i > 0) appendText(",");
+     
+     const PackedReading& record = batchRecords[i];
+     long value;
+     bool valid = true;
+     
+     switch (field) {
+       case FIELD_TIME:
+         value = (long)batchOffsets[i];
+         break;
+       case FIELD_AIR_TEMP:
+         value = record.airTemp;
+         valid = (record.airTemp != RECORD_INVALID_SIGNED);
+         break;
+       case FIELD_AIR_HUMIDITY:
+         value = record.airHumidity;
+         valid = (record.airHumidity != RECORD_INVALID_UNSIGNED);
+         break;
+       case FIELD_CO2:
+         value = record.co2;
+         valid = (record.co2 != RECORD_INVALID_UNSIGNED);
+         break;
+       case FIELD_PH:
+         value = record.ph;
+         valid = (record.ph != RECORD_INVALID_UNSIGNED);
+         break;
+       case FIELD_EC:
+         value = record.ec;
+         valid = (record.ec != RECORD_INVALID_UNSIGNED);
+         break;
+       default:
+         value = record.vwc;
+         valid = (record.vwc != RECORD_INVALID_UNSIGNED);
+         break;
+     }
+     
+     if (valid) {
+       appendNumber(value);
+     } else {
+       appendText("null");
+     }
+   }
+   
+   appendText("]");
+ }
+ 
+ void FirebaseComm::appendRollups() {
+   static const char* const names[ROLLUP_METRIC_COUNT] = {
+     "temp", "rh", "co2", "ph", "ec", "vwc"
+   };
+   
+   // ActuatorId order
+   static const char* const actuatorNames[ACTUATOR_COUNT] = {
+     "heater1", "heater2", "exhaust", "circulation", "pump", "light"
+   };
+   
+   appendText(",\"rollups\":[");
+   
+   for (uint8_t i = 0; i < rollupCount; i++) {
+     const PackedRollup& rollup = batchRollups[i];
+     if (i > 0) appendText(",");
+     
+     appendText("{\"w\":");
+     appendUnsigned(SensorRollup::getWindowLength((RollupLevel)rollup.level));
+     appendText(",\"s\":");
+     appendUnsigned(rollup.windowStart);
+     
+     for (uint8_t m = 0; m < ROLLUP_METRIC_COUNT; m++) {
+       const PackedRollupMetric& metric = rollup.metrics[m];
+       appendText(",\"");
+       appendText(names[m]);
+       appendText("\":");
+       
+       if (metric.count == 0) {
+         appendText("null");
+         continue;
+       }
+       
+       // Air temperature carries the int16 bit pattern
+       bool isSigned = (m == ROLLUP_AIR_TEMP);
+       appendText("[");
+       appendNumber(isSigned ? (int16_t)metric.min : metric.min);
+       appendText(",");
+       appendNumber(isSigned ? (int16_t)metric.max : metric.max);
+       appendText(",");
+       appendNumber(isSigned ? (int16_t)metric.mean : metric.mean);
+       appendText(",");
+       appendNumber(metric.count);
+       appendText(",");
+       appendNumber(isSigned ? (int16_t)metric.last : metric.last);
+       appendText("]");
+     }
+     
+     // Actuators that were ON during the window
+     appendText(",\"act\":{");
+     bool first = true;
+     for (uint8_t id = 0; id < ACTUATOR_COUNT; id++) {
+       const PackedActuatorUsage& usage = rollup.actuators[id];
+       if (usage.onSeconds == 0) continue;
+       
+       if (!first) appendText(",");
+       first = false;
+       appendText("\"");
+       appendText(actuatorNames[id]);
+       appendText("\":[");
+       appendNumber(usage.onSeconds);
+       appendText(",");
+       appendNumber(usage.energy);
+       appendText("]");
+     }
+     appendText("}}");
+   }
+   
+   appendText("]");
+ }
+ 
+ /**
+  * POSTs a request body to the cloud ingest endpoint over HTTPS.
+  * STUB: WiFi disabled - would require WiFiSSLClient on the ESP32 bridge
+  */
+ bool FirebaseComm::sendPayload(const char* path, const char* body, size_t length) {
+   // Never handshake on the request path - maintainConnection() reconnects
+   if (!connected) {
+     if (linkIdle) {
+       // Closed for inactivity: reopen (resumed) on the next link pass
+       linkIdle = false;
+       reconnectDelayMs = 0;
+     }
+     return false;
+   }
+   
+   // Stub: no transport yet. A real client writes one keep-alive request
+   // ("Connection: keep-alive", Content-Length) on the open socket.
+   bool ok = false;
+   
+   if (!ok) {
+     // Broken socket - drop it, retry through the backoff policy
+     disconnect(true);
+     scheduleReconnect();
+     return false;
+   }
+   
+   this->linkStats.requestsOnConnection++;
+   markActivity();
+   return true;
+ }
+ 
+ /**
+  * Sends one alert to the ingest endpoint.
+  */
+ bool FirebaseComm::sendAlert(const char* details, size_t length, const char* severity) {
+   LoggedAlert alert;
+   memset(&alert, 0, sizeof(alert));
+   alert.firstSeen = millis();
+   alert.boot = bootId;
+   alert.severity = AlertQueue::parseSeverity(severity);
+   return sendTextAlert(alert, details, length, true);
+ }
+ 
+ /**
+  * One text alert, live or from the local log:
+  *   {"data":{"device":"gh-001","boot":<id>,"now":<millis>,"severity":"critical",
+  *    "first":<millis>,"logBoot":<id>,"message":"..."}}
+  * "first" is millis() of "logBoot", the boot that raised the alert -
+  * not "boot" for a record logged before the latest reset. The text is
+  * escaped straight into the static payload buffer, so the caller can
+  * pass a log record or stack buffer without copying it. Severity is
+  * omitted when unknown.
+  */
+ bool FirebaseComm::sendTextAlert(const LoggedAlert& alert, const char* details, size_t length,
+                                  bool custody) {
+   if (length > UPLINK_MAX_ALERT_TEXT) {
+     length = UPLINK_MAX_ALERT_TEXT;
+   }
+   
+ #if FIREBASE_RPC_LINK
+   return sendAlertsOverLink(nullptr, &alert, details, length, custody);
+ #else
+   (void)custody;  // A failed request is the caller's to log
+   payloadLength = 0;
+   payloadOverflow = false;
+   appendText("{\"data\":{\"device\":\"");
+   appendText(deviceId);
+   appendText("\",\"boot\":");
+   appendUnsigned(bootId);
+   appendText(",\"now\":");
+   appendUnsigned(millis());
+   if (alert.severity <= ALERT_CRITICAL) {
+     appendText(",\"severity\":\"");
+     appendText(AlertQueue::getSeverityName((AlertSeverity)alert.severity));
+     appendText("\"");
+   }
+   appendText(",\"first\":");
+   appendUnsigned(alert.firstSeen);
+   appendText(",\"logBoot\":");
+   appendUnsigned(alert.boot);
+   appendText(",\"message\":\"");
+   appendEscaped(details, length);
+   appendText("\"}}");
+   
+   if (payloadOverflow) {
+     payloadLength = 0;
+     return false;
+   }
+   
+   if (!sendPayload(UPLINK_ALERT_PATH, payload, payloadLength)) {
+     return false;
+   }
+   
+   Serial.print("🚨 Alert uploaded: ");
+   Serial.write((const uint8_t*)details, length);
+   Serial.println();
+   return true;
+ #endif
+ }
+ 
+ /**
+  * Sends a coalesced AlertQueue batch as one request:
+  *   {"data":{"device":"gh-001","boot":<id>,"now":<millis>,"alerts":[
+  *     {"type":"Humidity too high","severity":"medium","count":12,
+  *      "first":<millis>,"last":<millis>,"escalated":false,"message":"..."},...]}}
+  * Entries arrive most severe first.
+  */
+ bool FirebaseComm::sendAlertBatch(const AlertBatch& batch) {
+   if (batch.count == 0) return true;
+   
+ #if FIREBASE_RPC_LINK
+   return sendAlertsOverLink(&batch, nullptr, nullptr, 0, true);
+ #else
+   payloadLength = 0;
+   payloadOverflow = false;
+   appendText("{\"data\":{\"device\":\"");
+   appendText(deviceId);
+   appendText("\",\"boot\":");
+   appendUnsigned(bootId);
+   appendText(",\"now\":");
+   appendUnsigned(millis());
+   appendText(",\"alerts\":[");
+   
+   for (uint8_t i = 0; i < batch.count; i++) {
+     const AlertEntry& entry = batch.entries[i];
+     if (i > 0) appendText(",");
+     
+     appendText("{\"type\":\"");
+     appendText(AnomalyDetection::getTypeName(entry.type));
+     appendText("\",\"severity\":\"");
+     appendText(AlertQueue::getSeverityName(entry.severity));
+     appendText("\",\"count\":");
+     appendNumber(entry.occurrences);
+     appendText(",\"first\":");
+     appendUnsigned(entry.firstSeen);
+     appendText(",\"last\":");
+     appendUnsigned(entry.lastSeen);
+     appendText(entry.escalated ? ",\"escalated\":true" : ",\"escalated\":false");
+     appendText(",\"message\":\"");
+     appendEscaped(entry.text, strlen(entry.text));
+     appendText("\"}");
+   }
+   appendText("]}}");
+   
+   if (payloadOverflow) {
+     payloadLength = 0;
+     return false;
+   }
+   
+   if (!sendPayload(UPLINK_ALERT_PATH, payload, payloadLength)) {
+     return false;
+   }
+   
+   Serial.print("🚨 Alert batch uploaded: ");
+   Serial.print(batch.count);
+   Serial.println(" alerts");
+   return true;
+ #endif
+ }
+ 
+ void FirebaseComm::setAlertFallback(void (*callback)(const LoggedAlert& alert, const char* details,
+                                                      size_t length)) {
+   alertFallback = callback;
+ }
+ 
+ /**
+  * Re-sends an alert record from the local log, with the severity, onset
+  * and boot it was logged with. Direct transport: same as sendAlert().
+  * Over the link the first call sends it and returns false; once
+  * RPC_RESULT has confirmed it, the same record returns true.
+  */
+ bool FirebaseComm::sendLoggedAlert(const LoggedAlert& alert, const char* details, size_t length) {
+   if (length > UPLINK_MAX_ALERT_TEXT) {
+     length = UPLINK_MAX_ALERT_TEXT;
+   }
+   
+ #if FIREBASE_RPC_LINK
+   uint32_t crc = SensorManager::calculateCRC32((const uint8_t*)details, length);
+   
+   if (alertState == UPLINK_CONFIRMED && !alertCustody) {
+     alertState = UPLINK_IDLE;
+     if (crc == alertCrc) {
+       Serial.println("🚨 Logged alert delivered (co-processor)");
+       return true;
+     }
+     // A different record - send this one too
+   }
+   sendAlertsOverLink(nullptr, &alert, details, length, false);
+   return false;
+ #else
+   return sendTextAlert(alert, details, length, false);
+ #endif
+ }
+ 
+ // ============================================================================
+ // COMMAND STREAM
+ // ============================================================================
+ 
  /**
   * Check for commands from Firebase
-  * STUB: Not implemented
+  * Commands are pushed over the stream - this only drains what arrived.
   */
  void FirebaseComm::checkForCommands(ActuatorManager& actuators) {
-   // Stub: No commands to check
+   handleRealtimeUpdates(actuators);
  }
  
  /**
-  * Handle real-time updates from Firebase
-  * STUB: Not implemented
+  * Parses whatever the command stream has buffered (no network request).
+  * Bounded to COMMAND_STREAM_READ_CHUNK bytes per call to keep the loop
+  * responsive; the rest is picked up on the next call.
   */
  void FirebaseComm::handleRealtimeUpdates(ActuatorManager& actuators) {
-   // Stub: No updates to handle
+   commandSink = &actuators;
+   
+ #if FIREBASE_RPC_LINK
+   // Pull: the reply (results, commands, then status) is parsed by poll()
+   if (!awaitingReply) {
+     sendLinkRequest(RPC_POLL);
+   }
+ #else
+   if (!streamOpen) return;
+   
+   uint8_t buffer[COMMAND_STREAM_READ_CHUNK];
+   size_t length = readCommandStream(buffer, sizeof(buffer));
+   if (length > 0) {
+     lastStreamActivity = millis();
+     commandStream.feed(buffer, length);
+   }
+ #endif
  }
  
  /**
-  * Fetch configuration from Firebase
-  * STUB: Not implemented
+  * Opens the SSE stream on its own TLS socket:
+  *   GET <database>/commands/<greenhouseId>.json?orderBy="$key"&limitToLast=4
+  *   Accept: text/event-stream
+  * limitToLast bounds the initial snapshot to what fits one event buffer.
+  * STUB: WiFi disabled - no transport yet
   */
- bool FirebaseComm::fetchConfig() {
+ bool FirebaseComm::openCommandStream() {
+   lastStreamAttempt = millis();
+   
+   bool ok = false;  // Stub: no transport yet
+   
+   if (!ok) {
+     streamRetryMs = backoffDelay(streamFailures);
+     if (streamFailures < 255) streamFailures++;
+     return false;
+   }
+   
+   streamOpen = true;
+   streamFailures = 0;
+   streamRetryMs = 0;
+   lastStreamActivity = millis();
+   commandStream.reset();
+   linkStats.streamConnects++;
+   return true;
+ }
+ 
+ void FirebaseComm::closeCommandStream() {
+   streamOpen = false;
+   commandStream.reset();
+   // Retry through the backoff policy
+   lastStreamAttempt = millis();
+   streamRetryMs = backoffDelay(streamFailures);
+   if (streamFailures < 255) streamFailures++;
+ }
+ 
+ /**
+  * Non-blocking read of buffered stream bytes.
+  * STUB: WiFi disabled - nothing to read
+  */
+ size_t FirebaseComm::readCommandStream(uint8_t* buffer, size_t capacity) {
+   return 0;
+ }
+ 
+ void FirebaseComm::onStreamEvent(const char* event, const char* data, size_t length, void* context) {
+   static_cast<FirebaseComm*>(context)->handleStreamEvent(event, data, length);
+ }
+ 
+ /**
+  * Realtime Database stream events:
+  *   put/patch  {"path":"/","data":{"<key>":{...},...}}  (snapshot / multi)
+  *              {"path":"/<key>","data":{"target":"pump","action":"on"}}
+  *   keep-alive (data null), cancel / auth_revoked (stream closed)
+  * The first snapshot after boot is existing history and is not executed;
+  * snapshots after a reconnect execute anything newer than the last key.
+  */
+ void FirebaseComm::handleStreamEvent(const char* event, const char* data, size_t length) {
+   if (strcmp(event, "keep-alive") == 0) {
+     return;
+   }
+   
+   if (strcmp(event, "cancel") == 0 || strcmp(event, "auth_revoked") == 0) {
+     Serial.println("⚠️  Command stream closed by server");
+     closeCommandStream();
+     return;
+   }
+   
+   if (strcmp(event, "put") != 0 && strcmp(event, "patch") != 0) {
+     return;
+   }
+   
+   StaticJsonDocument<COMMAND_JSON_CAPACITY> doc;
+   DeserializationError error = deserializeJson(doc, data, length);
+   if (error) {
+     linkStats.commandsRejected++;
+     Serial.print("✗ Command event parse failed: ");
+     Serial.println(error.c_str());
+     return;
+   }
+   
+   const char* path = doc["path"] | "";
+   JsonVariantConst payload = doc["data"];
+   if (payload.isNull()) {
+     // Deletion - or an empty history snapshot, after which every
+     // command is new
+     if (strcmp(path, "/") == 0) {
+       commandHistorySeen = true;
+     }
+     return;
+   }
+   
+   if (strcmp(path, "/") == 0) {
+     bool execute = commandHistorySeen || strcmp(event, "patch") == 0;
+     commandHistorySeen = true;
+     
+     // Push IDs sort by creation time: anything at or before the key we
+     // had before this event is a replay. Children may arrive in any order.
+     char newest[COMMAND_KEY_SIZE];
+     strcpy(newest, lastCommandKey);
+     
+     for (JsonPairConst child : payload.as<JsonObjectConst>()) {
+       const char* key = child.key().c_str();
+       if (!isNewCommandKey(key)) continue;
+       
+       dispatchCommand(child.value(), execute);
+       if (strcmp(key, newest) > 0) {
+         strcpy(newest, key);
+       }
+     }
+     strcpy(lastCommandKey, newest);
+     return;
+   }
+   
+   // Single child: "/<key>"
+   const char* key = path + 1;
+   if (isNewCommandKey(key)) {
+     strcpy(lastCommandKey, key);
+     dispatchCommand(payload, true);
+   }
+ }
+ 
+ /**
+  * Config deltas carry their own generation, so they are applied even
+  * from the history snapshot - a delta pushed while the device was off
+  * still lands, and one already applied is skipped.
+  */
+ void FirebaseComm::dispatchCommand(JsonVariantConst command, bool execute) {
+   const char* target = command["target"] | "";
+   if (strcmp(target, "config") == 0) {
+     handleConfigUpdate(command);
+   } else if (execute) {
+     handleCommand(target, command["action"] | "");
+   }
+ }
+ 
+ bool FirebaseComm::isNewCommandKey(const char* key) {
+   size_t length = strlen(key);
+   return length > 0 && length < COMMAND_KEY_SIZE && strcmp(key, lastCommandKey) > 0;
+ }
+ 
+ /**
+  * Maps one command onto the actuator queue
+  */
+ void FirebaseComm::handleCommand(const char* target, const char* action) {
+   linkStats.commandsReceived++;
+   
+   static const struct {
+     const char* name;
+     CommandTarget target;
+   } targets[] = {
+     {"heater_primary", CMD_HEATER_PRIMARY},
+     {"heater_secondary", CMD_HEATER_SECONDARY},
+     {"fan_exhaust", CMD_FAN_EXHAUST},
+     {"fan_circulation", CMD_FAN_CIRCULATION},
+     {"pump", CMD_PUMP},
+     {"light", CMD_LIGHT},
+     {"all", CMD_STOP_ALL}
+   };
+   
+   ActuatorCommand command;
+   command.receivedAt = millis();
+   
+   bool known = false;
+   for (size_t i = 0; i < sizeof(targets) / sizeof(targets[0]); i++) {
+     if (strcmp(target, targets[i].name) == 0) {
+       command.target = targets[i].target;
+       known = true;
+       break;
+     }
+   }
+   
+   if (strcmp(action, "on") == 0) {
+     command.state = true;
+   } else if (strcmp(action, "off") == 0 || strcmp(action, "stop") == 0) {
+     command.state = false;
+   } else {
+     known = false;
+   }
+   
+   // "all" only supports stop
+   if (known && command.target == CMD_STOP_ALL && command.state) {
+     known = false;
+   }
+   
+   if (!known || commandSink == nullptr || !commandSink->queueCommand(command)) {
+     linkStats.commandsRejected++;
+     Serial.print("✗ Command rejected: ");
+     Serial.print(target);
+     Serial.print(" ");
+     Serial.println(action);
+   }
+ }
+ 
+ /**
+  * Applies {"generation":N,"set":{"<key>":value,...}} to the config store.
+  * All or nothing: one unknown key or out-of-range value rejects the
+  * update. Returns true when the store holds generation N afterwards.
+  */
+ bool FirebaseComm::handleConfigUpdate(JsonVariantConst update) {
+   uint32_t generation = update["generation"] | 0UL;
+   if (!isNewConfigGeneration(generation)) {
+     return generation != 0;  // Replay of an applied update
+   }
+   
+   linkStats.commandsReceived++;
+   
+   uint8_t keys = 0;
+   bool valid = update["set"].is<JsonObjectConst>();
+   if (valid) {
+     for (JsonPairConst item : update["set"].as<JsonObjectConst>()) {
+       // Non-numbers become NaN, which the store rejects
+       float value = item.value().is<float>() ? item.value().as<float>() : NAN;
+       if (!applyConfigKey(item.key().c_str(), value)) {
+         valid = false;
+         break;
+       }
+       keys++;
+     }
+   }
+   
+   if (!valid) {
+     configStore.revert();
+     linkStats.commandsRejected++;
+     return false;
+   }
+   
+   return commitConfigUpdate(generation, keys);
+ }
+ 
+ bool FirebaseComm::isNewConfigGeneration(uint32_t generation) {
+   return generation != 0 && generation > configStore.getCloudGeneration();
+ }
+ 
+ bool FirebaseComm::applyConfigKey(const char* key, float value) {
+   if (configStore.set(key, value)) {
+     return true;
+   }
+   Serial.print("✗ Config key rejected: ");
+   Serial.println(key);
    return false;
  }
  
+ /**
+  * Stores the generation with the applied keys and commits them.
+  */
+ bool FirebaseComm::commitConfigUpdate(uint32_t generation, uint8_t keys) {
+   configStore.setCloudGeneration(generation);
+   if (!configStore.commit()) {
+     if (configStore.isDirty()) {
+       // Flash write failed and nothing was applied: drop the delta so
+       // the cloud's resend of this generation is not taken as a replay
+       configStore.revert();
+       Serial.println("✗ Config update not saved: flash write failed");
+     } else {
+       // Reverted: the delta left a min/max pair inverted
+       Serial.println("✗ Config update rejected: min/max out of order");
+     }
+     linkStats.commandsRejected++;
+     return false;
+   }
+   
+   Serial.print("✓ Config generation ");
+   Serial.print(generation);
+   Serial.print(" applied (");
+   Serial.print(keys);
+   Serial.println(" key(s))");
+   return true;
+ }
+ 
+ /**
+  * Reads config/<greenhouseId> - the full current config as one delta
+  * against the defaults ({"generation":N,"set":{...}}) - and applies it
+  * if it is newer than what the store holds. Covers updates that fell
+  * out of the command stream's limitToLast window while offline.
+  */
+ bool FirebaseComm::fetchConfig() {
+ #if FIREBASE_RPC_LINK
+   // The co-processor reads the document; RPC_CONFIG comes back in a poll reply
+   return connected && sendLinkRequest(RPC_FETCH_CONFIG);
+ #else
+   char path[64] = "config/";
+   strncat(path, deviceId, sizeof(path) - 16);
+   strcat(path, ".json");
+   
+   char response[CONFIG_FETCH_SIZE];
+   size_t length = receiveData(path, response, sizeof(response));
+   if (length == 0) {
+     return false;
+   }
+   
+   StaticJsonDocument<COMMAND_JSON_CAPACITY> doc;
+   if (deserializeJson(doc, response, length)) {
+     Serial.println("✗ Config document parse failed");
+     return false;
+   }
+   return handleConfigUpdate(doc.as<JsonVariantConst>());
+ #endif
+ }
+ 
  /**
   * Update configuration in Firebase
   * STUB: Not implemented
   */
- bool FirebaseComm::updateConfig(String key, String value) {
+ bool FirebaseComm::updateConfig(const char* key, const char* value) {
    return false;
  }
  
+ /**
+  * Reads a Realtime Database path into a caller buffer (NUL-terminated).
+  * STUB: Not implemented - returns the number of bytes read
+  */
+ size_t FirebaseComm::receiveData(const char* path, char* buffer, size_t capacity) {
+   if (capacity > 0) buffer[0] = '\0';
+   return 0;
+ }
+ 
  /**
   * Check if connected to Firebase
-  * STUB: Always returns false (not connected)
+  * STUB: False until connect() has a transport
   */
  bool FirebaseComm::isConnected() {
-   return false;  // Stub mode - never connected
+   return this->connected;  // Stub mode - connect() never succeeds
  }
 
- 
\ No newline at end of file
+  
+ // ============================================================================
+ // CO-PROCESSOR LINK
+ // ============================================================================
+ 
+ /**
+  * Services the RPC link: TX drain and reply parsing. Frames are
+  * handled from inside this call (onLinkFrame).
+  */
+ void FirebaseComm::poll() {
+ #if FIREBASE_RPC_LINK
+   link.poll();
+   
+   if (awaitingReply && millis() - replySentAt >= RPC_REPLY_WINDOW_MS) {
+     awaitingReply = false;  // Reply lost - the next pull asks again
+   }
+ #endif
+ }
+ 
+ unsigned long FirebaseComm::msUntilNextPoll() {
+ #if FIREBASE_RPC_LINK
+   // A frame still going out or a reply due: service the port every 1 ms
+   if (link.isSending() || awaitingReply) return 1;
+ #endif
+   return 0xFFFFFFFFUL;
+ }
+ 
+ void FirebaseComm::onLinkFrame(uint8_t type, uint8_t seq, const uint8_t* data, size_t length, void* context) {
+   static_cast<FirebaseComm*>(context)->handleLinkFrame(type, data, length);
+ }
+ 
+ /**
+  * Payloads may grow at the end in later link versions, so only a
+  * short one is rejected.
+  */
+ void FirebaseComm::handleLinkFrame(uint8_t type, const uint8_t* data, size_t length) {
+   switch (type) {
+     case RPC_STATUS: {
+       RpcStatus status;
+       if (length < sizeof(status)) return;
+       memcpy(&status, data, sizeof(status));
+       handleLinkStatus(status);
+       break;
+     }
+     case RPC_RESULT: {
+       RpcResult result;
+       if (length < sizeof(result)) return;
+       memcpy(&result, data, sizeof(result));
+       handleLinkResult(result);
+       break;
+     }
+     case RPC_COMMAND: {
+       RpcCommand command;
+       if (length < sizeof(command)) {
+         linkStats.commandsRejected++;
+         return;
+       }
+       memcpy(&command, data, sizeof(command));
+       handleLinkCommand(command);
+       break;
+     }
+     case RPC_CONFIG:
+       handleLinkConfig(data, length);
+       break;
+   }
+ }
+ 
+ /**
+  * RPC_STATUS ends every poll reply. The co-processor's session and
+  * stream counters replace the ones a direct transport keeps.
+  */
+ void FirebaseComm::handleLinkStatus(const RpcStatus& status) {
+   awaitingReply = false;
+   coprocessor = status;
+   
+   bool wasConnected = connected;
+   connected = (status.flags & RPC_STATUS_CLOUD) != 0;
+   streamOpen = (status.flags & RPC_STATUS_STREAM) != 0;
+   linkStats.fullHandshakes = status.fullHandshakes;
+   linkStats.resumedHandshakes = status.resumedHandshakes;
+   linkStats.failedAttempts = status.failedAttempts;
+   linkStats.streamConnects = status.streamConnects;
+   
+   // Co-processor rebooted (or never heard from us)
+   if (!(status.flags & RPC_STATUS_HELLO)) {
+     sendHello();
+   }
+   
+   if (connected && !wasConnected) {
+     Serial.println("✓ Cloud session up (co-processor)");
+     fetchConfig();  // Config changed while offline
+   } else if (!connected && wasConnected) {
+     Serial.println("⚠️  Cloud session lost (co-processor) - buffering locally");
+   }
+ }
+ 
+ void FirebaseComm::handleLinkResult(const RpcResult& result) {
+   if (uplinkState == UPLINK_IN_FLIGHT && result.requestSeq == uplinkSeq) {
+     if (result.status != RPC_RESULT_OK) {
+       Serial.print("✗ Batch upload failed (status ");
+       Serial.print(result.status);
+       Serial.print(", HTTP ");
+       Serial.print(result.httpStatus);
+       Serial.println(") - will retry");
+     }
+     finishUpload(result.status == RPC_RESULT_OK);
+     return;
+   }
+   
+   if (alertState == UPLINK_IN_FLIGHT && result.requestSeq == alertSeq) {
+     if (result.status != RPC_RESULT_OK) {
+       Serial.print("✗ Alert delivery failed (status ");
+       Serial.print(result.status);
+       Serial.print(", HTTP ");
+       Serial.print(result.httpStatus);
+       Serial.println(")");
+     }
+     finishAlert(result.status == RPC_RESULT_OK);
+   }
+   // Anything else answers a request that already timed out
+ }
+ 
+ void FirebaseComm::finishUpload(bool ok) {
+   uplinkState = ok ? UPLINK_CONFIRMED : UPLINK_IDLE;
+   if (ok) {
+     linkStats.uploadsConfirmed++;
+     linkStats.requestsOnConnection++;
+   } else {
+     linkStats.uploadsFailed++;
+   }
+   
+   if (uploadCallback != nullptr) {
+     uploadCallback(ok);
+   }
+ }
+ 
+ /**
+  * A live alert is done either way - on failure its copy goes to the
+  * fallback. A logged one waits, confirmed, for sendLoggedAlert() to
+  * claim it, or is retried from the log by the next sync.
+  */
+ void FirebaseComm::finishAlert(bool ok) {
+   if (ok) {
+     linkStats.alertsConfirmed++;
+   } else {
+     linkStats.alertsFailed++;
+   }
+   
+   if (alertCustody) {
+     alertState = UPLINK_IDLE;
+     if (!ok && alertFallback != nullptr) {
+       alertFallback(alertRecord, alertText, alertTextLength);
+     }
+     return;
+   }
+   
+   alertState = ok ? UPLINK_CONFIRMED : UPLINK_IDLE;
+   if (uploadCallback != nullptr) {
+     uploadCallback(ok);
+   }
+ }
+ 
+ /**
+  * The co-processor has already filtered the stream's history snapshot
+  * and replays, so every RPC_COMMAND is new.
+  */
+ void FirebaseComm::handleLinkCommand(const RpcCommand& command) {
+   linkStats.commandsReceived++;
+   
+   ActuatorCommand queued;
+   queued.target = (CommandTarget)command.target;
+   queued.state = (command.state != 0);
+   queued.receivedAt = millis();
+   
+   // "all" only supports stop
+   bool known = command.target <= CMD_STOP_ALL && command.state <= 1 &&
+                !(queued.target == CMD_STOP_ALL && queued.state);
+   
+   if (!known || commandSink == nullptr || !commandSink->queueCommand(queued)) {
+     linkStats.commandsRejected++;
+     Serial.print("✗ Command rejected: target ");
+     Serial.print(command.target);
+     Serial.print(" state ");
+     Serial.println(command.state);
+   }
+ }
+ 
+ /**
+  * RPC_CONFIG: RpcConfigHeader, then count × (uint8 name length, name,
+  * float). Same all-or-nothing rules as handleConfigUpdate().
+  */
+ void FirebaseComm::handleLinkConfig(const uint8_t* data, size_t length) {
+   RpcConfigHeader header;
+   if (length < sizeof(header)) {
+     linkStats.commandsRejected++;
+     return;
+   }
+   memcpy(&header, data, sizeof(header));
+   
+   if (!isNewConfigGeneration(header.generation)) {
+     return;  // Replay of an applied update
+   }
+   
+   linkStats.commandsReceived++;
+   
+   size_t offset = sizeof(header);
+   uint8_t keys = 0;
+   bool valid = true;
+   
+   for (uint8_t i = 0; i < header.count && valid; i++) {
+     char name[COMMAND_KEY_SIZE];
+     uint8_t nameLength = (offset < length) ? data[offset++] : 0;
+     if (nameLength == 0 || nameLength >= sizeof(name) ||
+         offset + nameLength + sizeof(float) > length) {
+       valid = false;
+       break;
+     }
+     memcpy(name, data + offset, nameLength);
+     name[nameLength] = '\0';
+     offset += nameLength;
+     
+     float value;
+     memcpy(&value, data + offset, sizeof(value));
+     offset += sizeof(value);
+     
+     valid = applyConfigKey(name, value);
+     if (valid) keys++;
+   }
+   
+   if (!valid) {
+     configStore.revert();
+     linkStats.commandsRejected++;
+     return;
+   }
+   
+   commitConfigUpdate(header.generation, keys);
+ }
+ 
+ void FirebaseComm::sendHello() {
+   RpcHello hello;
+   hello.linkVersion = RPC_LINK_VERSION;
+   hello.uplinkVersion = UPLINK_FORMAT_VERSION;
+   hello.reserved = 0;
+   
+   size_t idLength = strlen(deviceId);
+   if (link.beginFrame(RPC_HELLO, sizeof(hello) + idLength) != 0) {
+     link.append(&hello, sizeof(hello));
+     link.append(deviceId, idLength);
+     link.endFrame();
+   }
+ }
+ 
+ /**
+  * Sends an empty request (RPC_POLL / RPC_FETCH_CONFIG). A poll opens
+  * the reply window that msUntilNextPoll() services at 1 ms.
+  */
+ bool FirebaseComm::sendLinkRequest(uint8_t type) {
+   if (link.send(type, nullptr, 0) == 0) {
+     return false;
+   }
+   if (type == RPC_POLL) {
+     awaitingReply = true;
+     replySentAt = millis();
+   }
+   return true;
+ }
+ 
+ /**
+  * RPC_UPLOAD_BATCH: RpcBatchHeader, uint32 offsets[n], PackedReading[n],
+  * PackedRollup[r] - the pending batch arrays as they are. The
+  * co-processor builds the columnar document from them (serializeBatch()
+  * is the reference) and answers with RPC_RESULT once the cloud has.
+  * Returns true only for the call that claims a confirmed upload.
+  */
+ bool FirebaseComm::sendBatchOverLink() {
+   uint32_t crc = batchCrc();
+   
+   if (uplinkState == UPLINK_CONFIRMED) {
+     uplinkState = UPLINK_IDLE;
+     if (crc == uplinkCrc) {
+       Serial.print("📊 Uploaded ");
+       Serial.print(batchCount);
+       Serial.print(" readings, ");
+       Serial.print(rollupCount);
+       Serial.print(" rollups in ");
+       Serial.print(payloadLength);
+       Serial.println(" bytes (co-processor)");
+       
+       beginBatch();
+       return true;
+     }
+     // Rebuilt from somewhere else - upload this one too
+   }
+   
+   if (uplinkState == UPLINK_IN_FLIGHT || !connected) {
+     return false;
+   }
+   
+   assignBatchSeq(crc);
+   
+   RpcBatchHeader header;
+   header.now = millis();
+   header.base = batchBase;
+   header.count = batchCount;
+   header.rollupCount = rollupCount;
+   header.version = UPLINK_FORMAT_VERSION;
+   header.boot = bootId;
+   header.seq = batchSeq;
+   header.logBoot = batchBoot;
+   
+   size_t length = sizeof(header) + batchCount * (sizeof(uint32_t) + sizeof(PackedReading)) +
+                   rollupCount * sizeof(PackedRollup);
+   uint8_t seq = link.beginFrame(RPC_UPLOAD_BATCH, length);
+   if (seq == 0) {
+     return false;  // TX ring busy - next sync
+   }
+   link.append(&header, sizeof(header));
+   link.append(batchOffsets, batchCount * sizeof(uint32_t));
+   link.append(batchRecords, batchCount * sizeof(PackedReading));
+   link.append(batchRollups, rollupCount * sizeof(PackedRollup));
+   link.endFrame();
+   
+   payloadLength = length;
+   uplinkState = UPLINK_IN_FLIGHT;
+   uplinkSeq = seq;
+   uplinkSentAt = millis();
+   uplinkReadings = batchCount;
+   uplinkRollups = rollupCount;
+   return false;
+ }
+ 
+ /**
+  * Same content as the batch last sent (a retry) keeps its seq; anything
+  * else is a new batch.
+  */
+ void FirebaseComm::assignBatchSeq(uint32_t crc) {
+   if (batchSeq == 0 || crc != uplinkCrc) {
+     batchSeq++;
+   }
+   uplinkCrc = crc;
+ }
+ 
+ uint32_t FirebaseComm::batchCrc() {
+   uint32_t crc = SensorManager::calculateCRC32((const uint8_t*)&batchBase, sizeof(batchBase));
+   crc = SensorManager::calculateCRC32((const uint8_t*)&batchBoot, sizeof(batchBoot), crc);
+   crc = SensorManager::calculateCRC32((const uint8_t*)batchOffsets, batchCount * sizeof(uint32_t), crc);
+   crc = SensorManager::calculateCRC32((const uint8_t*)batchRecords, batchCount * sizeof(PackedReading), crc);
+   return SensorManager::calculateCRC32((const uint8_t*)batchRollups, rollupCount * sizeof(PackedRollup), crc);
+ }
+ 
+ /**
+  * RPC_UPLOAD_ALERTS: one AlertQueue batch, or one free-text alert
+  * (batch == nullptr). Only one alerts frame is in flight; finishAlert()
+  * settles it on the matching RPC_RESULT or a timeout. With custody the
+  * alert is kept (as formatted text) for the fallback.
+  */
+ bool FirebaseComm::sendAlertsOverLink(const AlertBatch* batch, const LoggedAlert* text,
+                                       const char* details, size_t length, bool custody) {
+   // A confirmed logged alert is still to be claimed - don't overwrite it
+   if (!connected || alertState != UPLINK_IDLE) return false;
+   
+   RpcAlertHeader header;
+   header.now = millis();
+   header.boot = bootId;
+   header.logBoot = (batch != nullptr) ? bootId : text->boot;
+   header.count = (batch != nullptr) ? batch->count : 1;
+   memset(header.reserved, 0, sizeof(header.reserved));
+   
+   size_t size = sizeof(header) + header.count * sizeof(RpcAlertEntry);
+   if (batch != nullptr) {
+     for (uint8_t i = 0; i < batch->count; i++) {
+       size += strlen(batch->entries[i].text);
+     }
+   } else {
+     size += length;
+   }
+   
+   uint8_t seq = link.beginFrame(RPC_UPLOAD_ALERTS, size);
+   if (seq == 0) {
+     return false;
+   }
+   link.append(&header, sizeof(header));
+   
+   RpcAlertEntry entry;
+   memset(&entry, 0, sizeof(entry));
+   
+   if (batch == nullptr) {
+     entry.type = RPC_ALERT_TYPE_TEXT;
+     entry.severity = (text->severity <= ALERT_CRITICAL) ? text->severity : RPC_ALERT_SEVERITY_NONE;
+     entry.occurrences = 1;
+     entry.textLength = length;
+     entry.firstSeen = text->firstSeen;
+     entry.lastSeen = text->firstSeen;
+     link.append(&entry, sizeof(entry));
+     link.append(details, length);
+   } else {
+     for (uint8_t i = 0; i < batch->count; i++) {
+       const AlertEntry& alert = batch->entries[i];
+       entry.type = alert.type;
+       entry.severity = alert.severity;
+       entry.escalated = alert.escalated ? 1 : 0;
+       entry.occurrences = alert.occurrences;
+       entry.textLength = strlen(alert.text);
+       entry.firstSeen = alert.firstSeen;
+       entry.lastSeen = alert.lastSeen;
+       link.append(&entry, sizeof(entry));
+       link.append(alert.text, entry.textLength);
+     }
+   }
+   link.endFrame();
+   
+   alertState = UPLINK_IN_FLIGHT;
+   alertSeq = seq;
+   alertSentAt = millis();
+   alertCustody = custody;
+   if (batch != nullptr) {
+     alertTextLength = custody ? AlertQueue::formatBatch(*batch, alertText, sizeof(alertText)) : 0;
+     alertRecord = AlertQueue::describeBatch(*batch, bootId);
+   } else {
+     alertRecord = *text;
+     alertCrc = SensorManager::calculateCRC32((const uint8_t*)details, length);
+     alertTextLength = custody ? length : 0;
+     if (custody) memcpy(alertText, details, length);
+   }
+   
+   Serial.print("🚨 Alert sent to co-processor (");
+   Serial.print(header.count);
+   Serial.println(header.count == 1 ? " alert)" : " alerts)");
+   return true;
+ }
+ 
+ void FirebaseComm::printLinkStatus() {
+   Serial.println("\n=== Cloud Link ===");
+ #if FIREBASE_RPC_LINK
+   RpcLinkStats rpc = link.getStats();
+   Serial.print("Co-processor: ");
+   if (!link.isAlive()) {
+     Serial.println("silent");
+   } else {
+     Serial.print((coprocessor.flags & RPC_STATUS_WIFI) ? "WiFi up (" : "WiFi down (");
+     Serial.print(coprocessor.rssi);
+     Serial.print(" dBm), cloud ");
+     Serial.print((coprocessor.flags & RPC_STATUS_CLOUD) ? "up" : "down");
+     Serial.print(", stream ");
+     Serial.print((coprocessor.flags & RPC_STATUS_STREAM) ? "open" : "closed");
+     Serial.print(", ");
+     Serial.print(coprocessor.queuedAlerts);
+     Serial.println(" alerts queued");
+   }
+   Serial.print("Frames: ");
+   Serial.print(rpc.framesSent);
+   Serial.print(" sent, ");
+   Serial.print(rpc.framesReceived);
+   Serial.print(" received, ");
+   Serial.print(rpc.crcErrors);
+   Serial.print(" bad, ");
+   Serial.print(rpc.rxOverflows);
+   Serial.print(" overflowed, ");
+   Serial.print(rpc.txRefused);
+   Serial.println(" refused (TX full)");
+   Serial.print("Uploads: ");
+   Serial.print(linkStats.uploadsConfirmed);
+   Serial.print(" confirmed, ");
+   Serial.print(linkStats.uploadsFailed);
+   Serial.print(" failed");
+   Serial.println(isUploadPending() ? ", one in flight" : "");
+   Serial.print("Alerts: ");
+   Serial.print(linkStats.alertsConfirmed);
+   Serial.print(" confirmed, ");
+   Serial.print(linkStats.alertsFailed);
+   Serial.print(" failed");
+   Serial.println(alertState == UPLINK_IN_FLIGHT ? ", one in flight" : "");
+ #else
+   Serial.println(connected ? "Direct transport: connected" : "Direct transport: offline (stub)");
+ #endif
+   Serial.print("Handshakes: ");
+   Serial.print(linkStats.fullHandshakes);
+   Serial.print(" full, ");
+   Serial.print(linkStats.resumedHandshakes);
+   Serial.print(" resumed, ");
+   Serial.print(linkStats.failedAttempts);
+   Serial.println(" failed");
+   Serial.print("Commands: ");
+   Serial.print(linkStats.commandsReceived);
+   Serial.print(" received, ");
+   Serial.print(linkStats.commandsRejected);
+   Serial.println(" rejected\n");
+ }
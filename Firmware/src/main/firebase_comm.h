@@ -2,6 +2,56 @@
  * GreenOS - Firebase Communication
  * 
  * Handles real-time data synchronization with Firebase
+ *
+ * Buffered readings are uploaded in batches: up to UPLINK_MAX_BATCH
+ * packed readings go out as one columnar JSON document in a single
+ * HTTPS request, so handshake and per-document overhead is paid once
+ * per batch instead of once per sample. Completed rollup windows ride
+ * along in the same request.
+ *
+ * Connection policy: one long-lived TLS session with HTTP/1.1
+ * keep-alive, reused by every request. Handshakes only happen in
+ * maintainConnection() (its own low-priority task), never inside a
+ * request; a request with no live connection fails fast and the data
+ * stays buffered. Failed attempts back off exponentially with jitter
+ * from lastConnectionAttempt. An idle socket is closed and not reopened
+ * until there is something to send.
+ *
+ * Commands arrive on a separate streaming (server-sent events) socket
+ * on the Realtime Database path commands/<greenhouseId>; events are parsed
+ * incrementally into ActuatorManager's command queue. The stream is
+ * silent apart from server keep-alives, so an idle device makes no
+ * requests at all. The same stream carries config deltas
+ * ({"target":"config","generation":N,"set":{...}}) for the config
+ * store; fetchConfig() reads the full config document once per connect.
+ *
+ * No Arduino String anywhere on these paths: text goes in as pointer and
+ * length, and every request body is serialized into the one static
+ * payload buffer, so steady-state uplink does no heap allocation.
+ *
+ * Transport (FIREBASE_RPC_LINK, default on): the ESP32-S3 co-processor
+ * owns WiFi, TLS, the REST keep-alive session and the command stream,
+ * and talks to this class over RpcLink. Batches and alerts go across as
+ * packed binary and the co-processor renders the JSON documents above;
+ * commands and config deltas come back already parsed. Nothing here
+ * waits on the link:
+ * - isConnected() follows the co-processor's RPC_STATUS (cloud session
+ *   up and the link alive); it reconnects and backs off on its own.
+ * - sendBatch() sends the batch and returns false; once the cloud has
+ *   accepted it, the same batch (rebuilt from the same cursor) returns
+ *   true. While an upload is outstanding the batch is capped at what was
+ *   sent, so a rebuild stops exactly where the upload did. A batch that
+ *   differs is uploaded again - overlap is possible, a gap is not.
+ * - Every batch carries an id, (boot id, seq). A retry of the same
+ *   content repeats it, so the server stores a batch once however often
+ *   the confirmation is lost.
+ * - One alerts frame is in flight at a time and counts as delivered only
+ *   when RPC_RESULT with its seq reports OK. sendAlert() and
+ *   sendAlertBatch() keep a copy of a live alert and hand it to the
+ *   alert fallback (the local log) if delivery fails or times out.
+ *   sendLoggedAlert() works like sendBatch(): send, then claim the
+ *   result by sending the same record again.
+ * With FIREBASE_RPC_LINK 0 the direct (stubbed) transport is built.
  */
 
 #ifndef FIREBASE_COMM_H
@@ -10,20 +60,176 @@
 #include <Arduino.h>
 #include "sensor_manager.h"
 #include "actuator_manager.h"
+#include "record_codec.h"
+#include "event_stream.h"
+#include "sensor_rollup.h"
+#include "alert_queue.h"
+#include "rpc_link.h"
+#include <ArduinoJson.h>
+
+#ifndef FIREBASE_RPC_LINK
+#define FIREBASE_RPC_LINK 1           // 0 = direct transport (no WiFi on this core yet)
+#endif
+
+// ============================================================================
+// BATCH UPLINK CONFIGURATION
+// ============================================================================
+
+#define UPLINK_FORMAT_VERSION 1
+#define UPLINK_MAX_BATCH 120          // Readings per request (1 h at 30 s)
+#define UPLINK_MAX_ROLLUPS 8          // Completed rollup windows per request
+#define UPLINK_PAYLOAD_SIZE 9216      // Worst case ~48 B/reading + ~380 B/rollup + header
+#define UPLINK_BATCH_PATH "/ingestSensorBatch"
+#define UPLINK_ALERT_PATH "/ingestAlert"
+#define UPLINK_MAX_ALERT_TEXT 256     // Longer alert text is truncated
+
+// ============================================================================
+// CONNECTION POLICY
+// ============================================================================
+
+#define FIREBASE_BACKOFF_BASE_MS 2000       // First retry delay
+#define FIREBASE_BACKOFF_MAX_MS 300000      // Cap (5 minutes)
+#define FIREBASE_KEEPALIVE_IDLE_MS 55000    // Close idle socket before the server does (~60 s)
+#define FIREBASE_LINK_SERVICE_MS 1000       // maintainConnection() period
+
+// ============================================================================
+// COMMAND STREAM
+// ============================================================================
+
+#define COMMAND_STREAM_TIMEOUT_MS 90000     // Server keep-alive is every ~30 s
+#define COMMAND_STREAM_READ_CHUNK 128       // Bytes parsed per handleRealtimeUpdates()
+#define COMMAND_JSON_CAPACITY 512           // ArduinoJson pool for one event
+#define COMMAND_KEY_SIZE 24                 // Push IDs are 20 chars
+#define CONFIG_FETCH_SIZE 512               // config/<greenhouseId>.json response
+
+// ============================================================================
+// CO-PROCESSOR LINK
+// ============================================================================
+
+#define RPC_REPLY_WINDOW_MS 20              // Fast port polling after RPC_POLL, until RPC_STATUS
+#define RPC_UPLOAD_TIMEOUT_MS 30000         // Batch upload without RPC_RESULT counts as failed
+
+enum UplinkState {
+  UPLINK_IDLE,
+  UPLINK_IN_FLIGHT,                         // Sent, no RPC_RESULT yet
+  UPLINK_CONFIRMED                          // Accepted - waiting for sendBatch() to claim it
+};
+
+struct FirebaseLinkStats {
+  uint32_t fullHandshakes;
+  uint32_t resumedHandshakes;    // TLS session resumption (abbreviated)
+  uint32_t failedAttempts;
+  uint32_t requestsOnConnection; // Requests served by the current socket
+  unsigned long reconnectDelayMs;
+  uint32_t streamConnects;
+  uint32_t commandsReceived;
+  uint32_t commandsRejected;     // Malformed, unknown or queue full
+  uint32_t uploadsConfirmed;     // Co-processor link only
+  uint32_t uploadsFailed;
+  uint32_t alertsConfirmed;      // Alert frames acknowledged by RPC_RESULT
+  uint32_t alertsFailed;         // Refused or timed out
+};
 
 class FirebaseComm {
 private:
-  String deviceId;
+  const char* deviceId;             // GREENHOUSE_ID (static storage)
   bool connected;
   unsigned long lastConnectionAttempt;
   
+  // Connection policy state
+  uint8_t consecutiveFailures;
+  unsigned long reconnectDelayMs;   // Jittered delay after lastConnectionAttempt
+  unsigned long lastActivity;       // Last request on the open socket
+  bool sessionCached;               // TLS session ticket available for resumption
+  bool linkIdle;                    // Closed for inactivity - reopen on demand
+  FirebaseLinkStats linkStats;
+  
+  // Command stream state
+  EventStreamParser commandStream;
+  bool streamOpen;
+  uint8_t streamFailures;
+  unsigned long lastStreamAttempt;
+  unsigned long streamRetryMs;
+  unsigned long lastStreamActivity;
+  bool commandHistorySeen;          // First snapshot is history, not new commands
+  char lastCommandKey[COMMAND_KEY_SIZE];
+  ActuatorManager* commandSink;
+  
+  // Pending batch: records plus their offset from batchBase
+  PackedReading batchRecords[UPLINK_MAX_BATCH];
+  uint32_t batchOffsets[UPLINK_MAX_BATCH];
+  uint16_t batchCount;
+  unsigned long batchBase;
+  PackedRollup batchRollups[UPLINK_MAX_ROLLUPS];
+  uint8_t rollupCount;
+  
+  // Serialized request body (static - no heap use per upload)
+  char payload[UPLINK_PAYLOAD_SIZE];
+  size_t payloadLength;
+  bool payloadOverflow;
+  
+  // Co-processor link state
+  RpcLink link;
+  RpcStatus coprocessor;            // Latest RPC_STATUS
+  bool linkWasAlive;
+  bool awaitingReply;               // RPC_POLL sent, RPC_STATUS not back yet
+  unsigned long replySentAt;
+  UplinkState uplinkState;
+  uint8_t uplinkSeq;
+  unsigned long uplinkSentAt;
+  uint32_t uplinkCrc;               // Of the batch that was sent
+  uint16_t uplinkReadings;          // Its size - caps the batch until claimed
+  uint8_t uplinkRollups;
+  uint32_t bootId;                  // Persistent per-boot id (setBootId)
+  uint32_t batchSeq;                // Seq of the batch last sent
+  uint32_t batchBoot;               // Boot the pending batch was logged in
+  void (*uploadCallback)(bool ok);
+  UplinkState alertState;
+  uint8_t alertSeq;
+  unsigned long alertSentAt;
+  uint32_t alertCrc;                // Of the text or batch that was sent
+  bool alertCustody;                // Live alert - returned to alertFallback on failure
+  char alertText[UPLINK_MAX_ALERT_TEXT];
+  size_t alertTextLength;
+  LoggedAlert alertRecord;          // Severity, onset and boot of alertText
+  void (*alertFallback)(const LoggedAlert& alert, const char* details, size_t length);
+  
 public:
   FirebaseComm();
   void init();
   
+  // Names this boot in batch ids - must differ from every earlier boot
+  void setBootId(uint32_t id);
+  
   // Data sync
-  bool syncSensorData(SensorData data);
-  bool sendAlert(String alertDetails);
+  bool syncSensorData(const SensorData& data);
+  
+  // Batch uplink - the caller advances its sync cursor only when
+  // sendBatch() succeeds
+  void beginBatch();
+  void setBatchBoot(uint32_t boot);
+  bool addToBatch(const PackedBlockHeader& header, const PackedReading* records);
+  bool addRollupToBatch(const PackedRollup& rollup);
+  uint16_t getBatchCount();
+  uint8_t getBatchRollupCount();
+  bool sendBatch();
+  size_t getLastPayloadSize();
+  
+  // Live alerts. Over the link, true = handed over: a failed delivery
+  // comes back through the alert fallback.
+  bool sendAlert(const char* details, size_t length, const char* severity = nullptr);
+  bool sendAlertBatch(const AlertBatch& batch);
+  void setAlertFallback(void (*callback)(const LoggedAlert& alert, const char* details, size_t length));
+  
+  // Alert from the local log - the caller advances its cursor only when
+  // this returns true (over the link: the call after RPC_RESULT)
+  bool sendLoggedAlert(const LoggedAlert& alert, const char* details, size_t length);
+  
+  // Readings the next batch may hold (capped while an upload is outstanding)
+  uint16_t getBatchCapacity();
+  bool isUploadPending();
+  // Called when an outstanding upload is accepted (true) or fails
+  void setUploadCallback(void (*callback)(bool ok));
   
   // Command handling
   void checkForCommands(ActuatorManager& actuators);
@@ -31,15 +237,69 @@ public:
   
   // Configuration
   bool fetchConfig();
-  bool updateConfig(String key, String value);
+  bool updateConfig(const char* key, const char* value);
   
   // Status
   bool isConnected();
   
+  // Connection upkeep - call from a low-priority task, never from a request
+  void maintainConnection();
+  FirebaseLinkStats getLinkStats();
+  
+  // Co-processor link I/O - call every loop(), never blocks
+  void poll();
+  unsigned long msUntilNextPoll();
+  void printLinkStatus();
+  
 private:
   bool connect();
-  bool sendData(String path, String json);
-  String receiveData(String path);
+  void disconnect(bool keepSession);
+  void scheduleReconnect();
+  void markActivity();
+  static unsigned long backoffDelay(uint8_t failures);
+  
+  // Command stream
+  bool openCommandStream();
+  void closeCommandStream();
+  size_t readCommandStream(uint8_t* buffer, size_t capacity);
+  static void onStreamEvent(const char* event, const char* data, size_t length, void* context);
+  void handleStreamEvent(const char* event, const char* data, size_t length);
+  bool isNewCommandKey(const char* key);
+  void dispatchCommand(JsonVariantConst command, bool execute);
+  void handleCommand(const char* target, const char* action);
+  bool handleConfigUpdate(JsonVariantConst update);
+  bool isNewConfigGeneration(uint32_t generation);
+  bool applyConfigKey(const char* key, float value);
+  bool commitConfigUpdate(uint32_t generation, uint8_t keys);
+  bool sendPayload(const char* path, const char* body, size_t length);
+  
+  // Co-processor link
+  static void onLinkFrame(uint8_t type, uint8_t seq, const uint8_t* data, size_t length, void* context);
+  void handleLinkFrame(uint8_t type, const uint8_t* data, size_t length);
+  void handleLinkStatus(const RpcStatus& status);
+  void handleLinkResult(const RpcResult& result);
+  void handleLinkCommand(const RpcCommand& command);
+  void handleLinkConfig(const uint8_t* data, size_t length);
+  void sendHello();
+  bool sendLinkRequest(uint8_t type);
+  bool sendBatchOverLink();
+  bool sendTextAlert(const LoggedAlert& alert, const char* details, size_t length, bool custody);
+  bool sendAlertsOverLink(const AlertBatch* batch, const LoggedAlert* text,
+                          const char* details, size_t length, bool custody);
+  void finishUpload(bool ok);
+  void finishAlert(bool ok);
+  uint32_t batchCrc();
+  void assignBatchSeq(uint32_t crc);
+  
+  // Columnar JSON serialization
+  size_t serializeBatch();
+  void appendText(const char* text);
+  void appendNumber(long value);
+  void appendUnsigned(uint32_t value);     // Ids and millis() - never negative
+  void appendEscaped(const char* text, size_t length);
+  void appendColumn(const char* name, uint8_t field);
+  void appendRollups();
+  size_t receiveData(const char* path, char* buffer, size_t capacity);
 };
 
 #endif // FIREBASE_COMM_H
@@ -0,0 +1,682 @@
+/**
+ * GreenOS - Append-only Flash Log Implementation
+ *
+ * Storage backend:
+ * - Zephyr builds use the fixed "storage_partition" through the flash_area
+ *   API (write block size and erase page size come from the driver)
+ * - Other builds, or boards without that partition, fall back to a RAM
+ *   emulation so the rest of the firmware behaves the same (data is lost
+ *   on reboot, as before)
+ *
+ * All writes go through a small staging buffer so every flash write is a
+ * whole number of write blocks at an aligned offset.
+ */
+
+#include "flash_log.h"
+#include "sensor_manager.h"
+
+#if defined(__ZEPHYR__) && defined(__has_include)
+#if __has_include(<zephyr/storage/flash_map.h>)
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/drivers/flash.h>
+#if FIXED_PARTITION_EXISTS(storage_partition)
+#define FLASH_LOG_ZEPHYR 1
+#endif
+#endif
+#endif
+
+FlashLog flashLog;
+
+// ============================================================================
+// ON-FLASH STRUCTURES
+// ============================================================================
+
+#define FLASH_LOG_SECTOR_MAGIC 0x4C4E5247UL   // "GRNL"
+
+struct LogSectorHeader {
+  uint32_t magic;
+  uint32_t sequence;
+  FlashLogCursor dataEnd;  // Just past the newest data record when the sector was started
+  uint32_t crc32;          // Over all of the above
+};
+
+struct LogRecordHeader {
+  uint8_t type;
+  uint8_t flags;
+  uint16_t length;       // Payload bytes (excluding header and padding)
+  uint32_t crc32;        // Over type, flags, length and payload
+};
+
+// ============================================================================
+// STORAGE BACKEND
+// ============================================================================
+
+#ifdef FLASH_LOG_ZEPHYR
+
+static const struct flash_area* logArea = nullptr;
+
+static bool backendOpen(uint32_t& size, uint32_t& sectorSize, uint16_t& align) {
+  if (flash_area_open(FIXED_PARTITION_ID(storage_partition), &logArea) != 0) {
+    return false;
+  }
+
+  struct flash_pages_info info;
+  if (flash_get_page_info_by_offs(flash_area_get_device(logArea), logArea->fa_off, &info) != 0) {
+    return false;
+  }
+
+  size = logArea->fa_size;
+  sectorSize = info.size;
+  align = flash_area_align(logArea);
+  return true;
+}
+
+static bool backendRead(uint32_t offset, void* data, size_t length) {
+  return flash_area_read(logArea, offset, data, length) == 0;
+}
+
+static bool backendWrite(uint32_t offset, const void* data, size_t length) {
+  return flash_area_write(logArea, offset, data, length) == 0;
+}
+
+static bool backendErase(uint32_t offset, size_t length) {
+  return flash_area_erase(logArea, offset, length) == 0;
+}
+
+static const bool backendPersistent = true;
+
+#else
+
+static uint8_t emulatedFlash[FLASH_LOG_EMULATED_SIZE];
+static bool emulatedErased = false;
+static uint32_t stuckOffset = 0;
+static uint8_t stuckMask = 0;
+
+void flashLogEmulateStuckBits(uint32_t offset, uint8_t mask) {
+  stuckOffset = offset < sizeof(emulatedFlash) ? offset : 0;
+  stuckMask = mask;
+  emulatedFlash[stuckOffset] &= ~stuckMask;
+}
+
+static bool backendOpen(uint32_t& size, uint32_t& sectorSize, uint16_t& align) {
+  // Erased once per boot, so a re-mount recovers like real flash
+  if (!emulatedErased) {
+    memset(emulatedFlash, 0xFF, sizeof(emulatedFlash));
+    emulatedErased = true;
+  }
+  size = FLASH_LOG_EMULATED_SIZE;
+  sectorSize = FLASH_LOG_EMULATED_SECTOR;
+  align = 8;
+  return true;
+}
+
+static bool backendRead(uint32_t offset, void* data, size_t length) {
+  memcpy(data, &emulatedFlash[offset], length);
+  return true;
+}
+
+static bool backendWrite(uint32_t offset, const void* data, size_t length) {
+  // Flash semantics: programming can only clear bits
+  const uint8_t* bytes = (const uint8_t*)data;
+  for (size_t i = 0; i < length; i++) {
+    emulatedFlash[offset + i] &= bytes[i];
+  }
+  return true;
+}
+
+static bool backendErase(uint32_t offset, size_t length) {
+  memset(&emulatedFlash[offset], 0xFF, length);
+  emulatedFlash[stuckOffset] &= ~stuckMask;  // Stuck bits stay 0
+  return true;
+}
+
+static const bool backendPersistent = false;
+
+#endif
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+FlashLog::FlashLog() {
+  available = false;
+  persistent = false;
+  sectorSize = 0;
+  sectorCount = 0;
+  writeAlign = 1;
+  headSequence = 0;
+  tailSequence = 0;
+  writeOffset = 0;
+  syncCursor = {0, 0};
+  dataEnd = {0, 0};
+  pinnedCount = 0;
+  stageFill = 0;
+  stageOffset = 0;
+  recordsAppended = 0;
+  sectorsDropped = 0;
+  corruptRecords = 0;
+}
+
+// ============================================================================
+// MOUNT AND RECOVERY
+// ============================================================================
+
+bool FlashLog::begin() {
+  available = false;
+
+  uint32_t size = 0;
+  if (!backendOpen(size, sectorSize, writeAlign)) {
+    return false;
+  }
+  persistent = backendPersistent;
+
+  if (writeAlign == 0) writeAlign = 1;
+  if (FLASH_LOG_STAGE_SIZE % writeAlign != 0 || sectorSize == 0) {
+    return false;  // Write block larger than staging buffer
+  }
+
+  // Reserved sectors come first; the ring is everything after them
+  uint32_t totalSectors = size / sectorSize;
+  if (totalSectors < FLASH_LOG_RESERVED_SECTORS + 2) {
+    return false;  // Need at least one sector to rotate into
+  }
+  sectorCount = totalSectors - FLASH_LOG_RESERVED_SECTORS;
+
+  // Find the head: highest valid sequence number in its own slot
+  bool found = false;
+  FlashLogCursor headDataEnd = {0, 0};
+  for (uint16_t i = 0; i < sectorCount; i++) {
+    uint32_t sequence;
+    FlashLogCursor end;
+    if (!readSectorHeader(i, sequence, &end)) continue;
+    if (!found || (int32_t)(sequence - headSequence) > 0) {
+      headSequence = sequence;
+      headDataEnd = end;
+      found = true;
+    }
+  }
+
+  if (!found) {
+    format();
+    return available;
+  }
+
+  // Tail: walk forward from the oldest possible slot to the first valid one
+  tailSequence = (headSequence >= (uint32_t)(sectorCount - 1)) ? headSequence - (sectorCount - 1) : 0;
+  while (tailSequence != headSequence) {
+    uint32_t sequence;
+    if (readSectorHeader(tailSequence % sectorCount, sequence) && sequence == tailSequence) break;
+    tailSequence++;
+  }
+
+  // Default: nothing synced yet
+  syncCursor = {tailSequence, headerSize()};
+  pinnedCount = 0;
+
+  // Every new sector is opened with the current cursor and pinned
+  // records, so the head alone holds the newest of each; the data end
+  // from before it is in its header (data since then moves it on)
+  dataEnd = headDataEnd;
+  if (isBefore(dataEnd, syncCursor)) {
+    dataEnd = syncCursor;  // That data has rotated out
+  }
+  scanSector(headSequence, true);
+
+  // A checkpoint older than the retained data means those sectors rotated out
+  if ((int32_t)(syncCursor.sequence - tailSequence) < 0) {
+    syncCursor = {tailSequence, headerSize()};
+  }
+
+  available = true;
+  return true;
+}
+
+bool FlashLog::readSectorHeader(uint16_t index, uint32_t& sequence, FlashLogCursor* dataEnd) {
+  LogSectorHeader header;
+  if (!backendRead((uint32_t)(FLASH_LOG_RESERVED_SECTORS + index) * sectorSize, &header, sizeof(header))) {
+    return false;
+  }
+  if (header.magic != FLASH_LOG_SECTOR_MAGIC) {
+    return false;
+  }
+  if (header.crc32 != SensorManager::calculateCRC32((const uint8_t*)&header, offsetof(LogSectorHeader, crc32))) {
+    return false;
+  }
+  if (header.sequence % sectorCount != index) {
+    return false;  // Stale header from a different geometry
+  }
+  sequence = header.sequence;
+  if (dataEnd != nullptr) *dataEnd = header.dataEnd;
+  return true;
+}
+
+void FlashLog::scanSector(uint32_t sequence, bool isHead) {
+  uint32_t offset = headerSize();
+
+  while (true) {
+    uint8_t type;
+    uint8_t payload[FLASH_LOG_MAX_PINNED_SIZE];
+    size_t length;
+    uint32_t nextOffset;
+
+    int status = readRecordAt(sequence, offset, type, payload, sizeof(payload), length, nextOffset);
+    if (status == 0) {
+      break;  // Erased space or end of sector
+    }
+    if (status < 0 && nextOffset == 0) {
+      // Torn/corrupt record - nothing after it can be trusted
+      if (isHead) offset = sectorSize;  // Close the sector
+      break;
+    }
+
+    if (status > 0) {
+      if (type == LOG_TYPE_CURSOR && length == sizeof(FlashLogCursor)) {
+        memcpy(&syncCursor, payload, sizeof(FlashLogCursor));
+      } else if (type >= LOG_TYPE_PINNED_BASE) {
+        rememberPinned(type, payload, length);
+      }
+    }
+    if (type < LOG_TYPE_INTERNAL_BASE) {
+      dataEnd = {sequence, nextOffset};
+    }
+    offset = nextOffset;
+  }
+
+  if (isHead) {
+    writeOffset = offset;
+  }
+}
+
+void FlashLog::format() {
+  for (uint16_t i = 0; i < sectorCount; i++) {
+    backendErase((uint32_t)(FLASH_LOG_RESERVED_SECTORS + i) * sectorSize, sectorSize);
+  }
+
+  tailSequence = 0;
+  syncCursor = {0, headerSize()};
+  dataEnd = syncCursor;
+  available = startSector(0);
+}
+
+// ============================================================================
+// SECTOR ROTATION
+// ============================================================================
+
+bool FlashLog::startSector(uint32_t sequence) {
+  uint32_t base = sectorBase(sequence);
+  if (!backendErase(base, sectorSize)) {
+    return false;
+  }
+
+  LogSectorHeader header;
+  header.magic = FLASH_LOG_SECTOR_MAGIC;
+  header.sequence = sequence;
+  header.dataEnd = dataEnd;
+  header.crc32 = SensorManager::calculateCRC32((const uint8_t*)&header, offsetof(LogSectorHeader, crc32));
+
+  stageOffset = base;
+  stageFill = 0;
+  if (!stageBytes((const uint8_t*)&header, sizeof(header)) || !flushStage(true)) {
+    return false;
+  }
+
+  headSequence = sequence;
+  writeOffset = headerSize();
+
+  // Carry forward state that must outlive the erase of the oldest sector
+  if (available && isBefore({tailSequence, headerSize()}, syncCursor)) {
+    writeRecord(LOG_TYPE_CURSOR, (const uint8_t*)&syncCursor, sizeof(syncCursor), nullptr, 0);
+  }
+  for (uint8_t i = 0; i < pinnedCount; i++) {
+    writeRecord(pinned[i].type, pinned[i].data, pinned[i].length, nullptr, 0);
+  }
+  return true;
+}
+
+bool FlashLog::rotate() {
+  uint32_t next = headSequence + 1;
+
+  // The slot we are about to erase holds the tail - retire it
+  if (next - tailSequence >= sectorCount) {
+    if (syncCursor.sequence == tailSequence && isBefore(syncCursor, dataEnd)) {
+      sectorsDropped++;  // Unsynced data lost to wrap-around
+    }
+    tailSequence++;
+    if ((int32_t)(syncCursor.sequence - tailSequence) < 0) {
+      syncCursor = {tailSequence, headerSize()};
+    }
+  }
+
+  return startSector(next);
+}
+
+// ============================================================================
+// APPEND
+// ============================================================================
+
+bool FlashLog::append(uint8_t type, const uint8_t* part1, size_t length1,
+                      const uint8_t* part2, size_t length2) {
+  if (!available) return false;
+  return writeRecord(type, part1, length1, part2, length2);
+}
+
+size_t FlashLog::maxPayloadSize() {
+  if (sectorSize == 0) return 0;
+
+  // Leave room for the header and the carried-forward cursor/pinned records
+  uint32_t reserved = headerSize() + alignUp(sizeof(LogRecordHeader) + sizeof(FlashLogCursor)) +
+                      FLASH_LOG_MAX_PINNED * alignUp(sizeof(LogRecordHeader) + FLASH_LOG_MAX_PINNED_SIZE);
+  uint32_t room = sectorSize - reserved - sizeof(LogRecordHeader);
+  room -= room % writeAlign;
+  return (room > 0xFFFF) ? 0xFFFF : room;
+}
+
+bool FlashLog::writeRecord(uint8_t type, const uint8_t* part1, size_t length1,
+                           const uint8_t* part2, size_t length2) {
+  size_t length = length1 + length2;
+  if (length > maxPayloadSize()) {
+    return false;
+  }
+
+  uint32_t total = alignUp(sizeof(LogRecordHeader) + length);
+  if (writeOffset + total > sectorSize) {
+    if (!rotate()) return false;
+  }
+
+  LogRecordHeader header;
+  header.type = type;
+  header.flags = 0xFF;
+  header.length = (uint16_t)length;
+  uint32_t crc = SensorManager::calculateCRC32((const uint8_t*)&header, 4);
+  if (length1 > 0) crc = SensorManager::calculateCRC32(part1, length1, crc);
+  if (length2 > 0) crc = SensorManager::calculateCRC32(part2, length2, crc);
+  header.crc32 = crc;
+
+  stageOffset = sectorBase(headSequence) + writeOffset;
+  stageFill = 0;
+  bool ok = stageBytes((const uint8_t*)&header, sizeof(header)) &&
+            stageBytes(part1, length1) &&
+            stageBytes(part2, length2) &&
+            flushStage(true);
+
+  // Even a failed write consumed (possibly partially programmed) space
+  writeOffset += total;
+  if (!ok) {
+    writeOffset = sectorSize;  // Close sector; next append rotates
+    return false;
+  }
+
+  recordsAppended++;
+  if (type < LOG_TYPE_INTERNAL_BASE) {
+    dataEnd = {headSequence, writeOffset};
+  }
+  return true;
+}
+
+bool FlashLog::stageBytes(const uint8_t* data, size_t length) {
+  while (length > 0) {
+    size_t chunk = FLASH_LOG_STAGE_SIZE - stageFill;
+    if (chunk > length) chunk = length;
+    memcpy(&stage[stageFill], data, chunk);
+    stageFill += chunk;
+    data += chunk;
+    length -= chunk;
+
+    if (stageFill == FLASH_LOG_STAGE_SIZE && !flushStage(false)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool FlashLog::flushStage(bool pad) {
+  if (stageFill == 0) return true;
+
+  size_t length = stageFill;
+  if (pad) {
+    length = alignUp(stageFill);
+    memset(&stage[stageFill], 0xFF, length - stageFill);
+  }
+
+  bool ok = backendWrite(stageOffset, stage, length);
+  stageOffset += length;
+  stageFill = 0;
+  return ok;
+}
+
+// ============================================================================
+// READ
+// ============================================================================
+
+// Returns 1 = record read, 0 = end of sector, -1 = unusable record
+// (nextOffset != 0: skip it, e.g. larger than buffer; nextOffset == 0: corrupt)
+int FlashLog::readRecordAt(uint32_t sequence, uint32_t offset, uint8_t& type,
+                           uint8_t* buffer, size_t capacity, size_t& length, uint32_t& nextOffset) {
+  nextOffset = 0;
+  type = LOG_TYPE_ERASED;
+  length = 0;
+
+  if (offset + sizeof(LogRecordHeader) > sectorSize) {
+    return 0;
+  }
+
+  uint32_t address = sectorBase(sequence) + offset;
+  LogRecordHeader header;
+  if (!backendRead(address, &header, sizeof(header))) {
+    return -1;
+  }
+
+  if (header.type == LOG_TYPE_ERASED && header.length == 0xFFFF) {
+    return 0;  // Erased - end of written data
+  }
+
+  uint32_t total = alignUp(sizeof(LogRecordHeader) + header.length);
+  if (offset + total > sectorSize) {
+    corruptRecords++;
+    return -1;
+  }
+
+  uint32_t seed = SensorManager::calculateCRC32((const uint8_t*)&header, 4);
+  if (!verifyPayload(address + sizeof(header), seed, header.crc32, header.length, buffer, capacity)) {
+    corruptRecords++;
+    return -1;
+  }
+
+  type = header.type;
+  length = header.length;
+  nextOffset = offset + total;
+  return (header.length <= capacity) ? 1 : -1;
+}
+
+bool FlashLog::verifyPayload(uint32_t address, uint32_t crc, uint32_t expected, size_t length,
+                             uint8_t* buffer, size_t capacity) {
+  if (buffer != nullptr && length <= capacity) {
+    // Read straight into the caller's buffer
+    if (!backendRead(address, buffer, length)) return false;
+    return SensorManager::calculateCRC32(buffer, length, crc) == expected;
+  }
+
+  // Too large for the caller - checksum in chunks through the stage buffer
+  while (length > 0) {
+    size_t chunk = (length > FLASH_LOG_STAGE_SIZE) ? FLASH_LOG_STAGE_SIZE : length;
+    if (!backendRead(address, stage, chunk)) return false;
+    crc = SensorManager::calculateCRC32(stage, chunk, crc);
+    address += chunk;
+    length -= chunk;
+  }
+  return crc == expected;
+}
+
+FlashLogReadResult FlashLog::readNext(FlashLogCursor& cursor, uint8_t& type,
+                                      uint8_t* buffer, size_t capacity, size_t& length) {
+  if (!available) return FLASH_LOG_READ_END;
+
+  // Cursor fell behind rotation - resume at the oldest retained data
+  if ((int32_t)(cursor.sequence - tailSequence) < 0) {
+    cursor = {tailSequence, headerSize()};
+  }
+
+  while (isBefore(cursor, dataEnd)) {
+    uint32_t nextOffset;
+    int status = readRecordAt(cursor.sequence, cursor.offset, type, buffer, capacity, length, nextOffset);
+
+    if (status == 0 || nextOffset == 0) {
+      // End of sector (or corrupt tail) - continue in the next one
+      cursor.sequence++;
+      cursor.offset = headerSize();
+      continue;
+    }
+
+    cursor.offset = nextOffset;
+    if (type < LOG_TYPE_INTERNAL_BASE) {
+      return (status > 0) ? FLASH_LOG_READ_OK : FLASH_LOG_READ_OVERSIZE;
+    }
+  }
+  return FLASH_LOG_READ_END;
+}
+
+FlashLogCursor FlashLog::getOldestCursor() {
+  FlashLogCursor cursor = {tailSequence, headerSize()};
+  return cursor;
+}
+
+// ============================================================================
+// SYNC CURSOR
+// ============================================================================
+
+FlashLogCursor FlashLog::getSyncCursor() {
+  return syncCursor;
+}
+
+bool FlashLog::commitSyncCursor(FlashLogCursor cursor) {
+  if (!available) return false;
+
+  syncCursor = cursor;
+  return writeRecord(LOG_TYPE_CURSOR, (const uint8_t*)&cursor, sizeof(cursor), nullptr, 0);
+}
+
+bool FlashLog::hasUnsynced() {
+  return available && isBefore(syncCursor, dataEnd);
+}
+
+// ============================================================================
+// PINNED RECORDS
+// ============================================================================
+
+bool FlashLog::setPinnedRecord(uint8_t type, const void* data, size_t length) {
+  if (!available || type < LOG_TYPE_PINNED_BASE || length > FLASH_LOG_MAX_PINNED_SIZE) {
+    return false;
+  }
+
+  rememberPinned(type, (const uint8_t*)data, length);
+  return writeRecord(type, (const uint8_t*)data, length, nullptr, 0);
+}
+
+bool FlashLog::getPinnedRecord(uint8_t type, void* data, size_t length) {
+  for (uint8_t i = 0; i < pinnedCount; i++) {
+    if (pinned[i].type == type && pinned[i].length == length) {
+      memcpy(data, pinned[i].data, length);
+      return true;
+    }
+  }
+  return false;
+}
+
+void FlashLog::rememberPinned(uint8_t type, const uint8_t* data, size_t length) {
+  if (length > FLASH_LOG_MAX_PINNED_SIZE) return;
+
+  uint8_t slot = pinnedCount;
+  for (uint8_t i = 0; i < pinnedCount; i++) {
+    if (pinned[i].type == type) slot = i;
+  }
+  if (slot == pinnedCount) {
+    if (pinnedCount >= FLASH_LOG_MAX_PINNED) return;
+    pinnedCount++;
+  }
+
+  pinned[slot].type = type;
+  pinned[slot].length = (uint8_t)length;
+  memcpy(pinned[slot].data, data, length);
+}
+
+// ============================================================================
+// STATUS
+// ============================================================================
+
+bool FlashLog::isAvailable() {
+  return available;
+}
+
+FlashLogStats FlashLog::getStats() {
+  FlashLogStats stats;
+  stats.persistent = persistent;
+  stats.capacityBytes = (uint32_t)sectorSize * sectorCount;
+  stats.sectorSize = sectorSize;
+  stats.sectorCount = sectorCount;
+  stats.headSequence = headSequence;
+  stats.unsyncedSectors = hasUnsynced() ? headSequence - syncCursor.sequence + 1 : 0;
+  stats.recordsAppended = recordsAppended;
+  stats.sectorsDropped = sectorsDropped;
+  stats.corruptRecords = corruptRecords;
+  return stats;
+}
+
+// ============================================================================
+// RESERVED SECTORS
+// ============================================================================
+
+bool FlashLog::readReserved(uint8_t index, uint32_t offset, void* data, size_t length) {
+  if (sectorSize == 0 || index >= FLASH_LOG_RESERVED_SECTORS || offset + length > sectorSize) {
+    return false;
+  }
+  return backendRead((uint32_t)index * sectorSize + offset, data, length);
+}
+
+bool FlashLog::writeReserved(uint8_t index, const void* data, size_t length) {
+  if (sectorSize == 0 || index >= FLASH_LOG_RESERVED_SECTORS || alignUp(length) > sectorSize) {
+    return false;
+  }
+
+  uint32_t base = (uint32_t)index * sectorSize;
+  if (!backendErase(base, sectorSize)) {
+    return false;
+  }
+
+  // Whole write blocks, tail padded with the erased value
+  const uint8_t* bytes = (const uint8_t*)data;
+  uint8_t chunk[FLASH_LOG_STAGE_SIZE];
+  for (size_t done = 0; done < length; done += sizeof(chunk)) {
+    size_t part = (length - done < sizeof(chunk)) ? length - done : sizeof(chunk);
+    memset(chunk, 0xFF, sizeof(chunk));
+    memcpy(chunk, bytes + done, part);
+    if (!backendWrite(base + done, chunk, alignUp(part))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint32_t FlashLog::getReservedSize() {
+  return sectorSize;
+}
+
+// ============================================================================
+// LAYOUT HELPERS
+// ============================================================================
+
+uint32_t FlashLog::sectorBase(uint32_t sequence) {
+  return (FLASH_LOG_RESERVED_SECTORS + sequence % sectorCount) * sectorSize;
+}
+
+uint32_t FlashLog::headerSize() {
+  return alignUp(sizeof(LogSectorHeader));
+}
+
+uint32_t FlashLog::alignUp(uint32_t value) {
+  return (value + writeAlign - 1) / writeAlign * writeAlign;
+}
+
+bool FlashLog::isBefore(FlashLogCursor a, FlashLogCursor b) {
+  if (a.sequence != b.sequence) return (int32_t)(a.sequence - b.sequence) < 0;
+  return a.offset < b.offset;
+}
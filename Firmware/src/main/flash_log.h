@@ -0,0 +1,199 @@
+/**
+ * GreenOS - Append-only Flash Log
+ *
+ * Log-structured store on the board's internal flash (Zephyr
+ * "storage_partition") for packed sensor blocks and alerts, so buffered
+ * data survives reboots and long WiFi outages.
+ *
+ * Layout:
+ * - The partition is used as a ring of erase sectors. Sector with
+ *   sequence number S lives at index S % sectorCount, so rotation is
+ *   strictly round-robin and every sector wears evenly.
+ * - Each sector starts with a CRC-protected header carrying its sequence
+ *   number and where data ended when the sector was started, followed
+ *   by records: [type][flags][length][crc32] + payload, padded to the
+ *   flash write block size. CRC32 covers type, length and payload
+ *   (SensorManager::calculateCRC32).
+ * - The "last synced" cursor is itself an appended record; recovery
+ *   picks the newest one.
+ * - Pinned records are re-appended at the start of every new sector, so
+ *   the current copy always outlives the erase of the oldest sector.
+ * - The first FLASH_LOG_RESERVED_SECTORS sectors are not part of the
+ *   ring: they hold the config store's A/B slots (config_store.h) and
+ *   are only touched through readReserved() / writeReserved().
+ *
+ * Power loss: recovery scans sector headers for the highest sequence,
+ * then walks the head sector until the first erased header. A torn or
+ * corrupt record closes the sector; the next append starts a fresh one.
+ */
+
+#ifndef FLASH_LOG_H
+#define FLASH_LOG_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+#define FLASH_LOG_STAGE_SIZE 64          // Write staging buffer (multiple of write block)
+#define FLASH_LOG_MAX_PINNED 3
+#define FLASH_LOG_MAX_PINNED_SIZE 48
+#define FLASH_LOG_RESERVED_SECTORS 2     // Leading sectors kept out of the ring (config A/B)
+
+// Fallback when no flash partition is available (RAM only, not persistent)
+#ifndef FLASH_LOG_EMULATED_SIZE
+#define FLASH_LOG_EMULATED_SIZE 8192
+#define FLASH_LOG_EMULATED_SECTOR 1024
+#endif
+
+// ============================================================================
+// RECORD TYPES
+// ============================================================================
+
+enum LogRecordType {
+  LOG_TYPE_READINGS = 0x01,     // RecordCodec block (header + PackedReadings)
+  LOG_TYPE_ALERT = 0x02,        // LoggedAlert + alert text
+  LOG_TYPE_ROLLUP = 0x03,       // PackedRollup (1-min / 15-min window)
+  LOG_TYPE_TRACE = 0x04,        // RecordCodec block captured for replay (never uploaded)
+  LOG_TYPE_BOOT = 0x06,         // uint32 boot id - the records after it were logged in that boot
+  LOG_TYPE_CURSOR = 0x10,       // Sync cursor checkpoint (internal)
+  LOG_TYPE_CALIBRATION = 0x20,  // Pinned: ADCCalibration (superseded by the config store)
+  LOG_TYPE_BOOT_ID = 0x21,      // Pinned: uint32 id of the latest boot
+  LOG_TYPE_SYNC_BOOT = 0x22,    // Pinned: uint32 LOG_TYPE_BOOT id in force at the sync cursor
+  LOG_TYPE_ERASED = 0xFF
+};
+
+#define LOG_TYPE_INTERNAL_BASE 0x10     // Types >= this are skipped by readNext()
+#define LOG_TYPE_PINNED_BASE 0x20       // Types >= this are pinned records
+
+// readNext() outcome
+enum FlashLogReadResult {
+  FLASH_LOG_READ_END = 0,       // No more data records
+  FLASH_LOG_READ_OK,            // Record copied into the buffer
+  FLASH_LOG_READ_OVERSIZE       // Valid record larger than the buffer (type/length set, nothing copied)
+};
+
+// Position of a record in the log
+struct FlashLogCursor {
+  uint32_t sequence;    // Sector sequence number
+  uint32_t offset;      // Byte offset inside that sector
+};
+
+struct FlashLogStats {
+  bool persistent;            // false = RAM emulation
+  uint32_t capacityBytes;
+  uint32_t sectorSize;
+  uint16_t sectorCount;
+  uint32_t headSequence;
+  uint32_t unsyncedSectors;   // Sectors between sync cursor and head (inclusive)
+  uint32_t recordsAppended;   // Since boot
+  uint32_t sectorsDropped;    // Unsynced sectors erased by rotation since boot
+  uint32_t corruptRecords;    // CRC failures seen since boot
+};
+
+// ============================================================================
+// FLASH LOG CLASS
+// ============================================================================
+
+class FlashLog {
+public:
+  FlashLog();
+
+  // Mount (and recover) the log. Returns false if no usable storage.
+  bool begin();
+  bool isAvailable();
+
+  // Append one record built from up to two parts (e.g. header + span),
+  // so callers never need to concatenate into a temporary buffer
+  bool append(uint8_t type, const uint8_t* part1, size_t length1,
+              const uint8_t* part2 = nullptr, size_t length2 = 0);
+  size_t maxPayloadSize();
+
+  // Sequential read of data records from a cursor (skips internal types).
+  // The cursor moves past the record for OK and OVERSIZE alike - a caller
+  // that must not lose an oversize record keeps its own copy.
+  FlashLogReadResult readNext(FlashLogCursor& cursor, uint8_t& type,
+                uint8_t* buffer, size_t capacity, size_t& length);
+
+  // Start of the oldest retained data (for full-log scans)
+  FlashLogCursor getOldestCursor();
+
+  // "Last synced" position
+  FlashLogCursor getSyncCursor();
+  bool commitSyncCursor(FlashLogCursor cursor);
+  bool hasUnsynced();
+
+  // Pinned records survive sector rotation
+  bool setPinnedRecord(uint8_t type, const void* data, size_t length);
+  bool getPinnedRecord(uint8_t type, void* data, size_t length);
+
+  // Reserved sectors outside the ring. writeReserved() erases the
+  // sector and programs it from offset 0 (padded to the write block).
+  bool readReserved(uint8_t index, uint32_t offset, void* data, size_t length);
+  bool writeReserved(uint8_t index, const void* data, size_t length);
+  uint32_t getReservedSize();
+
+  FlashLogStats getStats();
+  void format();
+
+private:
+  bool available;
+  bool persistent;
+  uint32_t sectorSize;
+  uint16_t sectorCount;
+  uint16_t writeAlign;
+
+  uint32_t headSequence;
+  uint32_t tailSequence;      // Oldest sector still holding data
+  uint32_t writeOffset;       // Next free byte in head sector
+  FlashLogCursor syncCursor;
+  FlashLogCursor dataEnd;     // Just past the newest data record
+
+  struct PinnedRecord {
+    uint8_t type;
+    uint8_t length;
+    uint8_t data[FLASH_LOG_MAX_PINNED_SIZE];
+  };
+  PinnedRecord pinned[FLASH_LOG_MAX_PINNED];
+  uint8_t pinnedCount;
+
+  uint8_t stage[FLASH_LOG_STAGE_SIZE];
+  uint16_t stageFill;
+  uint32_t stageOffset;        // Absolute flash offset the stage flushes to
+
+  uint32_t recordsAppended;
+  uint32_t sectorsDropped;
+  uint32_t corruptRecords;
+
+  // Layout helpers
+  uint32_t sectorBase(uint32_t sequence);
+  uint32_t headerSize();
+  uint32_t alignUp(uint32_t value);
+  bool isBefore(FlashLogCursor a, FlashLogCursor b);
+
+  // Recovery
+  bool readSectorHeader(uint16_t index, uint32_t& sequence, FlashLogCursor* dataEnd = nullptr);
+  void scanSector(uint32_t sequence, bool isHead);
+  bool verifyPayload(uint32_t address, uint32_t crc, uint32_t expected, size_t length,
+                     uint8_t* buffer, size_t capacity);
+  bool startSector(uint32_t sequence);
+  bool rotate();
+
+  // Record I/O
+  bool writeRecord(uint8_t type, const uint8_t* part1, size_t length1,
+                   const uint8_t* part2, size_t length2);
+  bool stageBytes(const uint8_t* data, size_t length);
+  bool flushStage(bool pad);
+  int readRecordAt(uint32_t sequence, uint32_t offset, uint8_t& type,
+                   uint8_t* buffer, size_t capacity, size_t& length, uint32_t& nextOffset);
+  void rememberPinned(uint8_t type, const uint8_t* data, size_t length);
+};
+
+extern FlashLog flashLog;
+
+// RAM emulation only (host tests): bits of the byte at offset that read 0
+// whatever is erased or written, like a worn cell. mask 0 clears it.
+void flashLogEmulateStuckBits(uint32_t offset, uint8_t mask);
+
+#endif // FLASH_LOG_H
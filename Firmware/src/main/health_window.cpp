@@ -0,0 +1,137 @@
+/**
+ * GreenOS - Sliding-Window Sensor Health Implementation
+ */
+
+#include "health_window.h"
+
+// ============================================================================
+// SLIDING ERROR WINDOW
+// ============================================================================
+
+HealthWindow::HealthWindow() {
+  memset(buckets, 0, sizeof(buckets));
+  currentEpoch = 0;
+}
+
+void HealthWindow::advance(unsigned long now) {
+  unsigned long epoch = now / HEALTH_BUCKET_MS;
+  if (epoch == currentEpoch) return;
+
+  // Clear every bucket the window slid past (all of them after a long
+  // gap or a millis() wrap)
+  unsigned long steps = epoch - currentEpoch;
+  if (epoch < currentEpoch || steps > HEALTH_BUCKETS) {
+    steps = HEALTH_BUCKETS;
+  }
+  for (unsigned long i = 1; i <= steps; i++) {
+    Bucket& bucket = buckets[(currentEpoch + i) % HEALTH_BUCKETS];
+    bucket.reads = 0;
+    bucket.errors = 0;
+  }
+  currentEpoch = epoch;
+}
+
+void HealthWindow::record(bool ok, unsigned long now) {
+  advance(now);
+
+  Bucket& bucket = buckets[currentEpoch % HEALTH_BUCKETS];
+  if (bucket.reads < 0xFFFF) {
+    bucket.reads++;
+    if (!ok) bucket.errors++;
+  }
+}
+
+uint32_t HealthWindow::getReads(unsigned long now) {
+  advance(now);
+
+  uint32_t reads = 0;
+  for (uint8_t i = 0; i < HEALTH_BUCKETS; i++) {
+    reads += buckets[i].reads;
+  }
+  return reads;
+}
+
+uint32_t HealthWindow::getErrors(unsigned long now) {
+  advance(now);
+
+  uint32_t errors = 0;
+  for (uint8_t i = 0; i < HEALTH_BUCKETS; i++) {
+    errors += buckets[i].errors;
+  }
+  return errors;
+}
+
+float HealthWindow::getErrorRate(unsigned long now) {
+  uint32_t reads = getReads(now);
+  if (reads == 0) return 0.0f;
+  return (float)getErrors(now) / reads * 100.0f;
+}
+
+// ============================================================================
+// LATENCY HISTOGRAM
+// ============================================================================
+
+LatencyHistogram::LatencyHistogram() {
+  reset();
+}
+
+void LatencyHistogram::reset() {
+  memset(counts, 0, sizeof(counts));
+  count = 0;
+  maxMicros = 0;
+}
+
+void LatencyHistogram::record(unsigned long micros) {
+  // Bucket = position of the highest set bit (0 and 1 share bucket 0)
+  uint8_t index = 0;
+  unsigned long value = micros >> 1;
+  while (value != 0 && index < LATENCY_BUCKETS - 1) {
+    value >>= 1;
+    index++;
+  }
+
+  counts[index]++;
+  count++;
+  if (micros > maxMicros) maxMicros = micros;
+}
+
+uint32_t LatencyHistogram::getCount() {
+  return count;
+}
+
+unsigned long LatencyHistogram::getMax() {
+  return maxMicros;
+}
+
+unsigned long LatencyHistogram::getPercentile(uint8_t percentile) {
+  if (count == 0) return 0;
+
+  // Smallest bucket whose cumulative count reaches the rank
+  uint32_t rank = ((uint64_t)count * percentile + 99) / 100;
+  if (rank == 0) rank = 1;
+
+  uint32_t cumulative = 0;
+  for (uint8_t i = 0; i < LATENCY_BUCKETS; i++) {
+    cumulative += counts[i];
+    if (cumulative >= rank) {
+      unsigned long bound = bucketUpperBound(i);
+      return (bound < maxMicros) ? bound : maxMicros;
+    }
+  }
+  return maxMicros;
+}
+
+void LatencyHistogram::summarize(LatencySummary& out) {
+  out.count = count;
+  out.p50Micros = getPercentile(50);
+  out.p99Micros = getPercentile(99);
+  out.maxMicros = maxMicros;
+}
+
+uint32_t LatencyHistogram::getBucket(uint8_t index) {
+  return counts[index];
+}
+
+unsigned long LatencyHistogram::bucketUpperBound(uint8_t index) {
+  return 1UL << (index + 1);
+}
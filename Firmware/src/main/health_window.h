@@ -0,0 +1,90 @@
+/**
+ * GreenOS - Sliding-Window Sensor Health
+ *
+ * HealthWindow: read/error counters in HEALTH_BUCKETS time buckets of
+ * HEALTH_BUCKET_MS each, so error rates cover only the last ~10 minutes
+ * instead of the whole uptime. A sensor that dies after a month shows
+ * 100% errors within one window, not a ratio diluted by past successes.
+ *
+ * LatencyHistogram: power-of-two microsecond buckets per sensor read,
+ * with count, max and bucket-resolution percentiles.
+ *
+ * Both are fixed memory and O(1) per record.
+ */
+
+#ifndef HEALTH_WINDOW_H
+#define HEALTH_WINDOW_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+#define HEALTH_BUCKET_MS 60000UL      // One bucket per minute
+#define HEALTH_BUCKETS 10             // Window = last 10 minutes
+#define LATENCY_BUCKETS 20            // [2^i, 2^(i+1)) us; last bucket >= 2^19 us (~0.5 s)
+
+// ============================================================================
+// SLIDING ERROR WINDOW
+// ============================================================================
+
+class HealthWindow {
+public:
+  HealthWindow();
+
+  void record(bool ok, unsigned long now);
+
+  // Totals over the window ending at now
+  uint32_t getReads(unsigned long now);
+  uint32_t getErrors(unsigned long now);
+  float getErrorRate(unsigned long now);   // %, 0 with no reads in the window
+
+private:
+  struct Bucket {
+    uint16_t reads;
+    uint16_t errors;
+  };
+
+  Bucket buckets[HEALTH_BUCKETS];
+  unsigned long currentEpoch;   // now / HEALTH_BUCKET_MS of the newest bucket
+
+  void advance(unsigned long now);
+};
+
+// ============================================================================
+// LATENCY HISTOGRAM
+// ============================================================================
+
+struct LatencySummary {
+  uint32_t count;
+  unsigned long p50Micros;
+  unsigned long p99Micros;
+  unsigned long maxMicros;
+};
+
+class LatencyHistogram {
+public:
+  LatencyHistogram();
+
+  void record(unsigned long micros);
+  void reset();
+
+  uint32_t getCount();
+  unsigned long getMax();
+
+  // Upper bound of the bucket holding the given percentile (0-100)
+  unsigned long getPercentile(uint8_t percentile);
+
+  void summarize(LatencySummary& out);
+
+  uint32_t getBucket(uint8_t index);
+  static unsigned long bucketUpperBound(uint8_t index);
+
+private:
+  uint32_t counts[LATENCY_BUCKETS];
+  uint32_t count;
+  unsigned long maxMicros;
+};
+
+#endif // HEALTH_WINDOW_H
@@ -6,19 +6,30 @@
  * - Finite State Machine (FSM) for robust operation
  * - Hardware Watchdog Timer (WDT) for auto-recovery
  * - Sensor health monitoring and validation
- * - SD card buffering for offline operation
+ * - Flash-backed local log for offline operation
  * - Safe-fail emergency protocols
  * - Memory management and error handling
  */
 
 #include <Arduino.h>
-// Note: WiFi library has BSP incompatibility on Arduino UNO Q Zephyr 0.52.0
-// System will operate in local mode (Serial Monitor only) for initial testing
+// Note: WiFi library has BSP incompatibility on Arduino UNO Q Zephyr 0.52.0.
+// The network runs on the ESP32-S3 co-processor instead (FIREBASE_RPC_LINK).
 #include "config.h"
 #include "sensor_manager.h"
 #include "actuator_manager.h"
 #include "firebase_comm.h"
 #include "anomaly_detection.h"
+#include "alert_queue.h"
+#include "climate_controller.h"
+#include "task_scheduler.h"
+#include "ring_buffer.h"
+#include "record_codec.h"
+#include "flash_log.h"
+#include "config_store.h"
+#include "boot_state.h"
+#include "sensor_rollup.h"
+#include "profiler.h"
+#include "sensor_trace.h"
 
 // ============================================================================
 // GLOBAL OBJECTS
@@ -28,6 +39,9 @@ SensorManager sensors;
 ActuatorManager actuators;
 FirebaseComm firebase;
 AnomalyDetection anomaly;
+AlertQueue alerts;
+ClimateController climate;
+TaskScheduler scheduler;
 
 // ============================================================================
 // SYSTEM STATE MACHINE
@@ -37,44 +51,93 @@ SystemState currentState = STATE_BOOT;
 SystemState previousState = STATE_BOOT;
 unsigned long stateEntryTime = 0;
 uint8_t bootFailCount = 0;
+bool sensorInitStarted = false;
+bool sensorInitRetryPending = false;
+unsigned long sensorInitStart = 0;       // Init start, or failure time while a retry is pending
+bool emergencyProtocolPending = false;   // Set on entry to STATE_EMERGENCY
+
+#define EMERGENCY_BLINK_MS 2000          // Rapid LED flash after entering emergency
+#define EMERGENCY_HOLD_MS 7000           // Time in emergency before returning to normal
+#define ANOMALY_REALERT_MS 60000         // Repeat warning response for an unchanged anomaly set
+#define SENSOR_READY_TIMEOUT_MS 5000     // Longest wait for first samples (cold boot)
+#define SENSOR_INIT_RETRY_MS 5000        // Pause before re-initializing failed sensors
+
+// Sent directly from the emergency state, never through the alert queue
+#define EMERGENCY_ANOMALIES (ANOMALY_BIT(TEMP_TOO_LOW) | ANOMALY_BIT(TEMP_TOO_HIGH))
+
+AnomalySet lastAlertedAnomalies = 0;
+unsigned long lastAnomalyAlert = 0;
 
 // ============================================================================
 // TIMING VARIABLES
 // ============================================================================
 
-unsigned long lastSensorRead = 0;
-unsigned long lastFirebaseSync = 0;
-unsigned long lastAnomalyCheck = 0;
+unsigned long lastSensorRead = 0;   // Safe mode only - normal operation uses the task table
 unsigned long lastModbusRead = 0;
-unsigned long lastSDFlush = 0;
 unsigned long lastMemoryCheck = 0;
-unsigned long lastHealthCheck = 0;
+
+// Status LED pattern, stepped from loop() (see updateStatusLED())
+int statusBlinkSteps = 0;           // On/off half-periods left
+unsigned long statusBlinkMs = 0;
+unsigned long statusBlinkAt = 0;    // Start of the current half-period
+
+#define FIREBASE_REALTIME_POLL_MS 100   // Command/realtime update polling period
+#define LOOP_MAX_SLEEP_MS 50            // Upper bound on idle sleep (serial responsiveness)
+
+// Task table ids (normal operation)
+int taskSensors = -1;
+int taskSync = -1;
+int taskHealth = -1;
+int taskLogFlush = -1;
 
 // ============================================================================
 // OFFLINE DATA BUFFERING
 // ============================================================================
 
-struct SensorReading {
-  unsigned long timestamp;
-  float airTemp;
-  float airHumidity;
-  float co2;
-  float ph;
-  float ec;
-  float vwc;
-};
+// Readings are held as 14-byte PackedReadings (see record_codec.h),
+// delta-encoded against the previous entry in the ring
+// Ring capacity - override in config.h to hold longer outages
+#ifndef OFFLINE_BUFFER_CAPACITY
+#define OFFLINE_BUFFER_CAPACITY MAX_BUFFERED_READINGS
+#endif
+
+RingBuffer<PackedReading, OFFLINE_BUFFER_CAPACITY> offlineBuffer;
+RecordCodec offlineCodec;
+unsigned long offlineTailTimestamp = 0;   // Absolute time of the oldest entry
+bool flashLogAvailable = false;
+uint32_t bootId = 0;                      // Differs on every boot (upload ids)
+uint32_t syncBoot = 0;                    // Boot that logged the records at the sync cursor (0 = unknown)
+
+// 1-min / 15-min min/max/mean/count/last summaries (see sensor_rollup.h)
+SensorRollup rollups;
+
+// ============================================================================
+// TRACE CAPTURE / REPLAY (soak testing - see sensor_trace.h)
+// ============================================================================
+
+// Sensor cycles per normal sensor interval while replaying
+#ifndef TRACE_REPLAY_SPEED
+#define TRACE_REPLAY_SPEED 60
+#endif
 
-SensorReading offlineBuffer[MAX_BUFFERED_READINGS];
-uint8_t bufferCount = 0;
-bool sdCardAvailable = false;
+TraceRecorder traceRecorder;
+TraceReplay traceReplay;
+bool traceReplayRunning = false;
+uint32_t traceReplayEmergencies = 0;      // Emergency-level cycles (no protocol run)
 
 // ============================================================================
 // SETUP - INITIALIZATION
 // ============================================================================
 
 void setup() {
+  // Reset cause and retained state first - decides how much startup to skip
+  bootState.begin();
+  bool warmBoot = bootState.isWarm();
+  
   Serial.begin(9600);  // Arduino UNO Q Zephyr only supports 9600 and 19200
-  delay(3000);  // Extended delay for Zephyr Serial initialization
+  if (!warmBoot) {
+    delay(3000);  // Extended delay for Zephyr Serial initialization
+  }
   
   // Send multiple newlines to clear any buffer
   for (int i = 0; i < 5; i++) {
@@ -88,18 +151,37 @@ void setup() {
   Serial.println();
   Serial.println("Board: Arduino UNO Q (STM32U5 + ESP32-S3)");
   Serial.println("Firmware: v1.0 - Local Mode");
+  bootState.printStatus();
   Serial.println();
   
+  // Relays before anything slow: OFF on a cold boot, as they were on a warm one
+  actuators.init();
+  climate.init(&actuators);
+  if (warmBoot) {
+    restoreRelays();
+  }
+  
   // Initialize status LED
   pinMode(STATUS_LED_PIN, OUTPUT);
-  blinkStatusLED(3, 200);  // 3 quick blinks = boot
+  if (!warmBoot) {
+    blinkStatusLED(3, 200);  // 3 quick blinks = boot
+  }
+  
+  // Cycle-counter timing for the 'p' command
+  profiler.begin();
   
   // Initialize hardware watchdog timer
   setupWatchdog();
   
-  // SD card not available on Zephyr - skip initialization
-  Serial.println("⚠️  SD card buffering disabled (Zephyr incompatibility)");
-  sdCardAvailable = false;
+  // Mount the local flash log (replaces SD card buffering)
+  initializeLocalLog();
+  assignBootId();
+  
+  // Thresholds, calibration and intervals from the A/B config slots
+  loadDeviceConfig();
+  
+  // Register normal-operation tasks
+  setupTasks();
   
   // Set initial state
   changeState(STATE_SENSOR_INIT);
@@ -110,13 +192,28 @@ void setup() {
 // ============================================================================
 
 void loop() {
+  uint32_t loopStart = profiler.start();
+  
   // Pet the watchdog to prevent reset
   feedWatchdog();
   
   // Check watchdog timeout (software implementation)
   checkWatchdog();
   
+  // Advance non-blocking sensor bus transactions (Modbus RS485)
+  sensors.poll();
+  
+  // Co-processor link: TX drain and poll replies (commands, results)
+  firebase.poll();
+  
+  // Run due deferred actuator actions (interlock delays, alarm patterns)
+  actuators.tick();
+  updateStatusLED();
+  
   // Execute current state
+  uint32_t stateStart = profiler.start();
+  ProfileSection stateSection = profileSectionFor(currentState);
+  
   switch (currentState) {
     case STATE_BOOT:
       // Should not reach here (handled in setup)
@@ -151,13 +248,31 @@ void loop() {
       stateCalibrationMode();
       break;
   }
+  profiler.stop(stateSection, stateStart);
   
   // Periodic maintenance tasks (run in all states)
   periodicMemoryCheck();
   handleSerialCommands();
   
-  // Small delay to prevent tight loop
-  delay(10);
+  // Worst-case loop latency excludes the deliberate idle sleep
+  profiler.stop(PROFILE_LOOP, loopStart);
+  
+  // Sleep until the next task deadline instead of spinning
+  idleUntilNextDeadline();
+}
+
+ProfileSection profileSectionFor(SystemState state) {
+  switch (state) {
+    case STATE_BOOT:             return PROFILE_STATE_BOOT;
+    case STATE_SENSOR_INIT:      return PROFILE_STATE_SENSOR_INIT;
+    case STATE_NETWORK_CONNECT:  return PROFILE_STATE_NETWORK;
+    case STATE_FIREBASE_AUTH:    return PROFILE_STATE_AUTH;
+    case STATE_NORMAL_OPERATION: return PROFILE_STATE_NORMAL;
+    case STATE_SAFE_MODE:        return PROFILE_STATE_SAFE;
+    case STATE_EMERGENCY:        return PROFILE_STATE_EMERGENCY;
+    case STATE_CALIBRATION_MODE: return PROFILE_STATE_CALIBRATION;
+  }
+  return PROFILE_STATE_BOOT;
 }
 
 // ============================================================================
@@ -165,23 +280,43 @@ void loop() {
 // ============================================================================
 
 void stateSensorInit() {
-  Serial.println("\n[STATE] Initializing Sensors...");
-  
-  // Initialize sensor manager
-  sensors.init();
-  
-  // Initialize actuator manager
-  actuators.init();
+  // Non-blocking: loop() keeps the watchdog, poll() and the relays running
+  // while the sensors come up together
+  if (!sensorInitStarted) {
+    if (sensorInitRetryPending && millis() - sensorInitStart < SENSOR_INIT_RETRY_MS) {
+      return;
+    }
+    sensorInitRetryPending = false;
+    sensorInitStarted = true;
+    sensorInitStart = millis();
+    
+    Serial.println("\n[STATE] Initializing Sensors...");
+    sensors.init();
+    
+    // Warm boot: the retained reading covers the gap until the sensors
+    // report; the sensor task picks them up as they become ready
+    SensorReading retained;
+    if (bootState.getReading(retained)) {
+      sensors.restoreReading(retained, bootState.getPreheatElapsed());
+      Serial.println("✓ Warm boot - resuming on the retained sensor snapshot");
+      changeState(STATE_NETWORK_CONNECT);
+      return;
+    }
+  }
   
-  // Wait for initial sensor readings
-  delay(2000);
+  // Readiness polling instead of a fixed settle delay
+  if (!sensors.isReady() && millis() - sensorInitStart < SENSOR_READY_TIMEOUT_MS) {
+    return;
+  }
   sensors.readAll();
   
   // Verify at least one critical sensor is working
-  SensorData data = sensors.getData();
+  const SensorData& data = sensors.getData();
   if (data.airTemp > -50 && data.airTemp < 60) {
     // Temperature sensor working, proceed
-    Serial.println("✓ Sensor initialization successful");
+    Serial.print("✓ Sensor initialization successful (");
+    Serial.print(millis() - sensorInitStart);
+    Serial.println(" ms)");
     changeState(STATE_NETWORK_CONNECT);
   } else {
     Serial.println("✗ Sensor initialization failed!");
@@ -190,17 +325,25 @@ void stateSensorInit() {
       Serial.println("⚠️ Too many boot failures, entering safe mode");
       changeState(STATE_SAFE_MODE);
     } else {
-      delay(5000);
-      // Retry initialization
+      // Retry initialization after SENSOR_INIT_RETRY_MS
+      sensorInitStarted = false;
+      sensorInitRetryPending = true;
+      sensorInitStart = millis();
     }
   }
 }
 
 void stateNetworkConnect() {
+  #if FIREBASE_RPC_LINK
+  // WiFi, TLS and the Firebase sessions belong to the ESP32-S3
+  Serial.println("\n[STATE] Network Connection (ESP32-S3 co-processor)");
+  Serial.println("ℹ️  The co-processor joins WiFi on its own; uploads start once it reports a cloud session");
+  #else
   // STUB: WiFi library has BSP incompatibility - skip network connection
   Serial.println("\n[STATE] Network Connection (Skipped - WiFi BSP issue)");
   Serial.println("⚠️  WiFi disabled due to Arduino UNO Q BSP incompatibility");
   Serial.println("ℹ️  System will operate in local mode (Serial Monitor only)");
+  #endif
   
   // Skip to Firebase auth (which will also fail gracefully)
   changeState(STATE_FIREBASE_AUTH);
@@ -210,16 +353,20 @@ void stateFirebaseAuth() {
   Serial.println("\n[STATE] Authenticating with Firebase...");
   
   firebase.init();
+  firebase.setUploadCallback(onUploadComplete);
+  firebase.setAlertFallback(saveAlertToLog);
   
   if (firebase.isConnected()) {
     Serial.println("✓ Firebase authentication successful");
     
-    // Sync any buffered offline data
+    // Config changes made while offline, then buffered offline data
+    firebase.fetchConfig();
     syncBufferedData();
     
     changeState(STATE_NORMAL_OPERATION);
   } else {
-    Serial.println("✗ Firebase authentication failed");
+    // Over the co-processor link the session comes up later, in the background
+    Serial.println("✗ No Firebase session yet");
     Serial.println("⚠️ Operating in offline mode");
     changeState(STATE_NORMAL_OPERATION);
   }
@@ -233,75 +380,13 @@ void stateNormalOperation() {
     Serial.println("✓ GreenOS is now running!");
     Serial.println("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━\n");
     blinkStatusLED(1, 1000);  // Long blink = operational
+    scheduler.resetDeadlines();  // Everything runs once on entry
     firstRun = false;
   }
   
-  unsigned long currentMillis = millis();
-  
-  // Read sensors periodically
-  if (currentMillis - lastSensorRead >= SENSOR_READ_INTERVAL) {
-    lastSensorRead = currentMillis;
-    sensors.readAll();
-    
-    // Log to serial for debugging
-    if (Serial) {
-      Serial.println("=== Sensor Readings ===");
-      sensors.printReadings();
-    }
-    
-    // If offline, buffer data locally (WiFi disabled, always buffer)
-    bufferSensorData(sensors.getData());
-  }
-  
-  // Check for anomalies
-  if (currentMillis - lastAnomalyCheck >= ANOMALY_CHECK_INTERVAL) {
-    lastAnomalyCheck = currentMillis;
-    
-    if (anomaly.detectAnomalies(sensors.getData())) {
-      Serial.println("⚠️ ANOMALY DETECTED!");
-      
-      AnomalyType type = anomaly.getAnomalyType();
-      
-      // Check if emergency-level anomaly
-      if (type == TEMP_TOO_LOW || type == TEMP_TOO_HIGH) {
-        changeState(STATE_EMERGENCY);
-        return;
-      }
-      
-      // Handle non-emergency anomalies
-      actuators.handleWarning(type);
-      
-      // Send alert to Firebase if connected
-      if (firebase.isConnected()) {
-        firebase.sendAlert(anomaly.getAnomalyDetails());
-      } else {
-        // Save alert to SD card for later sync
-        saveAlertToSD(anomaly.getAnomalyDetails());
-      }
-    }
-  }
-  
-  // Sync with Firebase periodically (disabled - no WiFi)
-  if (currentMillis - lastFirebaseSync >= FIREBASE_SYNC_INTERVAL) {
-    lastFirebaseSync = currentMillis;
-    // WiFi disabled - skip Firebase sync
-  }
-  
-  // Handle real-time Firebase updates
-  if (firebase.isConnected()) {
-    firebase.handleRealtimeUpdates(actuators);
-  }
-  
-  // Flush SD card buffer periodically
-  if (sdCardAvailable && currentMillis - lastSDFlush >= SD_BUFFER_FLUSH_INTERVAL) {
-    lastSDFlush = currentMillis;
-    flushSDBuffer();
-  }
-  
-  // Sensor health check
-  if (currentMillis - lastHealthCheck >= SENSOR_HEALTH_CHECK_INTERVAL) {
-    lastHealthCheck = currentMillis;
-    checkSensorHealth();
+  // Run every due task, most urgent first; stop if a task changed state
+  while (currentState == STATE_NORMAL_OPERATION && scheduler.runNext()) {
+    feedWatchdog();
   }
 }
 
@@ -309,6 +394,11 @@ void stateSafeMode() {
   static bool firstRun = true;
   
   if (firstRun) {
+    // Safe mode protects the real greenhouse - live sensors and relays
+    if (traceReplayRunning) {
+      finishTraceReplay();
+    }
+    
     Serial.println("\n╔════════════════════════════════════════╗");
     Serial.println("║          SAFE MODE ACTIVATED           ║");
     Serial.println("╚════════════════════════════════════════╝");
@@ -319,8 +409,8 @@ void stateSafeMode() {
     actuators.stopAll();
     
     // Enable critical protection based on current conditions
-    SensorData data = sensors.getData();
-    if (data.airTemp < TEMP_MIN) {
+    const SensorData& data = sensors.getData();
+    if (data.airTemp < configStore.get().tempMin) {
       Serial.println("⚠️ Low temperature detected, enabling emergency heat");
       actuators.setHeater(true, true);
     }
@@ -332,14 +422,14 @@ void stateSafeMode() {
   // In safe mode, still read sensors and maintain critical protection
   unsigned long currentMillis = millis();
   
-  if (currentMillis - lastSensorRead >= SENSOR_READ_INTERVAL * 2) {
+  if (currentMillis - lastSensorRead >= configStore.get().sensorIntervalMs * 2) {
     lastSensorRead = currentMillis;
     sensors.readAll();
     
-    SensorData data = sensors.getData();
+    const SensorData& data = sensors.getData();
     
     // Maintain critical temperature protection
-    if (data.airTemp < TEMP_MIN) {
+    if (data.airTemp < configStore.get().tempMin) {
       actuators.setHeater(true, true);
     } else if (data.airTemp > TEMP_OPTIMAL_MAX) {
       actuators.setHeater(true, false);
@@ -355,39 +445,61 @@ void stateSafeMode() {
 }
 
 void stateEmergency() {
-  Serial.println("\n╔════════════════════════════════════════╗");
-  Serial.println("║       EMERGENCY MODE ACTIVATED         ║");
-  Serial.println("╚════════════════════════════════════════╝");
-  
-  AnomalyType type = anomaly.getAnomalyType();
-  Serial.print("Emergency type: ");
-  Serial.println(type);
-  
-  // Execute emergency protocols (cast to EmergencyType)
-  actuators.handleEmergency((EmergencyType)type);
-  
-  // Send urgent alert
-  if (firebase.isConnected()) {
-    firebase.sendAlert(anomaly.getAnomalyDetails());
+  // Protocol runs once per entry; afterwards the state only times the LED
+  // pattern and hold period while the task table keeps sensing
+  if (emergencyProtocolPending) {
+    emergencyProtocolPending = false;
+    blinkStatusLED(0, 0);  // The emergency flash below owns the LED
+    
+    Serial.println("\n╔════════════════════════════════════════╗");
+    Serial.println("║       EMERGENCY MODE ACTIVATED         ║");
+    Serial.println("╚════════════════════════════════════════╝");
+    
+    AnomalyType type = anomaly.getAnomalyType();
+    Serial.print("Emergency type: ");
+    Serial.println(type);
+    
+    // Execute emergency protocols (the enums do not share ordinals)
+    actuators.handleEmergency(type == TEMP_TOO_LOW ? LOW_TEMP : HIGH_TEMP);
+    
+    // Send urgent alert now (bypasses the alert queue), or keep it for
+    // the next sync
+    char details[ANOMALY_DETAILS_SIZE];
+    size_t length = anomaly.formatDetails(details, sizeof(details));
+    if (!firebase.isConnected() ||
+        !firebase.sendAlert(details, length, AlertQueue::getSeverityName(ALERT_CRITICAL))) {
+      LoggedAlert alert;
+      memset(&alert, 0, sizeof(alert));
+      alert.firstSeen = stateEntryTime;
+      alert.boot = bootId;
+      alert.severity = ALERT_CRITICAL;
+      saveAlertToLog(alert, details, length);
+    }
+    
+    // Activate buzzer if available
+    #ifdef BUZZER_PIN
+    tone(BUZZER_PIN, 1000, 2000);  // 1kHz tone for 2 seconds (non-blocking)
+    #endif
   }
   
-  // Activate buzzer if available
-  #ifdef BUZZER_PIN
-  tone(BUZZER_PIN, 1000, 2000);  // 1kHz tone for 2 seconds
-  #endif
+  unsigned long elapsed = millis() - stateEntryTime;
   
-  // Flash LED rapidly
-  for (int i = 0; i < 10; i++) {
-    digitalWrite(STATUS_LED_PIN, HIGH);
-    delay(100);
+  // Flash LED rapidly (10 × 100 ms on/off)
+  if (elapsed < EMERGENCY_BLINK_MS) {
+    digitalWrite(STATUS_LED_PIN, ((elapsed / 100) % 2 == 0) ? HIGH : LOW);
+  } else {
     digitalWrite(STATUS_LED_PIN, LOW);
-    delay(100);
+  }
+  
+  // Keep reading sensors and checking anomalies during the hold period
+  while (currentState == STATE_EMERGENCY && scheduler.runNext()) {
     feedWatchdog();
   }
   
   // Return to normal operation after emergency actions taken
-  delay(5000);
-  changeState(STATE_NORMAL_OPERATION);
+  if (currentState == STATE_EMERGENCY && elapsed >= EMERGENCY_HOLD_MS) {
+    changeState(STATE_NORMAL_OPERATION);
+  }
 }
 
 void stateCalibrationMode() {
@@ -420,6 +532,328 @@ void stateCalibrationMode() {
   // Stay in calibration mode
 }
 
+// ============================================================================
+// NORMAL OPERATION TASKS
+// ============================================================================
+
+void setupTasks() {
+  const DeviceConfig& config = configStore.get();
+  
+  // On a shared deadline the sensor cycle goes first, so detection and
+  // the control pass both see this cycle's readings
+  taskSensors = scheduler.addTask("sensors", taskReadSensors, config.sensorIntervalMs, TASK_PRIORITY_CRITICAL);
+  #if CLIMATE_CONTROL_ENABLED
+  scheduler.addTask("control", taskClimateControl, CONTROL_PERIOD_MS, TASK_PRIORITY_HIGH);
+  #endif
+  scheduler.addTask("realtime", taskRealtimeUpdates, FIREBASE_REALTIME_POLL_MS, TASK_PRIORITY_NORMAL);
+  taskSync = scheduler.addTask("sync", taskFirebaseSync, config.syncIntervalMs, TASK_PRIORITY_NORMAL);
+  scheduler.addTask("alerts", taskSendAlerts, ALERT_SERVICE_MS, TASK_PRIORITY_NORMAL);
+  scheduler.addTask("netlink", taskMaintainLink, FIREBASE_LINK_SERVICE_MS, TASK_PRIORITY_LOW);
+  taskHealth = scheduler.addTask("health", taskHealthCheck, config.healthIntervalMs, TASK_PRIORITY_NORMAL);
+  taskLogFlush = scheduler.addTask("logflush", taskFlushLog, SD_BUFFER_FLUSH_INTERVAL, TASK_PRIORITY_LOW);
+  
+  // Flushing only makes sense with a mounted log
+  scheduler.setEnabled(taskLogFlush, flashLogAvailable);
+  
+  // PIR triggers pull the next sensor cycle forward when it matters
+  sensors.setMotionCallback(onMotionTrigger);
+  
+  // Replayed traces enter through readAll() like live readings
+  sensors.setReplaySource(&traceReplay);
+  
+  // Microphone chunks busy-wait - not while the link UART is moving data
+  sensors.setCaptureHold(isLinkBusy);
+}
+
+bool isLinkBusy() {
+  return firebase.msUntilNextPoll() <= 1;
+}
+
+void onMotionTrigger() {
+  // Off hours: evaluate now instead of up to a sensor interval later
+  if (anomaly.isOffHours()) {
+    scheduler.runSoon(taskSensors);
+  }
+}
+
+void taskReadSensors() {
+  sensors.readAll();
+  
+  if (traceReplayRunning && !sensors.isReplaying()) {
+    // Trace exhausted - this cycle published nothing new
+    finishTraceReplay();
+    return;
+  }
+  
+  // Log to serial for debugging (at 9600 baud this would pace a replay)
+  if (Serial && !traceReplayRunning) {
+    Serial.println("=== Sensor Readings ===");
+    sensors.printReadings();
+  }
+  
+  // One snapshot per cycle, shared by every consumer below
+  const SensorData& data = sensors.getData();
+  
+  // Streaming detector is O(1) per sample - check every reading
+  checkAnomalies(data);
+  
+  // Replayed readings stop here - they are not telemetry and must not
+  // reach the uplink, the local log or a new trace
+  if (traceReplayRunning) return;
+  
+  // Streaming rollups - closed windows queue for the log/uplink
+  ActuatorUsage usage;
+  actuators.getUsage(usage);
+  rollups.add(data, usage);
+  
+  // If offline, buffer data locally (WiFi disabled, always buffer)
+  bufferSensorData(data);
+  
+  if (traceRecorder.isRecording()) {
+    traceRecorder.add(data);
+    if (!traceRecorder.isRecording()) {
+      Serial.print("⚠️  Trace recording stopped - log share used (");
+      Serial.print(traceRecorder.getRecordCount());
+      Serial.println(" snapshots)");
+    }
+  }
+  
+  saveRetainedState();
+}
+
+void toggleTraceRecording() {
+  if (traceRecorder.isRecording()) {
+    traceRecorder.stop();
+    Serial.print("✓ Trace recording stopped (");
+    Serial.print(traceRecorder.getRecordCount());
+    Serial.print(" snapshots, ");
+    Serial.print(traceRecorder.getDroppedCount());
+    Serial.println(" dropped)");
+    return;
+  }
+  
+  if (traceReplayRunning || !flashLogAvailable || !traceRecorder.start(&flashLog)) {
+    Serial.println("⚠️  Cannot record trace - replay running, no local log, or too little log space beside unsynced data");
+    return;
+  }
+  Serial.println("✓ Trace recording started");
+}
+
+void startTraceReplay() {
+  // Flush a capture in progress so it is part of the replay
+  if (traceRecorder.isRecording()) {
+    toggleTraceRecording();
+  }
+  
+  if (!flashLogAvailable || !traceReplay.startFromLog(&flashLog)) {
+    Serial.println("⚠️  No trace in the local log");
+    return;
+  }
+  traceReplayRunning = true;
+  traceReplayEmergencies = 0;
+  
+  // Controllers run on the replay against a shadow relay mask
+  actuators.setDryRun(true);
+  
+  // Live baselines don't describe the trace (and vice versa on the way back)
+  anomaly.init();
+  lastAlertedAnomalies = 0;
+  
+  unsigned long period = configStore.get().sensorIntervalMs / TRACE_REPLAY_SPEED;
+  scheduler.setPeriod(taskSensors, period > 0 ? period : 1);
+  
+  Serial.print("✓ Trace replay started (");
+  Serial.print(TRACE_REPLAY_SPEED);
+  Serial.println("x) - detection and control in dry run, no uplink or logging");
+}
+
+void finishTraceReplay() {
+  traceReplay.stop();
+  traceReplayRunning = false;
+  
+  // Back to the real relays; control windows restart from live state
+  actuators.setDryRun(false);
+  climate.suspend();
+  
+  anomaly.init();
+  lastAlertedAnomalies = 0;
+  scheduler.setPeriod(taskSensors, configStore.get().sensorIntervalMs);
+  
+  Serial.print("✓ Trace replay stopped after ");
+  Serial.print(traceReplay.getReplayedCount());
+  Serial.print(" readings (");
+  Serial.print(actuators.getShadowSwitches());
+  Serial.print(" dry-run relay changes, ");
+  Serial.print(traceReplayEmergencies);
+  Serial.println(" emergency cycles) - back to live sensors");
+}
+
+void taskClimateControl() {
+  // Emergency protocols own the relays while active
+  if (currentState != STATE_NORMAL_OPERATION) return;
+  
+  // Windows follow the data's clock, so a replay runs them on trace time
+  const SensorData& data = sensors.getData();
+  climate.update(data, traceReplayRunning ? data.timestamp : millis());
+  saveRetainedState();
+}
+
+void restoreRelays() {
+  // Through command() so interlocks still apply; duty and cycle history
+  // start over with this boot
+  ActuatorMask relays = bootState.getRelays();
+  if (relays != 0) {
+    actuators.command(relays, 0);
+    Serial.print("✓ Relays restored: 0x");
+    Serial.println(actuators.getState(), HEX);
+  }
+}
+
+void saveRetainedState() {
+  // A replayed reading must not come back as live data after a reset
+  if (traceReplayRunning) return;
+  bootState.save(actuators.getState(), sensors.getData(), sensors.getPreheatElapsed(), currentState);
+}
+
+void checkAnomalies(const SensorData& data) {
+  ProfileScope scope(PROFILE_ANOMALY);
+  
+  bool detected = anomaly.detectAnomalies(data);
+  AnomalySet anomalies = detected ? anomaly.getAnomalySet() : 0;
+  
+  // Every pass feeds the queue (dedup, hold-down, escalation); an empty
+  // set clears active conditions. Replayed conditions are not alerted.
+  if (!traceReplayRunning) {
+    alerts.update(anomaly, anomalies & ~EMERGENCY_ANOMALIES, millis());
+  }
+  
+  if (!detected) {
+    lastAlertedAnomalies = 0;
+    return;
+  }
+  
+  // Emergency-level anomalies are never held back
+  if (anomalies & EMERGENCY_ANOMALIES) {
+    // A replayed emergency is counted, never acted on
+    if (traceReplayRunning) {
+      traceReplayEmergencies++;
+      return;
+    }
+    
+    // Already holding in emergency - protocol actions are in effect
+    if (currentState != STATE_EMERGENCY) {
+      Serial.println("⚠️ ANOMALY DETECTED!");
+      changeState(STATE_EMERGENCY);
+    }
+    return;
+  }
+  
+  // Persistent condition - act when the set changes, then at most once
+  // per ANOMALY_REALERT_MS (alerts are rate-limited by the queue)
+  if (anomalies == lastAlertedAnomalies && millis() - lastAnomalyAlert < ANOMALY_REALERT_MS) {
+    return;
+  }
+  lastAlertedAnomalies = anomalies;
+  lastAnomalyAlert = millis();
+  
+  Serial.println("⚠️ ANOMALY DETECTED!");
+  
+  #if !CLIMATE_CONTROL_ENABLED
+  // Handle every non-emergency anomaly in one pass (the control loops
+  // regulate these conditions when enabled)
+  actuators.handleWarning(anomalies);
+  #endif
+}
+
+void taskSendAlerts() {
+  const AlertBatch* batch = alerts.takeBatch(millis());
+  if (batch == nullptr) return;
+  
+  // One request for the whole batch; offline it becomes one log record
+  if (!firebase.isConnected() || !firebase.sendAlertBatch(*batch)) {
+    char details[UPLINK_MAX_ALERT_TEXT];
+    size_t length = AlertQueue::formatBatch(*batch, details, sizeof(details));
+    saveAlertToLog(AlertQueue::describeBatch(*batch, bootId), details, length);
+  }
+}
+
+void taskFirebaseSync() {
+  // Batched upload of buffered readings once the cloud session is up
+  if (firebase.isConnected()) {
+    syncBufferedData();
+  }
+}
+
+void onUploadComplete(bool ok) {
+  // Claim an accepted batch (and start the next) without waiting a period
+  if (ok) {
+    scheduler.runSoon(taskSync);
+  }
+}
+
+void taskMaintainLink() {
+  // Reconnects/handshakes happen here only, off the control-task path
+  firebase.maintainConnection();
+}
+
+void taskRealtimeUpdates() {
+  // Parse buffered command-stream bytes (local only - no request traffic).
+  // The stream has its own socket, so this runs even while the REST link
+  // is idle-closed.
+  firebase.handleRealtimeUpdates(actuators);
+}
+
+void taskFlushLog() {
+  ProfileScope scope(PROFILE_LOG_FLUSH);
+  flushOfflineBuffer();
+  flushRollups();
+}
+
+void taskHealthCheck() {
+  checkSensorHealth();
+}
+
+void idleUntilNextDeadline() {
+  unsigned long sleepMs = 10;  // Other states keep the original 10 ms pacing
+  
+  if (currentState == STATE_NORMAL_OPERATION || currentState == STATE_EMERGENCY) {
+    sleepMs = scheduler.msUntilNextDeadline();
+    if (sleepMs > LOOP_MAX_SLEEP_MS) {
+      sleepMs = LOOP_MAX_SLEEP_MS;
+    }
+  }
+  
+  // Wake for the next status LED edge
+  if (statusBlinkSteps > 0) {
+    unsigned long blinkMs = statusBlinkMs - min(millis() - statusBlinkAt, statusBlinkMs);
+    if (blinkMs < sleepMs) {
+      sleepMs = blinkMs;
+    }
+  }
+  
+  // Wake for the next deferred actuator action
+  unsigned long actionMs = actuators.msUntilNextAction();
+  if (actionMs < sleepMs) {
+    sleepMs = actionMs;
+  }
+  
+  // Wake for the next bus character or background ADC scan
+  unsigned long pollMs = sensors.msUntilNextPoll();
+  if (pollMs < sleepMs) {
+    sleepMs = pollMs;
+  }
+  
+  // Keep the co-processor UART serviced while a frame or reply is moving
+  unsigned long linkMs = firebase.msUntilNextPoll();
+  if (linkMs < sleepMs) {
+    sleepMs = linkMs;
+  }
+  
+  if (sleepMs > 0) {
+    delay(sleepMs);
+  }
+}
+
 // ============================================================================
 // WATCHDOG TIMER FUNCTIONS
 // ============================================================================
@@ -451,7 +885,9 @@ void setupWatchdog() {
 void feedWatchdog() {
   #if WDT_ENABLED
   if (watchdogEnabled) {
-    lastWatchdogFeed = millis();
+    unsigned long now = millis();
+    profiler.recordWatchdogGap(now - lastWatchdogFeed);
+    lastWatchdogFeed = now;
   }
   #endif
 }
@@ -466,6 +902,7 @@ void checkWatchdog() {
       Serial.print(timeSinceLastFeed);
       Serial.println(" ms");
       Serial.println("System appears to be hung. Initiating software reset...\n");
+      bootState.noteReset(BOOT_WATCHDOG);
       delay(1000);
       
       // Perform software reset
@@ -476,58 +913,348 @@ void checkWatchdog() {
 }
 
 // ============================================================================
-// SD CARD BUFFERING FUNCTIONS
+// LOCAL LOG BUFFERING FUNCTIONS
 // ============================================================================
 
-void initializeSDCard() {
-  // STUB: SD library not compatible with Zephyr architecture
-  Serial.println("SD card not available (Zephyr incompatibility)");
-  sdCardAvailable = false;
+void initializeLocalLog() {
+  // SD library is not compatible with Zephyr - use internal flash instead
+  flashLogAvailable = flashLog.begin();
+  
+  if (!flashLogAvailable) {
+    Serial.println("⚠️  Local log unavailable - buffering in RAM only");
+    return;
+  }
+  
+  FlashLogStats stats = flashLog.getStats();
+  Serial.print("✓ Local log mounted: ");
+  Serial.print(stats.capacityBytes / 1024);
+  Serial.print(" KB, ");
+  Serial.print(stats.sectorCount);
+  Serial.print(" sectors, ");
+  Serial.print(stats.unsyncedSectors);
+  Serial.println(" sector(s) pending sync");
+  
+  if (!stats.persistent) {
+    Serial.println("ℹ️  No flash partition - log is RAM-emulated (lost on reset)");
+  }
 }
 
-void bufferSensorData(SensorData data) {
-  if (!sdCardAvailable && bufferCount >= MAX_BUFFERED_READINGS) {
-    Serial.println("⚠️ Buffer full, dropping oldest reading");
-    // Shift buffer (drop oldest)
-    for (int i = 0; i < MAX_BUFFERED_READINGS - 1; i++) {
-      offlineBuffer[i] = offlineBuffer[i + 1];
+void assignBootId() {
+  // Persistent log: a counter pinned in it, one step per boot
+  uint32_t previous = 0;
+  if (flashLogAvailable && flashLog.getStats().persistent) {
+    flashLog.getPinnedRecord(LOG_TYPE_BOOT_ID, &previous, sizeof(previous));
+    bootId = previous + 1;
+    if (bootId == 0 || bootId >= 0x80000000UL) bootId = 1;
+    if (!flashLog.setPinnedRecord(LOG_TYPE_BOOT_ID, &bootId, sizeof(bootId))) {
+      Serial.println("✗ Boot id not stored - it may repeat after a reset");
     }
-    bufferCount = MAX_BUFFERED_READINGS - 1;
+  } else {
+    // Nothing survives a reset - a random id (high bit set, never a counter value)
+    randomSeed(micros() ^ ((unsigned long)analogRead(MQ135_SENSOR_PIN) << 16));
+    bootId = 0x80000000UL | (uint32_t)random(0x7FFFFFFFL);
+  }
+  
+  firebase.setBootId(bootId);
+  Serial.print("ℹ️  Boot id ");
+  Serial.println(bootId);
+  
+  // Records from here on are this boot's; unsynced ones before the
+  // marker keep the boot the sync cursor last crossed into
+  if (flashLogAvailable) {
+    flashLog.getPinnedRecord(LOG_TYPE_SYNC_BOOT, &syncBoot, sizeof(syncBoot));
+    flashLog.append(LOG_TYPE_BOOT, (const uint8_t*)&bootId, sizeof(bootId));
+  }
+}
+
+void loadDeviceConfig() {
+  bool stored = configStore.begin(&flashLog);
+  configStore.setChangeCallback(applyDeviceConfig);
+  applyDeviceConfig();
+  
+  if (stored) {
+    Serial.print("✓ Device config loaded (cloud generation ");
+    Serial.print(configStore.getCloudGeneration());
+    Serial.println(")");
+  } else {
+    Serial.println("ℹ️  No stored device config - using compiled defaults");
+  }
+}
+
+// Runs at boot and after every config commit (calibration, cloud delta)
+void applyDeviceConfig() {
+  const DeviceConfig& config = configStore.get();
+  
+  anomaly.setLimits(config.tempMin, config.tempMax, config.humidityMin, config.humidityMax);
+  anomaly.setOffHours(config.offHours != 0);
+  sensors.applyCalibration(config);
+  
+  // Only on a change - setPeriod() restarts the period
+  if (!traceReplayRunning) {
+    applyTaskPeriod(taskSensors, config.sensorIntervalMs);
+  }
+  applyTaskPeriod(taskSync, config.syncIntervalMs);
+  applyTaskPeriod(taskHealth, config.healthIntervalMs);
+}
+
+void applyTaskPeriod(int taskId, unsigned long periodMs) {
+  if (taskId >= 0 && scheduler.getTask(taskId).periodMs != periodMs) {
+    scheduler.setPeriod(taskId, periodMs);
+  }
+}
+
+void bufferSensorData(const SensorData& data) {
+  // An empty ring starts a fresh delta chain anchored at this reading
+  if (offlineBuffer.isEmpty()) {
+    offlineCodec.reset();
+    offlineTailTimestamp = data.timestamp;
   }
   
-  if (bufferCount < MAX_BUFFERED_READINGS) {
-    offlineBuffer[bufferCount].timestamp = data.timestamp;
-    offlineBuffer[bufferCount].airTemp = data.airTemp;
-    offlineBuffer[bufferCount].airHumidity = data.airHumidity;
-    offlineBuffer[bufferCount].co2 = data.co2;
-    offlineBuffer[bufferCount].ph = data.ph;
-    offlineBuffer[bufferCount].ec = data.ec;
-    offlineBuffer[bufferCount].vwc = data.vwc;
-    bufferCount++;
+  // O(1) push - overwrites the oldest reading once the ring is full
+  if (!offlineBuffer.push(offlineCodec.pack(data))) {
+    // New oldest entry's delta is relative to the one just dropped
+    offlineTailTimestamp += RecordCodec::deltaMillis(offlineBuffer.at(0));
+    
+    if (offlineBuffer.getOverwritten() == 1) {
+      Serial.println("⚠️ Buffer full, dropping oldest readings");
+    }
   }
 }
 
-void flushSDBuffer() {
-  // STUB: SD card not available on Zephyr
-  if (bufferCount == 0) return;
+void consumeOfflineReadings(size_t count) {
+  // Re-anchor the tail timestamp on the first entry that remains
+  if (count < offlineBuffer.size()) {
+    for (size_t i = 1; i <= count; i++) {
+      offlineTailTimestamp += RecordCodec::deltaMillis(offlineBuffer.at(i));
+    }
+  }
+  offlineBuffer.consume(count);
+}
+
+void flushOfflineBuffer() {
+  if (offlineBuffer.isEmpty()) return;
+  
+  if (!flashLogAvailable) {
+    // Keep readings in RAM - the ring overwrites the oldest when full
+    Serial.print("⚠️  Cannot flush ");
+    Serial.print(offlineBuffer.size());
+    Serial.println(" readings - local log not available");
+    return;
+  }
   
-  Serial.print("⚠️  Cannot flush ");
-  Serial.print(bufferCount);
-  Serial.println(" readings - SD card not available");
+  // Readings per log record (header + packed run must fit one record,
+  // and one record must fit one uplink batch)
+  size_t maxRecords = (flashLog.maxPayloadSize() - sizeof(PackedBlockHeader)) / sizeof(PackedReading);
+  if (maxRecords > UPLINK_MAX_BATCH) maxRecords = UPLINK_MAX_BATCH;
   
-  // Clear buffer to prevent overflow
-  bufferCount = 0;
+  // Drain straight from ring storage - each chunk becomes one packed block,
+  // appended as header + span without an intermediate copy
+  RingSpan<PackedReading> span = offlineBuffer.peekContiguous(maxRecords);
+  while (span.length > 0) {
+    PackedBlockHeader header = RecordCodec::blockHeader(span.length, offlineTailTimestamp);
+    
+    if (!flashLog.append(LOG_TYPE_READINGS,
+                         (const uint8_t*)&header, sizeof(header),
+                         (const uint8_t*)span.data, span.length * sizeof(PackedReading))) {
+      Serial.println("✗ Local log write failed - keeping readings in RAM");
+      return;
+    }
+    
+    consumeOfflineReadings(span.length);
+    span = offlineBuffer.peekContiguous(maxRecords);
+  }
+}
+
+void flushRollups() {
+  // Without a log, completed windows wait in the rollup ring for syncOfflineBuffer()
+  if (!flashLogAvailable) return;
+  
+  while (rollups.getPendingCount() > 0) {
+    const PackedRollup& rollup = rollups.getPending(0);
+    if (!flashLog.append(LOG_TYPE_ROLLUP, (const uint8_t*)&rollup, sizeof(PackedRollup))) {
+      Serial.println("✗ Local log write failed - keeping rollups in RAM");
+      return;
+    }
+    rollups.consumePending(1);
+  }
 }
 
 void syncBufferedData() {
-  // STUB: SD card not available on Zephyr
-  Serial.println("⚠️  Cannot sync buffered data - SD card not available");
+  ProfileScope scope(PROFILE_SYNC);
+  
+  if (!firebase.isConnected()) {
+    if (!offlineBuffer.isEmpty() || rollups.getPendingCount() > 0 ||
+        (flashLogAvailable && flashLog.hasUnsynced())) {
+      Serial.println("⚠️  Cannot sync buffered data - Firebase not connected");
+    }
+    return;
+  }
+  
+  if (flashLogAvailable) {
+    // Hand RAM readings to the log first so one cursor covers everything
+    flushOfflineBuffer();
+    flushRollups();
+    syncLoggedData();
+  } else {
+    syncOfflineBuffer();
+  }
+}
+
+void syncLoggedData() {
+  // One log record's worth of readings (see flushOfflineBuffer())
+  static uint32_t scratch[(sizeof(PackedBlockHeader) + UPLINK_MAX_BATCH * sizeof(PackedReading) + 3) / 4];
+  uint8_t* record = (uint8_t*)scratch;
+  
+  FlashLogCursor cursor = flashLog.getSyncCursor();
+  FlashLogCursor uploaded = cursor;  // Everything before this is in the batch
+  uint8_t type;
+  size_t length;
+  bool alertPending = false;            // Sent, confirmation not back yet
+  bool oversize = false;                // Stopped before a record that doesn't fit
+  
+  firebase.beginBatch();
+  firebase.setBatchBoot(syncBoot);
+  
+  FlashLogReadResult result;
+  while ((result = flashLog.readNext(cursor, type, record, sizeof(scratch), length)) != FLASH_LOG_READ_END) {
+    if (result == FLASH_LOG_READ_OVERSIZE) {
+      // Never skipped: the cursor stays before it until a build that can
+      // hold it uploads it
+      Serial.print("⚠️  Logged record too large to sync (");
+      Serial.print((unsigned long)length);
+      Serial.println(" bytes) - sync stopped before it");
+      oversize = true;
+      break;
+    }
+    
+    if (type == LOG_TYPE_BOOT) {
+      // One boot per batch - the server maps each boot's millis() on its own
+      if (firebase.getBatchCount() > 0 || firebase.getBatchRollupCount() > 0) break;
+      
+      // Nothing unsynced before the marker, so the pinned id can move
+      // first: a reset in between only reads the same marker again
+      uint32_t next = 0;
+      if (length == sizeof(next)) memcpy(&next, record, sizeof(next));
+      if (next != syncBoot) {
+        syncBoot = next;
+        flashLog.setPinnedRecord(LOG_TYPE_SYNC_BOOT, &syncBoot, sizeof(syncBoot));
+      }
+      firebase.setBatchBoot(syncBoot);
+      uploaded = cursor;
+      continue;
+    }
+    
+    if (type == LOG_TYPE_ALERT) {
+      // Keep log order: upload pending readings before the alert
+      if (firebase.getBatchCount() > 0 || firebase.getBatchRollupCount() > 0) break;
+      
+      // Text is sent straight from the record (after its header)
+      LoggedAlert alert;
+      if (length < sizeof(alert)) {
+        uploaded = cursor;  // Malformed - skip it
+        continue;
+      }
+      memcpy(&alert, record, sizeof(alert));
+      if (!firebase.sendLoggedAlert(alert, (const char*)record + sizeof(alert), length - sizeof(alert))) {
+        alertPending = true;
+        break;
+      }
+      
+      uploaded = cursor;
+      continue;
+    }
+    
+    if (type == LOG_TYPE_ROLLUP) {
+      const PackedRollup* rollup = (const PackedRollup*)record;
+      if (length != sizeof(PackedRollup) || rollup->version != ROLLUP_VERSION) {
+        uploaded = cursor;  // Not this layout - skip it
+        continue;
+      }
+      if (!firebase.addRollupToBatch(*rollup)) {
+        break;  // Batch full
+      }
+      uploaded = cursor;
+      continue;
+    }
+    
+    PackedBlockHeader header;
+    if (type != LOG_TYPE_READINGS || RecordCodec::readBlockHeader(record, length, header) == 0) {
+      uploaded = cursor;  // Unknown or malformed - skip it
+      continue;
+    }
+    
+    if (!firebase.addToBatch(header, (const PackedReading*)(record + sizeof(header)))) {
+      break;  // Batch full - this block goes in the next one
+    }
+    uploaded = cursor;
+  }
+  
+  if (!firebase.sendBatch()) {
+    // Over the co-processor link the first call only starts the upload
+    if (!firebase.isUploadPending()) {
+      Serial.println("⚠️  Batch upload failed - will retry");
+    }
+    return;
+  }
+  
+  // Advance only past what the server acknowledged
+  FlashLogCursor previous = flashLog.getSyncCursor();
+  if (uploaded.sequence != previous.sequence || uploaded.offset != previous.offset) {
+    flashLog.commitSyncCursor(uploaded);
+  }
+  
+  // Backlog: next batch now rather than a sync period later (a pending
+  // alert's confirmation schedules it through onUploadComplete(); an
+  // oversize record only retries each sync period)
+  if (!alertPending && !oversize && flashLog.hasUnsynced()) {
+    scheduler.runSoon(taskSync);
+  }
+}
+
+void syncOfflineBuffer() {
+  // No log - upload straight from the RAM rings
+  if (offlineBuffer.isEmpty() && rollups.getPendingCount() == 0) return;
+  
+  // Capacity is capped at an outstanding upload's size, so the span matches it
+  RingSpan<PackedReading> span = offlineBuffer.peekContiguous(firebase.getBatchCapacity());
+  PackedBlockHeader header = RecordCodec::blockHeader(span.length, offlineTailTimestamp);
+  
+  firebase.beginBatch();
+  firebase.addToBatch(header, span.data);
+  
+  size_t rollupsAdded = 0;
+  while (rollupsAdded < rollups.getPendingCount() &&
+         firebase.addRollupToBatch(rollups.getPending(rollupsAdded))) {
+    rollupsAdded++;
+  }
+  
+  if (firebase.sendBatch()) {
+    consumeOfflineReadings(span.length);
+    rollups.consumePending(rollupsAdded);
+    if (!offlineBuffer.isEmpty() || rollups.getPendingCount() > 0) {
+      scheduler.runSoon(taskSync);
+    }
+  } else if (!firebase.isUploadPending()) {
+    Serial.println("⚠️  Batch upload failed - will retry");
+  }
 }
 
-void saveAlertToSD(String alertDetails) {
-  // STUB: SD card not available - log to Serial only
-  Serial.print("🚨 ALERT (Serial only): ");
-  Serial.println(alertDetails);
+void saveAlertToLog(const LoggedAlert& alert, const char* alertDetails, size_t length) {
+  Serial.print("🚨 ALERT: ");
+  Serial.write((const uint8_t*)alertDetails, length);
+  Serial.println();
+  
+  if (!flashLogAvailable) return;
+  
+  // Record: LoggedAlert + alert text (no terminator)
+  if (length > flashLog.maxPayloadSize() - sizeof(alert)) {
+    length = flashLog.maxPayloadSize() - sizeof(alert);
+  }
+  
+  if (!flashLog.append(LOG_TYPE_ALERT, (const uint8_t*)&alert, sizeof(alert),
+                       (const uint8_t*)alertDetails, length)) {
+    Serial.println("✗ Local log write failed - alert kept on Serial only");
+  }
 }
 
 // ============================================================================
@@ -539,19 +1266,37 @@ void changeState(SystemState newState) {
   currentState = newState;
   stateEntryTime = millis();
   
+  if (newState == STATE_EMERGENCY) {
+    emergencyProtocolPending = true;
+  }
+  
+  // Control loops re-assert their relays when normal operation resumes
+  if (previousState == STATE_NORMAL_OPERATION && newState != STATE_NORMAL_OPERATION) {
+    climate.suspend();
+  }
+  
   Serial.print("\n>>> STATE CHANGE: ");
   Serial.print(previousState);
   Serial.print(" → ");
   Serial.println(newState);
 }
 
+// Starts count on/off blinks of delayMs each; loop() plays them out, so
+// the caller (and a warm boot) carries on immediately
 void blinkStatusLED(int count, int delayMs) {
-  for (int i = 0; i < count; i++) {
-    digitalWrite(STATUS_LED_PIN, HIGH);
-    delay(delayMs);
-    digitalWrite(STATUS_LED_PIN, LOW);
-    delay(delayMs);
-  }
+  statusBlinkSteps = count * 2;
+  statusBlinkMs = delayMs;
+  statusBlinkAt = millis();
+  digitalWrite(STATUS_LED_PIN, count > 0 ? HIGH : LOW);
+}
+
+void updateStatusLED() {
+  if (statusBlinkSteps == 0 || millis() - statusBlinkAt < statusBlinkMs) return;
+  
+  statusBlinkAt = millis();
+  statusBlinkSteps--;
+  // Even steps left = start of an "on" half-period
+  digitalWrite(STATUS_LED_PIN, (statusBlinkSteps > 0 && statusBlinkSteps % 2 == 0) ? HIGH : LOW);
 }
 
 void periodicMemoryCheck() {
@@ -594,6 +1339,18 @@ void checkSensorHealth() {
   }
 }
 
+void printLatency(const char* label, const LatencySummary& latency) {
+  Serial.print(label);
+  Serial.print(latency.count);
+  Serial.print(" reads, p50 ");
+  Serial.print(latency.p50Micros);
+  Serial.print(" us, p99 ");
+  Serial.print(latency.p99Micros);
+  Serial.print(" us, max ");
+  Serial.print(latency.maxMicros);
+  Serial.println(" us");
+}
+
 void handleSerialCommands() {
   if (Serial.available()) {
     char cmd = Serial.read();
@@ -613,12 +1370,16 @@ void handleSerialCommands() {
       case 'h':
       case 'H': {
         SensorHealthReport health = sensors.getHealthReport();
-        Serial.println("\n=== Sensor Health Report ===");
+        Serial.println("\n=== Sensor Health Report (errors: last 10 min) ===");
         Serial.print("SCD-30:  ");
         Serial.print(health.scd30Valid ? "OK" : "FAIL");
         Serial.print(" (Error: ");
         Serial.print(health.scd30ErrorRate, 1);
-        Serial.println("%)");
+        Serial.print("%, Samples: ");
+        Serial.print(health.scd30Samples);
+        Serial.print(", Not ready: ");
+        Serial.print(health.scd30NotReady);
+        Serial.println(")");
         Serial.print("MQ135:   ");
         Serial.print(health.mq135Valid ? "OK" : "FAIL");
         Serial.print(" (Error: ");
@@ -630,14 +1391,90 @@ void handleSerialCommands() {
         Serial.print(health.modbusValid ? "OK" : "FAIL");
         Serial.print(" (Error: ");
         Serial.print(health.modbusErrorRate, 1);
-        Serial.println("%)");
+        Serial.print("%, Probes: ");
+        Serial.print(health.soilProbesValid);
+        Serial.print("/");
+        Serial.print(health.soilProbeCount);
+        Serial.print(", Sweep: ");
+        Serial.print(health.modbusSweepMicros / 1000);
+        Serial.print(" ms, Max: ");
+        Serial.print(health.modbusMaxSweepMicros / 1000);
+        Serial.println(" ms)");
+        printLatency("  SCD-30 read: ", health.scd30Latency);
+        printLatency("  MQ135 read:  ", health.mq135Latency);
+        printLatency("  Modbus txn:  ", health.modbusLatency);
+        if (flashLogAvailable) {
+          FlashLogStats log = flashLog.getStats();
+          Serial.print("Log:     ");
+          Serial.print(log.persistent ? "Flash" : "RAM");
+          Serial.print(" (Pending: ");
+          Serial.print(log.unsyncedSectors);
+          Serial.print("/");
+          Serial.print(log.sectorCount);
+          Serial.print(" sectors, Dropped: ");
+          Serial.print(log.sectorsDropped);
+          Serial.print(", Corrupt: ");
+          Serial.print(log.corruptRecords);
+          Serial.println(")");
+        }
         Serial.println();
         break;
       }
         
+      case 't':
+      case 'T':
+        scheduler.printStatus();
+        break;
+        
+      case 'p':
+      case 'P':
+        profiler.printLine(WDT_TIMEOUT_SECONDS * 1000UL);
+        break;
+        
+      case 'z':
+      case 'Z':
+        profiler.reset();
+        Serial.println("✓ Profiler statistics cleared");
+        break;
+        
+      case 'l':
+      case 'L':
+        climate.printStatus();
+        break;
+        
+      case 'q':
+      case 'Q':
+        alerts.printStatus();
+        break;
+        
+      case 'k':
+      case 'K':
+        configStore.printStatus();
+        break;
+        
+      case 'n':
+      case 'N':
+        firebase.printLinkStatus();
+        break;
+        
+      case 'w':
+      case 'W':
+        toggleTraceRecording();
+        break;
+        
+      case 'y':
+      case 'Y':
+        if (traceReplayRunning) {
+          finishTraceReplay();
+        } else {
+          startTraceReplay();
+        }
+        break;
+        
       case 'r':
       case 'R':
         Serial.println("Resetting system...");
+        bootState.noteReset(BOOT_SOFTWARE);
         NVIC_SystemReset();
         break;
     }
@@ -0,0 +1,271 @@
+/**
+ * GreenOS - Non-blocking Modbus RTU Master Implementation
+ *
+ * Implements function 0x03 (Read Holding Registers) directly on the
+ * RS485 UART so transactions can be spread across many loop() passes:
+ * - TRANSMIT:    wait for 3.5 char bus silence, drive DE/RE high, send
+ *                the request, release the bus once the last stop bit is out
+ * - AWAIT_FRAME: collect response bytes until the expected length arrives,
+ *                the bus goes quiet for 3.5 chars, or the timeout expires
+ * - PARSE:       validate slave ID, function, byte count and CRC16
+ *
+ * Timing follows the Modbus over Serial Line spec: above 19200 baud the
+ * inter-frame gap is fixed at 1.75 ms.
+ */
+
+#include "modbus_rtu.h"
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+ModbusRTU::ModbusRTU() {
+  port = nullptr;
+  deRePin = -1;
+  charMicros = 0;
+  frameGapMicros = 0;
+
+  state = MODBUS_IDLE;
+  slaveId = 0;
+  registerCount = 0;
+  callback = nullptr;
+  context = nullptr;
+
+  txLength = 0;
+  txStarted = false;
+  txStartMicros = 0;
+  rxLength = 0;
+
+  lastBusActivityMicros = 0;
+  awaitStartMillis = 0;
+  transactionStartMicros = 0;
+  lastTransactionMicros = 0;
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+void ModbusRTU::begin(Stream& serialPort, unsigned long baudRate, int directionPin) {
+  port = &serialPort;
+  deRePin = directionPin;
+
+  // 1 start + 8 data + 1 parity/stop + 1 stop = 11 bits per character
+  charMicros = (11UL * 1000000UL) / baudRate;
+  frameGapMicros = (baudRate > 19200) ? 1750UL : (charMicros * 7) / 2;
+
+  pinMode(deRePin, OUTPUT);
+  digitalWrite(deRePin, LOW);  // Receive mode by default
+
+  state = MODBUS_IDLE;
+  lastBusActivityMicros = micros();
+}
+
+// ============================================================================
+// REQUEST
+// ============================================================================
+
+bool ModbusRTU::requestHoldingRegisters(uint8_t slave, uint16_t startRegister, uint8_t count,
+                                        ModbusCompletionCallback cb, void* ctx) {
+  if (port == nullptr || state != MODBUS_IDLE) {
+    return false;
+  }
+  if (count == 0 || count > MODBUS_MAX_REGISTERS) {
+    return false;
+  }
+
+  slaveId = slave;
+  registerCount = count;
+  callback = cb;
+  context = ctx;
+
+  // Build request: [slave][0x03][start hi][start lo][count hi][count lo][crc lo][crc hi]
+  txFrame[0] = slave;
+  txFrame[1] = MODBUS_FUNC_READ_HOLDING;
+  txFrame[2] = highByte(startRegister);
+  txFrame[3] = lowByte(startRegister);
+  txFrame[4] = 0;
+  txFrame[5] = count;
+  uint16_t crc = calculateCRC16(txFrame, 6);
+  txFrame[6] = lowByte(crc);
+  txFrame[7] = highByte(crc);
+  txLength = 8;
+
+  txStarted = false;
+  rxLength = 0;
+  transactionStartMicros = micros();
+  state = MODBUS_TRANSMIT;
+  return true;
+}
+
+// ============================================================================
+// STATE MACHINE
+// ============================================================================
+
+void ModbusRTU::poll() {
+  if (port == nullptr) return;
+
+  unsigned long now = micros();
+
+  switch (state) {
+    case MODBUS_IDLE:
+      // Discard stray bytes (late responses, line noise) but remember that
+      // the bus was busy so the next request still honours the frame gap
+      while (port->available()) {
+        port->read();
+        lastBusActivityMicros = now;
+      }
+      break;
+
+    case MODBUS_TRANSMIT:
+      pollTransmit(now);
+      break;
+
+    case MODBUS_AWAIT_FRAME:
+      pollAwaitFrame(now);
+      break;
+
+    case MODBUS_PARSE:
+      complete(parseFrame());
+      break;
+  }
+}
+
+void ModbusRTU::pollTransmit(unsigned long now) {
+  if (!txStarted) {
+    // Enforce 3.5 character silence before the next frame
+    if (now - lastBusActivityMicros < frameGapMicros) return;
+
+    while (port->available()) port->read();  // Flush stale input
+
+    digitalWrite(deRePin, HIGH);  // Transmit mode
+    port->write(txFrame, txLength);
+    txStartMicros = now;
+    txStarted = true;
+    return;
+  }
+
+  // Hold DE/RE until the last character (plus one char of margin) has left
+  // the shift register, without blocking on Serial.flush()
+  if (now - txStartMicros < (unsigned long)(txLength + 1) * charMicros) return;
+
+  digitalWrite(deRePin, LOW);  // Receive mode
+  lastBusActivityMicros = now;
+  awaitStartMillis = millis();
+  state = MODBUS_AWAIT_FRAME;
+}
+
+void ModbusRTU::pollAwaitFrame(unsigned long now) {
+  while (port->available() && rxLength < sizeof(rxFrame)) {
+    rxFrame[rxLength++] = port->read();
+    lastBusActivityMicros = now;
+  }
+
+  if (frameComplete()) {
+    state = MODBUS_PARSE;
+  } else if (rxLength > 0 && now - lastBusActivityMicros >= frameGapMicros) {
+    state = MODBUS_PARSE;  // Bus went quiet mid-frame - parse what we have
+  } else if (rxLength == 0 && millis() - awaitStartMillis >= MODBUS_RESPONSE_TIMEOUT_MS) {
+    complete(MODBUS_RESPONSE_TIMED_OUT);
+    return;
+  } else {
+    return;
+  }
+
+  // Parse in the same pass so results are not delayed by a loop() iteration
+  complete(parseFrame());
+}
+
+bool ModbusRTU::frameComplete() {
+  if (rxLength < 2) return false;
+
+  // Exception response: [slave][func | 0x80][code][crc lo][crc hi]
+  if (rxFrame[1] & 0x80) return rxLength >= 5;
+
+  return rxLength >= 5 + 2 * registerCount;
+}
+
+uint8_t ModbusRTU::parseFrame() {
+  if (rxLength < 5) {
+    return MODBUS_RESPONSE_TIMED_OUT;  // Truncated frame
+  }
+
+  if (rxFrame[0] != slaveId) {
+    return MODBUS_INVALID_SLAVE_ID;
+  }
+
+  uint16_t crc = calculateCRC16(rxFrame, rxLength - 2);
+  if (rxFrame[rxLength - 2] != lowByte(crc) || rxFrame[rxLength - 1] != highByte(crc)) {
+    return MODBUS_INVALID_CRC;
+  }
+
+  if (rxFrame[1] == (MODBUS_FUNC_READ_HOLDING | 0x80)) {
+    return rxFrame[2];  // Slave exception code
+  }
+
+  if (rxFrame[1] != MODBUS_FUNC_READ_HOLDING) {
+    return MODBUS_INVALID_FUNCTION;
+  }
+
+  if (rxFrame[2] != 2 * registerCount || rxLength != 5 + 2 * registerCount) {
+    return MODBUS_INVALID_CRC;  // Length mismatch - treat as corrupt datagram
+  }
+
+  for (uint8_t i = 0; i < registerCount; i++) {
+    registers[i] = word(rxFrame[3 + 2 * i], rxFrame[4 + 2 * i]);
+  }
+  return MODBUS_SUCCESS;
+}
+
+void ModbusRTU::complete(uint8_t result) {
+  ModbusCompletionCallback cb = callback;
+  void* ctx = context;
+
+  lastTransactionMicros = micros() - transactionStartMicros;
+  lastBusActivityMicros = micros();
+  callback = nullptr;
+  context = nullptr;
+
+  // Go idle before the callback so it can immediately queue the next request
+  state = MODBUS_IDLE;
+
+  if (cb != nullptr) {
+    cb(slaveId, result, registers, registerCount, ctx);
+  }
+}
+
+// ============================================================================
+// STATUS
+// ============================================================================
+
+bool ModbusRTU::isIdle() {
+  return state == MODBUS_IDLE;
+}
+
+ModbusState ModbusRTU::getState() {
+  return state;
+}
+
+unsigned long ModbusRTU::getFrameGapMicros() {
+  return frameGapMicros;
+}
+
+unsigned long ModbusRTU::getLastTransactionMicros() {
+  return lastTransactionMicros;
+}
+
+// ============================================================================
+// UTILITY FUNCTIONS
+// ============================================================================
+
+// CRC16 (Modbus polynomial 0xA001, init 0xFFFF), transmitted low byte first
+uint16_t ModbusRTU::calculateCRC16(const uint8_t* data, size_t length) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < length; i++) {
+    crc ^= data[i];
+    for (int j = 0; j < 8; j++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : (crc >> 1);
+    }
+  }
+  return crc;
+}
@@ -0,0 +1,115 @@
+/**
+ * GreenOS - Non-blocking Modbus RTU Master
+ *
+ * Asynchronous request/response engine for the RS485 soil sensor bus.
+ * Replaces the blocking ModbusMaster::readHoldingRegisters() call so a
+ * slow or missing slave never stalls the main loop() FSM.
+ *
+ * Transaction flow (advanced by poll() from loop()):
+ *   IDLE → TRANSMIT → AWAIT_FRAME → PARSE → IDLE (completion callback)
+ */
+
+#ifndef MODBUS_RTU_H
+#define MODBUS_RTU_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+#ifndef MODBUS_RESPONSE_TIMEOUT_MS
+#define MODBUS_RESPONSE_TIMEOUT_MS 200   // Max wait for first/next response byte
+#endif
+
+#define MODBUS_MAX_REGISTERS 16          // Largest register block per request
+#define MODBUS_FUNC_READ_HOLDING 0x03
+
+// ============================================================================
+// RESULT CODES (same values as ModbusMaster for drop-in compatibility)
+// ============================================================================
+
+#define MODBUS_SUCCESS            0x00
+#define MODBUS_INVALID_SLAVE_ID   0xE0
+#define MODBUS_INVALID_FUNCTION   0xE1
+#define MODBUS_RESPONSE_TIMED_OUT 0xE2
+#define MODBUS_INVALID_CRC        0xE3
+// Exception responses from the slave are reported with their own code (0x01-0x0B)
+
+// ============================================================================
+// TRANSACTION STATE
+// ============================================================================
+
+enum ModbusState {
+  MODBUS_IDLE,
+  MODBUS_TRANSMIT,
+  MODBUS_AWAIT_FRAME,
+  MODBUS_PARSE
+};
+
+// Called once per transaction from poll(). registers is only valid for the
+// duration of the call and only when result == MODBUS_SUCCESS.
+typedef void (*ModbusCompletionCallback)(uint8_t slaveId, uint8_t result,
+                                         const uint16_t* registers, uint8_t count,
+                                         void* context);
+
+// ============================================================================
+// MODBUS RTU CLASS
+// ============================================================================
+
+class ModbusRTU {
+public:
+  ModbusRTU();
+  void begin(Stream& port, unsigned long baudRate, int deRePin);
+
+  // Queue a Read Holding Registers (0x03) request. Returns false if a
+  // transaction is already in flight or the request is invalid.
+  bool requestHoldingRegisters(uint8_t slaveId, uint16_t startRegister, uint8_t count,
+                               ModbusCompletionCallback callback, void* context);
+
+  // Advance the state machine - never blocks
+  void poll();
+
+  // Status
+  bool isIdle();
+  ModbusState getState();
+  unsigned long getFrameGapMicros();
+  unsigned long getLastTransactionMicros();
+
+  // CRC16 (Modbus polynomial 0xA001, init 0xFFFF), sent low byte first
+  static uint16_t calculateCRC16(const uint8_t* data, size_t length);
+
+private:
+  Stream* port;
+  int deRePin;
+  unsigned long charMicros;       // Time on the wire for one 11-bit character
+  unsigned long frameGapMicros;   // 3.5 character inter-frame silence
+
+  ModbusState state;
+  uint8_t slaveId;
+  uint8_t registerCount;
+  ModbusCompletionCallback callback;
+  void* context;
+
+  uint8_t txFrame[8];
+  uint8_t txLength;
+  bool txStarted;
+  unsigned long txStartMicros;
+
+  uint8_t rxFrame[5 + 2 * MODBUS_MAX_REGISTERS];
+  uint8_t rxLength;
+  uint16_t registers[MODBUS_MAX_REGISTERS];
+
+  unsigned long lastBusActivityMicros;
+  unsigned long awaitStartMillis;
+  unsigned long transactionStartMicros;
+  unsigned long lastTransactionMicros;
+
+  void pollTransmit(unsigned long nowMicros);
+  void pollAwaitFrame(unsigned long nowMicros);
+  bool frameComplete();
+  uint8_t parseFrame();
+  void complete(uint8_t result);
+};
+
+#endif // MODBUS_RTU_H
@@ -0,0 +1,209 @@
+/**
+ * GreenOS - Multi-drop Modbus Polling Scheduler Implementation
+ *
+ * Sweep flow:
+ * - startSweep() resets the cursor and dispatches the first eligible slave
+ * - Each completion updates that slave's SensorHealth and immediately
+ *   dispatches the next eligible slave from inside the callback
+ * - Slaves over MAX_SENSOR_ERRORS consecutive errors back off 1, 2, 4 ...
+ *   MODBUS_MAX_BACKOFF_SWEEPS sweeps; one good reply clears the backoff
+ * - Sweep duration (first request to last response) is measured so the
+ *   bus budget can be checked against SENSOR_READ_INTERVAL
+ */
+
+#include "modbus_scheduler.h"
+#include "config.h"
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+ModbusScheduler::ModbusScheduler() {
+  bus = nullptr;
+  startRegister = 0;
+  registerCount = 0;
+  handler = nullptr;
+  context = nullptr;
+  slaveCount = 0;
+  cursor = 0;
+  sweepStartMicros = 0;
+  requestStartMicros = 0;
+
+  stats.sweepCount = 0;
+  stats.polled = 0;
+  stats.skipped = 0;
+  stats.lastSweepMicros = 0;
+  stats.maxSweepMicros = 0;
+  stats.lastTransactionMicros = 0;
+  stats.inProgress = false;
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+
+void ModbusScheduler::begin(ModbusRTU* rtu, uint16_t firstRegister, uint8_t count,
+                            ModbusSlaveHandler slaveHandler, void* ctx) {
+  bus = rtu;
+  startRegister = firstRegister;
+  registerCount = count;
+  handler = slaveHandler;
+  context = ctx;
+}
+
+bool ModbusScheduler::addSlave(uint8_t slaveId) {
+  if (slaveCount >= MODBUS_MAX_SLAVES) {
+    return false;
+  }
+
+  ModbusSlave& slave = slaves[slaveCount++];
+  slave.id = slaveId;
+  slave.health = {true, 0, 0.0f, 0, 0, 0, 0};
+  slave.backoffSweeps = 0;
+  slave.nextSweep = 0;
+  return true;
+}
+
+// ============================================================================
+// SWEEP CONTROL
+// ============================================================================
+
+bool ModbusScheduler::startSweep() {
+  if (bus == nullptr || stats.inProgress || slaveCount == 0) {
+    return false;
+  }
+
+  cursor = 0;
+  stats.polled = 0;
+  stats.skipped = 0;
+  stats.inProgress = true;
+  sweepStartMicros = micros();
+
+  dispatchNext();
+  return true;
+}
+
+void ModbusScheduler::dispatchNext() {
+  while (cursor < slaveCount) {
+    uint8_t index = cursor;
+    ModbusSlave& slave = slaves[index];
+
+    // Skip slaves still serving a backoff period
+    if (stats.sweepCount < slave.nextSweep) {
+      stats.skipped++;
+      cursor++;
+      continue;
+    }
+
+    slave.health.totalReads++;
+    requestStartMicros = micros();
+    if (bus->requestHoldingRegisters(slave.id, startRegister, registerCount,
+                                     onResponse, this)) {
+      stats.polled++;
+      return;  // Cursor advances when the response arrives
+    }
+
+    // Bus refused the request (should not happen while we own it)
+    updateHealth(slave, false);
+    cursor++;
+  }
+
+  finishSweep();
+}
+
+void ModbusScheduler::finishSweep() {
+  stats.lastSweepMicros = micros() - sweepStartMicros;
+  if (stats.lastSweepMicros > stats.maxSweepMicros) {
+    stats.maxSweepMicros = stats.lastSweepMicros;
+  }
+  stats.sweepCount++;
+  stats.inProgress = false;
+}
+
+// ============================================================================
+// RESPONSE HANDLING
+// ============================================================================
+
+void ModbusScheduler::onResponse(uint8_t slaveId, uint8_t result,
+                                 const uint16_t* registers, uint8_t count,
+                                 void* ctx) {
+  static_cast<ModbusScheduler*>(ctx)->handleResponse(result, registers, count);
+}
+
+void ModbusScheduler::handleResponse(uint8_t result, const uint16_t* registers, uint8_t count) {
+  uint8_t index = cursor;
+  ModbusSlave& slave = slaves[index];
+  stats.lastTransactionMicros = micros() - requestStartMicros;
+
+  // ModbusRTU only completes with registers from a frame addressed by
+  // slave.id - anything else is already MODBUS_INVALID_SLAVE_ID
+  bool accepted = false;
+  if (handler != nullptr) {
+    accepted = handler(index, result, registers, count, context);
+  }
+  updateHealth(slave, accepted);
+
+  cursor++;
+  dispatchNext();  // Next frame goes out after the 3.5 char gap
+}
+
+void ModbusScheduler::updateHealth(ModbusSlave& slave, bool accepted) {
+  if (accepted) {
+    slave.health.lastValidRead = millis();
+    slave.health.consecutiveErrors = 0;
+    slave.health.isValid = true;
+    slave.backoffSweeps = 0;
+    slave.nextSweep = 0;
+    return;
+  }
+
+  slave.health.totalErrors++;
+  if (slave.health.consecutiveErrors < 255) {
+    slave.health.consecutiveErrors++;
+  }
+
+  if (slave.health.consecutiveErrors > MAX_SENSOR_ERRORS) {
+    slave.health.isValid = false;
+
+    // Exponential backoff: 1, 2, 4 ... MODBUS_MAX_BACKOFF_SWEEPS sweeps
+    slave.backoffSweeps = (slave.backoffSweeps == 0) ? 1 : slave.backoffSweeps * 2;
+    if (slave.backoffSweeps > MODBUS_MAX_BACKOFF_SWEEPS) {
+      slave.backoffSweeps = MODBUS_MAX_BACKOFF_SWEEPS;
+    }
+    slave.nextSweep = stats.sweepCount + 1 + slave.backoffSweeps;
+
+    Serial.print("⚠️ Modbus probe ");
+    Serial.print(slave.id);
+    Serial.print(" failing, skipping ");
+    Serial.print(slave.backoffSweeps);
+    Serial.println(" sweeps");
+  }
+}
+
+// ============================================================================
+// GETTERS
+// ============================================================================
+
+bool ModbusScheduler::isSweeping() {
+  return stats.inProgress;
+}
+
+uint8_t ModbusScheduler::getSlaveCount() {
+  return slaveCount;
+}
+
+uint8_t ModbusScheduler::getSlaveId(uint8_t index) {
+  return slaves[index].id;
+}
+
+SensorHealth& ModbusScheduler::getSlaveHealth(uint8_t index) {
+  return slaves[index].health;
+}
+
+bool ModbusScheduler::isBackedOff(uint8_t index) {
+  return stats.sweepCount < slaves[index].nextSweep;
+}
+
+ModbusSweepStats ModbusScheduler::getStats() {
+  return stats;
+}
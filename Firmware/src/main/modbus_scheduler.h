@@ -0,0 +1,104 @@
+/**
+ * GreenOS - Multi-drop Modbus Polling Scheduler
+ *
+ * Round-robins every soil probe on the shared RS485 bus. Requests are
+ * chained back-to-back from the completion callback, so the only idle
+ * time between frames is the 3.5 character gap enforced by ModbusRTU.
+ * Slaves that keep failing are skipped for an exponentially growing
+ * number of sweeps, keeping a full sweep bounded by the healthy probes.
+ */
+
+#ifndef MODBUS_SCHEDULER_H
+#define MODBUS_SCHEDULER_H
+
+#include <Arduino.h>
+#include "modbus_rtu.h"
+#include "sensor_manager.h"
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+#ifndef MODBUS_SOIL_PROBE_COUNT
+#define MODBUS_SOIL_PROBE_COUNT 1        // Probes at consecutive IDs from MODBUS_SLAVE_ID
+#endif
+
+#define MODBUS_MAX_SLAVES 16
+#define MODBUS_MAX_BACKOFF_SWEEPS 32     // Failed slave retried at least every 32 sweeps
+
+// Called for every completed transaction. Return true if the response was
+// accepted (valid and in range) so the slave's health can be updated.
+typedef bool (*ModbusSlaveHandler)(uint8_t index, uint8_t result,
+                                   const uint16_t* registers, uint8_t count,
+                                   void* context);
+
+// ============================================================================
+// SCHEDULER DATA STRUCTURES
+// ============================================================================
+
+struct ModbusSlave {
+  uint8_t id;
+  SensorHealth health;
+  uint8_t backoffSweeps;     // Current backoff length (0 = polled every sweep)
+  uint32_t nextSweep;        // First sweep number this slave is polled again
+};
+
+struct ModbusSweepStats {
+  uint32_t sweepCount;
+  uint8_t polled;            // Slaves queried in the last sweep
+  uint8_t skipped;           // Slaves skipped due to backoff in the last sweep
+  unsigned long lastSweepMicros;
+  unsigned long maxSweepMicros;
+  unsigned long lastTransactionMicros;   // Request sent -> response (or timeout)
+  bool inProgress;
+};
+
+// ============================================================================
+// MODBUS SCHEDULER CLASS
+// ============================================================================
+
+class ModbusScheduler {
+public:
+  ModbusScheduler();
+  void begin(ModbusRTU* bus, uint16_t startRegister, uint8_t registerCount,
+             ModbusSlaveHandler handler, void* context);
+  bool addSlave(uint8_t slaveId);
+
+  // Kick off a sweep over all slaves. Returns false if one is still running.
+  bool startSweep();
+  bool isSweeping();
+
+  // Slave table access
+  uint8_t getSlaveCount();
+  uint8_t getSlaveId(uint8_t index);
+  SensorHealth& getSlaveHealth(uint8_t index);
+  bool isBackedOff(uint8_t index);
+
+  ModbusSweepStats getStats();
+
+private:
+  ModbusRTU* bus;
+  uint16_t startRegister;
+  uint8_t registerCount;
+  ModbusSlaveHandler handler;
+  void* context;
+
+  ModbusSlave slaves[MODBUS_MAX_SLAVES];
+  uint8_t slaveCount;
+  uint8_t cursor;            // Next slave index to consider in this sweep
+
+  ModbusSweepStats stats;
+  unsigned long sweepStartMicros;
+  unsigned long requestStartMicros;
+
+  void dispatchNext();
+  void finishSweep();
+  void updateHealth(ModbusSlave& slave, bool accepted);
+
+  static void onResponse(uint8_t slaveId, uint8_t result,
+                         const uint16_t* registers, uint8_t count,
+                         void* context);
+  void handleResponse(uint8_t result, const uint16_t* registers, uint8_t count);
+};
+
+#endif // MODBUS_SCHEDULER_H
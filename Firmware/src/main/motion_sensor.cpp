@@ -0,0 +1,132 @@
+/**
+ * GreenOS - PIR Motion Sensor Implementation
+ */
+
+#include "motion_sensor.h"
+
+MotionSensor* MotionSensor::instance = nullptr;
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+MotionSensor::MotionSensor() {
+  pin = 0;
+  droppedEvents = 0;
+  callback = nullptr;
+  high = false;
+  highSince = 0;
+  windowStart = 0;
+  highTime = 0;
+  windowEvents = 0;
+  lastMotion = 0;
+  totalEvents = 0;
+}
+
+void MotionSensor::begin(uint8_t pin) {
+  this->pin = pin;
+  pinMode(pin, INPUT);
+
+  windowStart = millis();
+  high = digitalRead(pin);
+  highSince = windowStart;
+
+  instance = this;
+  attachInterrupt(digitalPinToInterrupt(pin), onEdge, CHANGE);
+}
+
+void MotionSensor::setCallback(MotionCallback callback) {
+  this->callback = callback;
+}
+
+// ============================================================================
+// INTERRUPT HANDLER (keep minimal)
+// ============================================================================
+
+void MotionSensor::onEdge() {
+  MotionSensor* self = instance;
+  if (self == nullptr) return;
+
+  MotionEvent edge;
+  edge.timestamp = millis();
+  edge.rising = digitalRead(self->pin) ? 1 : 0;
+  if (!self->edges.push(edge)) {
+    self->droppedEvents++;
+  }
+}
+
+// ============================================================================
+// EDGE PROCESSING
+// ============================================================================
+
+void MotionSensor::service() {
+  MotionEvent edge;
+  bool triggered = false;
+
+  while (edges.pop(edge)) {
+    bool wasHigh = high;
+    applyEdge(edge);
+    if (high && !wasHigh) triggered = true;
+  }
+
+  if (triggered && callback != nullptr) {
+    callback();
+  }
+}
+
+void MotionSensor::applyEdge(const MotionEvent& edge) {
+  if (edge.rising && !high) {
+    high = true;
+    highSince = edge.timestamp;
+    lastMotion = edge.timestamp;
+    windowEvents++;
+    totalEvents++;
+  } else if (!edge.rising && high) {
+    high = false;
+    // Only the part of the pulse inside this window counts
+    unsigned long start = ((long)(highSince - windowStart) > 0) ? highSince : windowStart;
+    highTime += edge.timestamp - start;
+  }
+  // Repeated level (bounce, or an edge lost to a full ring) - ignore
+}
+
+void MotionSensor::takeWindow(MotionWindow& out) {
+  service();
+
+  unsigned long now = millis();
+
+  // Resync if an edge was dropped while the ring was full
+  bool level = digitalRead(pin);
+  if (level != high && edges.isEmpty()) {
+    MotionEvent edge = {(uint32_t)now, (uint8_t)(level ? 1 : 0)};
+    applyEdge(edge);
+  }
+
+  unsigned long length = now - windowStart;
+  unsigned long active = highTime;
+  if (high) {
+    unsigned long start = ((long)(highSince - windowStart) > 0) ? highSince : windowStart;
+    active += now - start;
+  }
+
+  out.events = windowEvents;
+  out.dutyPercent = (length > 0) ? 100.0f * active / length : (high ? 100.0f : 0.0f);
+  out.lastMotion = lastMotion;
+  out.active = high;
+
+  windowStart = now;
+  highTime = 0;
+  windowEvents = 0;
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+uint32_t MotionSensor::getTotalEvents() {
+  return totalEvents;
+}
+
+uint32_t MotionSensor::getDroppedEvents() {
+  return droppedEvents;
+}
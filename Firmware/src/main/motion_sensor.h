@@ -0,0 +1,74 @@
+/**
+ * GreenOS - PIR Motion Sensor
+ *
+ * Edge interrupt on the PIR output. The handler only timestamps the edge
+ * into an SpscRing; service() (main loop) turns edges into per-window
+ * figures for SensorData: rising-edge count, share of the window the
+ * output was high, and the time of the last trigger. Pulses shorter than
+ * the sensor read interval are no longer missed, and a single blip can
+ * be told apart from sustained presence.
+ *
+ * An optional callback runs from service() (not the ISR) on each new
+ * trigger, so security checks can react without waiting for the next
+ * sensor cycle.
+ */
+
+#ifndef MOTION_SENSOR_H
+#define MOTION_SENSOR_H
+
+#include <Arduino.h>
+#include "spsc_ring.h"
+
+#define MOTION_EVENT_CAPACITY 32      // Edges buffered between service() calls
+
+struct MotionEvent {
+  uint32_t timestamp;                 // millis() at the edge
+  uint8_t rising;                     // 1 = output went high
+};
+
+struct MotionWindow {
+  uint16_t events;                    // Rising edges in the window
+  float dutyPercent;                  // Time the output was high
+  unsigned long lastMotion;           // millis() of the last rising edge (0 = never)
+  bool active;                        // Output high at the end of the window
+};
+
+typedef void (*MotionCallback)();
+
+class MotionSensor {
+public:
+  MotionSensor();
+  void begin(uint8_t pin);
+  void setCallback(MotionCallback callback);
+
+  // Drain edges from the ISR ring - call every loop()
+  void service();
+
+  // Figures since the previous call, then start a new window
+  void takeWindow(MotionWindow& out);
+
+  uint32_t getTotalEvents();
+  uint32_t getDroppedEvents();
+
+private:
+  static MotionSensor* instance;
+  static void onEdge();
+
+  uint8_t pin;
+  SpscRing<MotionEvent, MOTION_EVENT_CAPACITY> edges;
+  volatile uint32_t droppedEvents;    // Written by the ISR
+  MotionCallback callback;
+
+  // Window state (main loop only)
+  bool high;
+  unsigned long highSince;
+  unsigned long windowStart;
+  unsigned long highTime;
+  uint16_t windowEvents;
+  unsigned long lastMotion;
+  uint32_t totalEvents;
+
+  void applyEdge(const MotionEvent& edge);
+};
+
+#endif // MOTION_SENSOR_H
@@ -0,0 +1,145 @@
+/**
+ * GreenOS - Noise Meter Implementation
+ *
+ * Fixed point: samples are ADC_RESOLUTION-bit counts, filter state is Q8 (counts
+ * x 256) so the shifts keep sub-count precision, and energies are
+ * 64-bit sums of squared counts (a 64-sample block of full-scale
+ * samples exceeds 32 bits). The per-sample loop is shifts, adds and one
+ * 32x32->64 multiply-accumulate per sum (SMLAL on Cortex-M). The
+ * recursive filters force one scalar pass anyway, so CMSIS-DSP vector
+ * kernels would not save work here.
+ */
+
+#include "noise_meter.h"
+#include "config.h"
+
+#define MIC_DSP_SAMPLE_PERIOD_US (1000000UL / MIC_DSP_SAMPLE_RATE)
+
+// Max amplitude around mid-rail: half the ADC range
+#define MIC_DSP_FULL_SCALE ((ADC_MAX_VALUE + 1.0f) / 2.0f)
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+NoiseMeter::NoiseMeter() {
+  pin = 0;
+  started = false;
+  lastBlock = 0;
+  blockSamples = 0;
+  blockCount = 0;
+  dcQ8 = 0;
+  lowQ8 = 0;
+  energy = 0;
+  highEnergy = 0;
+  samples = 0;
+  peak = 0;
+  windowBlocks = 0;
+}
+
+void NoiseMeter::begin(uint8_t pin) {
+  this->pin = pin;
+  started = false;  // First block seeds the DC tracker
+  lastBlock = millis();
+  blockSamples = 0;
+}
+
+// ============================================================================
+// CAPTURE
+// ============================================================================
+
+void NoiseMeter::service() {
+  if (blockSamples == 0) {
+    if (millis() - lastBlock < MIC_DSP_INTERVAL_MS) {
+      return;
+    }
+    lastBlock = millis();
+  }
+  captureChunk();
+
+  if (blockSamples >= MIC_DSP_BLOCK_SAMPLES) {
+    blockSamples = 0;
+    windowBlocks++;
+    blockCount++;
+  }
+}
+
+unsigned long NoiseMeter::msUntilNextBlock() {
+  if (blockSamples > 0) return 0;  // Rest of the block is due now
+  unsigned long elapsed = millis() - lastBlock;
+  return (elapsed >= MIC_DSP_INTERVAL_MS) ? 0 : MIC_DSP_INTERVAL_MS - elapsed;
+}
+
+void NoiseMeter::captureChunk() {
+  if (!started) {
+    // Start the tracker at the bias point instead of ramping up from 0
+    dcQ8 = (int32_t)analogRead(pin) << 8;
+    lowQ8 = 0;
+    started = true;
+  }
+
+  uint64_t chunkEnergy = 0;
+  uint64_t chunkHigh = 0;
+  uint16_t chunkPeak = 0;
+
+  unsigned long next = micros();
+  for (uint16_t i = 0; i < MIC_DSP_CHUNK_SAMPLES; i++) {
+    while ((long)(micros() - next) < 0) {
+      // Pace conversions to the sample rate
+    }
+    next += MIC_DSP_SAMPLE_PERIOD_US;
+
+    int32_t rawQ8 = (int32_t)analogRead(pin) << 8;
+
+    // DC removal: x = raw - dc, dc follows raw with time constant 2^DC_SHIFT
+    dcQ8 += (rawQ8 - dcQ8) >> MIC_DSP_DC_SHIFT;
+    int32_t xQ8 = rawQ8 - dcQ8;
+
+    // Band split: low = one-pole low-pass of x, high = x - low
+    lowQ8 += (xQ8 - lowQ8) >> MIC_DSP_BAND_SHIFT;
+    int32_t highQ8 = xQ8 - lowQ8;
+
+    // Back to whole counts for the sums
+    int32_t x = xQ8 / 256;
+    int32_t h = highQ8 / 256;
+
+    chunkEnergy += (int64_t)x * x;
+    chunkHigh += (int64_t)h * h;
+
+    uint16_t magnitude = (uint16_t)(x < 0 ? -x : x);
+    if (magnitude > chunkPeak) chunkPeak = magnitude;
+  }
+
+  energy += chunkEnergy;
+  highEnergy += chunkHigh;
+  samples += MIC_DSP_CHUNK_SAMPLES;
+  blockSamples += MIC_DSP_CHUNK_SAMPLES;
+  if (chunkPeak > peak) peak = chunkPeak;
+}
+
+// ============================================================================
+// RESULTS
+// ============================================================================
+
+bool NoiseMeter::takeWindow(NoiseWindow& out) {
+  out.blocks = windowBlocks;
+  if (windowBlocks == 0) {
+    return false;
+  }
+
+  out.rms = sqrtf((float)energy / samples);
+  out.peak = peak;
+  out.dbfs = (out.rms > 0.0f) ? 20.0f * log10f(out.rms / MIC_DSP_FULL_SCALE) : MIC_DSP_SILENCE_DBFS;
+  out.highBandPercent = (energy > 0) ? 100.0f * (float)highEnergy / (float)energy : 0.0f;
+
+  energy = 0;
+  highEnergy = 0;
+  samples = 0;
+  peak = 0;
+  windowBlocks = 0;
+  return true;
+}
+
+uint32_t NoiseMeter::getBlockCount() {
+  return blockCount;
+}
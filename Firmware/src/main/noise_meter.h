@@ -0,0 +1,94 @@
+/**
+ * GreenOS - Noise Meter
+ *
+ * Sound level from the microphone channel, replacing the averaged DC
+ * voltage. Short blocks of MIC_DSP_BLOCK_SAMPLES are captured at
+ * MIC_DSP_SAMPLE_RATE every MIC_DSP_INTERVAL_MS and reduced in a single
+ * integer pass:
+ * - DC removal with a one-pole tracker (carried across blocks)
+ * - energy (for RMS), absolute peak
+ * - band split by a one-pole low-pass at ~370 Hz: energy below / above
+ *
+ * Blocks accumulate into a window that the sensor cycle collects with
+ * takeWindow(); only that step uses floating point (sqrt, log10).
+ *
+ * CPU budget: one block is 64 samples at 8 kHz = 8 ms of conversions
+ * every 250 ms (~3 %). Coverage is the same 3 %, so this hears
+ * sustained noise (alarms, machinery, voices), not every single click.
+ * A block is captured in chunks of MIC_DSP_CHUNK_SAMPLES, one per
+ * service() call, so no call holds the loop for more than ~1 ms (the
+ * RS485 and co-processor UARTs are serviced at that granularity). The
+ * filter state carries across the gaps between chunks as it does
+ * between blocks.
+ */
+
+#ifndef NOISE_METER_H
+#define NOISE_METER_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+#define MIC_DSP_SAMPLE_RATE 8000         // Hz
+#define MIC_DSP_BLOCK_SAMPLES 64         // Per capture (8 ms)
+#define MIC_DSP_CHUNK_SAMPLES 8          // Per service() call (1 ms)
+#define MIC_DSP_INTERVAL_MS 250          // Capture period
+#define MIC_DSP_DC_SHIFT 8               // DC tracker time constant 2^8 samples (~5 Hz)
+#define MIC_DSP_BAND_SHIFT 2             // Low-pass alpha 1/4 (~370 Hz at 8 kHz)
+#define MIC_DSP_SILENCE_DBFS -96.0f      // Reported for a zero-energy window
+
+// ============================================================================
+// RESULTS
+// ============================================================================
+
+struct NoiseWindow {
+  float rms;                   // ADC counts, DC removed
+  float peak;                  // ADC counts (absolute)
+  float dbfs;                  // 20·log10(rms / half the ADC range)
+  float highBandPercent;       // Share of energy above the band split
+  uint16_t blocks;             // Blocks in the window
+};
+
+// ============================================================================
+// NOISE METER CLASS
+// ============================================================================
+
+class NoiseMeter {
+public:
+  NoiseMeter();
+  void begin(uint8_t pin);
+
+  // Capture and reduce the next chunk if a block is due or under way -
+  // call every loop()
+  void service();
+  unsigned long msUntilNextBlock();
+
+  // Summary of blocks since the last call; false if there were none
+  bool takeWindow(NoiseWindow& out);
+
+  uint32_t getBlockCount();
+
+private:
+  uint8_t pin;
+  bool started;
+  unsigned long lastBlock;        // millis() the current / last block started
+  uint16_t blockSamples;          // Captured so far in the current block
+  uint32_t blockCount;
+
+  // Filter state (Q8 counts), carried across blocks
+  int32_t dcQ8;
+  int32_t lowQ8;
+
+  // Window accumulators
+  uint64_t energy;
+  uint64_t highEnergy;
+  uint32_t samples;
+  uint16_t peak;
+  uint16_t windowBlocks;
+
+  void captureChunk();
+};
+
+#endif // NOISE_METER_H
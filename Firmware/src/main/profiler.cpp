@@ -0,0 +1,149 @@
+/**
+ * GreenOS - Loop and Subsystem Profiler Implementation
+ */
+
+#include "profiler.h"
+
+Profiler profiler;
+
+// ============================================================================
+// CYCLE COUNTER (ARMv7-M / ARMv8-M mainline DWT)
+// ============================================================================
+
+#if PROFILE_HAS_DWT
+#define PROFILE_DEMCR      (*(volatile uint32_t*)0xE000EDFCUL)
+#define PROFILE_DWT_CTRL   (*(volatile uint32_t*)0xE0001000UL)
+#define PROFILE_DWT_CYCCNT (*(volatile uint32_t*)0xE0001004UL)
+
+#define PROFILE_DEMCR_TRCENA     (1UL << 24)
+#define PROFILE_DWT_CYCCNTENA    (1UL << 0)
+#define PROFILE_DWT_NOCYCCNT     (1UL << 25)
+#endif
+
+// Short names for the PROF line, in ProfileSection order
+static const char* const sectionNames[PROFILE_SECTION_COUNT] = {
+  "loop",
+  "boot", "init", "net", "auth", "normal", "safe", "emerg", "calib",
+  "read", "scd30", "mq135", "modbus",
+  "anomaly", "sync", "flush"
+};
+
+// ============================================================================
+// CONSTRUCTOR / SETUP
+// ============================================================================
+
+Profiler::Profiler() {
+  cycleCounter = false;
+  cyclesPerMicro = PROFILE_CPU_HZ / 1000000UL;
+  reset();
+}
+
+void Profiler::begin() {
+  #if PROFILE_HAS_DWT
+  if ((PROFILE_DWT_CTRL & PROFILE_DWT_NOCYCCNT) == 0 && cyclesPerMicro > 0) {
+    PROFILE_DEMCR |= PROFILE_DEMCR_TRCENA;
+    PROFILE_DWT_CYCCNT = 0;
+    PROFILE_DWT_CTRL |= PROFILE_DWT_CYCCNTENA;
+
+    // Confirm it is actually counting (debug block may be gated off)
+    uint32_t first = PROFILE_DWT_CYCCNT;
+    delayMicroseconds(2);
+    cycleCounter = (PROFILE_DWT_CYCCNT != first);
+  }
+  #endif
+
+  Serial.print(cycleCounter ? "✓ Profiler using DWT cycle counter (" : "ℹ️  Profiler using micros() (");
+  Serial.print(cycleCounter ? cyclesPerMicro : 1);
+  Serial.println(" ticks/us)");
+}
+
+// ============================================================================
+// RECORDING
+// ============================================================================
+
+uint32_t Profiler::start() {
+  #if PROFILE_HAS_DWT
+  if (cycleCounter) return PROFILE_DWT_CYCCNT;
+  #endif
+  return micros();
+}
+
+void Profiler::stop(ProfileSection section, uint32_t startTicks) {
+  // Unsigned difference handles counter wrap (cycles wrap every ~27 s at
+  // 160 MHz, well above any single span)
+  uint32_t elapsed = start() - startTicks;
+  record(section, cycleCounter ? elapsed / cyclesPerMicro : elapsed);
+}
+
+void Profiler::record(ProfileSection section, unsigned long micros) {
+  if (section >= PROFILE_SECTION_COUNT) return;
+
+  SectionStats& stats = sections[section];
+  stats.histogram.record(micros);
+  stats.totalMicros += micros;
+  if (micros < stats.minMicros) stats.minMicros = micros;
+}
+
+void Profiler::recordWatchdogGap(unsigned long gapMs) {
+  if (gapMs > maxWatchdogGapMs) maxWatchdogGapMs = gapMs;
+}
+
+void Profiler::reset() {
+  for (uint8_t i = 0; i < PROFILE_SECTION_COUNT; i++) {
+    sections[i].histogram.reset();
+    sections[i].minMicros = 0xFFFFFFFFUL;
+    sections[i].totalMicros = 0;
+  }
+  maxWatchdogGapMs = 0;
+}
+
+// ============================================================================
+// QUERIES
+// ============================================================================
+
+unsigned long Profiler::getMaxMicros(ProfileSection section) {
+  if (section >= PROFILE_SECTION_COUNT) return 0;
+  return sections[section].histogram.getMax();
+}
+
+unsigned long Profiler::getMaxWatchdogGap() {
+  return maxWatchdogGapMs;
+}
+
+bool Profiler::usesCycleCounter() {
+  return cycleCounter;
+}
+
+// ============================================================================
+// SERIAL DUMP
+// ============================================================================
+
+void Profiler::printLine(unsigned long watchdogTimeoutMs) {
+  Serial.print("PROF up=");
+  Serial.print(millis());
+  Serial.print(cycleCounter ? " ticks=dwt" : " ticks=us");
+  Serial.print(" wdt=");
+  Serial.print(maxWatchdogGapMs);
+  Serial.print("/");
+  Serial.print(watchdogTimeoutMs);
+
+  for (uint8_t i = 0; i < PROFILE_SECTION_COUNT; i++) {
+    SectionStats& stats = sections[i];
+    uint32_t count = stats.histogram.getCount();
+    if (count == 0) continue;
+
+    Serial.print(" ");
+    Serial.print(sectionNames[i]);
+    Serial.print("=");
+    Serial.print(count);
+    Serial.print(",");
+    Serial.print(stats.minMicros);
+    Serial.print(",");
+    Serial.print((unsigned long)(stats.totalMicros / count));
+    Serial.print(",");
+    Serial.print(stats.histogram.getMax());
+    Serial.print(",");
+    Serial.print(stats.histogram.getPercentile(99));
+  }
+  Serial.println();
+}
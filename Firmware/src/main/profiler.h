@@ -0,0 +1,133 @@
+/**
+ * GreenOS - Loop and Subsystem Profiler
+ *
+ * Scoped timers around the FSM states, the loop body and the sensor /
+ * anomaly / sync paths. Spans are taken from the Cortex-M DWT cycle
+ * counter where the core has one (micros() otherwise) and folded into
+ * fixed-memory per-section stats: count, min, avg, max and p99 from a
+ * LatencyHistogram. The longest gap between watchdog feeds is kept as
+ * well, to show how close the loop gets to WDT_TIMEOUT_SECONDS.
+ *
+ * printLine() emits everything as one key=value line for field logs:
+ *
+ *   PROF up=<ms> ticks=dwt|us wdt=<max feed gap ms>/<timeout ms> \
+ *     <section>=<count>,<min>,<avg>,<max>,<p99> ...   (times in us)
+ *
+ * Sections that never ran are omitted.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <Arduino.h>
+#include "health_window.h"
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+// Core clock for cycle -> microsecond conversion
+#ifndef PROFILE_CPU_HZ
+#ifdef F_CPU
+#define PROFILE_CPU_HZ F_CPU
+#else
+#define PROFILE_CPU_HZ 160000000UL    // STM32U585
+#endif
+#endif
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || defined(__ARM_ARCH_8M_MAIN__)
+#define PROFILE_HAS_DWT 1
+#else
+#define PROFILE_HAS_DWT 0
+#endif
+
+// ============================================================================
+// SECTIONS
+// ============================================================================
+
+enum ProfileSection {
+  PROFILE_LOOP,                 // loop() body, excluding the idle sleep
+  PROFILE_STATE_BOOT,           // One section per SystemState
+  PROFILE_STATE_SENSOR_INIT,
+  PROFILE_STATE_NETWORK,
+  PROFILE_STATE_AUTH,
+  PROFILE_STATE_NORMAL,
+  PROFILE_STATE_SAFE,
+  PROFILE_STATE_EMERGENCY,
+  PROFILE_STATE_CALIBRATION,
+  PROFILE_READ_ALL,             // SensorManager::readAll()
+  PROFILE_SCD30,
+  PROFILE_MQ135,
+  PROFILE_MODBUS,               // One soil probe transaction
+  PROFILE_ANOMALY,              // Detection + alert handling
+  PROFILE_SYNC,                 // Log/buffer upload
+  PROFILE_LOG_FLUSH,
+  PROFILE_SECTION_COUNT
+};
+
+// ============================================================================
+// PROFILER
+// ============================================================================
+
+class Profiler {
+public:
+  Profiler();
+
+  // Enable the cycle counter (falls back to micros() if absent)
+  void begin();
+
+  // Raw timestamp for start()/stop() pairs
+  uint32_t start();
+  void stop(ProfileSection section, uint32_t startTicks);
+
+  // Spans measured elsewhere (e.g. Modbus request -> response)
+  void record(ProfileSection section, unsigned long micros);
+
+  // Time since the previous feed, called on every watchdog feed
+  void recordWatchdogGap(unsigned long gapMs);
+
+  void reset();
+
+  unsigned long getMaxMicros(ProfileSection section);
+  unsigned long getMaxWatchdogGap();
+  bool usesCycleCounter();
+
+  void printLine(unsigned long watchdogTimeoutMs);
+
+private:
+  struct SectionStats {
+    LatencyHistogram histogram;   // Count, max and p99
+    unsigned long minMicros;
+    uint64_t totalMicros;
+  };
+
+  SectionStats sections[PROFILE_SECTION_COUNT];
+  unsigned long maxWatchdogGapMs;
+  bool cycleCounter;
+  uint32_t cyclesPerMicro;
+};
+
+extern Profiler profiler;
+
+// ============================================================================
+// SCOPED TIMER
+// ============================================================================
+
+// Times the enclosing block: { ProfileScope scope(PROFILE_SCD30); ... }
+class ProfileScope {
+public:
+  explicit ProfileScope(ProfileSection section) {
+    this->section = section;
+    startTicks = profiler.start();
+  }
+
+  ~ProfileScope() {
+    profiler.stop(section, startTicks);
+  }
+
+private:
+  ProfileSection section;
+  uint32_t startTicks;
+};
+
+#endif // PROFILER_H
@@ -0,0 +1,171 @@
+/**
+ * GreenOS - Packed Sensor Record Codec Implementation
+ *
+ * Resolution check against the sources (see readModbusSensor()):
+ * - Soil sensor reports 0.1 %, 0.1 °C, 0.01 pH and 1 µS/cm - all exact
+ * - SCD-30 reports float CO2/T/RH; stored at 1 ppm / 0.01 °C / 0.01 %RH,
+ *   well below its ±30 ppm / ±0.4 °C / ±3 %RH accuracy
+ */
+
+#include "record_codec.h"
+
+static_assert(sizeof(PackedReading) == 14, "PackedReading layout changed");
+static_assert(sizeof(PackedBlockHeader) == 8, "PackedBlockHeader layout changed");
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+RecordCodec::RecordCodec() {
+  lastTimestamp = 0;
+  hasLast = false;
+}
+
+void RecordCodec::reset() {
+  hasLast = false;
+}
+
+// ============================================================================
+// ENCODING
+// ============================================================================
+
+PackedReading RecordCodec::pack(const SensorData& data) {
+  PackedReading packed;
+  packed.timeDelta = encodeDelta(data.timestamp);
+  packed.airTemp = toFixedSigned(data.airTemp, RECORD_SCALE_TEMP);
+  packed.airHumidity = toFixedUnsigned(data.airHumidity, RECORD_SCALE_HUMIDITY);
+  packed.co2 = toFixedUnsigned(data.co2, RECORD_SCALE_CO2);
+  packed.ph = toFixedUnsigned(data.ph, RECORD_SCALE_PH);
+  packed.ec = toFixedUnsigned(data.ec, RECORD_SCALE_EC);
+  packed.vwc = toFixedUnsigned(data.vwc, RECORD_SCALE_VWC);
+  return packed;
+}
+
+unsigned long RecordCodec::getLastTimestamp() {
+  return lastTimestamp;
+}
+
+uint16_t RecordCodec::encodeDelta(unsigned long timestamp) {
+  if (!hasLast) {
+    hasLast = true;
+    lastTimestamp = timestamp;
+    return 0;
+  }
+
+  unsigned long delta = timestamp - lastTimestamp;
+  uint16_t encoded;
+
+  if (delta < RECORD_DELTA_SECONDS_FLAG) {
+    encoded = (uint16_t)delta;
+  } else {
+    // Coarse form: whole seconds, rounded; saturates at ~9 hours
+    unsigned long seconds = (delta + 500) / 1000;
+    if (seconds > 0x7FFF) seconds = 0x7FFF;
+    encoded = RECORD_DELTA_SECONDS_FLAG | (uint16_t)seconds;
+  }
+
+  // Track what the decoder will reconstruct, not the true time
+  lastTimestamp += decodeDelta(encoded);
+  return encoded;
+}
+
+// ============================================================================
+// DECODING
+// ============================================================================
+
+unsigned long RecordCodec::deltaMillis(const PackedReading& packed) {
+  return decodeDelta(packed.timeDelta);
+}
+
+unsigned long RecordCodec::decodeDelta(uint16_t encoded) {
+  if (encoded & RECORD_DELTA_SECONDS_FLAG) {
+    return (unsigned long)(encoded & 0x7FFF) * 1000UL;
+  }
+  return encoded;
+}
+
+void RecordCodec::unpack(const PackedReading& packed, unsigned long timestamp, SensorReading& out) {
+  out.timestamp = timestamp;
+  out.airTemp = fromFixedSigned(packed.airTemp, RECORD_SCALE_TEMP);
+  out.airHumidity = fromFixedUnsigned(packed.airHumidity, RECORD_SCALE_HUMIDITY);
+  out.co2 = fromFixedUnsigned(packed.co2, RECORD_SCALE_CO2);
+  out.ph = fromFixedUnsigned(packed.ph, RECORD_SCALE_PH);
+  out.ec = fromFixedUnsigned(packed.ec, RECORD_SCALE_EC);
+  out.vwc = fromFixedUnsigned(packed.vwc, RECORD_SCALE_VWC);
+}
+
+// ============================================================================
+// BLOCK FRAMING
+// ============================================================================
+
+size_t RecordCodec::blockSize(size_t count) {
+  return sizeof(PackedBlockHeader) + count * sizeof(PackedReading);
+}
+
+PackedBlockHeader RecordCodec::blockHeader(size_t count, unsigned long baseTimestamp) {
+  PackedBlockHeader header;
+  header.magic = RECORD_BLOCK_MAGIC;
+  header.version = RECORD_CODEC_VERSION;
+  header.count = (uint16_t)count;
+  header.baseTimestamp = baseTimestamp;
+  return header;
+}
+
+size_t RecordCodec::writeBlock(const PackedReading* records, size_t count, unsigned long baseTimestamp,
+                               uint8_t* out, size_t capacity) {
+  if (count > 0xFFFF || blockSize(count) > capacity) {
+    return 0;
+  }
+
+  PackedBlockHeader header = blockHeader(count, baseTimestamp);
+  memcpy(out, &header, sizeof(header));
+  memcpy(out + sizeof(header), records, count * sizeof(PackedReading));
+  return blockSize(count);
+}
+
+size_t RecordCodec::readBlockHeader(const uint8_t* in, size_t length, PackedBlockHeader& header) {
+  if (length < sizeof(PackedBlockHeader)) {
+    return 0;
+  }
+
+  memcpy(&header, in, sizeof(header));
+  if (header.magic != RECORD_BLOCK_MAGIC || header.version != RECORD_CODEC_VERSION) {
+    return 0;
+  }
+  if (blockSize(header.count) > length) {
+    return 0;  // Truncated block
+  }
+  return sizeof(PackedBlockHeader);
+}
+
+// ============================================================================
+// FIXED-POINT HELPERS
+// ============================================================================
+
+int16_t RecordCodec::toFixedSigned(float value, float scale) {
+  if (isnan(value)) return RECORD_INVALID_SIGNED;
+
+  float scaled = roundf(value * scale);
+  if (scaled < -32767.0f) return -32767;
+  if (scaled > 32767.0f) return 32767;
+  return (int16_t)scaled;
+}
+
+uint16_t RecordCodec::toFixedUnsigned(float value, float scale) {
+  if (isnan(value)) return RECORD_INVALID_UNSIGNED;
+
+  float scaled = roundf(value * scale);
+  if (scaled < 0.0f) return 0;
+  if (scaled > 65534.0f) return 65534;
+  return (uint16_t)scaled;
+}
+
+float RecordCodec::fromFixedSigned(int16_t raw, float scale) {
+  if (raw == RECORD_INVALID_SIGNED) return NAN;
+  return raw / scale;
+}
+
+float RecordCodec::fromFixedUnsigned(uint16_t raw, float scale) {
+  if (raw == RECORD_INVALID_UNSIGNED) return NAN;
+  return raw / scale;
+}
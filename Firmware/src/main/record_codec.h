@@ -0,0 +1,116 @@
+/**
+ * GreenOS - Packed Sensor Record Codec
+ *
+ * Compact 14-byte on-wire/at-rest format for buffered sensor readings,
+ * shared by the RAM offline buffer, the local log and cloud uploads:
+ * - 16-bit fixed-point fields at (or better than) sensor resolution
+ * - 16-bit timestamp delta from the previous record
+ * - Optional 8-byte block header carrying the absolute base timestamp
+ *
+ * Timestamp deltas below 32.768 s are stored exactly in milliseconds.
+ * Longer gaps set the top bit and store whole seconds (up to ~9 h); the
+ * encoder tracks the decoded time so rounding never accumulates.
+ */
+
+#ifndef RECORD_CODEC_H
+#define RECORD_CODEC_H
+
+#include <Arduino.h>
+#include "sensor_manager.h"
+
+// ============================================================================
+// FORMAT CONSTANTS
+// ============================================================================
+
+#define RECORD_CODEC_VERSION 1
+#define RECORD_BLOCK_MAGIC   0xA7
+
+// Fixed-point scale factors (value = raw / scale)
+#define RECORD_SCALE_TEMP     100     // 0.01 °C
+#define RECORD_SCALE_HUMIDITY 100     // 0.01 %RH
+#define RECORD_SCALE_CO2      1       // 1 ppm
+#define RECORD_SCALE_PH       100     // 0.01 pH (sensor resolution)
+#define RECORD_SCALE_EC       1000    // 1 µS/cm (sensor resolution)
+#define RECORD_SCALE_VWC      100     // 0.01 % VWC
+
+#define RECORD_INVALID_SIGNED   ((int16_t)-32768)   // NaN / no data
+#define RECORD_INVALID_UNSIGNED ((uint16_t)0xFFFF)
+
+#define RECORD_DELTA_SECONDS_FLAG 0x8000
+
+// ============================================================================
+// RECORD STRUCTURES
+// ============================================================================
+
+// Unpacked reading (what the offline buffer logically stores)
+struct SensorReading {
+  unsigned long timestamp;
+  float airTemp;
+  float airHumidity;
+  float co2;
+  float ph;
+  float ec;
+  float vwc;
+};
+
+// 14 bytes vs 28 for SensorReading
+struct PackedReading {
+  uint16_t timeDelta;     // ms since previous record (see header comment)
+  int16_t airTemp;
+  uint16_t airHumidity;
+  uint16_t co2;
+  uint16_t ph;
+  uint16_t ec;
+  uint16_t vwc;
+};
+
+// Precedes a run of PackedReadings in logs and upload payloads. The first
+// record's timeDelta is ignored - its time is baseTimestamp.
+struct PackedBlockHeader {
+  uint8_t magic;
+  uint8_t version;
+  uint16_t count;
+  uint32_t baseTimestamp;
+};
+
+// ============================================================================
+// RECORD CODEC CLASS
+// ============================================================================
+
+class RecordCodec {
+public:
+  RecordCodec();
+
+  // Start a new delta chain (next record gets delta 0)
+  void reset();
+
+  // Encode one snapshot, advancing the delta chain
+  PackedReading pack(const SensorData& data);
+  unsigned long getLastTimestamp();
+
+  // Decoding
+  static void unpack(const PackedReading& packed, unsigned long timestamp, SensorReading& out);
+  static unsigned long deltaMillis(const PackedReading& packed);
+
+  // Block framing: header + count records. Return bytes written/consumed, 0 on error.
+  static size_t writeBlock(const PackedReading* records, size_t count, unsigned long baseTimestamp,
+                           uint8_t* out, size_t capacity);
+  static size_t readBlockHeader(const uint8_t* in, size_t length, PackedBlockHeader& header);
+  static size_t blockSize(size_t count);
+  static PackedBlockHeader blockHeader(size_t count, unsigned long baseTimestamp);
+
+  // Fixed-point helpers (round to nearest, saturate, NaN → invalid sentinel)
+  static int16_t toFixedSigned(float value, float scale);
+  static uint16_t toFixedUnsigned(float value, float scale);
+  static float fromFixedSigned(int16_t raw, float scale);
+  static float fromFixedUnsigned(uint16_t raw, float scale);
+
+private:
+  unsigned long lastTimestamp;   // Decoded time of the last packed record
+  bool hasLast;
+
+  uint16_t encodeDelta(unsigned long timestamp);
+  static unsigned long decodeDelta(uint16_t encoded);
+};
+
+#endif // RECORD_CODEC_H
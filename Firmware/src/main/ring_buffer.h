@@ -0,0 +1,86 @@
+/**
+ * GreenOS - Fixed-capacity Ring Buffer
+ *
+ * Head/tail circular buffer with O(1) push that overwrites the oldest
+ * entry when full. Readers drain it in contiguous chunks through
+ * peekContiguous()/consume(), so sync and logging paths can hand the
+ * underlying storage straight to a writer without copying. A full drain
+ * takes at most two spans (before and after the wrap point).
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <Arduino.h>
+
+// Read-only view of a contiguous run of entries inside the ring
+template <typename T>
+struct RingSpan {
+  const T* data;
+  size_t length;
+};
+
+template <typename T, size_t N>
+class RingBuffer {
+public:
+  RingBuffer() : head(0), tail(0), count(0), overwritten(0) {}
+
+  // Append an entry. Returns false if the oldest entry had to be overwritten.
+  bool push(const T& item) {
+    bool room = (count < N);
+    items[head] = item;
+    head = next(head);
+    if (room) {
+      count++;
+    } else {
+      tail = next(tail);  // Drop oldest
+      overwritten++;
+    }
+    return room;
+  }
+
+  // Oldest entries up to the wrap point (or maxCount, whichever is smaller)
+  RingSpan<T> peekContiguous(size_t maxCount = N) {
+    size_t run = (tail + count <= N) ? count : N - tail;
+    if (run > maxCount) run = maxCount;
+    RingSpan<T> span = {&items[tail], run};
+    return span;
+  }
+
+  // Release the n oldest entries once the reader is done with them
+  void consume(size_t n) {
+    if (n > count) n = count;
+    tail = (tail + n) % N;
+    count -= n;
+  }
+
+  // i-th oldest entry (0 = oldest)
+  const T& at(size_t i) {
+    return items[(tail + i) % N];
+  }
+
+  void clear() {
+    head = 0;
+    tail = 0;
+    count = 0;
+  }
+
+  size_t size() { return count; }
+  size_t capacity() { return N; }
+  bool isEmpty() { return count == 0; }
+  bool isFull() { return count == N; }
+  uint32_t getOverwritten() { return overwritten; }
+
+private:
+  T items[N];
+  size_t head;        // Next write position
+  size_t tail;        // Oldest entry
+  size_t count;
+  uint32_t overwritten;
+
+  static size_t next(size_t index) {
+    return (index + 1 == N) ? 0 : index + 1;
+  }
+};
+
+#endif // RING_BUFFER_H
@@ -0,0 +1,244 @@
+/**
+ * GreenOS - Co-processor RPC Link Implementation
+ */
+
+#include "rpc_link.h"
+#include "sensor_manager.h"
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+RpcLink::RpcLink() {
+  port = nullptr;
+  callback = nullptr;
+  context = nullptr;
+  nextSeq = 1;
+  memset(&stats, 0, sizeof(stats));
+  txHead = 0;
+  txTail = 0;
+  txCount = 0;
+  framing = false;
+  codeIndex = 0;
+  code = 1;
+  frameCrc = 0;
+  rxLength = 0;
+  rxOverflow = false;
+  seen = false;
+  lastFrameMillis = 0;
+}
+
+void RpcLink::begin(Stream& port, RpcFrameCallback callback, void* context) {
+  this->port = &port;
+  this->callback = callback;
+  this->context = context;
+
+  // Drop anything from before this boot, and end whatever half frame
+  // the co-processor's parser holds
+  while (port.available()) port.read();
+  rxLength = 0;
+  rxOverflow = false;
+  put(0x00);
+}
+
+// ============================================================================
+// TRANSMIT
+// ============================================================================
+
+size_t RpcLink::encodedSize(size_t length) {
+  // One code byte per started 254-byte block, plus the delimiter
+  return length + length / 254 + 2;
+}
+
+uint8_t RpcLink::beginFrame(uint8_t type, size_t length) {
+  if (port == nullptr || framing || length > RPC_MAX_PAYLOAD ||
+      RPC_TX_BUFFER_SIZE - txCount < encodedSize(length + RPC_FRAME_OVERHEAD)) {
+    stats.txRefused++;
+    return 0;
+  }
+
+  uint8_t seq = nextSeq;
+  nextSeq = (nextSeq == 255) ? 1 : nextSeq + 1;
+
+  framing = true;
+  codeIndex = txHead;
+  put(0);                        // Code byte, patched when its block ends
+  code = 1;
+  frameCrc = 0;
+
+  uint8_t header[2] = {type, seq};
+  append(header, sizeof(header));
+  return seq;
+}
+
+void RpcLink::append(const void* data, size_t length) {
+  if (!framing) return;
+  frameCrc = SensorManager::calculateCRC32((const uint8_t*)data, length, frameCrc);
+  encode((const uint8_t*)data, length);
+}
+
+void RpcLink::endFrame() {
+  if (!framing) return;
+
+  uint8_t crc[4] = {
+    (uint8_t)frameCrc, (uint8_t)(frameCrc >> 8), (uint8_t)(frameCrc >> 16), (uint8_t)(frameCrc >> 24)
+  };
+  encode(crc, sizeof(crc));
+
+  txBuffer[codeIndex] = code;
+  put(0x00);                     // Delimiter
+  framing = false;
+  stats.framesSent++;
+}
+
+uint8_t RpcLink::send(uint8_t type, const void* payload, size_t length) {
+  uint8_t seq = beginFrame(type, length);
+  if (seq != 0) {
+    append(payload, length);
+    endFrame();
+  }
+  return seq;
+}
+
+void RpcLink::put(uint8_t byte) {
+  txBuffer[txHead] = byte;
+  txHead = (txHead + 1) % RPC_TX_BUFFER_SIZE;
+  txCount++;
+}
+
+void RpcLink::encode(const uint8_t* data, size_t length) {
+  for (size_t i = 0; i < length; i++) {
+    encodeByte(data[i]);
+  }
+}
+
+/**
+ * COBS: each block is a code byte (1 + bytes up to the next zero) and
+ * those non-zero bytes; a full 254-byte block (code 0xFF) has no
+ * implied zero after it.
+ */
+void RpcLink::encodeByte(uint8_t byte) {
+  if (byte != 0) {
+    put(byte);
+    code++;
+  }
+  if (byte == 0 || code == 0xFF) {
+    txBuffer[codeIndex] = code;
+    codeIndex = txHead;
+    put(0);
+    code = 1;
+  }
+}
+
+void RpcLink::pollTransmit() {
+  // Never hand out a frame that is still being encoded
+  size_t ready = framing ? (codeIndex + RPC_TX_BUFFER_SIZE - txTail) % RPC_TX_BUFFER_SIZE : txCount;
+
+  while (ready > 0) {
+    int room = port->availableForWrite();
+    if (room <= 0) return;
+
+    size_t chunk = ready;
+    if (chunk > (size_t)room) chunk = room;
+    if (chunk > RPC_TX_BUFFER_SIZE - txTail) chunk = RPC_TX_BUFFER_SIZE - txTail;
+
+    size_t written = port->write(txBuffer + txTail, chunk);
+    if (written == 0) return;
+
+    txTail = (txTail + written) % RPC_TX_BUFFER_SIZE;
+    txCount -= written;
+    ready -= written;
+  }
+}
+
+// ============================================================================
+// RECEIVE
+// ============================================================================
+
+void RpcLink::poll() {
+  if (port == nullptr) return;
+  pollTransmit();
+  pollReceive();
+}
+
+void RpcLink::pollReceive() {
+  for (uint8_t i = 0; i < RPC_RX_CHUNK && port->available(); i++) {
+    uint8_t byte = port->read();
+
+    if (byte == 0x00) {
+      if (rxOverflow) {
+        stats.rxOverflows++;
+      } else if (rxLength > 0) {
+        dispatch();
+      }
+      rxLength = 0;
+      rxOverflow = false;
+      continue;
+    }
+
+    if (rxLength >= RPC_RX_BUFFER_SIZE) {
+      rxOverflow = true;         // Resynchronize at the next delimiter
+      continue;
+    }
+    rxBuffer[rxLength++] = byte;
+  }
+}
+
+size_t RpcLink::decode(uint8_t* buffer, size_t length) {
+  size_t read = 0;
+  size_t write = 0;
+
+  while (read < length) {
+    uint8_t blockCode = buffer[read++];
+    if (blockCode == 0 || read + blockCode - 1 > length) {
+      return 0;
+    }
+    for (uint8_t i = 1; i < blockCode; i++) {
+      buffer[write++] = buffer[read++];
+    }
+    if (blockCode != 0xFF && read < length) {
+      buffer[write++] = 0x00;
+    }
+  }
+  return write;
+}
+
+void RpcLink::dispatch() {
+  size_t length = decode(rxBuffer, rxLength);
+  if (length < RPC_FRAME_OVERHEAD) {
+    stats.crcErrors++;
+    return;
+  }
+
+  size_t body = length - 4;
+  uint32_t crc = (uint32_t)rxBuffer[body] | ((uint32_t)rxBuffer[body + 1] << 8) |
+                 ((uint32_t)rxBuffer[body + 2] << 16) | ((uint32_t)rxBuffer[body + 3] << 24);
+  if (crc != SensorManager::calculateCRC32(rxBuffer, body)) {
+    stats.crcErrors++;
+    return;
+  }
+
+  stats.framesReceived++;
+  seen = true;
+  lastFrameMillis = millis();
+
+  if (callback != nullptr) {
+    callback(rxBuffer[0], rxBuffer[1], rxBuffer + 2, body - 2, context);
+  }
+}
+
+// ============================================================================
+// STATUS
+// ============================================================================
+
+bool RpcLink::isAlive() {
+  return seen && millis() - lastFrameMillis < RPC_LINK_TIMEOUT_MS;
+}
+
+bool RpcLink::isSending() {
+  return txCount > 0;
+}
+
+RpcLinkStats RpcLink::getStats() {
+  return stats;
+}
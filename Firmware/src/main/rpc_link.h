@@ -0,0 +1,233 @@
+/**
+ * GreenOS - Co-processor RPC Link
+ *
+ * Framed binary protocol on the inter-chip UART to the ESP32-S3, which
+ * owns WiFi, TLS and the Firebase sessions. The real-time MCU only
+ * pushes packed records and pulls commands; JSON and TLS never run on
+ * the control core.
+ *
+ * Frame on the wire: COBS(type, seq, payload..., crc32) 0x00
+ * - COBS removes every 0x00 from the frame, so 0x00 is the delimiter and
+ *   the receiver resynchronizes at the next one after any line noise
+ * - crc32 (little-endian, SensorManager::calculateCRC32) covers type,
+ *   seq and payload; a frame that fails it is dropped and counted
+ * - seq is 1-255 per sender (0 is never used); replies carry the seq of
+ *   the request they answer in their payload
+ *
+ * Both directions are non-blocking. Frames are encoded straight into a
+ * TX ring (beginFrame() reserves the worst-case size, so an accepted
+ * frame is always sent whole) and poll() moves as many bytes as the
+ * UART will take. Received bytes are collected until the delimiter,
+ * decoded in place and dispatched to a callback.
+ *
+ * The co-processor never talks unprompted: results, commands and config
+ * it holds for the MCU are queued and sent as the reply to the next
+ * RPC_POLL, ending with RPC_STATUS. RX bursts therefore only happen
+ * right after a poll, while the caller is polling the port every 1 ms.
+ */
+
+#ifndef RPC_LINK_H
+#define RPC_LINK_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+#ifndef RPC_LINK_SERIAL
+#define RPC_LINK_SERIAL Serial2        // Inter-chip UART (Serial1 is the RS485 bus)
+#endif
+
+#ifndef RPC_LINK_BAUD
+#define RPC_LINK_BAUD 460800           // ~46 bytes per 1 ms poll
+#endif
+
+#define RPC_LINK_VERSION 1
+#define RPC_MAX_PAYLOAD 3072           // Largest batch: 24 + 120 × 18 + 8 × 92 = 2920 B
+#define RPC_FRAME_OVERHEAD 6           // type, seq, crc32
+#define RPC_TX_BUFFER_SIZE 4096        // One full batch plus small frames
+#define RPC_RX_BUFFER_SIZE 512         // Replies are small (status, commands, config)
+#define RPC_RX_CHUNK 64                // Bytes parsed per poll()
+#define RPC_LINK_TIMEOUT_MS 3000       // No valid frame this long = co-processor down
+
+// ============================================================================
+// MESSAGE TYPES
+// ============================================================================
+
+enum RpcMessageType {
+  // MCU → co-processor
+  RPC_HELLO = 0x01,                    // RpcHello + device id (no NUL)
+  RPC_POLL = 0x02,                     // Empty - answered with queued frames, then RPC_STATUS
+  RPC_UPLOAD_BATCH = 0x03,             // RpcBatchHeader, uint32 offsets[n], PackedReading[n], PackedRollup[r]
+  RPC_UPLOAD_ALERTS = 0x04,            // RpcAlertHeader, then per alert RpcAlertEntry + text
+  RPC_FETCH_CONFIG = 0x05,             // Empty - answered with RPC_CONFIG
+
+  // Co-processor → MCU (only as a poll reply)
+  RPC_STATUS = 0x81,                   // RpcStatus - always last in a reply
+  RPC_RESULT = 0x82,                   // RpcResult for an upload (batch or alerts), once the cloud answered
+  RPC_COMMAND = 0x83,                  // RpcCommand (new commands only - history is filtered)
+  RPC_CONFIG = 0x84                    // RpcConfigHeader, then per key: uint8 length, name, float
+};
+
+// RpcStatus.flags
+#define RPC_STATUS_WIFI 0x01           // Associated, has an address
+#define RPC_STATUS_CLOUD 0x02          // Firebase authenticated, uploads accepted
+#define RPC_STATUS_STREAM 0x04         // Command stream open
+#define RPC_STATUS_HELLO 0x08          // Has the device id (cleared on co-processor boot)
+
+// RpcResult.status
+#define RPC_RESULT_OK 0
+#define RPC_RESULT_OFFLINE 1           // No cloud session
+#define RPC_RESULT_REJECTED 2          // Server answered with an error (httpStatus)
+#define RPC_RESULT_MALFORMED 3         // Payload did not parse
+#define RPC_RESULT_BUSY 4              // Co-processor queue full
+
+// ============================================================================
+// PAYLOADS (little-endian, no padding - copy out with memcpy)
+// ============================================================================
+
+struct RpcHello {
+  uint8_t linkVersion;                 // RPC_LINK_VERSION
+  uint8_t uplinkVersion;               // UPLINK_FORMAT_VERSION of the batch JSON to build
+  uint16_t reserved;
+};
+
+struct RpcStatus {
+  uint8_t flags;                       // RPC_STATUS_*
+  int8_t rssi;                         // dBm (0 = not associated)
+  uint16_t queuedAlerts;               // Alerts accepted but not yet delivered
+  uint32_t fullHandshakes;             // Co-processor TLS counters since its boot
+  uint32_t resumedHandshakes;
+  uint32_t failedAttempts;
+  uint32_t streamConnects;
+};
+
+struct RpcResult {
+  uint8_t requestSeq;
+  uint8_t status;                      // RPC_RESULT_*
+  uint16_t httpStatus;                 // 0 if no request was made
+};
+
+// Mirrors FirebaseComm's pending batch; offsets are ms from base. base
+// and the rollup starts are millis() of logBoot, now is of boot.
+struct RpcBatchHeader {
+  uint32_t now;                        // MCU millis() when built (the co-processor adds queueing time)
+  uint32_t base;
+  uint16_t count;
+  uint8_t rollupCount;
+  uint8_t version;                     // UPLINK_FORMAT_VERSION
+  uint32_t boot;                       // Batch id: boot id + per-boot seq (a retry
+  uint32_t seq;                        // repeats both so the server drops it)
+  uint32_t logBoot;                    // Boot the records were logged in (0 = unknown)
+};
+
+// Times in the entries are millis() of logBoot; now is of boot
+struct RpcAlertHeader {
+  uint32_t now;
+  uint32_t boot;                       // Sending boot id
+  uint32_t logBoot;                    // Boot the alerts were raised in (a logged alert may predate boot)
+  uint8_t count;
+  uint8_t reserved[3];
+};
+
+#define RPC_ALERT_TYPE_TEXT 0xFF       // RpcAlertEntry.type: free text (from the flash log)
+#define RPC_ALERT_SEVERITY_NONE 0xFF
+
+struct RpcAlertEntry {
+  uint8_t type;                        // AnomalyType or RPC_ALERT_TYPE_TEXT
+  uint8_t severity;                    // AlertSeverity or RPC_ALERT_SEVERITY_NONE
+  uint8_t escalated;
+  uint8_t reserved;
+  uint16_t occurrences;
+  uint16_t textLength;                 // Bytes of text following this entry
+  uint32_t firstSeen;
+  uint32_t lastSeen;
+};
+
+struct RpcCommand {
+  uint8_t target;                      // CommandTarget
+  uint8_t state;                       // 1 = on, 0 = off / stop
+};
+
+struct RpcConfigHeader {
+  uint32_t generation;
+  uint8_t count;
+  uint8_t reserved[3];
+};
+
+struct RpcLinkStats {
+  uint32_t framesSent;
+  uint32_t framesReceived;
+  uint32_t crcErrors;                  // Also COBS errors and runt frames
+  uint32_t rxOverflows;                // Frame longer than RPC_RX_BUFFER_SIZE
+  uint32_t txRefused;                  // beginFrame() with no room in the TX ring
+};
+
+// payload is only valid for the duration of the call
+typedef void (*RpcFrameCallback)(uint8_t type, uint8_t seq, const uint8_t* payload, size_t length,
+                                 void* context);
+
+// ============================================================================
+// RPC LINK CLASS
+// ============================================================================
+
+class RpcLink {
+public:
+  RpcLink();
+  void begin(Stream& port, RpcFrameCallback callback, void* context);
+
+  // Start a frame of exactly `length` payload bytes. Returns its seq, or
+  // 0 if the TX ring can't take the worst case right now (nothing queued).
+  uint8_t beginFrame(uint8_t type, size_t length);
+  void append(const void* data, size_t length);
+  void endFrame();
+  uint8_t send(uint8_t type, const void* payload, size_t length);
+
+  // Move queued bytes to the UART and parse what arrived - never blocks
+  void poll();
+
+  bool isAlive();                      // Valid frame within RPC_LINK_TIMEOUT_MS
+  bool isSending();                    // TX ring not yet drained
+  RpcLinkStats getStats();
+
+  // COBS, exposed for host tests. decode() works in place and returns
+  // the decoded length, or 0 for a malformed frame.
+  static size_t encodedSize(size_t length);
+  static size_t decode(uint8_t* buffer, size_t length);
+
+private:
+  Stream* port;
+  RpcFrameCallback callback;
+  void* context;
+  uint8_t nextSeq;
+  RpcLinkStats stats;
+
+  // TX ring of encoded bytes
+  uint8_t txBuffer[RPC_TX_BUFFER_SIZE];
+  size_t txHead;
+  size_t txTail;
+  size_t txCount;
+
+  // Frame being encoded
+  bool framing;
+  size_t codeIndex;                    // Ring index of the current COBS code byte
+  uint8_t code;
+  uint32_t frameCrc;
+
+  // RX
+  uint8_t rxBuffer[RPC_RX_BUFFER_SIZE];
+  size_t rxLength;
+  bool rxOverflow;
+  bool seen;
+  unsigned long lastFrameMillis;
+
+  void put(uint8_t byte);
+  void encodeByte(uint8_t byte);
+  void encode(const uint8_t* data, size_t length);
+  void pollTransmit();
+  void pollReceive();
+  void dispatch();
+};
+
+#endif // RPC_LINK_H
@@ -15,8 +15,16 @@
 
 #include "sensor_manager.h"
 #include "config.h"
+#include "modbus_rtu.h"
+#include "modbus_scheduler.h"
+#include "flash_log.h"
+#include "config_store.h"
+#include "adc_sampler.h"
+#include "noise_meter.h"
+#include "motion_sensor.h"
+#include "profiler.h"
+#include "sensor_trace.h"
 #include <Adafruit_SCD30.h>
-#include <ModbusMaster.h>
 #include <Wire.h>
 // Note: EEPROM not available on UNO R4 - calibration stored in RAM (resets on reboot)
 
@@ -25,24 +33,51 @@
 // ============================================================================
 
 Adafruit_SCD30 scd30;
-ModbusMaster modbusNode;
+ModbusRTU modbusBus;
+ModbusScheduler soilBus;
+
+// Background analog scan (MQ135, VWC)
+AdcSampler adcSampler;
+int8_t adcChannelMQ135 = -1;
+int8_t adcChannelVWC = -1;
+
+// Microphone blocks at audio rate (RMS / peak / band energy)
+NoiseMeter noiseMeter;
+
+// PIR edges captured by interrupt
+MotionSensor motionSensor;
 
 // ============================================================================
 // SENSOR HEALTH TRACKING
 // ============================================================================
 
-struct SensorHealth {
-  bool isValid;
-  unsigned long lastValidRead;
-  float lastValidValue;
-  uint8_t consecutiveErrors;
-  uint32_t totalReads;
-  uint32_t totalErrors;
-};
+SensorHealth scd30Health = {false, 0, 0.0f, 0, 0, 0, 0};
+SensorHealth mq135Health = {false, 0, 0.0f, 0, 0, 0, 0};
+SensorHealth modbusHealth = {false, 0, 0.0f, 0, 0, 0, 0};  // Aggregate over all soil probes
+
+// Recent error rates (last HEALTH_BUCKETS minutes) and read latencies;
+// the SensorHealth totals above remain the lifetime counts
+HealthWindow scd30Window;
+HealthWindow mq135Window;
+HealthWindow modbusWindow;
+LatencyHistogram scd30Latency;
+LatencyHistogram mq135Latency;
+LatencyHistogram modbusLatency;
+
+// ============================================================================
+// SCD-30 ACQUISITION PACING
+// ============================================================================
+
+// The SCD-30 produces one sample per SCD30_MEASUREMENT_INTERVAL seconds.
+// With SCD30_RDY_PIN wired (high while a sample is waiting) no I2C is
+// issued until it is ready; otherwise dataReady() is only asked once an
+// interval has elapsed since the last fetch. Missing samples become a
+// fault only after SCD30_OVERDUE_FACTOR intervals.
+#define SCD30_INTERVAL_MS ((unsigned long)SCD30_MEASUREMENT_INTERVAL * 1000UL)
+#define SCD30_OVERDUE_FACTOR 3
 
-SensorHealth scd30Health = {false, 0, 0.0f, 0, 0, 0};
-SensorHealth mq135Health = {false, 0, 0.0f, 0, 0, 0};
-SensorHealth modbusHealth = {false, 0, 0.0f, 0, 0, 0};
+unsigned long scd30LastSample = 0;      // millis() of the last fetch (or fault)
+uint32_t scd30Samples = 0;
 
 // ============================================================================
 // ADC CALIBRATION DATA
@@ -79,10 +114,32 @@ SensorManager::SensorManager() {
   data.co2 = 400.0f;
   data.par = 0.0f;
   data.motionDetected = false;
+  data.motionEvents = 0;
+  data.motionDuty = 0.0f;
+  data.lastMotionTime = 0;
   data.noiseLevel = 0.0f;
+  data.noisePeak = 0.0f;
+  data.noiseDbfs = MIC_DSP_SILENCE_DBFS;
+  data.noiseHighBand = 0.0f;
   data.upsActive = false;
   data.voltage = 5.0f;
   data.timestamp = 0;
+  data.sequence = 0;
+  
+  // Nothing published yet - consumers see the defaults as sequence 0
+  snapshots[0] = data;
+  snapshots[1] = data;
+  replayData = data;
+  publishedIndex = 0;
+  publishedSequence = 0;
+  replay = nullptr;
+  captureHold = nullptr;
+  
+  for (uint8_t i = 0; i < MAX_SOIL_PROBES; i++) {
+    soilProbes[i].slaveId = 0;
+    soilProbes[i].valid = false;
+    soilProbes[i].timestamp = 0;
+  }
 }
 
 // ============================================================================
@@ -122,6 +179,12 @@ void SensorManager::init() {
     // Enable/disable auto-calibration
     scd30.selfCalibrationEnabled(SCD30_AUTO_CALIBRATION);
     
+    #ifdef SCD30_RDY_PIN
+    pinMode(SCD30_RDY_PIN, INPUT);
+    #endif
+    // Ask dataReady() from the first cycle: the first sample is taken
+    // when the sensor reports it, not assumed one interval away
+    scd30LastSample = millis() - SCD30_INTERVAL_MS;
     scd30Health.isValid = true;
   } else {
     Serial.println("✗ SCD-30 initialization failed!");
@@ -130,21 +193,21 @@ void SensorManager::init() {
   
   // Initialize Modbus for RS485 soil sensor
   Serial1.begin(MODBUS_BAUD_RATE);  // Hardware serial for Modbus
-  pinMode(MODBUS_DE_RE_PIN, OUTPUT);
-  digitalWrite(MODBUS_DE_RE_PIN, LOW);  // Receive mode by default
   
-  // Initialize ModbusMaster
-  modbusNode.begin(MODBUS_SLAVE_ID, Serial1);
+  // Non-blocking RTU master handles DE/RE toggling and frame timing
+  modbusBus.begin(Serial1, MODBUS_BAUD_RATE, MODBUS_DE_RE_PIN);
   
-  // Set up preTransmission and postTransmission callbacks for RS485
-  modbusNode.preTransmission([]() {
-    digitalWrite(MODBUS_DE_RE_PIN, HIGH);  // Transmit mode
-  });
-  modbusNode.postTransmission([]() {
-    digitalWrite(MODBUS_DE_RE_PIN, LOW);   // Receive mode
-  });
+  // Register soil probes at consecutive slave IDs starting at MODBUS_SLAVE_ID
+  // Registers 0x0000 - 0x0006: Moisture, Temp, EC, pH, N, P, K
+  soilBus.begin(&modbusBus, MODBUS_REG_MOISTURE, 7, onSoilProbeResponse, this);
+  for (uint8_t i = 0; i < MODBUS_SOIL_PROBE_COUNT && i < MAX_SOIL_PROBES; i++) {
+    soilBus.addSlave(MODBUS_SLAVE_ID + i);
+    soilProbes[i].slaveId = MODBUS_SLAVE_ID + i;
+  }
   
-  Serial.println("✓ Modbus RS485 initialized");
+  Serial.print("✓ Modbus RS485 initialized (");
+  Serial.print(soilBus.getSlaveCount());
+  Serial.println(" soil probes)");
   
   // Initialize analog sensors
   analogReadResolution(ADC_RESOLUTION);
@@ -152,6 +215,11 @@ void SensorManager::init() {
   pinMode(VWC_SENSOR_PIN, INPUT);
   pinMode(MICROPHONE_PIN, INPUT);
   
+  // Continuous scan keeps a running average per channel from poll()
+  adcChannelMQ135 = adcSampler.addChannel(MQ135_SENSOR_PIN);
+  adcChannelVWC = adcSampler.addChannel(VWC_SENSOR_PIN);
+  noiseMeter.begin(MICROPHONE_PIN);
+  
   // Start MQ135 preheat timer
   mq135_startTime = millis();
   Serial.print("⏱ MQ135 preheating (requires ");
@@ -159,7 +227,7 @@ void SensorManager::init() {
   Serial.println(" hours)...");
   
   // Initialize digital sensors
-  pinMode(PIR_SENSOR_PIN, INPUT);
+  motionSensor.begin(PIR_SENSOR_PIN);  // Edge interrupt
   pinMode(UPS_STATUS_PIN, INPUT_PULLUP);
   
   Serial.println("=== Sensor Initialization Complete ===\n");
@@ -170,6 +238,14 @@ void SensorManager::init() {
 // ============================================================================
 
 void SensorManager::readAll() {
+  ProfileScope scope(PROFILE_READ_ALL);
+  
+  if (isReplaying()) {
+    // One trace reading per cycle; nothing new is published once it ends
+    if (readReplay()) publishSnapshot(replayData);
+    return;
+  }
+  
   data.timestamp = millis();
   
   // Read SCD-30 (CO2, Temperature, Humidity)
@@ -178,16 +254,101 @@ void SensorManager::readAll() {
   // Read MQ135 Air Quality
   readMQ135();
   
-  // Read Modbus soil sensor (EC, pH, Moisture, Temperature)
+  // Start a Modbus sweep over all soil probes (EC, pH, Moisture, Temperature)
+  // Results land in data via handleModbusResponse() as poll() completes them
   readModbusSensor();
   
   // Read simple digital/analog sensors
-  data.motionDetected = digitalRead(PIR_SENSOR_PIN);
+  readMotion();
   data.upsActive = !digitalRead(UPS_STATUS_PIN);  // Active low
-  data.noiseLevel = readCalibratedADC(MICROPHONE_PIN);
+  readMicrophone();
   
   // Update sensor health statistics
   updateHealthStatistics();
+  
+  // Soil values still in flight land in the next cycle's snapshot
+  publishSnapshot(data);
+}
+
+void SensorManager::publishSnapshot(const SensorData& source) {
+  uint8_t back = publishedIndex ^ 1;
+  snapshots[back] = source;
+  snapshots[back].sequence = ++publishedSequence;
+  publishedIndex = back;
+}
+
+// ============================================================================
+// TRACE REPLAY
+// ============================================================================
+
+bool SensorManager::readReplay() {
+  SensorReading reading;
+  if (!replay->next(reading)) {
+    return false;  // End of trace - the caller reports it
+  }
+  applyReading(reading, replayData);
+  return true;
+}
+
+void SensorManager::applyReading(const SensorReading& reading, SensorData& target) {
+  target.timestamp = reading.timestamp;
+  target.airTemp = reading.airTemp;
+  target.airHumidity = reading.airHumidity;
+  target.co2 = reading.co2;
+  target.ph = reading.ph;
+  target.ec = reading.ec;
+  target.vwc = reading.vwc;
+  
+  // Not in the packed format - "no data" so detectors hold their baselines
+  target.airQualityPPM = NAN;
+  target.substrateTemp = NAN;
+  target.nitrogen = NAN;
+  target.phosphorus = NAN;
+  target.potassium = NAN;
+  target.par = NAN;
+  target.motionDetected = false;
+  target.motionEvents = 0;
+  target.motionDuty = 0.0f;
+  target.noiseLevel = NAN;
+  target.noisePeak = NAN;
+  target.noiseDbfs = NAN;
+  target.noiseHighBand = NAN;
+  target.scd30ErrorRate = 0.0f;
+  target.mq135ErrorRate = 0.0f;
+  target.modbusErrorRate = 0.0f;
+}
+
+// ============================================================================
+// STARTUP / WARM BOOT
+// ============================================================================
+
+bool SensorManager::isReady() {
+  if (scd30Health.isValid) {
+    #ifdef SCD30_RDY_PIN
+    if (digitalRead(SCD30_RDY_PIN) != HIGH) return false;
+    #else
+    if (!scd30.dataReady()) return false;
+    #endif
+  }
+  
+  // Filled by poll()'s background scan
+  return adcSampler.isPrimed(adcChannelMQ135) && adcSampler.isPrimed(adcChannelVWC);
+}
+
+void SensorManager::restoreReading(const SensorReading& reading, unsigned long preheatElapsedMs) {
+  // Same fields as a replayed reading; the live readers overwrite them
+  // as each sensor reports
+  applyReading(reading, data);
+  data.timestamp = millis();
+  publishSnapshot(data);
+  
+  // The heater stayed powered through the reset
+  mq135_startTime = millis() - preheatElapsedMs;
+}
+
+unsigned long SensorManager::getPreheatElapsed() {
+  if (mq135_preheated) return MQ135_PREHEAT_TIME_MS;
+  return millis() - mq135_startTime;
 }
 
 // ============================================================================
@@ -195,42 +356,80 @@ void SensorManager::readAll() {
 // ============================================================================
 
 void SensorManager::readSCD30() {
-  scd30Health.totalReads++;
+  ProfileScope scope(PROFILE_SCD30);
+  
+  unsigned long now = millis();
   
   if (!scd30Health.isValid) {
-    // Sensor previously failed, skip reading
+    // Sensor previously failed, skip reading - but keep one failure per
+    // sample period in the window, or its error rate drains to 0%
+    if (now - scd30LastSample >= SCD30_INTERVAL_MS) {
+      scd30LastSample = now;
+      scd30Window.record(false, now);
+    }
+    return;
+  }
+  
+  #ifdef SCD30_RDY_PIN
+  bool ready = digitalRead(SCD30_RDY_PIN) == HIGH;
+  #else
+  bool ready = (now - scd30LastSample >= SCD30_INTERVAL_MS) && scd30.dataReady();
+  #endif
+  
+  if (!ready) {
+    if (now - scd30LastSample < SCD30_INTERVAL_MS * SCD30_OVERDUE_FACTOR) {
+      // No new sample yet - keep the previous one, no fault
+      scd30Health.notReady++;
+      return;
+    }
+    
+    // Overdue: the sensor stopped producing samples (one fault per period)
+    scd30LastSample = now;
+    scd30Health.totalReads++;
+    recordSCD30Fault();
     return;
   }
   
-  if (scd30.dataReady()) {
-    if (scd30.read()) {
-      float co2 = scd30.CO2;
-      float temp = scd30.temperature;
-      float humidity = scd30.relative_humidity;
+  scd30Health.totalReads++;
+  scd30LastSample = now;
+  
+  unsigned long readStart = micros();
+  bool fetched = scd30.read();
+  scd30Latency.record(micros() - readStart);
+  
+  if (fetched) {
+    float co2 = scd30.CO2;
+    float temp = scd30.temperature;
+    float humidity = scd30.relative_humidity;
+    
+    // Sanity checks
+    bool co2Valid = (co2 >= 300 && co2 <= 5000);
+    bool tempValid = (temp >= -10 && temp <= 50);
+    bool humidityValid = (humidity >= 0 && humidity <= 100);
+    
+    if (co2Valid && tempValid && humidityValid) {
+      // All readings valid
+      data.co2 = co2;
+      data.airTemp = temp;
+      data.airHumidity = humidity;
       
-      // Sanity checks
-      bool co2Valid = (co2 >= 300 && co2 <= 5000);
-      bool tempValid = (temp >= -10 && temp <= 50);
-      bool humidityValid = (humidity >= 0 && humidity <= 100);
+      scd30Health.lastValidRead = now;
+      scd30Health.lastValidValue = co2;
+      scd30Health.consecutiveErrors = 0;
+      scd30Samples++;
+      scd30Window.record(true, now);
       
-      if (co2Valid && tempValid && humidityValid) {
-        // All readings valid
-        data.co2 = co2;
-        data.airTemp = temp;
-        data.airHumidity = humidity;
-        
-        scd30Health.lastValidRead = millis();
-        scd30Health.lastValidValue = co2;
-        scd30Health.consecutiveErrors = 0;
-        
-        return;  // Success!
-      }
+      return;  // Success!
     }
   }
   
-  // Error handling
+  recordSCD30Fault();
+}
+
+void SensorManager::recordSCD30Fault() {
   scd30Health.consecutiveErrors++;
   scd30Health.totalErrors++;
+  scd30Window.record(false, millis());
   
   if (scd30Health.consecutiveErrors > MAX_SENSOR_ERRORS) {
     scd30Health.isValid = false;
@@ -246,6 +445,8 @@ void SensorManager::readSCD30() {
 // ============================================================================
 
 void SensorManager::readMQ135() {
+  ProfileScope scope(PROFILE_MQ135);
+  
   mq135Health.totalReads++;
   
   // Check if sensor is preheated
@@ -258,8 +459,10 @@ void SensorManager::readMQ135() {
     }
   }
   
+  unsigned long readStart = micros();
+  
   // Read analog voltage (with voltage divider compensation)
-  float voltage = readCalibratedADC(MQ135_SENSOR_PIN);
+  float voltage = readCalibratedADC(adcChannelMQ135);
   
   // Compensate for voltage divider (5V → 3.3V)
   // Original sensor voltage = measured voltage × (R1+R2)/R2
@@ -283,6 +486,8 @@ void SensorManager::readMQ135() {
       mq135Health.lastValidValue = airQualityPPM;
       mq135Health.lastValidRead = millis();
       mq135Health.consecutiveErrors = 0;
+      mq135Window.record(true, millis());
+      mq135Latency.record(micros() - readStart);
       return;
     }
   }
@@ -290,6 +495,8 @@ void SensorManager::readMQ135() {
   // Error handling
   mq135Health.consecutiveErrors++;
   mq135Health.totalErrors++;
+  mq135Window.record(false, millis());
+  mq135Latency.record(micros() - readStart);
   
   if (mq135Health.consecutiveErrors > MAX_SENSOR_ERRORS) {
     mq135Health.isValid = false;
@@ -303,21 +510,75 @@ void SensorManager::readMQ135() {
 // ============================================================================
 
 void SensorManager::readModbusSensor() {
-  modbusHealth.totalReads++;
+  // Returns false while the previous sweep is still in flight (slow or
+  // missing probes) - let it finish rather than stacking requests
+  soilBus.startSweep();
+}
+
+void SensorManager::poll() {
+  // Advance any in-flight Modbus transaction without blocking
+  modbusBus.poll();
   
-  uint8_t result;
-  uint16_t data16[7];  // Buffer for 7 registers
+  // PIR edges queued by the interrupt handler
+  motionSensor.service();
   
-  // Read all sensor registers in one transaction (more efficient)
-  // Registers 0x0000 - 0x0006: Moisture, Temp, EC, pH, N, P, K
-  result = modbusNode.readHoldingRegisters(MODBUS_REG_MOISTURE, 7);
+  // Background analog scan (no-op until the scan period has elapsed)
+  adcSampler.service();
   
-  if (result == modbusNode.ku8MBSuccess) {
-    // Read successful, parse data
-    for (int i = 0; i < 7; i++) {
-      data16[i] = modbusNode.getResponseBuffer(i);
-    }
-    
+  // Microphone chunk (~1 ms) - never while a frame is in flight on
+  // the RS485 bus or the co-processor link
+  if (!isBusy() && !isCaptureHeld()) {
+    noiseMeter.service();
+  }
+}
+
+void SensorManager::setMotionCallback(MotionCallback callback) {
+  motionSensor.setCallback(callback);
+}
+
+void SensorManager::setCaptureHold(bool (*hold)()) {
+  captureHold = hold;
+}
+
+bool SensorManager::isCaptureHeld() {
+  return captureHold != nullptr && captureHold();
+}
+
+void SensorManager::setReplaySource(TraceReplay* source) {
+  replay = source;
+}
+
+bool SensorManager::isReplaying() {
+  return replay != nullptr && replay->isActive();
+}
+
+unsigned long SensorManager::msUntilNextPoll() {
+  // A bus transaction in flight needs poll() at character-time granularity
+  if (isBusy()) return 1;
+  
+  unsigned long scanMs = adcSampler.msUntilNextScan();
+  unsigned long micMs = noiseMeter.msUntilNextBlock();
+  if (micMs == 0 && isCaptureHeld()) micMs = 1;  // Retry once the other port is quiet
+  return (micMs < scanMs) ? micMs : scanMs;
+}
+
+bool SensorManager::isBusy() {
+  return !modbusBus.isIdle();
+}
+
+bool SensorManager::onSoilProbeResponse(uint8_t index, uint8_t result,
+                                        const uint16_t* registers, uint8_t count,
+                                        void* context) {
+  return static_cast<SensorManager*>(context)->handleModbusResponse(index, result, registers);
+}
+
+bool SensorManager::handleModbusResponse(uint8_t index, uint8_t result, const uint16_t* data16) {
+  modbusHealth.totalReads++;
+  unsigned long transactionMicros = soilBus.getStats().lastTransactionMicros;
+  modbusLatency.record(transactionMicros);
+  profiler.record(PROFILE_MODBUS, transactionMicros);
+  
+  if (result == MODBUS_SUCCESS) {
     // Parse according to datasheet specifications
     float moisture = data16[0] / 10.0f;      // 0.1% resolution
     float soilTemp = data16[1] / 10.0f;      // 0.1°C resolution
@@ -335,34 +596,72 @@ void SensorManager::readModbusSensor() {
     
     if (moistureValid && tempValid && ecValid && phValid) {
       // All readings valid
-      data.vwc = moisture;
-      data.substrateTemp = soilTemp;
-      data.ec = ec;
-      data.ph = ph;
-      data.nitrogen = nitrogen;
-      data.phosphorus = phosphorus;
-      data.potassium = potassium;
+      SoilProbeReading& probe = soilProbes[index];
+      probe.vwc = moisture;
+      probe.substrateTemp = soilTemp;
+      probe.ec = ec;
+      probe.ph = ph;
+      probe.nitrogen = nitrogen;
+      probe.phosphorus = phosphorus;
+      probe.potassium = potassium;
+      probe.timestamp = millis();
+      probe.valid = true;
       
       modbusHealth.lastValidRead = millis();
       modbusHealth.lastValidValue = ec;  // Use EC as health indicator
       modbusHealth.consecutiveErrors = 0;
       modbusHealth.isValid = true;
+      modbusWindow.record(true, millis());
       
-      return;  // Success!
+      updateSoilAverages();
+      return true;  // Success!
     }
   }
   
   // Error handling
   modbusHealth.consecutiveErrors++;
   modbusHealth.totalErrors++;
+  modbusWindow.record(false, millis());
   
   if (modbusHealth.consecutiveErrors > MAX_SENSOR_ERRORS) {
     modbusHealth.isValid = false;
+  }
+  if (modbusHealth.consecutiveErrors == MAX_SENSOR_ERRORS + 1) {
     Serial.print("⚠️ Modbus sensor failed! Error code: 0x");
     Serial.println(result, HEX);
   }
   
   // Keep last known good values (already in data structure)
+  return false;
+}
+
+void SensorManager::updateSoilAverages() {
+  // SensorData carries the mean of all healthy probes so existing consumers
+  // (anomaly detection, buffering, sync) keep working with one value set
+  float sums[7] = {0, 0, 0, 0, 0, 0, 0};
+  uint8_t n = 0;
+  
+  for (uint8_t i = 0; i < soilBus.getSlaveCount(); i++) {
+    if (!soilProbes[i].valid || !soilBus.getSlaveHealth(i).isValid) continue;
+    sums[0] += soilProbes[i].vwc;
+    sums[1] += soilProbes[i].substrateTemp;
+    sums[2] += soilProbes[i].ec;
+    sums[3] += soilProbes[i].ph;
+    sums[4] += soilProbes[i].nitrogen;
+    sums[5] += soilProbes[i].phosphorus;
+    sums[6] += soilProbes[i].potassium;
+    n++;
+  }
+  
+  if (n == 0) return;
+  
+  data.vwc = sums[0] / n;
+  data.substrateTemp = sums[1] / n;
+  data.ec = sums[2] / n;
+  data.ph = sums[3] / n;
+  data.nitrogen = sums[4] / n;
+  data.phosphorus = sums[5] / n;
+  data.potassium = sums[6] / n;
 }
 
 // ============================================================================
@@ -370,30 +669,42 @@ void SensorManager::readModbusSensor() {
 // ============================================================================
 
 void SensorManager::loadADCCalibration() {
-  // STUB: EEPROM not available - using default calibration values
-  Serial.println("⚠️  ADC calibration using defaults (EEPROM not available)");
-  adcCal.offset = 0.0f;
-  adcCal.scale = 1.0f;
-  adcCal.vRef = ADC_VREF_NOMINAL;
-  adcCal.tempCoeff = 0.0002f;
-  adcCal.crc32 = 0;
+  // Loaded from the config store's A/B slots at boot (EEPROM not available)
+  applyCalibration(configStore.get());
+  
+  if (configStore.isPersisted()) {
+    Serial.println("✓ ADC calibration loaded from device config");
+  } else {
+    Serial.println("⚠️  ADC calibration using defaults (no stored calibration)");
+  }
 }
 
 void SensorManager::saveADCCalibration() {
-  // STUB: EEPROM not available - calibration stored in RAM only (lost on reboot)
-  adcCal.crc32 = calculateCRC32((uint8_t*)&adcCal, sizeof(ADCCalibration) - sizeof(uint32_t));
-  Serial.println("ℹ️  ADC calibration saved to RAM (will be lost on reboot)");
-}
-
-float SensorManager::readCalibratedADC(int pin) {
-  // Multi-sample averaging for noise reduction
-  uint32_t sum = 0;
-  for (int i = 0; i < ADC_SAMPLES; i++) {
-    sum += analogRead(pin);
-    delayMicroseconds(100);  // Short delay between samples
+  if (!configStore.setCalibration(adcCal.offset, adcCal.scale, adcCal.vRef, adcCal.tempCoeff)) {
+    Serial.println("✗ ADC calibration out of range - keeping the previous values");
+    applyCalibration(configStore.get());
+    return;
   }
   
-  float avgRaw = sum / (float)ADC_SAMPLES;
+  if (configStore.commit()) {
+    Serial.println("✓ ADC calibration saved to device config");
+  } else {
+    Serial.println("⚠️  ADC calibration saved to RAM only (will be lost on reboot)");
+  }
+}
+
+void SensorManager::applyCalibration(const DeviceConfig& config) {
+  adcCal.offset = config.adcOffset;
+  adcCal.scale = config.adcScale;
+  adcCal.vRef = config.adcVRef;
+  adcCal.tempCoeff = config.adcTempCoeff;
+  adcCal.crc32 = 0;  // Integrity is the config slot's CRC
+  mq135_R0 = config.mq135R0;
+}
+
+float SensorManager::readCalibratedADC(int8_t channel) {
+  // O(1): running average maintained by the background scan
+  float avgRaw = adcSampler.getAverageRaw(channel);
   
   // Convert to voltage
   float voltage = (avgRaw / ADC_MAX_VALUE) * adcCal.vRef;
@@ -408,25 +719,48 @@ float SensorManager::readCalibratedADC(int pin) {
   return voltage;
 }
 
+void SensorManager::readMotion() {
+  MotionWindow window;
+  motionSensor.takeWindow(window);
+  
+  data.motionEvents = window.events;
+  data.motionDuty = window.dutyPercent;
+  data.lastMotionTime = window.lastMotion;
+  data.motionDetected = window.events > 0 || window.active;
+}
+
+void SensorManager::readMicrophone() {
+  NoiseWindow window;
+  if (!noiseMeter.takeWindow(window)) {
+    // No block this cycle (bus kept poll() busy) - no measurement
+    data.noiseLevel = NAN;
+    data.noisePeak = NAN;
+    data.noiseDbfs = NAN;
+    data.noiseHighBand = NAN;
+    return;
+  }
+  
+  // AC amplitude: gain calibration applies, the zero offset does not
+  float voltsPerCount = adcCal.vRef / ADC_MAX_VALUE * adcCal.scale;
+  data.noiseLevel = window.rms * voltsPerCount;
+  data.noisePeak = window.peak * voltsPerCount;
+  data.noiseDbfs = window.dbfs;
+  data.noiseHighBand = window.highBandPercent;
+}
+
 // ============================================================================
 // SENSOR HEALTH MONITORING
 // ============================================================================
 
 void SensorManager::updateHealthStatistics() {
-  // Calculate error rates
-  float scd30ErrorRate = (scd30Health.totalReads > 0) ? 
-    (float)scd30Health.totalErrors / scd30Health.totalReads * 100.0f : 0.0f;
-  
-  float mq135ErrorRate = (mq135Health.totalReads > 0) ?
-    (float)mq135Health.totalErrors / mq135Health.totalReads * 100.0f : 0.0f;
-  
-  float modbusErrorRate = (modbusHealth.totalReads > 0) ?
-    (float)modbusHealth.totalErrors / modbusHealth.totalReads * 100.0f : 0.0f;
+  // Error rates over the recent window, so a sensor that starts failing
+  // after weeks of good reads shows up within minutes
+  unsigned long now = millis();
   
   // Store in data structure for Firebase sync
-  data.scd30ErrorRate = scd30ErrorRate;
-  data.mq135ErrorRate = mq135ErrorRate;
-  data.modbusErrorRate = modbusErrorRate;
+  data.scd30ErrorRate = scd30Window.getErrorRate(now);
+  data.mq135ErrorRate = mq135Window.getErrorRate(now);
+  data.modbusErrorRate = modbusWindow.getErrorRate(now);
 }
 
 SensorHealthReport SensorManager::getHealthReport() {
@@ -435,14 +769,28 @@ SensorHealthReport SensorManager::getHealthReport() {
   report.scd30Valid = scd30Health.isValid;
   report.scd30ErrorRate = data.scd30ErrorRate;
   report.scd30LastRead = scd30Health.lastValidRead;
+  scd30Latency.summarize(report.scd30Latency);
+  report.scd30Samples = scd30Samples;
+  report.scd30NotReady = scd30Health.notReady;
   
   report.mq135Valid = mq135Health.isValid;
   report.mq135ErrorRate = data.mq135ErrorRate;
   report.mq135Preheated = mq135_preheated;
+  mq135Latency.summarize(report.mq135Latency);
   
   report.modbusValid = modbusHealth.isValid;
   report.modbusErrorRate = data.modbusErrorRate;
   report.modbusLastRead = modbusHealth.lastValidRead;
+  modbusLatency.summarize(report.modbusLatency);
+  
+  ModbusSweepStats sweep = soilBus.getStats();
+  report.soilProbeCount = soilBus.getSlaveCount();
+  report.soilProbesValid = 0;
+  for (uint8_t i = 0; i < report.soilProbeCount; i++) {
+    if (soilBus.getSlaveHealth(i).isValid) report.soilProbesValid++;
+  }
+  report.modbusSweepMicros = sweep.lastSweepMicros;
+  report.modbusMaxSweepMicros = sweep.maxSweepMicros;
   
   return report;
 }
@@ -462,12 +810,7 @@ void SensorManager::performADCCalibration() {
   while (Serial.available()) Serial.read();  // Clear buffer
   
   delay(1000);
-  uint32_t zeroSum = 0;
-  for (int i = 0; i < ADC_SAMPLES; i++) {
-    zeroSum += analogRead(VWC_SENSOR_PIN);
-    delay(ADC_SAMPLE_DELAY_MS);
-  }
-  float zeroRaw = zeroSum / (float)ADC_SAMPLES;
+  float zeroRaw = captureADCWindow(adcChannelVWC);
   adcCal.offset = (zeroRaw / ADC_MAX_VALUE) * ADC_VREF_NOMINAL;
   Serial.print("Zero offset: ");
   Serial.print(adcCal.offset, 4);
@@ -484,12 +827,7 @@ void SensorManager::performADCCalibration() {
   while (Serial.available()) Serial.read();
   
   delay(1000);
-  uint32_t refSum = 0;
-  for (int i = 0; i < ADC_SAMPLES; i++) {
-    refSum += analogRead(VWC_SENSOR_PIN);
-    delay(ADC_SAMPLE_DELAY_MS);
-  }
-  float refRaw = refSum / (float)ADC_SAMPLES;
+  float refRaw = captureADCWindow(adcChannelVWC);
   float measuredVoltage = (refRaw / ADC_MAX_VALUE) * ADC_VREF_NOMINAL;
   adcCal.scale = refVoltage / (measuredVoltage - adcCal.offset);
   Serial.print("Scale factor: ");
@@ -516,6 +854,16 @@ void SensorManager::performADCCalibration() {
   Serial.println("=== CALIBRATION MODE END ===\n");
 }
 
+float SensorManager::captureADCWindow(int8_t channel) {
+  // Fresh window of samples taken after the input was connected
+  adcSampler.restart(channel);
+  while (!adcSampler.isPrimed(channel)) {
+    adcSampler.service();
+    delay(1);
+  }
+  return adcSampler.getAverageRaw(channel);
+}
+
 void SensorManager::calibrateMQ135() {
   Serial.println("\n=== MQ135 CALIBRATION MODE ===");
   Serial.println("Place sensor in clean air for 24-48 hours before calibration.");
@@ -524,22 +872,29 @@ void SensorManager::calibrateMQ135() {
   while (Serial.available()) Serial.read();
   
   // Read sensor resistance in clean air
-  float voltage = readCalibratedADC(MQ135_SENSOR_PIN);
+  float voltage = readCalibratedADC(adcChannelMQ135);
   float sensorVoltage = voltage * (MQ135_VDIV_R1 + MQ135_VDIV_R2) / MQ135_VDIV_R2;
   float Rs = (5.0 - sensorVoltage) * MQ135_LOAD_RESISTOR / sensorVoltage;
   
   // R0 = Rs / clean_air_ratio
-  mq135_R0 = Rs / MQ135_CLEAN_AIR_RATIO;
+  float r0 = Rs / MQ135_CLEAN_AIR_RATIO;
   
   Serial.print("✓ MQ135 R0 calibrated: ");
-  Serial.print(mq135_R0, 2);
+  Serial.print(r0, 2);
   Serial.println(" Ω");
   Serial.print("  Sensor resistance in clean air: ");
   Serial.print(Rs, 2);
   Serial.println(" Ω");
   
-  // STUB: Save to RAM only (no EEPROM available)
-  Serial.println("ℹ️  Calibration saved to RAM (will be lost on reboot)");
+  if (!configStore.setMQ135R0(r0)) {
+    Serial.println("✗ R0 out of range - check wiring, previous value kept");
+  } else if (configStore.commit()) {
+    mq135_R0 = r0;
+    Serial.println("✓ Calibration saved to device config");
+  } else {
+    mq135_R0 = r0;
+    Serial.println("⚠️  Calibration saved to RAM only (will be lost on reboot)");
+  }
   
   Serial.println("=== CALIBRATION MODE END ===\n");
 }
@@ -548,59 +903,107 @@ void SensorManager::calibrateMQ135() {
 // UTILITY FUNCTIONS
 // ============================================================================
 
-SensorData SensorManager::getData() {
-  return data;
+const SensorData& SensorManager::getData() {
+  return snapshots[publishedIndex];
+}
+
+uint32_t SensorManager::getSequence() {
+  return publishedSequence;
+}
+
+bool SensorManager::hasChangedSince(uint32_t sequence) {
+  return publishedSequence != sequence;
+}
+
+uint8_t SensorManager::getSoilProbeCount() {
+  return soilBus.getSlaveCount();
+}
+
+SoilProbeReading SensorManager::getSoilProbe(uint8_t index) {
+  return soilProbes[index];
 }
 
 void SensorManager::printReadings() {
+  const SensorData& snapshot = getData();
+  
   Serial.println("--- Environmental ---");
   Serial.print("Air Temp:     ");
-  Serial.print(data.airTemp, 1);
+  Serial.print(snapshot.airTemp, 1);
   Serial.println(" °C");
   Serial.print("Air Humidity: ");
-  Serial.print(data.airHumidity, 1);
+  Serial.print(snapshot.airHumidity, 1);
   Serial.println(" %");
   Serial.print("CO2:          ");
-  Serial.print(data.co2, 0);
+  Serial.print(snapshot.co2, 0);
   Serial.println(" ppm");
   Serial.print("Air Quality:  ");
-  Serial.print(data.airQualityPPM, 0);
+  Serial.print(snapshot.airQualityPPM, 0);
   Serial.println(" ppm");
   
   Serial.println("--- Soil ---");
   Serial.print("Soil Temp:    ");
-  Serial.print(data.substrateTemp, 1);
+  Serial.print(snapshot.substrateTemp, 1);
   Serial.println(" °C");
   Serial.print("Moisture:     ");
-  Serial.print(data.vwc, 1);
+  Serial.print(snapshot.vwc, 1);
   Serial.println(" %");
   Serial.print("pH:           ");
-  Serial.println(data.ph, 2);
+  Serial.println(snapshot.ph, 2);
   Serial.print("EC:           ");
-  Serial.print(data.ec, 2);
+  Serial.print(snapshot.ec, 2);
   Serial.println(" mS/cm");
   Serial.print("N-P-K:        ");
-  Serial.print(data.nitrogen, 0);
+  Serial.print(snapshot.nitrogen, 0);
   Serial.print("-");
-  Serial.print(data.phosphorus, 0);
+  Serial.print(snapshot.phosphorus, 0);
   Serial.print("-");
-  Serial.print(data.potassium, 0);
+  Serial.print(snapshot.potassium, 0);
   Serial.println(" mg/kg");
   
+  // Per-probe breakdown when several probes share the bus
+  if (soilBus.getSlaveCount() > 1) {
+    for (uint8_t i = 0; i < soilBus.getSlaveCount(); i++) {
+      Serial.print("  Probe ");
+      Serial.print(soilProbes[i].slaveId);
+      Serial.print(": ");
+      if (!soilProbes[i].valid || !soilBus.getSlaveHealth(i).isValid) {
+        Serial.println(soilBus.isBackedOff(i) ? "FAIL (backing off)" : "NO DATA");
+        continue;
+      }
+      Serial.print(soilProbes[i].vwc, 1);
+      Serial.print(" % / ");
+      Serial.print(soilProbes[i].substrateTemp, 1);
+      Serial.print(" °C / EC ");
+      Serial.println(soilProbes[i].ec, 2);
+    }
+  }
+  
   Serial.println("--- Status ---");
   Serial.print("Motion:       ");
-  Serial.println(data.motionDetected ? "YES" : "NO");
+  Serial.print(snapshot.motionDetected ? "YES" : "NO");
+  Serial.print(" (");
+  Serial.print(snapshot.motionEvents);
+  Serial.print(" triggers, ");
+  Serial.print(snapshot.motionDuty, 0);
+  Serial.println("% active)");
+  Serial.print("Noise:        ");
+  Serial.print(snapshot.noiseDbfs, 1);
+  Serial.print(" dBFS (peak ");
+  Serial.print(snapshot.noisePeak, 3);
+  Serial.print(" V, ");
+  Serial.print(snapshot.noiseHighBand, 0);
+  Serial.println("% high band)");
   Serial.print("UPS Active:   ");
-  Serial.println(data.upsActive ? "YES" : "NO");
+  Serial.println(snapshot.upsActive ? "YES" : "NO");
   Serial.print("Timestamp:    ");
-  Serial.print(data.timestamp);
+  Serial.print(snapshot.timestamp);
   Serial.println(" ms");
   Serial.println();
 }
 
 // CRC32 calculation for data integrity
-uint32_t SensorManager::calculateCRC32(const uint8_t* data, size_t length) {
-  uint32_t crc = 0xFFFFFFFF;
+uint32_t SensorManager::calculateCRC32(const uint8_t* data, size_t length, uint32_t crc) {
+  crc = ~crc;  // 0 → 0xFFFFFFFF initial value
   for (size_t i = 0; i < length; i++) {
     crc ^= data[i];
     for (int j = 0; j < 8; j++) {
@@ -5,12 +5,25 @@
  * - Adafruit SCD-30: NDIR CO2, Temperature, Humidity (I2C)
  * - MQ135: Air Quality Sensor (Analog)
  * - Modbus RS485: Soil EC/pH/Moisture/Temperature/NPK
+ *
+ * Readers fill a private working copy. At the end of each readAll() it
+ * is published into a double-buffered, sequence-numbered snapshot, and
+ * consumers get a const reference to it. That gives everyone the same
+ * view of one sensor cycle without copying the struct. A reference stays
+ * valid until the next-but-one publish, and hasChangedSince() lets idle
+ * consumers skip work.
  */
 
 #ifndef SENSOR_MANAGER_H
 #define SENSOR_MANAGER_H
 
 #include <Arduino.h>
+#include "motion_sensor.h"
+#include "health_window.h"
+
+class TraceReplay;
+struct DeviceConfig;
+struct SensorReading;
 
 // ============================================================================
 // SENSOR DATA STRUCTURE
@@ -36,8 +49,14 @@ struct SensorData {
   float par;                  // µmol/m²/s Photosynthetically Active Radiation
   
   // Security
-  bool motionDetected;        // PIR sensor
-  float noiseLevel;           // Microphone level (V)
+  bool motionDetected;        // PIR triggered during the cycle (or still high)
+  uint16_t motionEvents;      // PIR rising edges during the cycle
+  float motionDuty;           // % of the cycle the PIR output was high
+  unsigned long lastMotionTime; // millis() of the last PIR trigger (0 = never)
+  float noiseLevel;           // Microphone RMS level (V, DC removed)
+  float noisePeak;            // Microphone peak amplitude (V)
+  float noiseDbfs;            // RMS relative to ADC full scale (dBFS)
+  float noiseHighBand;        // % of sound energy above ~370 Hz
   
   // Power
   bool upsActive;             // UPS status
@@ -50,6 +69,40 @@ struct SensorData {
   
   // Metadata
   unsigned long timestamp;    // milliseconds since boot
+  uint32_t sequence;          // Snapshot number, 1 = first published cycle
+};
+
+// ============================================================================
+// SOIL PROBE DATA (one entry per Modbus slave on the RS485 bus)
+// ============================================================================
+
+#define MAX_SOIL_PROBES 16
+
+struct SoilProbeReading {
+  uint8_t slaveId;
+  bool valid;                 // At least one accepted reading
+  float substrateTemp;        // °C
+  float vwc;                  // % VWC
+  float ph;
+  float ec;                   // mS/cm
+  float nitrogen;             // mg/kg
+  float phosphorus;           // mg/kg
+  float potassium;            // mg/kg
+  unsigned long timestamp;    // millis() of last accepted reading
+};
+
+// ============================================================================
+// SENSOR HEALTH TRACKING
+// ============================================================================
+
+struct SensorHealth {
+  bool isValid;
+  unsigned long lastValidRead;
+  float lastValidValue;
+  uint8_t consecutiveErrors;
+  uint32_t totalReads;         // Fetch attempts (data was expected)
+  uint32_t totalErrors;        // Real faults only
+  uint32_t notReady;           // Polled before a new sample existed - not a fault
 };
 
 // ============================================================================
@@ -59,18 +112,27 @@ struct SensorData {
 struct SensorHealthReport {
   // SCD-30 Health
   bool scd30Valid;
-  float scd30ErrorRate;
+  float scd30ErrorRate;                // % over the health window, not lifetime
   unsigned long scd30LastRead;
+  LatencySummary scd30Latency;         // scd30.read() duration
+  uint32_t scd30Samples;               // New measurements fetched
+  uint32_t scd30NotReady;              // Cycles with no new measurement yet
   
   // MQ135 Health
   bool mq135Valid;
   float mq135ErrorRate;
+  LatencySummary mq135Latency;         // ADC lookup + conversion
   bool mq135Preheated;
   
   // Modbus Health
   bool modbusValid;
   float modbusErrorRate;
   unsigned long modbusLastRead;
+  LatencySummary modbusLatency;        // Request sent -> response, per probe
+  uint8_t soilProbeCount;
+  uint8_t soilProbesValid;
+  unsigned long modbusSweepMicros;     // Duration of last full bus sweep
+  unsigned long modbusMaxSweepMicros;
 };
 
 // ============================================================================
@@ -79,15 +141,56 @@ struct SensorHealthReport {
 
 class SensorManager {
 private:
-  SensorData data;
+  SensorData data;                // Working copy - readers write here
+  SensorData replayData;          // Replay's working copy - live data is left alone
+  SensorData snapshots[2];        // Published cycles (double buffer)
+  uint8_t publishedIndex;
+  uint32_t publishedSequence;
+  SoilProbeReading soilProbes[MAX_SOIL_PROBES];
+  TraceReplay* replay;            // Active replay replaces the hardware readers
+  bool (*captureHold)();          // Another port needs ~1 ms service - no mic chunk
+  
+  bool isCaptureHeld();
   
 public:
   SensorManager();
   void init();
   void readAll();
-  SensorData getData();
+  void poll();                // Drive non-blocking bus transactions - call every loop()
+  
+  // Startup readiness instead of a fixed settle delay: the SCD-30 has a
+  // first sample (or failed init) and the ADC windows are full
+  bool isReady();
+  
+  // Warm boot: publish the reading retained across the reset and resume
+  // the MQ135 preheat where it was (call after init())
+  void restoreReading(const SensorReading& reading, unsigned long preheatElapsedMs);
+  unsigned long getPreheatElapsed();
+  bool isBusy();              // Bus transaction in flight - poll() again within ~1 ms
+  unsigned long msUntilNextPoll();  // Longest sleep before poll() is due
+  
+  // Called from poll() on each new PIR trigger (main-loop context)
+  void setMotionCallback(MotionCallback callback);
+  
+  // Microphone chunks (busy-wait ~1 ms) also wait while this returns
+  // true - for a UART outside this class, e.g. the co-processor link
+  void setCaptureHold(bool (*hold)());
+  
+  // While the source is active, readAll() publishes trace readings
+  // instead of sampling hardware (see sensor_trace.h)
+  void setReplaySource(TraceReplay* source);
+  bool isReplaying();
+  
+  // Latest published snapshot (consistent per sensor cycle)
+  const SensorData& getData();
+  uint32_t getSequence();
+  bool hasChangedSince(uint32_t sequence);
   void printReadings();
   
+  // Per-probe soil data (SensorData holds the average of valid probes)
+  uint8_t getSoilProbeCount();
+  SoilProbeReading getSoilProbe(uint8_t index);
+  
   // Sensor health monitoring
   SensorHealthReport getHealthReport();
   void updateHealthStatistics();
@@ -98,17 +201,35 @@ public:
   void loadADCCalibration();
   void saveADCCalibration();
   
+  // Take ADC / MQ135 calibration from the device config (config_store.h)
+  void applyCalibration(const DeviceConfig& config);
+  
+  // CRC32 (IEEE 802.3) - pass the previous result as crc to continue a
+  // running checksum over several buffers
+  static uint32_t calculateCRC32(const uint8_t* data, size_t length, uint32_t crc = 0);
+  
 private:
   // Individual sensor readers
   void readSCD30();
+  void recordSCD30Fault();
   void readMQ135();
   void readModbusSensor();
+  void readMicrophone();
+  void readMotion();
+  bool readReplay();
+  void applyReading(const SensorReading& reading, SensorData& target);
   
-  // ADC utilities
-  float readCalibratedADC(int pin);
+  // Modbus completion handling (invoked from poll() via the bus scheduler)
+  static bool onSoilProbeResponse(uint8_t index, uint8_t result,
+                                  const uint16_t* registers, uint8_t count,
+                                  void* context);
+  bool handleModbusResponse(uint8_t index, uint8_t result, const uint16_t* registers);
+  void updateSoilAverages();
+  void publishSnapshot(const SensorData& source);
   
-  // Utility functions
-  uint32_t calculateCRC32(const uint8_t* data, size_t length);
+  // ADC utilities
+  float readCalibratedADC(int8_t channel);      // AdcSampler channel
+  float captureADCWindow(int8_t channel);       // Blocking - calibration only
 };
 
 #endif // SENSOR_MANAGER_H
@@ -0,0 +1,223 @@
+/**
+ * GreenOS - Sensor Rollups Implementation
+ */
+
+#include "sensor_rollup.h"
+
+static_assert(sizeof(PackedRollup) == 92, "PackedRollup layout changed");
+
+static const unsigned long windowLengths[ROLLUP_LEVEL_COUNT] = {
+  ROLLUP_1MIN_MS,
+  ROLLUP_15MIN_MS
+};
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+SensorRollup::SensorRollup() {
+  dropped = 0;
+  haveUsage = false;
+  for (uint8_t level = 0; level < ROLLUP_LEVEL_COUNT; level++) {
+    windows[level].active = false;
+    windows[level].start = 0;
+    for (uint8_t m = 0; m < ROLLUP_METRIC_COUNT; m++) {
+      resetAccumulator(windows[level].metrics[m]);
+    }
+  }
+}
+
+// ============================================================================
+// ACCUMULATION
+// ============================================================================
+
+void SensorRollup::add(const SensorData& data, const ActuatorUsage& usage) {
+  Window& minute = windows[ROLLUP_1MIN];
+  unsigned long start = data.timestamp - (data.timestamp % ROLLUP_1MIN_MS);
+
+  // Sample belongs to a later window - close the open one first
+  if (minute.active && start != minute.start) {
+    closeWindow(ROLLUP_1MIN);
+  }
+  if (!minute.active) {
+    openWindow(ROLLUP_1MIN, start);
+  }
+
+  accumulate(minute.metrics[ROLLUP_AIR_TEMP], data.airTemp);
+  accumulate(minute.metrics[ROLLUP_AIR_HUMIDITY], data.airHumidity);
+  accumulate(minute.metrics[ROLLUP_CO2], data.co2);
+  accumulate(minute.metrics[ROLLUP_PH], data.ph);
+  accumulate(minute.metrics[ROLLUP_EC], data.ec);
+  accumulate(minute.metrics[ROLLUP_VWC], data.vwc);
+
+  // On-time since the previous sample (unsigned difference survives wrap)
+  if (haveUsage) {
+    for (uint8_t id = 0; id < ACTUATOR_COUNT; id++) {
+      minute.actuatorOnMs[id] += usage.onTimeMs[id] - lastUsage.onTimeMs[id];
+    }
+  }
+  lastUsage = usage;
+  haveUsage = true;
+}
+
+void SensorRollup::resetAccumulator(RollupAccumulator& acc) {
+  acc.min = NAN;
+  acc.max = NAN;
+  acc.sum = 0.0f;
+  acc.last = NAN;
+  acc.count = 0;
+}
+
+void SensorRollup::accumulate(RollupAccumulator& acc, float value) {
+  if (isnan(value)) return;
+
+  if (acc.count == 0 || value < acc.min) acc.min = value;
+  if (acc.count == 0 || value > acc.max) acc.max = value;
+  acc.sum += value;
+  acc.last = value;
+  if (acc.count < 0xFFFF) acc.count++;
+}
+
+// ============================================================================
+// WINDOW MANAGEMENT
+// ============================================================================
+
+void SensorRollup::openWindow(RollupLevel level, unsigned long start) {
+  Window& window = windows[level];
+  window.active = true;
+  window.start = start;
+  for (uint8_t m = 0; m < ROLLUP_METRIC_COUNT; m++) {
+    resetAccumulator(window.metrics[m]);
+  }
+  for (uint8_t id = 0; id < ACTUATOR_COUNT; id++) {
+    window.actuatorOnMs[id] = 0;
+  }
+}
+
+void SensorRollup::closeWindow(RollupLevel level) {
+  Window& window = windows[level];
+  if (!window.active) return;
+
+  PackedRollup record;
+  record.version = ROLLUP_VERSION;
+  record.level = level;
+  record.reserved = 0;
+  record.windowStart = window.start;
+
+  for (uint8_t m = 0; m < ROLLUP_METRIC_COUNT; m++) {
+    const RollupAccumulator& acc = window.metrics[m];
+    RollupMetric metric = (RollupMetric)m;
+    PackedRollupMetric& out = record.metrics[m];
+
+    out.count = acc.count;
+    out.min = encodeValue(metric, acc.min);
+    out.max = encodeValue(metric, acc.max);
+    out.mean = encodeValue(metric, acc.count > 0 ? acc.sum / acc.count : NAN);
+    out.last = encodeValue(metric, acc.last);
+  }
+
+  for (uint8_t id = 0; id < ACTUATOR_COUNT; id++) {
+    uint32_t onMs = window.actuatorOnMs[id];
+    float deciWh = ActuatorManager::energyKwh((ActuatorId)id, onMs) * 10000.0f;
+    PackedActuatorUsage& out = record.actuators[id];
+
+    out.onSeconds = (uint16_t)((onMs + 500) / 1000);
+    out.energy = (deciWh >= 65535.0f) ? 0xFFFF : (uint16_t)(deciWh + 0.5f);
+  }
+
+  if (!pending.push(record)) {
+    dropped++;  // Oldest completed window overwritten
+  }
+  window.active = false;
+
+  // Cascade: each finished minute feeds the 15-minute window
+  if (level == ROLLUP_1MIN) {
+    mergeInto(ROLLUP_15MIN, window);
+  }
+}
+
+void SensorRollup::mergeInto(RollupLevel level, const Window& source) {
+  Window& target = windows[level];
+  unsigned long length = windowLengths[level];
+  unsigned long start = source.start - (source.start % length);
+
+  if (target.active && start != target.start) {
+    closeWindow(level);
+  }
+  if (!target.active) {
+    openWindow(level, start);
+  }
+
+  for (uint8_t m = 0; m < ROLLUP_METRIC_COUNT; m++) {
+    const RollupAccumulator& from = source.metrics[m];
+    RollupAccumulator& to = target.metrics[m];
+    if (from.count == 0) continue;
+
+    if (to.count == 0 || from.min < to.min) to.min = from.min;
+    if (to.count == 0 || from.max > to.max) to.max = from.max;
+    to.sum += from.sum;
+    to.last = from.last;
+    to.count = ((uint32_t)to.count + from.count > 0xFFFF) ? 0xFFFF : to.count + from.count;
+  }
+
+  for (uint8_t id = 0; id < ACTUATOR_COUNT; id++) {
+    target.actuatorOnMs[id] += source.actuatorOnMs[id];
+  }
+}
+
+// ============================================================================
+// COMPLETED WINDOWS
+// ============================================================================
+
+size_t SensorRollup::getPendingCount() {
+  return pending.size();
+}
+
+const PackedRollup& SensorRollup::getPending(size_t index) {
+  return pending.at(index);
+}
+
+void SensorRollup::consumePending(size_t count) {
+  pending.consume(count);
+}
+
+uint32_t SensorRollup::getDroppedCount() {
+  return dropped;
+}
+
+const RollupAccumulator& SensorRollup::getCurrent(RollupLevel level, RollupMetric metric) {
+  return windows[level].metrics[metric];
+}
+
+unsigned long SensorRollup::getWindowLength(RollupLevel level) {
+  return windowLengths[level];
+}
+
+// ============================================================================
+// FIXED-POINT HELPERS
+// ============================================================================
+
+float SensorRollup::metricScale(RollupMetric metric) {
+  switch (metric) {
+    case ROLLUP_AIR_TEMP:     return RECORD_SCALE_TEMP;
+    case ROLLUP_AIR_HUMIDITY: return RECORD_SCALE_HUMIDITY;
+    case ROLLUP_CO2:          return RECORD_SCALE_CO2;
+    case ROLLUP_PH:           return RECORD_SCALE_PH;
+    case ROLLUP_EC:           return RECORD_SCALE_EC;
+    default:                  return RECORD_SCALE_VWC;
+  }
+}
+
+uint16_t SensorRollup::encodeValue(RollupMetric metric, float value) {
+  if (metric == ROLLUP_AIR_TEMP) {
+    return (uint16_t)RecordCodec::toFixedSigned(value, metricScale(metric));
+  }
+  return RecordCodec::toFixedUnsigned(value, metricScale(metric));
+}
+
+float SensorRollup::decodeValue(RollupMetric metric, uint16_t raw) {
+  if (metric == ROLLUP_AIR_TEMP) {
+    return RecordCodec::fromFixedSigned((int16_t)raw, metricScale(metric));
+  }
+  return RecordCodec::fromFixedUnsigned(raw, metricScale(metric));
+}
@@ -0,0 +1,142 @@
+/**
+ * GreenOS - Sensor Rollups
+ *
+ * Streaming min/max/mean/count/last accumulators per metric for
+ * 1-minute and 15-minute windows, in fixed memory. Completed windows
+ * are packed (RecordCodec fixed-point scales) and queued for the local
+ * log and the uplink, so dashboards read pre-aggregated records instead
+ * of scanning raw readings.
+ *
+ * Only the 1-minute window is updated per sample; each closed 1-minute
+ * window is merged into the 15-minute one (min of mins, sum of sums).
+ * Windows are aligned to multiples of their length in millis() and
+ * invalid (NaN) samples are not counted.
+ *
+ * Each window also carries actuator on-time and estimated energy: the
+ * difference in ActuatorManager's since-boot usage counters between
+ * samples is booked to the window of the later sample.
+ */
+
+#ifndef SENSOR_ROLLUP_H
+#define SENSOR_ROLLUP_H
+
+#include <Arduino.h>
+#include "sensor_manager.h"
+#include "actuator_manager.h"
+#include "record_codec.h"
+#include "ring_buffer.h"
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+#define ROLLUP_VERSION 1
+#define ROLLUP_1MIN_MS 60000UL
+#define ROLLUP_15MIN_MS 900000UL
+#define ROLLUP_PENDING_CAPACITY 32     // Completed windows awaiting log/uplink
+
+enum RollupLevel {
+  ROLLUP_1MIN,
+  ROLLUP_15MIN,
+  ROLLUP_LEVEL_COUNT
+};
+
+// Same metric set and scales as PackedReading
+enum RollupMetric {
+  ROLLUP_AIR_TEMP,
+  ROLLUP_AIR_HUMIDITY,
+  ROLLUP_CO2,
+  ROLLUP_PH,
+  ROLLUP_EC,
+  ROLLUP_VWC,
+  ROLLUP_METRIC_COUNT
+};
+
+// ============================================================================
+// RECORD STRUCTURES
+// ============================================================================
+
+// Running accumulator (RAM only)
+struct RollupAccumulator {
+  float min;
+  float max;
+  float sum;
+  float last;
+  uint16_t count;
+};
+
+// Fixed-point per-metric summary. Values use the metric's RecordCodec
+// scale; air temperature is stored as the int16 bit pattern.
+struct PackedRollupMetric {
+  uint16_t count;
+  uint16_t min;
+  uint16_t max;
+  uint16_t mean;
+  uint16_t last;
+};
+
+// Actuator usage within one window
+struct PackedActuatorUsage {
+  uint16_t onSeconds;
+  uint16_t energy;               // 0.1 Wh (rated wattage × on-time)
+};
+
+// 92 bytes per completed window
+struct PackedRollup {
+  uint8_t version;
+  uint8_t level;                 // RollupLevel
+  uint16_t reserved;
+  uint32_t windowStart;          // millis() at window start
+  PackedRollupMetric metrics[ROLLUP_METRIC_COUNT];
+  PackedActuatorUsage actuators[ACTUATOR_COUNT];
+};
+
+// ============================================================================
+// SENSOR ROLLUP CLASS
+// ============================================================================
+
+class SensorRollup {
+public:
+  SensorRollup();
+
+  // Feed one snapshot with the actuator usage at the same moment;
+  // closes windows whose period has passed
+  void add(const SensorData& data, const ActuatorUsage& usage);
+
+  // Completed windows, oldest first
+  size_t getPendingCount();
+  const PackedRollup& getPending(size_t index);
+  void consumePending(size_t count);
+  uint32_t getDroppedCount();
+
+  // Live (still open) window
+  const RollupAccumulator& getCurrent(RollupLevel level, RollupMetric metric);
+  static unsigned long getWindowLength(RollupLevel level);
+
+  // Packed value helpers
+  static float metricScale(RollupMetric metric);
+  static uint16_t encodeValue(RollupMetric metric, float value);
+  static float decodeValue(RollupMetric metric, uint16_t raw);
+
+private:
+  struct Window {
+    bool active;
+    unsigned long start;
+    RollupAccumulator metrics[ROLLUP_METRIC_COUNT];
+    uint32_t actuatorOnMs[ACTUATOR_COUNT];
+  };
+
+  Window windows[ROLLUP_LEVEL_COUNT];
+  ActuatorUsage lastUsage;
+  bool haveUsage;
+  RingBuffer<PackedRollup, ROLLUP_PENDING_CAPACITY> pending;
+  uint32_t dropped;
+
+  void openWindow(RollupLevel level, unsigned long start);
+  void closeWindow(RollupLevel level);
+  void mergeInto(RollupLevel level, const Window& source);
+  static void resetAccumulator(RollupAccumulator& acc);
+  static void accumulate(RollupAccumulator& acc, float value);
+};
+
+#endif // SENSOR_ROLLUP_H
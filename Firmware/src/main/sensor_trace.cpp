@@ -0,0 +1,256 @@
+/**
+ * GreenOS - Sensor Trace Record / Replay Implementation
+ */
+
+#include "sensor_trace.h"
+
+// ============================================================================
+// RECORDER
+// ============================================================================
+
+TraceRecorder::TraceRecorder() {
+  log = nullptr;
+  recording = false;
+  pendingCount = 0;
+  blockBase = 0;
+  recordCount = 0;
+  droppedCount = 0;
+  bytesWritten = 0;
+  byteBudget = 0;
+}
+
+bool TraceRecorder::start(FlashLog* log) {
+  if (log == nullptr || !log->isAvailable()) return false;
+
+  this->log = log;
+  FlashLogStats stats = log->getStats();
+  byteBudget = TRACE_MAX_SECTORS * stats.sectorSize;
+  bytesWritten = 0;
+  if (!hasRoom()) return false;
+
+  codec.reset();
+  pendingCount = 0;
+  recordCount = 0;
+  droppedCount = 0;
+  recording = true;
+  return true;
+}
+
+void TraceRecorder::stop() {
+  if (!recording) return;
+
+  flush();
+  recording = false;
+}
+
+bool TraceRecorder::isRecording() {
+  return recording;
+}
+
+void TraceRecorder::add(const SensorData& data) {
+  if (!recording) return;
+
+  PackedReading packed = codec.pack(data);
+  if (pendingCount == 0) {
+    // Block header carries the absolute time of its first reading
+    blockBase = codec.getLastTimestamp();
+  }
+  pending[pendingCount++] = packed;
+  recordCount++;
+
+  if (pendingCount == TRACE_BLOCK_RECORDS) {
+    flush();
+    if (!hasRoom()) {
+      recording = false;
+    }
+  }
+}
+
+bool TraceRecorder::hasRoom() {
+  // Room for one more block within the budget, and for the rest of the
+  // budget before the head reaches unsynced sectors
+  if (bytesWritten + TRACE_BLOCK_BYTES > byteBudget) return false;
+
+  FlashLogStats stats = log->getStats();
+  uint32_t remainingSectors = TRACE_MAX_SECTORS - bytesWritten / stats.sectorSize;
+  return stats.unsyncedSectors + remainingSectors < stats.sectorCount;
+}
+
+void TraceRecorder::flush() {
+  if (pendingCount == 0) return;
+
+  PackedBlockHeader header = RecordCodec::blockHeader(pendingCount, blockBase);
+  if (!log->append(LOG_TYPE_TRACE,
+                   (const uint8_t*)&header, sizeof(header),
+                   (const uint8_t*)pending, pendingCount * sizeof(PackedReading))) {
+    droppedCount += pendingCount;
+  } else {
+    bytesWritten += sizeof(header) + pendingCount * sizeof(PackedReading);
+  }
+  pendingCount = 0;
+}
+
+uint32_t TraceRecorder::getRecordCount() {
+  return recordCount;
+}
+
+uint32_t TraceRecorder::getDroppedCount() {
+  return droppedCount;
+}
+
+// ============================================================================
+// REPLAY
+// ============================================================================
+
+TraceReplay::TraceReplay() {
+  source = SOURCE_NONE;
+  log = nullptr;
+  cursor.sequence = 0;
+  cursor.offset = 0;
+  memory = nullptr;
+  memoryLength = 0;
+  memoryOffset = 0;
+  block = nullptr;
+  blockCount = 0;
+  blockIndex = 0;
+  blockBase = 0;
+  traceTime = 0;
+  replayClock = 0;
+  started = false;
+  replayedCount = 0;
+}
+
+bool TraceReplay::startFromLog(FlashLog* log) {
+  if (log == nullptr || !log->isAvailable()) return false;
+
+  this->log = log;
+  cursor = log->getOldestCursor();
+  source = SOURCE_LOG;
+  blockCount = 0;
+  blockIndex = 0;
+  started = false;
+  replayedCount = 0;
+
+  // Nothing to play - don't report an active replay
+  if (!loadBlock()) {
+    source = SOURCE_NONE;
+    return false;
+  }
+  return true;
+}
+
+bool TraceReplay::startFromMemory(const uint8_t* trace, size_t length) {
+  if (trace == nullptr) return false;
+
+  memory = trace;
+  memoryLength = length;
+  memoryOffset = 0;
+  source = SOURCE_MEMORY;
+  blockCount = 0;
+  blockIndex = 0;
+  started = false;
+  replayedCount = 0;
+
+  if (!loadBlock()) {
+    source = SOURCE_NONE;
+    return false;
+  }
+  return true;
+}
+
+void TraceReplay::stop() {
+  source = SOURCE_NONE;
+  blockCount = 0;
+  blockIndex = 0;
+}
+
+bool TraceReplay::isActive() {
+  return source != SOURCE_NONE;
+}
+
+bool TraceReplay::next(SensorReading& out) {
+  if (source == SOURCE_NONE) return false;
+
+  if (blockIndex >= blockCount && !loadBlock()) {
+    stop();
+    return false;
+  }
+
+  // Blocks in memory need not be aligned
+  PackedReading packed;
+  memcpy(&packed, block + blockIndex * sizeof(PackedReading), sizeof(packed));
+
+  unsigned long recorded = (blockIndex == 0) ? blockBase
+                                             : traceTime + RecordCodec::deltaMillis(packed);
+  blockIndex++;
+
+  if (!started) {
+    started = true;
+    replayClock = millis();
+  } else if ((long)(recorded - traceTime) >= 0) {
+    replayClock += recorded - traceTime;
+  } else {
+    // A new recording session (earlier boot time) - keep time moving forward
+    replayClock += TRACE_SESSION_GAP_MS;
+  }
+  traceTime = recorded;
+
+  RecordCodec::unpack(packed, replayClock, out);
+  replayedCount++;
+  return true;
+}
+
+uint32_t TraceReplay::getReplayedCount() {
+  return replayedCount;
+}
+
+// ============================================================================
+// BLOCK LOADING
+// ============================================================================
+
+bool TraceReplay::loadBlock() {
+  blockCount = 0;
+  blockIndex = 0;
+
+  if (source == SOURCE_LOG) return loadLogBlock();
+  if (source == SOURCE_MEMORY) return loadMemoryBlock();
+  return false;
+}
+
+bool TraceReplay::loadLogBlock() {
+  uint8_t type;
+  size_t length;
+
+  // Readings, alerts and rollups are skipped (larger records never fit)
+  FlashLogReadResult result;
+  while ((result = log->readNext(cursor, type, buffer, sizeof(buffer), length)) != FLASH_LOG_READ_END) {
+    if (result == FLASH_LOG_READ_OVERSIZE || type != LOG_TYPE_TRACE) continue;
+
+    PackedBlockHeader header;
+    size_t used = RecordCodec::readBlockHeader(buffer, length, header);
+    if (used == 0 || header.count == 0) continue;
+
+    block = buffer + used;
+    blockCount = header.count;
+    blockBase = header.baseTimestamp;
+    return true;
+  }
+  return false;
+}
+
+bool TraceReplay::loadMemoryBlock() {
+  while (memoryOffset < memoryLength) {
+    PackedBlockHeader header;
+    size_t used = RecordCodec::readBlockHeader(memory + memoryOffset, memoryLength - memoryOffset, header);
+    if (used == 0) return false;  // Truncated or not a block - end of trace
+
+    block = memory + memoryOffset + used;
+    memoryOffset += RecordCodec::blockSize(header.count);
+    if (header.count == 0) continue;
+
+    blockCount = header.count;
+    blockBase = header.baseTimestamp;
+    return true;
+  }
+  return false;
+}
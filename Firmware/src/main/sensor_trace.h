@@ -0,0 +1,130 @@
+/**
+ * GreenOS - Sensor Trace Record / Replay
+ *
+ * TraceRecorder captures published SensorData snapshots into the local
+ * log as LOG_TYPE_TRACE records: RecordCodec blocks (8-byte header + up
+ * to TRACE_BLOCK_RECORDS 14-byte PackedReadings), the same format as
+ * buffered readings. Trace records are skipped by the uplink sync.
+ *
+ * Traces share the log ring with unsynced telemetry, so a recording is
+ * capped at TRACE_MAX_SECTORS of log space. It refuses to start, and
+ * stops early, when the cap plus the unsynced sectors would wrap the
+ * ring and erase telemetry that never reached the cloud.
+ *
+ * TraceReplay plays a trace back through SensorManager::readAll(), one
+ * record per sensor cycle, from the log or from a block buffer in memory
+ * (e.g. a trace compiled into the image). Timestamps are rebased onto a
+ * monotonic clock starting at the replay start, so session boundaries in
+ * a recording never move time backwards; running the sensor task faster
+ * than its normal period compresses hours of data into minutes.
+ *
+ * Only the packed fields (air temp/humidity, CO2, pH, EC, VWC) are
+ * replayed; everything else reads as "no data" (NaN / 0).
+ */
+
+#ifndef SENSOR_TRACE_H
+#define SENSOR_TRACE_H
+
+#include <Arduino.h>
+#include "record_codec.h"
+#include "flash_log.h"
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+#define TRACE_BLOCK_RECORDS 16        // Readings per LOG_TYPE_TRACE record (232 bytes)
+#define TRACE_BLOCK_BYTES (sizeof(PackedBlockHeader) + TRACE_BLOCK_RECORDS * sizeof(PackedReading))
+#define TRACE_SESSION_GAP_MS 60000UL  // Replayed gap where a recording restarts (earlier boot time)
+
+#ifndef TRACE_MAX_SECTORS
+#define TRACE_MAX_SECTORS 2           // Log sectors one recording may fill
+#endif
+
+// ============================================================================
+// RECORDER
+// ============================================================================
+
+class TraceRecorder {
+public:
+  TraceRecorder();
+
+  // False if the log is unavailable or can't hold a full trace beside
+  // the unsynced data
+  bool start(FlashLog* log);
+  void stop();                         // Flushes the partial block
+  bool isRecording();
+
+  // Append one snapshot (call once per published cycle). Recording
+  // stops by itself once the log share is used.
+  void add(const SensorData& data);
+
+  uint32_t getRecordCount();           // Snapshots captured since start()
+  uint32_t getDroppedCount();          // Lost to log write failures
+
+private:
+  FlashLog* log;
+  bool recording;
+  RecordCodec codec;
+  PackedReading pending[TRACE_BLOCK_RECORDS];
+  uint16_t pendingCount;
+  unsigned long blockBase;             // Decoded time of pending[0]
+  uint32_t recordCount;
+  uint32_t droppedCount;
+  uint32_t bytesWritten;
+  uint32_t byteBudget;                 // TRACE_MAX_SECTORS of this log
+
+  void flush();
+  bool hasRoom();
+};
+
+// ============================================================================
+// REPLAY
+// ============================================================================
+
+class TraceReplay {
+public:
+  TraceReplay();
+
+  // Play every LOG_TYPE_TRACE record, oldest first
+  bool startFromLog(FlashLog* log);
+
+  // Play concatenated RecordCodec blocks (RecordCodec::writeBlock output)
+  bool startFromMemory(const uint8_t* trace, size_t length);
+
+  void stop();
+  bool isActive();
+
+  // Next reading with its rebased timestamp; false (and inactive) at end
+  bool next(SensorReading& out);
+
+  uint32_t getReplayedCount();
+
+private:
+  enum Source { SOURCE_NONE, SOURCE_LOG, SOURCE_MEMORY };
+
+  Source source;
+  FlashLog* log;
+  FlashLogCursor cursor;
+  const uint8_t* memory;
+  size_t memoryLength;
+  size_t memoryOffset;
+
+  // Current block
+  uint8_t buffer[TRACE_BLOCK_BYTES];   // Log source only
+  const uint8_t* block;                // First PackedReading of the block
+  uint16_t blockCount;
+  uint16_t blockIndex;
+  unsigned long blockBase;             // Recorded time of the block's first reading
+  unsigned long traceTime;             // Recorded time of the last reading
+
+  unsigned long replayClock;           // Rebased time handed out
+  bool started;
+  uint32_t replayedCount;
+
+  bool loadBlock();
+  bool loadLogBlock();
+  bool loadMemoryBlock();
+};
+
+#endif // SENSOR_TRACE_H
@@ -0,0 +1,53 @@
+/**
+ * GreenOS - Single-Producer / Single-Consumer Ring
+ *
+ * Lock-free queue between one interrupt handler (producer) and the main
+ * loop (consumer). Each side writes only its own free-running index, so
+ * no interrupt masking is needed; a barrier orders the slot write before
+ * the index update. Unlike RingBuffer, a full ring rejects the new entry
+ * (the producer cannot move the consumer's tail).
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <Arduino.h>
+
+template <typename T, size_t N>
+class SpscRing {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "SpscRing capacity must be a power of two");
+
+public:
+  SpscRing() : head(0), tail(0) {}
+
+  // Producer side (ISR). Returns false if the ring is full.
+  bool push(const T& item) {
+    size_t h = head;
+    if (h - tail == N) return false;
+    items[h & (N - 1)] = item;
+    __sync_synchronize();  // Slot visible before the index
+    head = h + 1;
+    return true;
+  }
+
+  // Consumer side (main loop). Returns false if the ring is empty.
+  bool pop(T& item) {
+    size_t t = tail;
+    if (t == head) return false;
+    item = items[t & (N - 1)];
+    __sync_synchronize();  // Slot read before it is released
+    tail = t + 1;
+    return true;
+  }
+
+  size_t size() { return head - tail; }
+  bool isEmpty() { return head == tail; }
+  size_t capacity() { return N; }
+
+private:
+  T items[N];
+  volatile size_t head;   // Written by the producer only
+  volatile size_t tail;   // Written by the consumer only
+};
+
+#endif // SPSC_RING_H
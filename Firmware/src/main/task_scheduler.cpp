@@ -0,0 +1,197 @@
+/**
+ * GreenOS - Cooperative Task Scheduler Implementation
+ *
+ * - Deadlines advance by whole periods so tasks keep a fixed phase; a task
+ *   that falls more than one period behind is re-phased from now instead
+ *   of bursting to catch up
+ * - Run time is measured with micros() around each callback
+ * - The order table is re-sorted with an insertion sort after every run
+ *   (tiny N, already nearly sorted, so this is effectively O(N))
+ */
+
+#include "task_scheduler.h"
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+
+TaskScheduler::TaskScheduler() {
+  taskCount = 0;
+}
+
+// ============================================================================
+// TASK TABLE MANAGEMENT
+// ============================================================================
+
+int TaskScheduler::addTask(const char* name, TaskCallback callback, unsigned long periodMs,
+                           TaskPriority priority, unsigned long initialDelayMs) {
+  if (taskCount >= MAX_SCHEDULED_TASKS || callback == nullptr) {
+    return -1;
+  }
+
+  uint8_t id = taskCount;
+  ScheduledTask& task = tasks[id];
+  task.name = name;
+  task.callback = callback;
+  task.periodMs = periodMs;
+  task.nextDeadline = millis() + initialDelayMs;
+  task.priority = priority;
+  task.enabled = true;
+  task.runCount = 0;
+  task.lastRunMicros = 0;
+  task.maxRunMicros = 0;
+  task.totalRunMicros = 0;
+  task.maxLatenessMs = 0;
+
+  order[taskCount++] = id;
+  sortOrder();
+  return id;
+}
+
+void TaskScheduler::setEnabled(int taskId, bool enabled) {
+  if (taskId < 0 || taskId >= taskCount) return;
+
+  ScheduledTask& task = tasks[taskId];
+  if (enabled && !task.enabled) {
+    task.nextDeadline = millis() + task.periodMs;
+  }
+  task.enabled = enabled;
+  sortOrder();
+}
+
+void TaskScheduler::setPeriod(int taskId, unsigned long periodMs) {
+  if (taskId < 0 || taskId >= taskCount) return;
+
+  tasks[taskId].periodMs = periodMs;
+  tasks[taskId].nextDeadline = millis() + periodMs;
+  sortOrder();
+}
+
+void TaskScheduler::resetDeadlines() {
+  unsigned long now = millis();
+  for (uint8_t i = 0; i < taskCount; i++) {
+    tasks[i].nextDeadline = now;
+  }
+  sortOrder();
+}
+
+void TaskScheduler::runSoon(int taskId) {
+  if (taskId < 0 || taskId >= taskCount || !tasks[taskId].enabled) return;
+
+  tasks[taskId].nextDeadline = millis();
+  sortOrder();
+}
+
+// ============================================================================
+// DISPATCH
+// ============================================================================
+
+bool TaskScheduler::runNext() {
+  if (taskCount == 0) return false;
+
+  ScheduledTask& task = tasks[order[0]];
+  unsigned long now = millis();
+
+  if (!task.enabled || (long)(now - task.nextDeadline) < 0) {
+    return false;  // Front of the queue is not due, so nothing is
+  }
+
+  unsigned long lateness = now - task.nextDeadline;
+  if (lateness > task.maxLatenessMs) {
+    task.maxLatenessMs = lateness;
+  }
+
+  // Advance deadline before running so a slow task cannot starve others
+  if (lateness >= task.periodMs) {
+    task.nextDeadline = now + task.periodMs;
+  } else {
+    task.nextDeadline += task.periodMs;
+  }
+
+  unsigned long start = micros();
+  task.callback();
+  unsigned long elapsed = micros() - start;
+
+  task.runCount++;
+  task.lastRunMicros = elapsed;
+  task.totalRunMicros += elapsed;
+  if (elapsed > task.maxRunMicros) {
+    task.maxRunMicros = elapsed;
+  }
+
+  sortOrder();
+  return true;
+}
+
+unsigned long TaskScheduler::msUntilNextDeadline() {
+  if (taskCount == 0 || !tasks[order[0]].enabled) {
+    return 0xFFFFFFFFUL;
+  }
+
+  long remaining = (long)(tasks[order[0]].nextDeadline - millis());
+  return (remaining > 0) ? (unsigned long)remaining : 0;
+}
+
+// ============================================================================
+// ORDERING
+// ============================================================================
+
+bool TaskScheduler::runsBefore(uint8_t a, uint8_t b) {
+  const ScheduledTask& ta = tasks[a];
+  const ScheduledTask& tb = tasks[b];
+
+  if (ta.enabled != tb.enabled) return ta.enabled;
+
+  long diff = (long)(ta.nextDeadline - tb.nextDeadline);  // Rollover safe
+  if (diff != 0) return diff < 0;
+
+  return ta.priority < tb.priority;
+}
+
+void TaskScheduler::sortOrder() {
+  for (uint8_t i = 1; i < taskCount; i++) {
+    uint8_t id = order[i];
+    int j = i - 1;
+    while (j >= 0 && runsBefore(id, order[j])) {
+      order[j + 1] = order[j];
+      j--;
+    }
+    order[j + 1] = id;
+  }
+}
+
+// ============================================================================
+// STATUS
+// ============================================================================
+
+uint8_t TaskScheduler::getTaskCount() {
+  return taskCount;
+}
+
+ScheduledTask TaskScheduler::getTask(int taskId) {
+  return tasks[taskId];
+}
+
+void TaskScheduler::printStatus() {
+  Serial.println("\n=== Task Scheduler ===");
+  for (uint8_t i = 0; i < taskCount; i++) {
+    const ScheduledTask& task = tasks[order[i]];
+    Serial.print(task.name);
+    Serial.print(task.enabled ? "" : " (disabled)");
+    Serial.print(": period ");
+    Serial.print(task.periodMs);
+    Serial.print(" ms, runs ");
+    Serial.print(task.runCount);
+    Serial.print(", last ");
+    Serial.print(task.lastRunMicros);
+    Serial.print(" us, max ");
+    Serial.print(task.maxRunMicros);
+    Serial.print(" us, late max ");
+    Serial.print(task.maxLatenessMs);
+    Serial.println(" ms");
+  }
+  Serial.print("Next deadline in: ");
+  Serial.print(msUntilNextDeadline());
+  Serial.println(" ms");
+  Serial.println();
+}
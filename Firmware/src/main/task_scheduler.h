@@ -0,0 +1,85 @@
+/**
+ * GreenOS - Cooperative Task Scheduler
+ *
+ * Fixed-capacity table of periodic tasks run from loop(). Tasks are kept
+ * ordered by next deadline (ties broken by priority) so the most urgent
+ * task is always at the front and the idle time until the next deadline
+ * is known - loop() can sleep exactly that long instead of spinning.
+ */
+
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// CONFIGURATION
+// ============================================================================
+
+#define MAX_SCHEDULED_TASKS 12
+
+enum TaskPriority {
+  TASK_PRIORITY_CRITICAL,   // Sensor cycle - anomaly detection runs in it
+  TASK_PRIORITY_HIGH,       // Control loops
+  TASK_PRIORITY_NORMAL,     // Sync, health checks
+  TASK_PRIORITY_LOW         // Housekeeping (SD flush)
+};
+
+typedef void (*TaskCallback)();
+
+// ============================================================================
+// TASK DATA STRUCTURE
+// ============================================================================
+
+struct ScheduledTask {
+  const char* name;
+  TaskCallback callback;
+  unsigned long periodMs;
+  unsigned long nextDeadline;   // millis() when the task is next due
+  TaskPriority priority;
+  bool enabled;
+
+  // Measured run time
+  uint32_t runCount;
+  unsigned long lastRunMicros;
+  unsigned long maxRunMicros;
+  unsigned long totalRunMicros;
+  unsigned long maxLatenessMs;  // Worst start delay past the deadline
+};
+
+// ============================================================================
+// TASK SCHEDULER CLASS
+// ============================================================================
+
+class TaskScheduler {
+public:
+  TaskScheduler();
+
+  // Returns task id, or -1 if the table is full
+  int addTask(const char* name, TaskCallback callback, unsigned long periodMs,
+              TaskPriority priority, unsigned long initialDelayMs = 0);
+  void setEnabled(int taskId, bool enabled);
+  void setPeriod(int taskId, unsigned long periodMs);
+  void resetDeadlines();        // Restart all periods from now
+  void runSoon(int taskId);     // Due now; period restarts after it runs
+
+  // Run the single most urgent due task. Returns false if none is due.
+  bool runNext();
+
+  // Milliseconds until the earliest enabled deadline (0 = something is due)
+  unsigned long msUntilNextDeadline();
+
+  uint8_t getTaskCount();
+  ScheduledTask getTask(int taskId);
+  void printStatus();
+
+private:
+  ScheduledTask tasks[MAX_SCHEDULED_TASKS];
+  uint8_t order[MAX_SCHEDULED_TASKS];   // Task ids sorted by deadline, then priority
+  uint8_t taskCount;
+
+  void sortOrder();
+  bool runsBefore(uint8_t a, uint8_t b);
+};
+
+#endif // TASK_SCHEDULER_H